@@ -0,0 +1,42 @@
+/*
+   SWORD Emurator  batch runner
+
+   Runs many independent sessions listed in a job file.
+*/
+
+#ifndef	_BATCH_H_
+#define	_BATCH_H_
+
+#include "sim-type.h"
+
+/** Options of a batch run
+ */
+struct batch_opts {
+	int	threads;		/* workers, 0 for one per host core */
+	int	jit;			/* run hot code as host code */
+	int	hle;			/* run known routines as host code */
+	int	caps;			/* software CAPS LOCK */
+	unsigned long long vsync;	/* T-states between vsync interrupts,
+					   0 if none */
+	unsigned long long limit;	/* T-states per session, 0 if unlimited */
+	const char *pairs;		/* file to write the op-code pair
+					   counts to, NULL if not profiled */
+	const char *profile;		/* file to write the profile of each
+					   session to, NULL if not profiled */
+	const char *stats;		/* file to write the trap statistics
+					   of each session to, NULL if none */
+	const char *trace;		/* file to dump the instruction trace
+					   of each session to, NULL if none */
+	const char *snapshot;		/* snapshot every session starts
+					   from, NULL to cold boot */
+	const char *replay;		/* log every session replays, or to
+					   record each session to, NULL if
+					   none */
+	int	replaymode;		/* REPLAY_RECORD or REPLAY_PLAY */
+	int	fork;			/* run the sessions as a fork server */
+	WORD	forkpc;			/* fork point of the fork server */
+};
+
+int batch_run(const char *_jobfile, const struct batch_opts *_opts);
+
+#endif	/* _BATCH_H_ */
@@ -0,0 +1,133 @@
+/*
+   SWORD Emurator  Z80 basic block cache
+
+   Pre-decoded basic blocks for simz80().
+*/
+
+#ifndef	_BBCACHE_H_
+#define	_BBCACHE_H_
+
+#include "sim-type.h"
+#include "simz80.h"
+
+#define	BB_MAX_INSNS	(32)		/* max instructions in a block */
+#define	BB_NR_BLOCKS	(4096)		/* number of block descriptors */
+#define	BB_NR_RECORDS	(BB_NR_BLOCKS * 8)	/* size of record arena */
+#define	BB_HOT		(2)		/* entries before translation */
+#define	BB_SMC_LIMIT	(16)		/* invalidations before a page
+					   is left to the interpreter */
+#define	BB_NOADDR	(0x10000)	/* never matches a Z80 address */
+#define	BB_OP_EXIT	(0x100)		/* leaves the block */
+#define	BB_OP_FUSED	(0x101)		/* the first fused op-code pair */
+#define	BB_NR_PAIRS	(256*256)	/* op-code pairs */
+
+/** Pre-decoded Z80 instruction
+ */
+struct bb_insn {
+	unsigned int	addr;	/* address of op-code, BB_NOADDR if stale */
+	WORD	next;		/* address of the following instruction */
+	WORD	target;		/* resolved relative branch target */
+	WORD	imm;		/* resolved 8/16 bit immediate operand */
+	WORD	op;		/* first op-code byte (prefix for CB/DD/ED/FD),
+				   BB_OP_EXIT if stale */
+	WORD	xop;		/* handler of the block executor: op, or
+				   BB_OP_FUSED + n for the first record of
+				   fused pair n */
+	BYTE	len;		/* instruction length in bytes */
+};
+
+/** Decoded basic block
+ */
+struct bb_block {
+	WORD	start;		/* address of the first instruction */
+	unsigned int end;	/* address after the last instruction */
+	int	ninsn;		/* number of records, 0 if invalidated */
+	struct bb_insn *insn;	/* records followed by a BB_OP_EXIT sentinel */
+	void	*native;	/* host code translated by jit.c */
+};
+
+/** Block cache of a machine
+ */
+struct bb_cache {
+	struct bb_block	*map[64*1024];	/* block which starts at an address */
+	BYTE	code_map[64*1024/8];	/* addresses covered by blocks */
+	struct bb_block	blocks[BB_NR_BLOCKS];
+	struct bb_insn	records[BB_NR_RECORDS];
+	int	nblocks;		/* used block descriptors */
+	int	nrecords;		/* used records */
+	BYTE	heat[64*1024];		/* entries before translation */
+	BYTE	smc[256];		/* invalidations of each page */
+	unsigned long *pairs;		/* entries of each op-code pair,
+					   NULL unless profiled */
+};
+
+/** Determine whether an address is a part of a cached block.
+    @param[in] _a Z80 address
+    @note This needs the machine as "cpu".
+ */
+#define BB_IS_CODE(_a)							\
+	( cpu->bb->code_map[ ( (_a) & 0xffff ) >> 3 ] & ( 1 << ( (_a) & 7 ) ) )
+
+#ifdef OPT_BBCACHE
+/** Notify a write to Z80 memory which may hit a cached block.
+    @param[in] _a Z80 address written
+ */
+#define BB_CHECK(_a) do{					\
+		if ( BB_IS_CODE(_a) )				\
+			bb_code_written( cpu, (_a) & 0xffff );	\
+	}while(0)
+/** Notify a write to Z80 memory done by the host.
+    @param[in] _a   the first address written
+    @param[in] _len the number of bytes written
+ */
+#define BB_INVALIDATE(_a, _len) do{				\
+		bb_invalidate_range( cpu, (_a), (_len) );	\
+		HLE_INVALIDATE( (_a), (_len) );			\
+	}while(0)
+/** Notify a block write to Z80 memory done by Z80 code.
+    @param[in] _a   the first address written
+    @param[in] _len the number of bytes written, not wrapping at 0xffff
+ */
+#define BB_CHECK_RANGE(_a, _len) do{				\
+		bb_code_written_range( cpu, (_a), (_len) );	\
+	}while(0)
+#else
+#define BB_CHECK(_a) do{ }while(0)
+#define BB_CHECK_RANGE(_a, _len) do{ }while(0)
+#define BB_INVALIDATE(_a, _len) HLE_INVALIDATE( (_a), (_len) )
+#endif
+
+int bb_alloc(struct z80_cpu *_cpu);
+void bb_free(struct z80_cpu *_cpu);
+void bb_init(struct z80_cpu *_cpu);
+void bb_flush(struct z80_cpu *_cpu);
+void bb_code_written(struct z80_cpu *_cpu, WORD _addr);
+void bb_code_written_range(struct z80_cpu *_cpu, WORD _addr, int _len);
+void bb_invalidate_range(struct z80_cpu *_cpu, WORD _addr, int _len);
+const struct bb_insn *bb_miss(struct z80_cpu *_cpu, WORD _pc);
+int bb_profile_pairs(struct z80_cpu *_cpu);
+void bb_count_pairs(struct z80_cpu *_cpu, const struct bb_insn *_ins);
+void bb_add_pairs(unsigned long *_sum, const struct z80_cpu *_cpu);
+int bb_write_pairs(const char *_name, const unsigned long *_pairs);
+
+#ifdef OPT_FUSION
+/* op-code pairs with a fused handler, made by simz80.pl */
+extern const BYTE z80_fuse_pairs[][2];
+extern const int z80_nfuse;
+#endif
+
+/** Find the decoded block which starts at the specified address.
+    @param[in] cpu the machine
+    @param[in] pc  Z80 address
+    @retval NULL no block (interpret the code)
+    @return the first record of the block
+ */
+static inline const struct bb_insn *
+bb_lookup(struct z80_cpu *cpu, WORD pc){
+
+	if ( cpu->bb->map[pc] != NULL )
+		return cpu->bb->map[pc]->insn;
+	return bb_miss(cpu, pc);
+}
+
+#endif  /*  _BBCACHE_H_  */
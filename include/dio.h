@@ -15,6 +15,7 @@
 int dio_dread(unsigned char *buf, int diskno, int recno, int numrec);
 int dio_dwrite(unsigned char *buf, int diskno, int recno, int numrec);
 void dio_diclose(int diskno);
+void dio_reset(void);
 
 /* file I/O */
 int dio_wopen(char *name, int attr, int dtadr, int size, int exadr);
@@ -24,7 +25,22 @@ int dio_wdd(unsigned char *buf, int len);
 int dio_rdd(unsigned char *buf, int len);
 
 /* disk image file name */
-extern char	*dio_disk[SOS_MAXIMAGEDRIVES];
+extern __thread char	*dio_disk[SOS_MAXIMAGEDRIVES];
+
+#define	DIO_PATHLEN	(256)	/* longest file name kept in a snapshot */
+
+/** Files of a session, see dio_save()
+ */
+struct dio_state {
+	char	disk[SOS_MAXIMAGEDRIVES][DIO_PATHLEN];	/* "" if not mounted */
+	char	open[DIO_PATHLEN];	/* the open file, "" if none */
+	long	pos;			/* its position */
+	int	write;			/* opened by dio_wopen() */
+	int	ascii;			/* in ascii convert mode */
+};
+
+int dio_save(struct dio_state *_st);
+int dio_load(const struct dio_state *_st);
 
 #define SOS_TAPE_COMMON_IDX   (0)  /* Common MZ format tape */
 #define SOS_TAPE_MONITOR_IDX  (1)  /* Monitor specific format tape */
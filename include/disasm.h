@@ -0,0 +1,25 @@
+/*
+   SWORD Emurator  Z80 disassembler
+*/
+
+#ifndef	_DISASM_H_
+#define	_DISASM_H_
+
+#include <stddef.h>
+#include "sim-type.h"
+
+#define	DISASM_MAX	(4)		/* longest instruction in bytes */
+#define	DISASM_BUFSIZ	(24)		/* enough for any instruction */
+
+struct z80_cpu;
+
+/* mnemonics of the op-codes, in simz80.c */
+extern const char *const z80_mn_op[256];	/* xx */
+extern const char *const z80_mn_cb[256];	/* CB xx */
+extern const char *const z80_mn_ed[256];	/* ED xx */
+extern const char *const z80_mn_xy[256];	/* DD xx, FD xx */
+
+int disasm(const BYTE *_code, WORD _addr, char *_buf, size_t _len);
+int disasm_ram(struct z80_cpu *_cpu, WORD _addr, char *_buf, size_t _len);
+
+#endif	/* _DISASM_H_ */
@@ -0,0 +1,59 @@
+/*
+   SWORD Emurator  high-level emulation
+
+   Runs known Z80 library routines (multiply, divide, fill, compare)
+   as host code when they are called, with the same effect on the
+   registers, the memory and the T-states as running them.
+*/
+
+#ifndef	_HLE_H_
+#define	_HLE_H_
+
+#include "sim-type.h"
+
+/* what is known of a called address, else 1 + the routine there */
+#define	HLE_UNKNOWN	(0)		/* not looked at since written */
+#define	HLE_NONE	(0xff)		/* no known routine */
+
+#define	HLE_NR		(5)		/* routines known */
+#define	HLE_MAXLEN	(16)		/* bytes of the longest routine */
+
+struct z80_cpu;
+
+/** The routines found in a machine
+ */
+struct hle {
+	BYTE	map[0x10000];		/* HLE_* or the routine of each
+					   address called */
+	unsigned long hash[HLE_NR];	/* of the code of each routine */
+};
+
+#ifdef OPT_HLE
+/** Determine whether a call may go to a known routine.
+    @param[in] _a Z80 address called
+    @note This needs the machine as "cpu".
+ */
+#define HLE_MAYBE(_a)							\
+	( cpu->hle != NULL && cpu->hle->map[ (_a) & 0xffff ] != HLE_NONE )
+
+/** Notify a write to Z80 memory which may change a routine.
+    @param[in] _a   the first address written
+    @param[in] _len the number of bytes written
+    @note This needs the machine as "cpu".
+ */
+#define HLE_INVALIDATE(_a, _len) do{					\
+		if ( cpu->hle != NULL )					\
+			hle_written( cpu, (_a), (_len) );		\
+	}while(0)
+#else
+#define HLE_MAYBE(_a)	(0)
+#define HLE_INVALIDATE(_a, _len) do{ }while(0)
+#endif
+
+int hle_start(struct z80_cpu *_cpu);
+void hle_stop(struct z80_cpu *_cpu);
+int hle_call(struct z80_cpu *_cpu, WORD _addr, WORD _ret,
+    unsigned long long _deadline);
+void hle_written(struct z80_cpu *_cpu, WORD _addr, unsigned int _len);
+
+#endif	/* _HLE_H_ */
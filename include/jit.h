@@ -0,0 +1,55 @@
+/*
+   SWORD Emurator  x86-64 dynamic recompiler
+
+   Translates the blocks of the basic block cache into host code.
+*/
+
+#ifndef	_JIT_H_
+#define	_JIT_H_
+
+#include <stddef.h>
+#include "sim-type.h"
+
+#define	JIT_ARENA_SIZE	(4*1024*1024)	/* size of the code arena */
+#define	JIT_HALT	(0x20000)	/* returned PC stopped at HALT */
+
+/** Z80 registers seen by the translated code, and the code arena of
+    the machine
+ */
+struct jit_regs {
+	WORD	af;
+	WORD	bc;
+	WORD	de;
+	WORD	hl;
+	WORD	sp;
+	BYTE	stale;		/* a write threw a block away */
+	unsigned long long deadline;	/* cycles to stop at */
+	BYTE	*arena;		/* code arena, NULL if not translating */
+	size_t	used;		/* used bytes in the arena */
+};
+
+/** The machine which owns the registers.
+    @param[in] _r registers of translated code
+ */
+#define JIT_CPU(_r)							\
+	((struct z80_cpu *)((char *)(_r) - offsetof(struct z80_cpu, jit)))
+
+struct z80_cpu;
+
+struct bb_insn;
+
+/* helper for an op-code the translator does not expand inline;
+   takes the address after the op-code byte and the pre-decoded
+   instruction, returns the next PC */
+typedef FASTREG (*jit_helper)(struct jit_regs *_r, FASTREG _pc,
+    const struct bb_insn *_ins);
+
+extern jit_helper jit_optab[256];
+
+int jit_init(struct z80_cpu *_cpu);
+void jit_free(struct z80_cpu *_cpu);
+void jit_flush(struct z80_cpu *_cpu);
+FASTWORK jit_run(struct z80_cpu *_cpu, FASTREG _pc,
+    unsigned long long _deadline);
+
+#endif  /*  _JIT_H_  */
@@ -0,0 +1,43 @@
+/*
+   SWORD Emurator  I/O ports
+
+   Lets host modules handle the IN and OUT instructions of Z80 code.
+*/
+
+#ifndef	_PORT_H_
+#define	_PORT_H_
+
+#include "sim-type.h"
+
+struct z80_cpu;
+
+/** Handler of an IN instruction.
+    @param[in] _cpu  the machine
+    @param[in] _port the port read
+    @param[in] _arg  argument given to port_add()
+    @return the byte read
+ */
+typedef BYTE (*port_in_fn)(struct z80_cpu *_cpu, BYTE _port, void *_arg);
+
+/** Handler of an OUT instruction.
+    @param[in] _cpu  the machine
+    @param[in] _port the port written
+    @param[in] _val  the byte written
+    @param[in] _arg  argument given to port_add()
+ */
+typedef void (*port_out_fn)(struct z80_cpu *_cpu, BYTE _port, BYTE _val,
+    void *_arg);
+
+/** Handlers of an I/O port
+ */
+struct port {
+	port_in_fn	in;	/* NULL if the port reads 0 */
+	port_out_fn	out;	/* NULL if writes are ignored */
+	void	*arg;
+};
+
+int port_add(struct z80_cpu *_cpu, BYTE _port, port_in_fn _in,
+    port_out_fn _out, void *_arg);
+void port_del(struct z80_cpu *_cpu, BYTE _port);
+
+#endif	/* _PORT_H_ */
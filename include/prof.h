@@ -0,0 +1,73 @@
+/*
+   SWORD Emurator  execution profiler
+
+   Counts the executions and the T-states of every Z80 address and
+   op-code, and the T-states of the call stacks made by CALL and RET.
+*/
+
+#ifndef	_PROF_H_
+#define	_PROF_H_
+
+#include "sim-type.h"
+
+#define	PROF_DEPTH	(64)		/* deepest call stack tracked */
+#define	PROF_NONE	(-1)		/* no node */
+#define	PROF_FOLDED	".folded"	/* file name suffix of folded stacks */
+
+struct z80_cpu;
+
+/** Function called from a call stack
+ */
+struct prof_node {
+	WORD	func;			/* entry address */
+	WORD	site;			/* address of the last CALL to it */
+	int	parent;			/* caller, PROF_NONE for the root */
+	int	child;			/* first callee, PROF_NONE if none */
+	int	sibling;		/* next callee of the parent */
+	unsigned long long calls;	/* times called */
+	unsigned long long cycles;	/* T-states of its own code */
+	unsigned long long insns;	/* instructions of its own code */
+};
+
+/** Profile of a machine
+ */
+struct prof {
+	unsigned long long count[64*1024];	/* executions of each address */
+	unsigned long long cycles[64*1024];	/* T-states of each address */
+	unsigned long long ops[256];		/* executions of each op-code */
+	int	func[64*1024];		/* function each address ran in last,
+					   PROF_NONE if never run */
+	struct prof_node *node;		/* call tree, node 0 is the root */
+	int	nnodes;			/* nodes used */
+	int	maxnodes;		/* nodes allocated */
+	int	stack[PROF_DEPTH];	/* nodes of the call stack */
+	WORD	ret[PROF_DEPTH];	/* return address of each call */
+	int	depth;			/* index of the innermost call */
+	int	started;		/* an instruction has been counted */
+	WORD	pc, sp;			/* the last instruction counted */
+	BYTE	op, op2;
+	unsigned long long cyc;		/* the cycle count before it ran */
+};
+
+#ifdef OPT_PROFILE
+/** Count an instruction which is about to run.
+    @param[in] _pc  its address
+    @param[in] _sp  the stack pointer
+    @param[in] _cyc the cycle count
+    @note This needs the machine as "cpu".
+ */
+#define PROF_INSN(_pc, _sp, _cyc) do{				\
+		if ( cpu->prof != NULL )			\
+			prof_insn( cpu, (_pc), (_sp), (_cyc) );	\
+	}while(0)
+#else
+#define PROF_INSN(_pc, _sp, _cyc) do{ }while(0)
+#endif
+
+int prof_start(struct z80_cpu *_cpu);
+void prof_stop(struct z80_cpu *_cpu);
+void prof_insn(struct z80_cpu *_cpu, WORD _pc, WORD _sp,
+    unsigned long long _cyc);
+int prof_write(struct z80_cpu *_cpu, const char *_name);
+
+#endif	/* _PROF_H_ */
@@ -0,0 +1,64 @@
+/*
+   SWORD Emurator  record and replay
+
+   Logs the inputs of a session which do not follow from the machine,
+   the keys, so that the session can be run again the same way.
+*/
+
+#ifndef	_REPLAY_H_
+#define	_REPLAY_H_
+
+#include <stdio.h>
+#include "sim-type.h"
+
+#define	REPLAY_MAGIC	"S-OS RPL"	/* first 8 bytes of a log */
+#define	REPLAY_VERSION	(2)
+
+/* modes */
+#define	REPLAY_RECORD	(0)		/* write the inputs to the log */
+#define	REPLAY_PLAY	(1)		/* take the inputs from the log */
+
+/* kinds of inputs */
+#define	REPLAY_GETKY	(2)		/* a key, or none, without waiting */
+#define	REPLAY_WAITKY	(3)		/* a key waited for */
+#define	REPLAY_BRKEY	(4)		/* the break key was pressed; only
+					   a press is logged */
+
+struct z80_cpu;
+
+/** A session being recorded or replayed
+ */
+struct replay {
+	FILE	*fp;			/* the log */
+	char	*file;			/* its name */
+	int	 mode;			/* REPLAY_RECORD or REPLAY_PLAY */
+	unsigned long long base;	/* T-states run before the start */
+	unsigned long long last;	/* position of the last record */
+	/* the next record to replay */
+	int	 kind;			/* REPLAY_*, 0 at the end of the log */
+	unsigned long long pos;		/* T-states since the start */
+	int	 value;
+};
+
+/** Take an input from the log of a machine.
+    @note This evaluates to 0 unless the machine is replayed; the input
+          is to be read as usual then.
+ */
+#define REPLAY_GET(_cpu, _kind, _pos, _v)				\
+	( (_cpu)->replay != NULL && replay_get( (_cpu), (_kind), (_pos), (_v) ) )
+
+/** Log an input read for a machine which is recorded.
+ */
+#define REPLAY_PUT(_cpu, _kind, _pos, _v) do{				\
+		if ( (_cpu)->replay != NULL )				\
+			replay_put( (_cpu), (_kind), (_pos), (_v) );	\
+	}while(0)
+
+int replay_start(struct z80_cpu *_cpu, const char *_file, int _mode);
+int replay_stop(struct z80_cpu *_cpu);
+int replay_get(struct z80_cpu *_cpu, int _kind, unsigned long long _pos,
+    int *_v);
+void replay_put(struct z80_cpu *_cpu, int _kind, unsigned long long _pos,
+    int _v);
+
+#endif	/* _REPLAY_H_ */
@@ -0,0 +1,61 @@
+/*
+   SWORD Emurator  event scheduler and maskable interrupts
+
+   Runs host device callbacks at given values of the cycle count of a
+   machine, and lets the devices interrupt the Z80.
+*/
+
+#ifndef	_SCHED_H_
+#define	_SCHED_H_
+
+#include "sim-type.h"
+
+#define	SCHED_NR	(8)		/* pending events of a machine */
+#define	SCHED_LINES	(8)		/* interrupt request lines */
+
+/* vsync timer */
+#define	SCHED_CLOCK	(4000000UL)	/* T-states a second, if not paced */
+#define	SCHED_VSYNC_LINE (0)		/* its request line */
+#define	SCHED_VSYNC_VECTOR (0xff)	/* data bus: RST 38H for IM 0 */
+
+struct z80_cpu;
+
+/** Callback of an event.
+    @param[in] _cpu the machine
+    @param[in] _arg argument given to sched_add()
+ */
+typedef void (*sched_fn)(struct z80_cpu *_cpu, void *_arg);
+
+/** Event
+ */
+struct sched_event {
+	sched_fn fn;		/* NULL if the slot is free */
+	void	*arg;
+	unsigned long long at;	/* cycle count to run at */
+};
+
+/** Scheduler of a machine
+ */
+struct sched {
+	unsigned long long next;	/* cycle count to call sched_run() at */
+	BYTE	irq;			/* raised request lines, bit 0 first */
+	BYTE	vector[SCHED_LINES];	/* data bus of each line (IM 0, IM 2) */
+	unsigned long long ei;		/* cycle count right after the last EI */
+	struct sched_event ev[SCHED_NR];
+	unsigned long long vsync;	/* T-states between vsync interrupts,
+					   0 if the timer is off */
+	unsigned long long vsync_at;	/* cycle count of the next one */
+};
+
+void sched_init(struct z80_cpu *_cpu);
+int sched_add(struct z80_cpu *_cpu, unsigned long long _at, sched_fn _fn,
+    void *_arg);
+void sched_del(struct z80_cpu *_cpu, int _id);
+void sched_irq(struct z80_cpu *_cpu, int _line, BYTE _vector);
+void sched_irq_clear(struct z80_cpu *_cpu, int _line);
+unsigned long long sched_budget(struct z80_cpu *_cpu,
+    unsigned long long _budget);
+void sched_run(struct z80_cpu *_cpu);
+int sched_vsync(struct z80_cpu *_cpu, unsigned long long _period);
+
+#endif	/* _SCHED_H_ */
@@ -7,11 +7,40 @@
 #ifndef	_SCREEN_H_
 #define	_SCREEN_H_
 
+#include <stddef.h>
+
+#ifndef SCR_MAXLINES
+# define SCR_MAXLINES	(25)	/* maximam lines of virtual screen */
+#endif
+#ifndef	SCR_MAXWIDTH
+# define SCR_MAXWIDTH	(80)	/* maximam width of virtual screen */
+#endif
+
+struct z80_cpu;
+
+/** Contents of the virtual screen, see scr_save()
+ */
+struct scr_state {
+	int	w, h;				/* size */
+	int	y, x;				/* cursor */
+	int	capson;				/* software CAPS LOCK */
+	unsigned char lattr[SCR_MAXLINES];	/* line attributes */
+	unsigned char chr[SCR_MAXLINES][SCR_MAXWIDTH];	/* characters */
+};
+
 void	scr_caps(int s);
 int	scr_initx(void);
+void	scr_attach(struct z80_cpu *_cpu);
 int	scr_finish(void);
+int	scr_initbatch(const char *_keys, size_t _len);
+void	scr_batchkeys(const char *_keys, size_t _len);
+char	*scr_endbatch(size_t *_len);
+int	scr_isbatch(void);
+int	scr_keys_exhausted(void);
 void	scr_redraw(void);
 void    scr_locate_cursor(int _y, int _x);
+void	scr_save(struct scr_state *_st);
+void	scr_load(const struct scr_state *_st);
 
 void scr_putchar(char c);
 void scr_asyncputchar(char c);
@@ -23,6 +52,8 @@ void scr_tab(int x);
 int scr_getl(char *buf);
 int scr_getky(void);
 int scr_brkey(void);
+void scr_busy(void);
+void scr_clock(unsigned long hz);
 int scr_inkey(void);
 int scr_pause(void);
 void scr_bell(void);
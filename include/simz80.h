@@ -27,33 +27,84 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA. */
 
 #include "sim-type.h"
 #include "trap.h"
-
-/* two sets of accumulator / flags */
-extern WORD af[2];
-extern int af_sel;
+#include "jit.h"
+#include "watch.h"
+#include "port.h"
+#include "sched.h"
+#include "prof.h"
+#include "trace.h"
+#include "replay.h"
+#include "hle.h"
 
 /* two sets of 16-bit registers */
-extern struct ddregs {
+struct ddregs {
 	WORD bc;
 	WORD de;
 	WORD hl;
-} regs[2];
-extern int regs_sel;
+};
 
-extern WORD ir;
-extern WORD ix;
-extern WORD iy;
-extern WORD sp;
-extern WORD pc;
-extern WORD IFF;
+#define	Z80_CACHELINE	(64)
+#if defined(__GNUC__)
+#define	Z80_ALIGNED	__attribute__ ((aligned (Z80_CACHELINE)))
+#else
+#define	Z80_ALIGNED
+#endif
 
-extern BYTE ram[64*1024];
+struct bb_cache;
+
+/** Z80 machine: registers and memory.
+    simz80_run(), the trap handlers and everything else which touches
+    the machine take a pointer to it, so that several machines can run
+    in one process.  The registers used by every instruction share the
+    first cache line.
+ */
+struct z80_cpu {
+	WORD	af[2];		/* accumulator and flags (2 banks) */
+	struct ddregs regs[2];	/* bc,de,hl (2 banks) */
+	WORD	sp;
+	WORD	pc;
+	WORD	ix;
+	WORD	iy;
+	WORD	ir;		/* other Z80 registers */
+	WORD	IFF;
+	BYTE	im;		/* interrupt mode */
+	BYTE	af_sel;		/* bank select for af */
+	BYTE	regs_sel;	/* bank select for regs */
+	unsigned long long cycles;	/* T-states executed so far */
+	unsigned long long rbase;	/* T-states when R was loaded, see
+					   Z80_R() */
+
+	struct jit_regs	jit;	/* state of translated code */
+	struct bb_cache	*bb;	/* decoded blocks, NULL if not cached */
+	BYTE	watch_map[256];	/* watchers of each page, see watch.c */
+	struct watch watch[WATCH_NR];
+	struct port port[256];	/* I/O port handlers, see port.c */
+	struct sched sched;	/* events and interrupt requests */
+	struct prof *prof;	/* execution profile, NULL if not profiled */
+	struct trace *trace;	/* instruction trace, NULL if not traced */
+	struct replay *replay;	/* record or replay, NULL if neither */
+	struct hle *hle;	/* known routines, NULL if run as Z80 code */
+
+	BYTE	ram[64*1024] Z80_ALIGNED;	/* Z80 memory space */
+} Z80_ALIGNED;
 
 #ifdef DEBUG
 extern volatile int stopsim;
 #endif
 
-extern FASTWORK simz80(FASTREG PC);
+extern FASTWORK simz80(struct z80_cpu *cpu, FASTREG PC);
+extern FASTWORK simz80_run(struct z80_cpu *cpu, FASTREG PC,
+    unsigned long long max_cycles);
+
+#define SIMZ80_STOP	0x10000		/* simz80_run() stopped before HALT */
+#define SIMZ80_FOREVER	(~0ULL)		/* no cycle budget */
+
+/* T-states of the op-codes, see simz80.pl */
+extern const BYTE z80_cc_op[256];
+extern const BYTE z80_cc_cb[256];
+extern const BYTE z80_cc_ed[256];
+extern const BYTE z80_cc_xy[256];
+extern const BYTE z80_cc_xycb[256];
 
 #define FLAG_C	1
 #define FLAG_N	2
@@ -62,6 +113,14 @@ extern FASTWORK simz80(FASTREG PC);
 #define FLAG_Z	64
 #define FLAG_S	128
 
+/** The R register after a number of T-states.  Its low 7 bits count
+    the M1 cycles since LD R,A, one per 4 T-states, which is the least
+    an instruction takes; no instruction has to count them.
+ */
+#define Z80_R(_cpu, _cyc)						\
+	( ( (_cpu)->ir & 0x80 )						\
+	    | ( ( (_cpu)->ir + ( (_cyc) - (_cpu)->rbase ) / 4 ) & 0x7f ) )
+
 #define SETFLAG(f,c)	AF = (c) ? AF | FLAG_ ## f : AF & ~FLAG_ ## f
 #define TSTFLAG(f)	((AF & FLAG_ ## f) != 0)
 
@@ -73,7 +132,7 @@ extern FASTWORK simz80(FASTREG PC);
 #define Setlreg(x, v)	x = (((x)&0xff00) | ((v)&0xff))
 #define Sethreg(x, v)	x = (((x)&0xff) | (((v)&0xff) << 8))
 
-#define RAM(a)		ram[ (a) & 0xffff ]
+#define RAM(a)		cpu->ram[ (a) & 0xffff ]
 #define GetBYTE_INTERNAL(a)	( RAM( (a) ) )
 #define GetWORD_INTERNAL(a)	( RAM( (a) ) | (RAM( (a) + 1 ) << 8) )
 #define PutBYTE_INTERNAL(a, v)	do{		\
@@ -84,12 +143,54 @@ extern FASTWORK simz80(FASTREG PC);
 		RAM( (a) + 1 ) = (v) >> 8;			       \
 	} while (0)
 
-#define GetBYTE(a)     trap_get_byte(a)
-#define PutBYTE(a, v)  trap_put_byte(a,v)
-#define GetWORD(a)     trap_get_word(a)
-#define PutWORD(a, v)  trap_put_word(a,v)
-/* Define these as macros or functions if you really want to simulate I/O */
-#define Input(port)	0
-#define Output(port, value)
+/* these need the machine as "cpu", and bbcache.h */
+#define GetBYTE(a)     trap_get_byte(cpu,a)
+#define GetWORD(a)     trap_get_word(cpu,a)
+#define PutBYTE(a, v)	do{					\
+		WORD pb_a = (a);				\
+		PutBYTE_INTERNAL(pb_a, (v));			\
+		BB_CHECK(pb_a);					\
+		if ( WATCH_IS_WATCHED(pb_a) )			\
+			watch_hit(cpu, pb_a, 1, 0);		\
+	}while(0)
+#define PutWORD(a, v)	do{					\
+		WORD pw_a = (a), pw_v = (v);			\
+		PutWORD_INTERNAL(pw_a, pw_v);			\
+		BB_CHECK(pw_a);					\
+		BB_CHECK(pw_a + 1);				\
+		if ( WATCH_IS_WATCHED(pw_a)			\
+		    || WATCH_IS_WATCHED(pw_a + 1) )		\
+			watch_hit(cpu, pw_a, 2, 0);		\
+	}while(0)
+
+/** Read an I/O port.
+    @param[in] cpu  the machine
+    @param[in] port the port
+    @return the byte read, 0 if the port has no handler
+ */
+static inline BYTE
+port_in(struct z80_cpu *cpu, BYTE port){
+	const struct port *p = &cpu->port[port];
+
+	return p->in != NULL ? p->in(cpu, port, p->arg) : 0;
+}
+
+/** Write to an I/O port.
+    @param[in] cpu  the machine
+    @param[in] port the port
+    @param[in] val  the byte to write
+ */
+static inline void
+port_out(struct z80_cpu *cpu, BYTE port, BYTE val){
+	const struct port *p = &cpu->port[port];
+
+	if ( p->out != NULL )
+		p->out(cpu, port, val, p->arg);
+}
+
+/* these need the machine as "cpu".  The operands are evaluated once,
+   they may advance PC or HL. */
+#define Input(port)	port_in(cpu, (port))
+#define Output(port, value)	port_out(cpu, (port), (value))
 
 #endif
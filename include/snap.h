@@ -0,0 +1,56 @@
+/*
+   SWORD Emurator  machine snapshot
+
+   Saves a whole session in a file and puts it back, so that a program
+   state need not be reached again from a cold boot.
+*/
+
+#ifndef	_SNAP_H_
+#define	_SNAP_H_
+
+#include <stdint.h>
+#include "sim-type.h"
+#include "sos.h"
+#include "dio.h"
+#include "screen.h"
+#include "sched.h"
+
+#define	SNAP_MAGIC	"S-OS SNP"	/* first 8 bytes of a snapshot */
+#define	SNAP_VERSION	(1)
+#define	SNAP_ORDER	(0x01020304)	/* tells the byte order */
+#define	SNAP_ALIGN	(4096)		/* sections start on a page */
+#define	SNAP_WKSIZ	(EM_WKSIZ + 1)	/* size of the S-OS special work */
+
+struct z80_cpu;
+
+/** Header of a snapshot, at the start of the file.  The memory and
+    the S-OS special work follow, each on a page of its own, at the
+    offsets given here.  The file is written in the byte order and the
+    layout of the host, and is read back only by the same build.
+ */
+struct snap_header {
+	char	magic[8];		/* SNAP_MAGIC */
+	uint32_t version;		/* SNAP_VERSION */
+	uint32_t order;			/* SNAP_ORDER */
+	uint32_t hsize;			/* sizeof(struct snap_header) */
+	uint32_t ram;			/* offset of the memory */
+	uint32_t wkram;			/* offset of the special work */
+	uint32_t size;			/* size of the file */
+	uint64_t cycles;		/* T-states run before it was saved */
+
+	/* registers */
+	WORD	af[2], bc[2], de[2], hl[2];
+	WORD	sp, pc, ix, iy, ir, iff;
+	BYTE	im, af_sel, regs_sel;
+	BYTE	irq;			/* raised interrupt request lines */
+	BYTE	vector[SCHED_LINES];
+
+	sos_tape_device_info tapes[SOS_TAPE_NR];
+	struct dio_state dio;
+	struct scr_state scr;
+};
+
+int snap_save(struct z80_cpu *_cpu, const char *_file);
+int snap_load(struct z80_cpu *_cpu, const char *_file);
+
+#endif	/* _SNAP_H_ */
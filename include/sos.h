@@ -175,4 +175,12 @@
 
 #define	EM_VER		(0x1620)	/* XXX: SWORD version */
 
+/*
+   machine setup and command processor (sos.c)
+*/
+struct z80_cpu;
+void	coldboot(struct z80_cpu *_cpu);
+void	ccp(struct z80_cpu *_cpu);
+int	setup_dos_file(struct z80_cpu *_cpu);
+
 #endif
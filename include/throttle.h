@@ -0,0 +1,29 @@
+/*
+   SWORD Emurator  real-speed throttling
+
+   Paces the emulated CPU against the host monotonic clock.
+*/
+
+#ifndef	_THROTTLE_H_
+#define	_THROTTLE_H_
+
+#include <time.h>
+
+#define	THROTTLE_SLICE_NS	(5000000L)	/* length of a time slice */
+#define	THROTTLE_LAG_NS		(100000000L)	/* lag given up on */
+
+/** Pace of a machine
+ */
+struct throttle {
+	unsigned long	hz;		/* emulated clock, 0 if free-running */
+	unsigned long long slice;	/* T-states per slice */
+	unsigned long long slice_end;	/* cycle count ending the slice */
+	unsigned long long base_cycles;	/* cycle count at base_time */
+	struct timespec	base_time;	/* when base_cycles should be reached */
+};
+
+int throttle_set(struct throttle *_t, const char *_spec);
+unsigned long long throttle_budget(struct throttle *_t,
+    unsigned long long _cycles);
+
+#endif	/* _THROTTLE_H_ */
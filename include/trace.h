@@ -0,0 +1,60 @@
+/*
+   SWORD Emurator  instruction trace
+
+   Keeps the last Z80 instructions run in a ring buffer, so that the
+   way to a crash can be seen after it.
+*/
+
+#ifndef	_TRACE_H_
+#define	_TRACE_H_
+
+#include <signal.h>
+#include "sim-type.h"
+
+#define	TRACE_SIZE	(4096)		/* entries of the ring, a power of 2 */
+#define	TRACE_SHOW	(16)		/* entries shown by the "trace" command */
+
+struct z80_cpu;
+
+/** An instruction run
+ */
+struct trace_ent {
+	WORD	pc, sp;			/* address and stack pointer */
+	WORD	af, bc, de, hl, ix, iy;	/* registers before it ran */
+	BYTE	op[4];			/* bytes at the address */
+};
+
+/** Trace of a machine
+ */
+struct trace {
+	struct trace_ent ent[TRACE_SIZE];	/* the ring */
+	unsigned long long n;		/* instructions recorded */
+	char	*file;			/* file to dump to */
+	int	intr;			/* interrupts dumped */
+};
+
+extern volatile sig_atomic_t trace_intrs;
+
+#ifdef OPT_TRACE
+/** Record an instruction which is about to run.
+    @note This needs the machine as "cpu".  The registers are evaluated
+          only while the machine is traced.
+ */
+#define TRACE_INSN(_pc, _af, _bc, _de, _hl, _ix, _iy, _sp) do{	\
+		if ( cpu->trace != NULL )				\
+			trace_insn( cpu, (_pc), (_af), (_bc), (_de),	\
+			    (_hl), (_ix), (_iy), (_sp) );		\
+	}while(0)
+#else
+#define TRACE_INSN(_pc, _af, _bc, _de, _hl, _ix, _iy, _sp) do{ }while(0)
+#endif
+
+int trace_start(struct z80_cpu *_cpu, const char *_file);
+void trace_stop(struct z80_cpu *_cpu);
+void trace_insn(struct z80_cpu *_cpu, WORD _pc, WORD _af, WORD _bc,
+    WORD _de, WORD _hl, WORD _ix, WORD _iy, WORD _sp);
+int trace_dump(struct z80_cpu *_cpu, const char *_why);
+void trace_print(struct z80_cpu *_cpu, int _n);
+void trace_intr(int _sig);
+
+#endif	/* _TRACE_H_ */
@@ -7,18 +7,29 @@
 
 #include "sim-type.h"
 
+struct z80_cpu;
+struct _sos_tape_device_info;
+
 /*
    entry points
 */
-int trap(int func);
-int trap_init(void);
+int trap(struct z80_cpu *_cpu, int func);
+int trap_init(struct z80_cpu *_cpu);
+void trap_reset(void);
 
-BYTE trap_get_byte(WORD _addr);
-WORD trap_get_word(WORD _addr);
-void trap_put_byte(WORD _addr, BYTE _val);
-void trap_put_word(WORD _addr, WORD _val);
-int trap_write_workarea_without_sync(WORD _addr, BYTE _val);
+BYTE trap_get_byte(struct z80_cpu *_cpu, WORD _addr);
+WORD trap_get_word(struct z80_cpu *_cpu, WORD _addr);
+void trap_move_block(struct z80_cpu *_cpu, WORD _dst, WORD _src,
+    unsigned int _len, int _down);
+unsigned int trap_find_byte(struct z80_cpu *_cpu, WORD _addr,
+    unsigned int _len, BYTE _val, int _down);
+int trap_write_workarea_without_sync(struct z80_cpu *_cpu, WORD _addr,
+    BYTE _val);
 void trap_change_tape(char _dev);
+void trap_save(BYTE *_wk, struct _sos_tape_device_info *_tp);
+void trap_load(const BYTE *_wk, const struct _sos_tape_device_info *_tp);
+void trap_stats_print(const char *_name);
+int trap_stats_write(const char *_name);
 /*
    return values from TRAP routine
 */
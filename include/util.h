@@ -9,7 +9,9 @@
 
 #include "simz80.h"
 
-void z80_push(WORD value);
-WORD z80_pop(void);
+void z80_push(struct z80_cpu *_cpu, WORD value);
+WORD z80_pop(struct z80_cpu *_cpu);
+struct z80_cpu *z80_new(void);
+void z80_free(struct z80_cpu *_cpu);
 
 #endif
@@ -0,0 +1,43 @@
+/*
+   SWORD Emurator  interpreter variants
+
+   Interpreters generated by simz80.pl with other options than
+   simz80.c, built side by side (configure --with-variants); one of
+   them runs every machine of the process.
+*/
+
+#ifndef	_VARIANT_H_
+#define	_VARIANT_H_
+
+#include "sim-type.h"
+
+#define	VARIANT_DEFAULT	"default"	/* name of simz80_run() itself */
+
+struct z80_cpu;
+
+/** An interpreter built in
+ */
+struct simz80_variant {
+	const char *name;		/* its line in src/variants.lst */
+	const char *options;		/* the options of simz80.pl */
+	FASTWORK (*run)(struct z80_cpu *, FASTREG, unsigned long long);
+};
+
+#ifdef OPT_VARIANTS
+extern const struct simz80_variant simz80_variants[];
+extern FASTWORK (*simz80_runner)(struct z80_cpu *, FASTREG,
+    unsigned long long);
+
+/** The interpreter selected by simz80_select(), called as
+    simz80_run().
+ */
+#define	SIMZ80_RUN	(*simz80_runner)
+#else
+#define	SIMZ80_RUN	simz80_run
+#endif
+
+int simz80_select(const char *_name);
+void simz80_list(void);
+int simz80_bench(void);
+
+#endif	/* _VARIANT_H_ */
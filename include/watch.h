@@ -0,0 +1,45 @@
+/*
+   SWORD Emurator  write watch
+
+   Calls back the modules which need to know when Z80 code writes to
+   some addresses, e.g. the S-OS work area shown on the screen.
+*/
+
+#ifndef	_WATCH_H_
+#define	_WATCH_H_
+
+#include "sim-type.h"
+
+#define	WATCH_NR	(8)		/* watchers of a machine */
+
+struct z80_cpu;
+
+/** Callback of a watcher, called after the byte has been written.
+    @param[in] _cpu  the machine
+    @param[in] _addr the address written
+    @param[in] _arg  argument given to watch_add()
+ */
+typedef void (*watch_fn)(struct z80_cpu *_cpu, WORD _addr, void *_arg);
+
+/** Watcher of a range of Z80 memory
+ */
+struct watch {
+	watch_fn fn;		/* NULL if the slot is free */
+	void	*arg;
+	WORD	lo;		/* the first address watched */
+	WORD	hi;		/* the last address watched */
+};
+
+/** Determine whether a page has watchers.
+    @param[in] _a Z80 address
+    @note This needs the machine as "cpu".
+ */
+#define WATCH_IS_WATCHED(_a)	( cpu->watch_map[ ( (_a) & 0xffff ) >> 8 ] )
+
+int watch_add(struct z80_cpu *_cpu, WORD _lo, WORD _hi, watch_fn _fn,
+    void *_arg);
+void watch_del(struct z80_cpu *_cpu, int _id);
+void watch_hit(struct z80_cpu *_cpu, WORD _addr, unsigned int _len,
+    int _down);
+
+#endif	/* _WATCH_H_ */
@@ -0,0 +1,1086 @@
+/*
+   SWORD Emurator  batch runner
+
+   Runs the sessions listed in a job file, each one on its own machine
+   with a headless screen, on a pool of worker threads.  A job is a
+   line of
+
+	program input [disk0 [disk1 ...]]
+
+   program is an S-OS file, which is loaded at its data address and
+   started at its execution address; the session ends when it returns
+   to #BOOT.  "-" boots the monitor instead.  The bytes of the input
+   file are typed as keys ("-" for none); a session which waits for a
+   key after the last one ends.  The disk images are mounted as disk#0,
+   disk#1 and so on.  Empty lines and lines starting with '#' are
+   ignored.  Given a snapshot, every session starts from it instead of
+   a cold boot: the program is loaded onto it, "-" goes on where the
+   snapshot was saved, and the disks replace the ones of the snapshot.
+
+   The jobs are dealt to the workers as contiguous ranges.  A worker
+   runs the jobs at the front of its own range; once the range is
+   empty, it steals the back half of the range of another worker, so
+   that a few long jobs do not leave the other workers idle.  When all
+   jobs are done, the status and the screen output of every session
+   are printed in the order of the job file.  The counts of the op-code
+   pairs run by all sessions may be written for src/fuse.lst, and the
+   Z80 code and the trap calls of every session may be profiled, and
+   its instructions traced, to files of their own, "name.N" (or
+   "base.N.folded", "base.N.json") for the N-th job.  SIGINT dumps the
+   traces of the running sessions.  The inputs of every session may be
+   recorded to "name.N", or every session may replay one log, see
+   replay.c; a session whose log ends goes on with the keys of its job.
+
+   The screen, the disk I/O and the S-OS work area of a session belong
+   to the thread which runs it.  The current directory is shared, so
+   "cd" is refused in the command processor.
+
+   As a fork server (sos -f addr), the machine is booted once, as for
+   the first job but without keys, and run until it reaches the fork
+   point; then a child process is forked for each job, which types
+   the keys of its job from there and sends its result back.  The
+   program and the disks of the other jobs are not used.  The fork
+   point must be reached before a key is read, and must not be
+   overwritten before.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#ifdef	OPT_BATCH
+# include <pthread.h>
+#endif
+#include "compat.h"
+#include "simz80.h"
+#include "sos.h"
+#include "dio.h"
+#include "screen.h"
+#include "trap.h"
+#include "keymap.h"
+#include "util.h"
+#include "bbcache.h"
+#include "jit.h"
+#include "sched.h"
+#include "prof.h"
+#include "trace.h"
+#include "replay.h"
+#include "hle.h"
+#include "snap.h"
+#include "batch.h"
+#include "variant.h"
+
+#ifdef	OPT_BATCH
+
+#define	BATCH_NONE	"-"		/* no program or no input */
+#define	BATCH_DELIM	" \t"		/* field separators */
+
+/* end of a session */
+#define	BATCH_QUIT	(0)		/* returned to #BOOT */
+#define	BATCH_EOF	(1)		/* waited for a key after the last one */
+#define	BATCH_LIMIT	(2)		/* used up its T-states */
+#define	BATCH_ERROR	(3)		/* could not be run */
+#define	BATCH_BREAK	(4)		/* reached the fork point, see
+					   batch_forkserver() */
+
+#define	BATCH_HALT	(0x76)		/* HALT, planted at the fork point */
+
+static const char *batch_status[] = {
+	"quit",
+	"eof",
+	"limit",
+	"error",
+};
+
+/** A session to run
+ */
+struct batch_job {
+	char	*program;		/* S-OS file, NULL for the monitor */
+	char	*input;			/* keys to type, NULL for none */
+	char	*disk[SOS_MAXIMAGEDRIVES];	/* disk images */
+	int	 status;		/* BATCH_* */
+	unsigned long long cycles;	/* T-states run */
+	char	*screen;		/* screen output */
+	size_t	 screenlen;		/* length of the screen output */
+	pid_t	 pid;			/* child of the fork server */
+	int	 fd;			/* pipe from the child */
+};
+
+/** Result of a session run by a child of the fork server, sent over
+    the pipe and followed by the screen output
+ */
+struct batch_result {
+	int	 status;
+	unsigned long long cycles;
+	size_t	 screenlen;
+};
+
+struct batch_pool;
+
+/** A worker thread and the jobs it owns
+ */
+struct batch_worker {
+	pthread_mutex_t	 lock;		/* protects head and tail */
+	int		 head, tail;	/* jobs [head, tail) */
+	int		 id;		/* index in the pool */
+	int		 started;	/* thread is running */
+	pthread_t	 thread;
+	struct batch_pool *pool;
+};
+
+/** The jobs and the workers
+ */
+struct batch_pool {
+	struct batch_job	*jobs;
+	int			 njobs;
+	struct batch_worker	*workers;
+	int			 nworkers;
+	const struct batch_opts	*opts;
+	unsigned long		*pairs;	/* op-code pairs run, NULL if not
+					   profiled */
+	pthread_mutex_t		 pairs_lock;	/* protects pairs */
+};
+
+/** Read a whole file.
+    @param[in]  name file name
+    @param[out] buf  contents, the caller frees it
+    @param[out] len  length of the contents
+    @retval  0 success
+    @retval -1 the file can not be read
+ */
+static int
+batch_readfile(const char *name, char **buf, size_t *len){
+	FILE	*fp;
+	long	 size;
+
+	fp = fopen(name, "rb");
+	if ( fp == NULL )
+		return -1;
+
+	if ( ( fseek(fp, 0L, SEEK_END) != 0 ) || ( ( size = ftell(fp) ) < 0 ) )
+		goto close_out;
+	rewind(fp);
+
+	*buf = malloc(size + 1);
+	if ( *buf == NULL )
+		goto close_out;
+	if ( fread(*buf, 1, size, fp) != (size_t)size ) {
+
+		free(*buf);
+		*buf = NULL;
+		goto close_out;
+	}
+	*len = size;
+	fclose(fp);
+
+	return 0;
+
+close_out:
+	fclose(fp);
+	return -1;
+}
+
+/** Load an S-OS file at its data address.
+    @param[in]  cpu   the machine
+    @param[in]  name  file name
+    @param[out] exadr execution address
+    @retval  0 success
+    @retval  otherwise S-OS error code
+ */
+static int
+batch_load(struct z80_cpu *cpu, char *name, int *exadr){
+	int	attr, dtadr, size;
+	int	r;
+
+	if ( ( r = dio_ropen(name, &attr, &dtadr, &size, exadr, 0) ) != 0 )
+		return r;
+
+	dtadr &= 0xffff;
+	if ( size > 0x10000 - dtadr )
+		size = 0x10000 - dtadr;		/* do not wrap around */
+	r = dio_rdd(cpu->ram + dtadr, size);
+	BB_INVALIDATE(dtadr, size);
+
+	return r;
+}
+
+/** Run a machine until its session ends, or until it reaches the fork
+    point.
+    @param[in] cpu   the machine
+    @param[in] limit T-states to run, 0 if unlimited
+    @param[in] bp    address of a HALT planted at the fork point, -1 if
+                     none
+    @return BATCH_QUIT, BATCH_EOF, BATCH_LIMIT, BATCH_ERROR or BATCH_BREAK
+ */
+static int
+batch_loop(struct z80_cpu *cpu, unsigned long long limit, int bp){
+	unsigned long long budget;
+	int	r;
+	WORD	xpc;
+
+	for(;;) {
+
+		budget = SIMZ80_FOREVER;
+		if ( limit != 0 ) {
+
+			if ( cpu->cycles >= limit )
+				return BATCH_LIMIT;
+			budget = limit - cpu->cycles;
+		}
+
+		sched_run(cpu);
+		r = SIMZ80_RUN(cpu, cpu->pc, sched_budget(cpu, budget));
+		if ( r & SIMZ80_STOP )
+			continue;		/* check the limit and events */
+		if ( (int)( ( r - 1 ) & 0xffff ) == bp )
+			return BATCH_BREAK;
+
+		switch( trap(cpu, (int) cpu->ram[r]) ) {
+
+		case TRAP_NEXT:
+			cpu->pc++;
+			break;
+		case TRAP_HOLD:
+			break;
+		case TRAP_COLD:
+			xpc = cpu->pc;
+			coldboot(cpu);
+			cpu->pc = xpc;
+			break;
+		case TRAP_MON:
+			cpu->pc++;	/* a snapshot goes on after the trap */
+			ccp(cpu);
+			break;
+		case TRAP_QUIT:
+			return BATCH_QUIT;
+		default:
+			return BATCH_ERROR;
+		}
+
+		if ( scr_keys_exhausted() )
+			return BATCH_EOF;
+	}
+}
+
+/** Make the name of a file of a session: "name.N", or "base.N.ext"
+    if the name is "base.ext" and ext is the given suffix.
+    @param[in] name   file name given by the options
+    @param[in] n      job number, counted from 1
+    @param[in] suffix suffix to keep at the end, e.g. ".folded"
+    @return the file name, the caller frees it; NULL if out of memory
+ */
+static char *
+batch_path(const char *name, int n, const char *suffix){
+	size_t	 len, slen;
+	char	*buf;
+
+	len = strlen(name);
+	slen = strlen(suffix);
+	if ( len < slen || strcmp(name + len - slen, suffix) != 0 )
+		slen = 0;
+
+	buf = malloc(len + 16);
+	if ( buf != NULL )
+		sprintf(buf, "%.*s.%d%s", (int)( len - slen ), name, n,
+		    name + len - slen);
+	return buf;
+}
+
+/** Set up the machine of a session: the snapshot or the dos file, the
+    disks and the program of the job.  Messages go to the screen.
+    @param[in] cpu  the machine
+    @param[in] job  the session
+    @param[in] pool the jobs and the workers
+    @retval  0 success
+    @retval -1 the session can not be run
+ */
+static int
+batch_boot(struct z80_cpu *cpu, struct batch_job *job,
+    struct batch_pool *pool){
+	const struct batch_opts *opts = pool->opts;
+	int		 exadr = 0;
+	int		 n;
+
+	scr_attach(cpu);
+	setdefaultkeymap();
+	scr_caps(opts->caps);
+	trap_reset();
+
+	if ( opts->snapshot != NULL ) {
+
+		/* the snapshot replaces the dos file and the cold boot */
+		coldboot(cpu);
+		if ( snap_load(cpu, opts->snapshot) ) {
+
+			scr_puts("load: can not load <");
+			scr_puts((char *)opts->snapshot);
+			scr_puts(">\r");
+			return -1;
+		}
+	} else if ( setup_dos_file(cpu) )
+		return -1;
+
+	/* the disks of the job replace the ones of the snapshot */
+	for(n = 0; n < SOS_MAXIMAGEDRIVES; ++n) {
+
+		if ( job->disk[n] == NULL )
+			continue;
+		dio_diclose(n);
+		free(dio_disk[n]);
+		dio_disk[n] = strdup(job->disk[n]);
+		if ( dio_disk[n] == NULL ) {
+
+			scr_puts("batch: out of memory\r");
+			return -1;
+		}
+	}
+
+	if ( ( job->program != NULL )
+	    && batch_load(cpu, job->program, &exadr) ) {
+
+		scr_puts("load: failed to load <");
+		scr_puts(job->program);
+		scr_puts(">\r");
+		return -1;
+	}
+
+	if ( opts->snapshot == NULL )
+		coldboot(cpu);
+	if ( pool->pairs != NULL && bb_profile_pairs(cpu) ) {
+
+		scr_puts("batch: out of memory\r");
+		return -1;
+	}
+	if ( opts->jit )
+		(void)jit_init(cpu);	/* the interpreter runs it otherwise */
+	if ( opts->hle )
+		(void)hle_start(cpu);	/* the Z80 code runs otherwise */
+	if ( opts->vsync != 0 && sched_vsync(cpu, opts->vsync) ) {
+
+		scr_puts("vsync: can not start the timer\r");
+		return -1;
+	}
+
+	if ( job->program != NULL ) {
+
+		z80_push(cpu, SOS_BOOT);	/* quit address */
+		cpu->pc = exadr;
+	} else if ( opts->snapshot == NULL )
+		cpu->pc = SOS_COLD;
+
+	return 0;
+}
+
+/** Start the profile and the trace of a session.
+    @param[in] cpu  the machine
+    @param[in] job  the session
+    @param[in] pool the jobs and the workers
+    @retval  0 success
+    @retval -1 out of memory
+ */
+static int
+batch_observe(struct z80_cpu *cpu, struct batch_job *job,
+    struct batch_pool *pool){
+	const struct batch_opts *opts = pool->opts;
+	char		*path;
+	int		 rc;
+
+	if ( opts->profile != NULL && prof_start(cpu) ) {
+
+		scr_puts("batch: out of memory\r");
+		return -1;
+	}
+	if ( opts->trace != NULL ) {
+
+		path = batch_path(opts->trace, (int)( job - pool->jobs ) + 1, "");
+		rc = ( path == NULL || trace_start(cpu, path) );
+		free(path);
+		if ( rc != 0 ) {
+
+			scr_puts("batch: out of memory\r");
+			return -1;
+		}
+	}
+	if ( opts->replay != NULL && opts->replaymode == REPLAY_PLAY
+	    && replay_start(cpu, opts->replay, REPLAY_PLAY) ) {
+
+		scr_puts("replay: can not open <");
+		scr_puts((char *)opts->replay);
+		scr_puts(">\r");
+		return -1;
+	}
+	if ( opts->replay != NULL && opts->replaymode == REPLAY_RECORD ) {
+
+		path = batch_path(opts->replay, (int)( job - pool->jobs ) + 1,
+		    "");
+		rc = ( path == NULL || replay_start(cpu, path, REPLAY_RECORD) );
+		free(path);
+		if ( rc != 0 ) {
+
+			scr_puts("batch: can not write the record\r");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/** Collect the results of a session which has run.
+    @param[in] cpu  the machine
+    @param[in] job  the session
+    @param[in] pool the jobs and the workers
+ */
+static void
+batch_finish(struct z80_cpu *cpu, struct batch_job *job,
+    struct batch_pool *pool){
+	const struct batch_opts *opts = pool->opts;
+	char		*path;
+
+	job->cycles = cpu->cycles;
+	if ( pool->pairs != NULL ) {
+
+		pthread_mutex_lock(&pool->pairs_lock);
+		bb_add_pairs(pool->pairs, cpu);
+		pthread_mutex_unlock(&pool->pairs_lock);
+	}
+	if ( opts->profile != NULL ) {
+
+		path = batch_path(opts->profile, (int)( job - pool->jobs ) + 1,
+		    PROF_FOLDED);
+		if ( path == NULL || prof_write(cpu, path) ) {
+
+			scr_puts("batch: can not write the profile\r");
+			job->status = BATCH_ERROR;
+		}
+		free(path);
+	}
+	if ( replay_stop(cpu) ) {
+
+		scr_puts("batch: can not write the record\r");
+		job->status = BATCH_ERROR;
+	}
+	if ( opts->stats != NULL ) {
+
+		path = batch_path(opts->stats, (int)( job - pool->jobs ) + 1,
+		    ".json");
+		if ( path == NULL || trap_stats_write(path) ) {
+
+			scr_puts("batch: can not write the trap statistics\r");
+			job->status = BATCH_ERROR;
+		}
+		free(path);
+	}
+}
+
+/** Run a session on this thread.
+    @param[in] job  the session
+    @param[in] pool the jobs and the workers
+ */
+static void
+batch_session(struct batch_job *job, struct batch_pool *pool){
+	struct z80_cpu	*cpu = NULL;
+	char		*keys = NULL;
+	size_t		 nkeys = 0;
+	int		 rc = 0;
+
+	job->status = BATCH_ERROR;
+
+	if ( job->input != NULL )
+		rc = batch_readfile(job->input, &keys, &nkeys);
+	if ( scr_initbatch(keys, nkeys) )
+		goto out;
+	if ( rc != 0 ) {
+
+		scr_puts("batch: can not read input <");
+		scr_puts(job->input);
+		scr_puts(">\r");
+		goto out;
+	}
+
+	cpu = z80_new();
+	if ( cpu == NULL ) {
+
+		scr_puts("batch: out of memory\r");
+		goto out;
+	}
+	if ( batch_boot(cpu, job, pool) || batch_observe(cpu, job, pool) )
+		goto out;
+
+	job->status = batch_loop(cpu, pool->opts->limit, -1);
+	batch_finish(cpu, job, pool);
+
+out:
+	dio_reset();
+	job->screen = scr_endbatch(&job->screenlen);
+	if ( cpu != NULL )
+		z80_free(cpu);
+	free(keys);
+}
+
+/** Take the next job of a worker's own range.
+    @param[in] w the worker
+    @return index of the job, -1 if the range is empty
+ */
+static int
+batch_take(struct batch_worker *w){
+	int	n = -1;
+
+	pthread_mutex_lock(&w->lock);
+	if ( w->head < w->tail )
+		n = w->head++;
+	pthread_mutex_unlock(&w->lock);
+
+	return n;
+}
+
+/** Steal the back half of the range of another worker.
+    The first stolen job is returned, the rest becomes the range of
+    the thief.
+    @param[in] w the thief
+    @return index of the job, -1 if all ranges are empty
+ */
+static int
+batch_steal(struct batch_worker *w){
+	struct batch_pool	*pool = w->pool;
+	struct batch_worker	*v;
+	int			 i, mid, tail;
+
+	for(i = 1; i < pool->nworkers; ++i) {
+
+		v = &pool->workers[( w->id + i ) % pool->nworkers];
+		pthread_mutex_lock(&v->lock);
+		if ( v->head < v->tail ) {
+
+			tail = v->tail;
+			mid = v->head + ( v->tail - v->head ) / 2;
+			v->tail = mid;
+			pthread_mutex_unlock(&v->lock);
+
+			pthread_mutex_lock(&w->lock);
+			w->head = mid + 1;
+			w->tail = tail;
+			pthread_mutex_unlock(&w->lock);
+
+			return mid;
+		}
+		pthread_mutex_unlock(&v->lock);
+	}
+
+	return -1;	/* no jobs appear later, so the worker is done */
+}
+
+/** Body of a worker thread.
+    @param[in] arg the worker
+ */
+static void *
+batch_worker(void *arg){
+	struct batch_worker	*w = arg;
+	int			 n;
+
+	while( ( ( n = batch_take(w) ) >= 0 ) || ( ( n = batch_steal(w) ) >= 0 ) )
+		batch_session(&w->pool->jobs[n], w->pool);
+
+	return NULL;
+}
+
+/** Write all of a buffer to a pipe.
+    @param[in] fd  the pipe
+    @param[in] buf the buffer
+    @param[in] len its length
+    @retval  0 success
+    @retval -1 error
+ */
+static int
+batch_write(int fd, const void *buf, size_t len){
+	const char	*p = buf;
+	ssize_t		 n;
+
+	while( len > 0 ) {
+
+		n = write(fd, p, len);
+		if ( n < 0 && errno == EINTR )
+			continue;
+		if ( n <= 0 )
+			return -1;
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/** Read a whole buffer from a pipe.
+    @param[in]  fd  the pipe
+    @param[out] buf the buffer
+    @param[in]  len its length
+    @retval  0 success
+    @retval -1 error, or the pipe was closed before
+ */
+static int
+batch_read(int fd, void *buf, size_t len){
+	char	*p = buf;
+	ssize_t	 n;
+
+	while( len > 0 ) {
+
+		n = read(fd, p, len);
+		if ( n < 0 && errno == EINTR )
+			continue;
+		if ( n <= 0 )
+			return -1;
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/** Run a session in a child of the fork server, on the machine
+    inherited from the server, and send its result to the server.
+    This does not return.
+    @param[in] cpu  the machine
+    @param[in] job  the session
+    @param[in] pool the jobs and the workers
+    @param[in] fd   the pipe to the server
+ */
+static void
+batch_child(struct z80_cpu *cpu, struct batch_job *job,
+    struct batch_pool *pool, int fd){
+	struct batch_result res;
+	struct dio_state st;
+	char		*keys = NULL;
+	char		*screen;
+	size_t		 nkeys = 0;
+
+	job->status = BATCH_ERROR;
+
+	/* open the files again, the offsets of the inherited ones are
+	   shared with the server and the other children */
+	if ( dio_save(&st) || dio_load(&st) ) {
+
+		scr_puts("batch: can not open the files again\r");
+		goto out;
+	}
+	if ( job->input != NULL
+	    && batch_readfile(job->input, &keys, &nkeys) ) {
+
+		scr_puts("batch: can not read input <");
+		scr_puts(job->input);
+		scr_puts(">\r");
+		goto out;
+	}
+	scr_batchkeys(keys, nkeys);
+	if ( batch_observe(cpu, job, pool) )
+		goto out;
+
+	job->status = batch_loop(cpu, pool->opts->limit, -1);
+	batch_finish(cpu, job, pool);
+
+out:
+	dio_reset();
+	screen = scr_endbatch(&res.screenlen);
+	res.status = job->status;
+	res.cycles = cpu->cycles;
+	if ( batch_write(fd, &res, sizeof(res)) == 0 && screen != NULL )
+		(void)batch_write(fd, screen, res.screenlen);
+	_exit(0);
+}
+
+/** Start a child of the fork server to run a session.
+    @param[in] cpu  the machine at the fork point
+    @param[in] job  the session
+    @param[in] pool the jobs and the workers
+ */
+static void
+batch_spawn(struct z80_cpu *cpu, struct batch_job *job,
+    struct batch_pool *pool){
+	int	 fds[2];
+
+	job->pid = -1;
+	job->fd = -1;
+	if ( pipe(fds) != 0 )
+		return;
+
+	/* every stream, the files of the session too: what is buffered
+	   would be written again by each child */
+	fflush(NULL);
+	job->pid = fork();
+	if ( job->pid == 0 ) {
+
+		close(fds[0]);
+		batch_child(cpu, job, pool, fds[1]);
+	}
+	close(fds[1]);
+	if ( job->pid < 0 ) {
+
+		close(fds[0]);
+		return;
+	}
+	job->fd = fds[0];
+}
+
+/** Take the result of a session from its child.
+    @param[in] job the session
+ */
+static void
+batch_reap(struct batch_job *job){
+	static const char died[] = "batch: no result from the session\n";
+	struct batch_result res;
+	int	 ok = 0;
+
+	if ( job->fd >= 0 ) {
+
+		if ( batch_read(job->fd, &res, sizeof(res)) == 0 ) {
+
+			job->status = res.status;
+			job->cycles = res.cycles;
+			job->screenlen = res.screenlen;
+			job->screen = ( res.screenlen > 0 )
+			    ? malloc(res.screenlen) : NULL;
+			ok = ( res.screenlen == 0 || ( job->screen != NULL
+				&& batch_read(job->fd, job->screen,
+				    res.screenlen) == 0 ) );
+		}
+		close(job->fd);
+	}
+	if ( job->pid > 0 )
+		while( waitpid(job->pid, NULL, 0) < 0 && errno == EINTR )
+			;
+
+	if ( !ok ) {
+
+		free(job->screen);
+		job->status = BATCH_ERROR;
+		job->screenlen = sizeof(died) - 1;
+		job->screen = strdup(died);
+	}
+}
+
+/** Run all sessions as a fork server: boot one machine as for the first
+    job, without keys, run it up to the fork point and fork a child for
+    every job there.  The children share the memory of the machine
+    with the server until they write to it, type the keys of their
+    job, and send the status and the screen output back over a pipe.
+    Up to pool->nworkers children run at once.
+    @param[in] pool the jobs and the workers
+ */
+static void
+batch_forkserver(struct batch_pool *pool){
+	const struct batch_opts *opts = pool->opts;
+	struct z80_cpu	*cpu = NULL;
+	char		*screen;
+	size_t		 len;
+	BYTE		 save;
+	int		 status = BATCH_ERROR;
+	int		 next, done;
+
+	if ( scr_initbatch(NULL, 0) )
+		goto out;
+	cpu = z80_new();
+	if ( cpu == NULL ) {
+
+		scr_puts("batch: out of memory\r");
+		goto out;
+	}
+	if ( batch_boot(cpu, &pool->jobs[0], pool) )
+		goto out;
+
+	save = cpu->ram[opts->forkpc];
+	cpu->ram[opts->forkpc] = BATCH_HALT;
+	BB_INVALIDATE(opts->forkpc, 1);
+	status = batch_loop(cpu, opts->limit, opts->forkpc);
+	cpu->ram[opts->forkpc] = save;
+	BB_INVALIDATE(opts->forkpc, 1);
+	if ( status != BATCH_BREAK ) {
+
+		status = BATCH_ERROR;
+		scr_puts("batch: the fork point was not reached\r");
+		goto out;
+	}
+	cpu->pc = opts->forkpc;
+	cpu->cycles -= z80_cc_op[BATCH_HALT];	/* it did not run */
+
+	for(next = done = 0; done < pool->njobs; ++done) {
+
+		while( next < pool->njobs && next - done < pool->nworkers )
+			batch_spawn(cpu, &pool->jobs[next++], pool);
+		batch_reap(&pool->jobs[done]);
+	}
+
+out:
+	dio_reset();
+	screen = scr_endbatch(&len);
+	if ( status != BATCH_BREAK ) {
+
+		/* the first job shows why none was run */
+		for(done = 0; done < pool->njobs; ++done)
+			pool->jobs[done].status = BATCH_ERROR;
+		pool->jobs[0].screen = screen;
+		pool->jobs[0].screenlen = len;
+	} else
+		free(screen);
+	if ( cpu != NULL )
+		z80_free(cpu);
+}
+
+/** Copy a field of a job line.
+    @param[in] field the field
+    @return a copy, NULL for BATCH_NONE or if out of memory
+ */
+static char *
+batch_field(const char *field){
+
+	if ( strcmp(field, BATCH_NONE) == 0 )
+		return NULL;
+	return strdup(field);
+}
+
+/** Read the job file.
+    @param[in] name the job file
+    @param[in] pool the pool to add the jobs to
+    @retval  0 success
+    @retval -1 error, a message is printed
+ */
+static int
+batch_parse(const char *name, struct batch_pool *pool){
+	FILE			*fp;
+	char			 buf[SOS_UNIX_BUFSIZ];
+	char			*p;
+	struct batch_job	*job;
+	int			 line, size, n;
+
+	fp = fopen(name, "r");
+	if ( fp == NULL ) {
+
+		perror(name);
+		return -1;
+	}
+
+	size = 0;
+	for(line = 1; fgets(buf, sizeof(buf), fp) != NULL; ++line) {
+
+		buf[strcspn(buf, "\r\n")] = '\0';
+		p = strtok(buf, BATCH_DELIM);
+		if ( ( p == NULL ) || ( *p == '#' ) )
+			continue;	/* empty line or comment */
+
+		if ( pool->njobs == size ) {
+
+			size = ( size == 0 ) ? 64 : size * 2;
+			job = realloc(pool->jobs, size * sizeof(*job));
+			if ( job == NULL )
+				goto nomem_out;
+			pool->jobs = job;
+		}
+		job = &pool->jobs[pool->njobs++];
+		memset(job, 0, sizeof(*job));
+
+		job->program = batch_field(p);
+		if ( ( p = strtok(NULL, BATCH_DELIM) ) != NULL )
+			job->input = batch_field(p);
+		for(n = 0; ( p = strtok(NULL, BATCH_DELIM) ) != NULL; ++n) {
+
+			if ( n >= SOS_MAXIMAGEDRIVES ) {
+
+				fprintf(stderr, "%s:%d: too many disks\n",
+				    name, line);
+				goto err_out;
+			}
+			job->disk[n] = batch_field(p);
+		}
+	}
+	fclose(fp);
+
+	return 0;
+
+nomem_out:
+	fprintf(stderr, "%s: out of memory\n", name);
+err_out:
+	fclose(fp);
+	return -1;
+}
+
+/** Run all sessions of a job file and print their results.
+    @param[in] jobfile the job file
+    @param[in] opts    options of the batch run
+    @retval 0 all sessions quit or used up their input
+    @retval 1 a session failed or used up its T-states, or the jobs
+              could not be run
+ */
+int
+batch_run(const char *jobfile, const struct batch_opts *opts){
+	struct batch_pool	 pool;
+	struct batch_job	*job;
+#ifdef	OPT_TRACE
+	struct sigaction	 sact;
+#endif
+	long			 ncpu;
+	int			 i, n, rc;
+
+	memset(&pool, 0, sizeof(pool));
+	pool.opts = opts;
+	pthread_mutex_init(&pool.pairs_lock, NULL);
+	rc = 1;
+	if ( batch_parse(jobfile, &pool) )
+		goto free_out;
+
+	if ( opts->pairs != NULL && opts->fork ) {
+
+		fprintf(stderr, "batch: op-code pairs can not be counted "
+		    "by a fork server\n");
+		goto free_out;
+	}
+	if ( opts->pairs != NULL ) {
+
+#ifdef	OPT_FUSION
+		pool.pairs = calloc(BB_NR_PAIRS, sizeof(unsigned long));
+		if ( pool.pairs == NULL ) {
+
+			fprintf(stderr, "batch: out of memory\n");
+			goto free_out;
+		}
+#else
+		fprintf(stderr, "batch: op-code pairs can not be counted "
+		    "(configure --with-fusion)\n");
+		goto free_out;
+#endif
+	}
+#ifndef	OPT_HLE
+	if ( opts->hle ) {
+
+		fprintf(stderr, "batch: the routines can not be run as host "
+		    "code (configure --with-hle)\n");
+		goto free_out;
+	}
+#endif
+#ifndef	OPT_PROFILE
+	if ( opts->profile != NULL ) {
+
+		fprintf(stderr, "batch: the code can not be profiled "
+		    "(configure --with-profile)\n");
+		goto free_out;
+	}
+#endif
+#ifdef	OPT_TRACE
+	if ( opts->trace != NULL ) {
+
+		/* the first SIGINT dumps the traces, the second one kills */
+		memset(&sact, 0, sizeof(sact));
+		sact.sa_handler = trace_intr;
+		sigemptyset(&sact.sa_mask);
+		sact.sa_flags = SA_RESETHAND;
+		(void)sigaction(SIGINT, &sact, NULL);
+	}
+#else
+	if ( opts->trace != NULL ) {
+
+		fprintf(stderr, "batch: the instructions can not be traced "
+		    "(configure --with-trace)\n");
+		goto free_out;
+	}
+#endif
+
+	pool.nworkers = opts->threads;
+	if ( pool.nworkers <= 0 ) {
+
+		ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+		pool.nworkers = ( ncpu > 0 ) ? (int)ncpu : 1;
+	}
+	if ( pool.nworkers > pool.njobs )
+		pool.nworkers = ( pool.njobs > 0 ) ? pool.njobs : 1;
+
+	pool.workers = calloc(pool.nworkers, sizeof(*pool.workers));
+	if ( pool.workers == NULL ) {
+
+		fprintf(stderr, "batch: out of memory\n");
+		goto free_out;
+	}
+	for(i = 0; i < pool.nworkers; ++i) {
+
+		pthread_mutex_init(&pool.workers[i].lock, NULL);
+		pool.workers[i].id = i;
+		pool.workers[i].pool = &pool;
+		pool.workers[i].head = (int)( (long)pool.njobs * i / pool.nworkers );
+		pool.workers[i].tail =
+		    (int)( (long)pool.njobs * ( i + 1 ) / pool.nworkers );
+	}
+
+	/*
+	 * This thread is the first worker.  The jobs of a worker whose
+	 * thread can not be created are stolen by the others.  A fork
+	 * server runs on this thread alone, so that the children inherit
+	 * the thread which owns the machine.
+	 */
+	if ( opts->fork ) {
+
+		if ( pool.njobs > 0 )
+			batch_forkserver(&pool);
+	} else {
+
+		for(i = 1; i < pool.nworkers; ++i)
+			pool.workers[i].started =
+			    ( pthread_create(&pool.workers[i].thread, NULL,
+				batch_worker, &pool.workers[i]) == 0 );
+		batch_worker(&pool.workers[0]);
+		for(i = 1; i < pool.nworkers; ++i)
+			if ( pool.workers[i].started )
+				pthread_join(pool.workers[i].thread, NULL);
+	}
+
+	rc = 0;
+	for(n = 0; n < pool.njobs; ++n) {
+
+		job = &pool.jobs[n];
+		printf("#job %d %s %s %llu\n", n + 1,
+		    ( job->program != NULL ) ? job->program : BATCH_NONE,
+		    batch_status[job->status], job->cycles);
+		if ( job->screen != NULL )
+			fwrite(job->screen, 1, job->screenlen, stdout);
+		if ( ( job->status == BATCH_LIMIT )
+		    || ( job->status == BATCH_ERROR ) )
+			rc = 1;
+	}
+	fflush(stdout);
+
+	if ( ( pool.pairs != NULL )
+	    && bb_write_pairs(opts->pairs, pool.pairs) ) {
+
+		fprintf(stderr, "batch: can not write <%s>\n", opts->pairs);
+		rc = 1;
+	}
+
+free_out:
+	for(n = 0; n < pool.njobs; ++n) {
+
+		job = &pool.jobs[n];
+		free(job->program);
+		free(job->input);
+		for(i = 0; i < SOS_MAXIMAGEDRIVES; ++i)
+			free(job->disk[i]);
+		free(job->screen);
+	}
+	free(pool.jobs);
+	if ( pool.workers != NULL )
+		for(i = 0; i < pool.nworkers; ++i)
+			pthread_mutex_destroy(&pool.workers[i].lock);
+	free(pool.workers);
+	free(pool.pairs);
+	pthread_mutex_destroy(&pool.pairs_lock);
+
+	return rc;
+}
+
+#else  /*  !OPT_BATCH  */
+
+int
+batch_run(const char *jobfile, const struct batch_opts *opts){
+
+	fprintf(stderr, "batch: not available (configure --with-batch)\n");
+	return 1;
+}
+
+#endif  /*  OPT_BATCH  */
@@ -0,0 +1,498 @@
+/*
+   SWORD Emurator  Z80 basic block cache
+
+   simz80() executes hot code from pre-decoded basic blocks which hold
+   the immediate operands and relative branch targets already resolved.
+   Every byte covered by a cached block has its bit set in the code
+   map of the machine's cache; a write to such a byte throws the blocks
+   covering it away.
+
+   Configured --with-fusion, consecutive records whose op-codes are a
+   pair listed in src/fuse.lst run in one handler of simz80() (see
+   simz80.pl).  The list may be made from the counts of the pairs
+   entered in the block executor, written by bb_write_pairs().
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simz80.h"
+#include "bbcache.h"
+#include "jit.h"
+
+/** Determine the length of an instruction.
+    @param[in] cpu the machine
+    @param[in] a   address of the instruction
+    @return length in bytes
+ */
+static int
+bb_insn_len(struct z80_cpu *cpu, WORD a){
+	BYTE op, op2;
+
+	op = RAM(a);
+	switch( op ) {
+
+	case 0x01: case 0x11: case 0x21: case 0x31:	/* LD dd,nnnn */
+	case 0x22: case 0x2a: case 0x32: case 0x3a:	/* LD (nnnn) */
+	case 0xc3: case 0xcd:				/* JP, CALL */
+		return 3;
+	case 0x06: case 0x0e: case 0x16: case 0x1e:	/* LD r,nn */
+	case 0x26: case 0x2e: case 0x36: case 0x3e:
+	case 0x10: case 0x18: case 0x20: case 0x28:	/* DJNZ, JR */
+	case 0x30: case 0x38:
+	case 0xc6: case 0xce: case 0xd6: case 0xde:	/* ALU A,nn */
+	case 0xe6: case 0xee: case 0xf6: case 0xfe:
+	case 0xd3: case 0xdb:				/* OUT, IN */
+	case 0xcb:
+		return 2;
+	case 0xed:
+		op2 = RAM(a + 1);
+		return ( ( op2 & 0xc7 ) == 0x43 ) ? 4 : 2; /* LD (nnnn),dd */
+	case 0xdd:
+	case 0xfd:
+		op2 = RAM(a + 1);
+		switch( op2 ) {
+
+		case 0x21: case 0x22: case 0x2a:	/* nnnn */
+		case 0x36:				/* (IXY+dd),nn */
+		case 0xcb:
+			return 4;
+		case 0x26: case 0x2e:			/* LD IXYh/l,nn */
+		case 0x34: case 0x35:			/* (IXY+dd) */
+		case 0x46: case 0x4e: case 0x56: case 0x5e:
+		case 0x66: case 0x6e: case 0x7e:
+		case 0x70: case 0x71: case 0x72: case 0x73:
+		case 0x74: case 0x75: case 0x77:
+		case 0x86: case 0x8e: case 0x96: case 0x9e:
+		case 0xa6: case 0xae: case 0xb6: case 0xbe:
+			return 3;
+		default:
+			return 2;
+		}
+	default:
+		break;
+	}
+	if ( ( op & 0xc7 ) == 0xc4 || ( op & 0xc7 ) == 0xc2 )
+		return 3;	/* CALL cc,nnnn / JP cc,nnnn */
+	return 1;
+}
+
+/** Determine whether an instruction ends a basic block.
+    @param[in] cpu the machine
+    @param[in] a   address of the instruction
+    @retval 1 the instruction may change PC or stops the simulator
+    @retval 0 the instruction falls through
+ */
+static int
+bb_insn_ends_block(struct z80_cpu *cpu, WORD a){
+	BYTE op, op2;
+
+	op = RAM(a);
+	if ( ( op & 0xe7 ) == 0x20 || op == 0x10 || op == 0x18 )
+		return 1;	/* JR cc, DJNZ, JR */
+	if ( ( op & 0xc0 ) == 0xc0 ) {
+
+		switch( op & 0x07 ) {
+
+		case 0: case 2: case 4: case 7:	/* RET cc, JP cc, CALL cc, RST */
+			return 1;
+		default:
+			break;
+		}
+	}
+	switch( op ) {
+
+	case 0x76:		/* HALT (traps) */
+	case 0xc3: case 0xc9: case 0xcd: case 0xe9:
+		return 1;
+	case 0xdd:
+	case 0xfd:
+		return ( RAM(a + 1) == 0xe9 );	/* JP (IXY) */
+	case 0xed:
+		op2 = RAM(a + 1);
+		return ( ( op2 & 0xc7 ) == 0x45 );	/* RETN, RETI */
+	default:
+		break;
+	}
+	return 0;
+}
+
+/** Set or clear the code bits of an address range.
+    @param[in] bb    the block cache
+    @param[in] start first address
+    @param[in] end   address after the range (may be 0x10000)
+    @param[in] set   1 to set, 0 to clear
+ */
+static void
+bb_mark(struct bb_cache *bb, unsigned int start, unsigned int end, int set){
+	unsigned int a;
+
+	for(a = start; a < end; ++a) {
+
+		if ( set )
+			bb->code_map[(a & 0xffff) >> 3] |= ( 1 << ( a & 7 ) );
+		else
+			bb->code_map[(a & 0xffff) >> 3] &= ~( 1 << ( a & 7 ) );
+	}
+}
+
+#ifdef OPT_FUSION
+/** Let the first record of every fused op-code pair of a block run the
+    handler of the pair.
+    @param[in] b the block
+ */
+static void
+bb_fuse(struct bb_block *b){
+	struct bb_insn *ins = b->insn;
+	int i, k;
+
+	for(i = 0; i + 1 < b->ninsn; ++i) {
+
+		for(k = 0; k < z80_nfuse; ++k) {
+
+			if ( ( ins[i].op == z80_fuse_pairs[k][0] )
+			    && ( ins[i + 1].op == z80_fuse_pairs[k][1] ) )
+				break;
+		}
+		if ( k < z80_nfuse ) {
+
+			ins[i].xop = BB_OP_FUSED + k;
+			++i;	/* pairs do not overlap */
+		}
+	}
+}
+#endif
+
+/** Decode a basic block.
+    @param[in] cpu the machine
+    @param[in] pc  address of the first instruction
+    @return the new block
+ */
+static struct bb_block *
+bb_translate(struct z80_cpu *cpu, WORD pc){
+	struct bb_cache *bb = cpu->bb;
+	struct bb_block *b;
+	struct bb_insn  *ins;
+	unsigned int     a;
+	int              end;
+
+	if ( ( bb->nblocks >= BB_NR_BLOCKS )
+	    || ( bb->nrecords + BB_MAX_INSNS + 1 > BB_NR_RECORDS ) )
+		bb_flush(cpu);
+
+	b = &bb->blocks[bb->nblocks++];
+	b->start = pc;
+	b->insn = ins = &bb->records[bb->nrecords];
+	b->ninsn = 0;
+	b->native = NULL;
+
+	a = pc;
+	do {
+		ins->addr = a;
+		ins->op = ins->xop = RAM(a);
+		ins->len = bb_insn_len(cpu, a);
+		ins->imm = ( ins->len == 2 ) ? RAM(a + 1) : GetWORD_INTERNAL(a + 1);
+		ins->target = a + 2 + (signed char)RAM(a + 1);
+		end = bb_insn_ends_block(cpu, a);
+		a += ins->len;
+		ins->next = a;
+		++ins;
+		++b->ninsn;
+	} while( !end && ( b->ninsn < BB_MAX_INSNS ) && ( a <= 0xffff ) );
+
+	ins->addr = BB_NOADDR;		/* sentinel */
+	ins->op = ins->xop = BB_OP_EXIT;
+	b->end = a;
+	bb->nrecords += b->ninsn + 1;
+
+#ifdef OPT_FUSION
+	bb_fuse(b);
+#endif
+	bb_mark(bb, b->start, b->end, 1);
+	bb->map[pc] = b;
+
+	return b;
+}
+
+/** Throw away the blocks which cover an address range.
+    @param[in] cpu the machine
+    @param[in] lo  first address
+    @param[in] hi  address after the range
+    @param[in] smc 1 if the write comes from Z80 code
+ */
+static void
+bb_kill_range(struct z80_cpu *cpu, unsigned int lo, unsigned int hi, int smc){
+	struct bb_cache *bb = cpu->bb;
+	struct bb_block *b;
+	unsigned int     clo, chi;
+	int              i, j;
+
+	clo = 0x10000;
+	chi = 0;
+	for(i = 0; i < bb->nblocks; ++i) {
+
+		b = &bb->blocks[i];
+		if ( ( b->ninsn == 0 ) || ( b->end <= lo ) || ( b->start >= hi ) )
+			continue;
+
+		/* a block being executed leaves at its next record */
+		for(j = 0; j < b->ninsn; ++j) {
+
+			b->insn[j].addr = BB_NOADDR;
+			b->insn[j].op = b->insn[j].xop = BB_OP_EXIT;
+		}
+		b->ninsn = 0;
+		if ( bb->map[b->start] == b )
+			bb->map[b->start] = NULL;
+#ifdef OPT_JIT
+		/* translated code being executed leaves after the write */
+		b->native = NULL;
+		cpu->jit.stale = 1;
+#endif
+
+		if ( b->start < clo )
+			clo = b->start;
+		if ( b->end > chi )
+			chi = b->end;
+		if ( smc && ( bb->smc[lo >> 8] < BB_SMC_LIMIT ) )
+			++bb->smc[lo >> 8];
+	}
+	if ( clo >= chi )
+		return;
+
+	/* other blocks may share the bytes just cleared */
+	bb_mark(bb, clo, chi, 0);
+	for(i = 0; i < bb->nblocks; ++i) {
+
+		b = &bb->blocks[i];
+		if ( ( b->ninsn != 0 ) && ( b->end > clo ) && ( b->start < chi ) )
+			bb_mark(bb, b->start, b->end, 1);
+	}
+}
+
+/** Allocate the block cache of a machine.
+    @param[in] cpu the machine
+    @retval 0 success, or the cache is not compiled in
+    @retval -1 out of memory
+ */
+int
+bb_alloc(struct z80_cpu *cpu){
+
+#ifdef OPT_BBCACHE
+	cpu->bb = calloc(1, sizeof(struct bb_cache));
+	if ( cpu->bb == NULL )
+		return -1;
+#endif
+	return 0;
+}
+
+/** Release the block cache of a machine.
+    @param[in] cpu the machine
+ */
+void
+bb_free(struct z80_cpu *cpu){
+
+	if ( cpu->bb != NULL )
+		free(cpu->bb->pairs);
+	free(cpu->bb);
+	cpu->bb = NULL;
+}
+
+/** Initialize the block cache.
+    @param[in] cpu the machine
+ */
+void
+bb_init(struct z80_cpu *cpu){
+
+	if ( cpu->bb == NULL )
+		return;
+	bb_flush(cpu);
+	memset(cpu->bb->smc, 0, sizeof(cpu->bb->smc));
+}
+
+/** Throw away all blocks.
+    @param[in] cpu the machine
+ */
+void
+bb_flush(struct z80_cpu *cpu){
+	struct bb_cache *bb = cpu->bb;
+	int i;
+
+	/* stale records make a running block leave the cache */
+	for(i = 0; i < bb->nrecords; ++i) {
+
+		bb->records[i].addr = BB_NOADDR;
+		bb->records[i].op = bb->records[i].xop = BB_OP_EXIT;
+	}
+
+	memset(bb->map, 0, sizeof(bb->map));
+	memset(bb->code_map, 0, sizeof(bb->code_map));
+	memset(bb->heat, 0, sizeof(bb->heat));
+	bb->nblocks = 0;
+	bb->nrecords = 0;
+#ifdef OPT_JIT
+	jit_flush(cpu);
+	cpu->jit.stale = 1;
+#endif
+}
+
+/** Handle a write from Z80 code to an address covered by a block.
+    @param[in] cpu  the machine
+    @param[in] addr the address written
+ */
+void
+bb_code_written(struct z80_cpu *cpu, WORD addr){
+
+	bb_kill_range(cpu, addr, (unsigned int)addr + 1, 1);
+}
+
+/** Handle a block write from Z80 code (LDIR, LDDR) to a memory range.
+    @param[in] cpu  the machine
+    @param[in] addr the first address written
+    @param[in] len  the number of bytes written
+ */
+void
+bb_code_written_range(struct z80_cpu *cpu, WORD addr, int len){
+	unsigned int a;
+
+	for(a = addr; a < (unsigned int)addr + len; ++a) {
+
+		if ( BB_IS_CODE(a) ) {
+
+			bb_kill_range(cpu, a, (unsigned int)addr + len, 1);
+			break;
+		}
+	}
+}
+
+/** Throw away the blocks in a memory range written by the host.
+    @param[in] cpu  the machine
+    @param[in] addr the first address written
+    @param[in] len  the number of bytes written
+ */
+void
+bb_invalidate_range(struct z80_cpu *cpu, WORD addr, int len){
+	unsigned int a;
+
+	for(a = addr; a < (unsigned int)addr + len; ++a) {
+
+		if ( BB_IS_CODE(a) ) {
+
+			bb_kill_range(cpu, a, (unsigned int)addr + len, 0);
+			break;
+		}
+	}
+}
+
+/** Look up a block which is not in the block map.
+    @param[in] cpu the machine
+    @param[in] pc  Z80 address
+    @retval NULL the address is not hot yet or its page is self-modifying
+    @return the first record of the new block
+ */
+const struct bb_insn *
+bb_miss(struct z80_cpu *cpu, WORD pc){
+	struct bb_cache *bb = cpu->bb;
+
+	if ( bb->smc[pc >> 8] >= BB_SMC_LIMIT )
+		return NULL;
+	if ( ++bb->heat[pc] < BB_HOT )
+		return NULL;
+
+	bb->heat[pc] = 0;
+	return bb_translate(cpu, pc)->insn;
+}
+
+/** Start counting the op-code pairs entered in the block executor.
+    @param[in] cpu the machine
+    @retval 0 success
+    @retval -1 out of memory, or fusion is not compiled in
+ */
+int
+bb_profile_pairs(struct z80_cpu *cpu){
+
+#ifdef OPT_FUSION
+	if ( cpu->bb == NULL )
+		return -1;
+	if ( cpu->bb->pairs == NULL )
+		cpu->bb->pairs = calloc(BB_NR_PAIRS, sizeof(unsigned long));
+	return ( cpu->bb->pairs != NULL ) ? 0 : -1;
+#else
+	return -1;
+#endif
+}
+
+/** Count the op-code pairs of a block being entered.
+    @param[in] cpu the machine
+    @param[in] ins the first record of the block
+    @note A block left early still counts all its pairs.
+ */
+void
+bb_count_pairs(struct z80_cpu *cpu, const struct bb_insn *ins){
+
+	for(; ( ins[0].op != BB_OP_EXIT ) && ( ins[1].op != BB_OP_EXIT ); ++ins)
+		++cpu->bb->pairs[( ins[0].op << 8 ) | ins[1].op];
+}
+
+/** Add the op-code pair counts of a machine to a sum.
+    @param[in,out] sum BB_NR_PAIRS counts
+    @param[in]     cpu the machine
+ */
+void
+bb_add_pairs(unsigned long *sum, const struct z80_cpu *cpu){
+	int i;
+
+	if ( cpu->bb == NULL || cpu->bb->pairs == NULL )
+		return;
+	for(i = 0; i < BB_NR_PAIRS; ++i)
+		sum[i] += cpu->bb->pairs[i];
+}
+
+/** Compare two op-code pairs by their counts, the most frequent first.
+ */
+static int
+bb_pair_cmp(const void *a, const void *b){
+	const unsigned long *x = *(const unsigned long * const *)a;
+	const unsigned long *y = *(const unsigned long * const *)b;
+
+	if ( *x != *y )
+		return ( *x < *y ) ? 1 : -1;
+	return ( x < y ) ? -1 : 1;
+}
+
+/** Write the op-code pair counts in the format of src/fuse.lst.
+    @param[in] name  file name
+    @param[in] pairs BB_NR_PAIRS counts
+    @retval 0 success
+    @retval -1 the file can not be written, or out of memory
+ */
+int
+bb_write_pairs(const char *name, const unsigned long *pairs){
+	const unsigned long **sorted;
+	FILE *fp;
+	int i, n;
+
+	sorted = malloc(BB_NR_PAIRS * sizeof(*sorted));
+	if ( sorted == NULL )
+		return -1;
+	for(i = n = 0; i < BB_NR_PAIRS; ++i)
+		if ( pairs[i] != 0 )
+			sorted[n++] = &pairs[i];
+	qsort(sorted, n, sizeof(*sorted), bb_pair_cmp);
+
+	fp = fopen(name, "w");
+	if ( fp == NULL ) {
+
+		free(sorted);
+		return -1;
+	}
+	fprintf(fp, "# op-code pairs entered in cached blocks\n");
+	fprintf(fp, "# op1 op2 count\n");
+	for(i = 0; i < n; ++i)
+		fprintf(fp, "%02x %02x %lu\n", (int)( ( sorted[i] - pairs ) >> 8 ),
+		    (int)( ( sorted[i] - pairs ) & 0xff ), *sorted[i]);
+	free(sorted);
+	return ( fclose(fp) == 0 ) ? 0 : -1;
+}
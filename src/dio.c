@@ -33,14 +33,17 @@
 
 #define	DIO_RECLEN	(256)		/* length of a record */
 
-static FILE	*openfp = NULL;		/* for dio_[wr]open */
-static int	asciimode =0;		/* now in ascii convert mode */
+/* files of a batch session belong to the thread which runs it */
+static __thread FILE	*openfp = NULL;		/* for dio_[wr]open */
+static __thread int	asciimode =0;		/* now in ascii convert mode */
+static __thread char	openname[SOS_UNIX_PATH_MAX];	/* name of openfp */
+static __thread int	openwrite = 0;		/* openfp is written */
 
-static DIR	*dirfp = NULL;		/* for dio_dopen */
-static int	dircurrent = -1;	/* current dirno */
+static __thread DIR	*dirfp = NULL;		/* for dio_dopen */
+static __thread int	dircurrent = -1;	/* current dirno */
 
-char	*dio_disk[SOS_MAXIMAGEDRIVES];
-static FILE	*imagefp[SOS_MAXIMAGEDRIVES];	/* for image file */
+__thread char	*dio_disk[SOS_MAXIMAGEDRIVES];
+static __thread FILE	*imagefp[SOS_MAXIMAGEDRIVES];	/* for image file */
 
 
 /*
@@ -54,7 +57,7 @@ dio_stou(char *sosname){
     int l;	/* length counter */
     int ei;	/* end index on name */
     int nei;	/* end of name part on name */
-    static char	name[SOS_FNAMELEN+2];
+    static __thread char	name[SOS_FNAMELEN+2];
     char	*p;
 
     for (l=ei=0; l<SOS_FNAMENAMELEN; l++){
@@ -86,7 +89,7 @@ dio_stou(char *sosname){
 */
 char *
 dio_utos(char *unixname){
-    static char	sosname[SOS_FNAMELEN+1];
+    static __thread char	sosname[SOS_FNAMELEN+1];
     int	i;
     char	c;
 
@@ -133,12 +136,15 @@ dio_wopen(char *sosname, int attr, int dtadr, int size, int exadr){
     if ((openfp = fopen(name, "wb")) == NULL){
 	return(1);
     }
+    snprintf(openname, sizeof(openname), "%s", name);
+    openwrite = 1;
 
     /* store SWORD header */
     snprintf(buf, DIO_HEADERLEN+1, DIO_HEADERPAT ,attr, dtadr, exadr);
 
     if (fwrite(buf, sizeof(char), DIO_HEADERLEN, openfp) < DIO_HEADERLEN){
 	fclose(openfp);
+	openfp = NULL;
 	unlink(name);
 	return(1);
     }
@@ -176,6 +182,8 @@ dio_ropen(char *sosname, int *attr, int *dtadr, int *size,
     if ((openfp = fopen(name, "rb")) == NULL){
 	return(8);
     }
+    snprintf(openname, sizeof(openname), "%s", name);
+    openwrite = 0;
 
     /* check SWORD header */
     *buf = '\0';	/* paranoia */
@@ -226,7 +234,7 @@ dio_dopen(char *namebuf, int *attr, int *dtadr, int *size, int *exadr, int dirno
     int	i;
     char	*sosname;
 
-    if (dirno == 0){		/* start from virgin */
+    if (dirno == 0 || dirfp == NULL){	/* start from virgin */
 	if (dirfp != NULL){
 	    (void) closedir(dirfp);
 	}
@@ -429,3 +437,93 @@ int dio_dwrite(unsigned char *buf, int diskno, int recno, int numrec){
     }
     return(0);
 }
+
+/*
+   close all files and unmount all disk images
+*/
+void
+dio_reset(void){
+    int	n;
+
+    if (openfp != NULL){
+	fclose(openfp);
+	openfp = NULL;
+    }
+    asciimode = 0;
+    if (dirfp != NULL){
+	closedir(dirfp);
+	dirfp = NULL;
+    }
+    dircurrent = -1;
+    for (n=0; n<SOS_MAXIMAGEDRIVES; n++){
+	dio_diclose(n);
+	free(dio_disk[n]);
+	dio_disk[n] = NULL;
+    }
+}
+
+/** Record the files of this session for a snapshot: the mounted disk
+    images and the file opened by dio_wopen() or dio_ropen().  A
+    directory being read is not kept; dio_dopen() reads it again from
+    the start.
+    @param[out] st the files
+    @retval 0 success
+    @retval -1 a file name is longer than DIO_PATHLEN
+ */
+int
+dio_save(struct dio_state *st){
+    int	n;
+
+    memset(st, 0, sizeof(*st));
+    for (n=0; n<SOS_MAXIMAGEDRIVES; n++){
+	if (dio_disk[n] == NULL)
+	    continue;
+	if (strlen(dio_disk[n]) >= DIO_PATHLEN)
+	    return(-1);
+	strcpy(st->disk[n], dio_disk[n]);
+    }
+    if (openfp != NULL){
+	if (strlen(openname) >= DIO_PATHLEN)
+	    return(-1);
+	(void) fflush(openfp);
+	strcpy(st->open, openname);
+	st->pos = ftell(openfp);
+	st->write = openwrite;
+	st->ascii = asciimode;
+    }
+    return(0);
+}
+
+/** Close the files of this session and open the ones recorded by
+    dio_save().  An open file is opened again at its position; a file
+    being written is not truncated.
+    @param[in] st the files
+    @retval 0 success
+    @retval -1 out of memory, or the open file can not be opened
+ */
+int
+dio_load(const struct dio_state *st){
+    int	n;
+
+    dio_reset();
+    for (n=0; n<SOS_MAXIMAGEDRIVES; n++){
+	if (st->disk[n][0] == '\0')
+	    continue;
+	if ((dio_disk[n] = strdup(st->disk[n])) == NULL)
+	    return(-1);
+    }
+    if (st->open[0] != '\0'){
+	openfp = fopen(st->open, st->write ? "r+b" : "rb");
+	if (openfp == NULL)
+	    return(-1);
+	if (fseek(openfp, st->pos, SEEK_SET) != 0){
+	    fclose(openfp);
+	    openfp = NULL;
+	    return(-1);
+	}
+	snprintf(openname, sizeof(openname), "%s", st->open);
+	openwrite = st->write;
+	asciimode = st->ascii;
+    }
+    return(0);
+}
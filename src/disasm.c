@@ -0,0 +1,196 @@
+/*
+   SWORD Emurator  Z80 disassembler
+
+   The mnemonics come from the tables which simz80.pl generates from
+   the names of the cases of the interpreter, so the disassembler and
+   the interpreter agree on every op-code.  An op-code the interpreter
+   does not know is shown as DB of the bytes it skips: a DD or FD
+   prefix which it ignores, and an ED prefix before an undefined
+   op-code from 40H to 7FH, take one byte, other undefined ED
+   op-codes two.  disasm() writes into the caller's buffer and
+   allocates nothing, so that it may be called while tracing and
+   profiling.
+
+   Numbers are written in hex with the H suffix, as S-OS does; the
+   target of a relative jump is written as its address.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "simz80.h"
+#include "disasm.h"
+
+/** Append a string to the output.
+    @param[out]    buf the output
+    @param[in]     len size of buf
+    @param[in,out] pos length of the output
+    @param[in]     s   the string
+ */
+static void
+dis_puts(char *buf, size_t len, size_t *pos, const char *s){
+
+	while( *s != '\0' && *pos + 1 < len )
+		buf[(*pos)++] = *s++;
+	buf[*pos] = '\0';
+}
+
+/** Append a number in hex, with a leading 0 if it starts with a letter.
+    @param[out]    buf    the output
+    @param[in]     len    size of buf
+    @param[in,out] pos    length of the output
+    @param[in]     v      the number
+    @param[in]     digits hex digits to write
+ */
+static void
+dis_hex(char *buf, size_t len, size_t *pos, unsigned int v, int digits){
+	char tmp[8];
+
+	snprintf(tmp, sizeof(tmp), "%s%0*XH",
+	    ( ( v >> ( 4 * ( digits - 1 ) ) ) & 0xf ) >= 10 ? "0" : "",
+	    digits, v);
+	dis_puts(buf, len, pos, tmp);
+}
+
+/** Append an index displacement, e.g. "+05H" or "-80H".
+    @param[out]    buf the output
+    @param[in]     len size of buf
+    @param[in,out] pos length of the output
+    @param[in]     d   the displacement byte
+ */
+static void
+dis_disp(char *buf, size_t len, size_t *pos, BYTE d){
+	int v = (signed char)d;
+
+	dis_puts(buf, len, pos, ( v < 0 ) ? "-" : "+");
+	dis_hex(buf, len, pos, ( v < 0 ) ? -v : v, 2);
+}
+
+/** Disassemble an instruction.
+    @param[in]  code the bytes of the instruction, DISASM_MAX of them
+    @param[in]  addr its address
+    @param[out] buf  the instruction, e.g. "LD A,(IX+05H)"
+    @param[in]  len  size of buf, DISASM_BUFSIZ is enough
+    @return length of the instruction in bytes
+ */
+int
+disasm(const BYTE *code, WORD addr, char *buf, size_t len){
+	const char *mn, *p;
+	const char *xy = NULL;		/* index register */
+	int xycb = 0;			/* DD CB dd xx or FD CB dd xx */
+	size_t pos = 0;
+	int n;				/* next operand byte */
+
+	if ( len == 0 )
+		return 1;
+	buf[0] = '\0';
+
+	switch( code[0] ) {
+
+	case 0xcb:
+		mn = z80_mn_cb[code[1]];
+		n = 2;
+		break;
+	case 0xed:
+		mn = z80_mn_ed[code[1]];
+		n = 2;
+		if ( mn == NULL && 0x40 <= code[1] && code[1] <= 0x7f ) {
+
+			dis_puts(buf, len, &pos, "DB 0EDH");
+			return 1;		/* runs as an ignored prefix */
+		}
+		if ( mn == NULL ) {
+
+			dis_puts(buf, len, &pos, "DB 0EDH,");
+			dis_hex(buf, len, &pos, code[1], 2);
+			return 2;
+		}
+		break;
+	case 0xdd:
+	case 0xfd:
+		xy = ( code[0] == 0xdd ) ? "IX" : "IY";
+		if ( code[1] == 0xcb ) {
+
+			mn = z80_mn_cb[code[3]];
+			xycb = 1;
+			n = 4;
+			break;
+		}
+		mn = z80_mn_xy[code[1]];
+		n = 2;
+		if ( mn == NULL ) {
+
+			dis_puts(buf, len, &pos, "DB ");
+			dis_hex(buf, len, &pos, code[0], 2);
+			return 1;
+		}
+		break;
+	default:
+		mn = z80_mn_op[code[0]];
+		n = 1;
+		break;
+	}
+
+	for(p = mn; *p != '\0'; ) {
+
+		if ( strncmp(p, "nnnn", 4) == 0 ) {
+
+			dis_hex(buf, len, &pos, code[n] | ( code[n + 1] << 8 ), 4);
+			n += 2;
+			p += 4;
+		} else if ( strncmp(p, "nn", 2) == 0 ) {
+
+			dis_hex(buf, len, &pos, code[n++], 2);
+			p += 2;
+		} else if ( strncmp(p, "+dd", 3) == 0 ) {
+
+			dis_disp(buf, len, &pos, code[n++]);
+			p += 3;
+		} else if ( strncmp(p, "dd", 2) == 0 ) {
+
+			n++;		/* JR, DJNZ: relative to the next one */
+			dis_hex(buf, len, &pos,
+			    (WORD)( addr + n + (signed char)code[n - 1] ), 4);
+			p += 2;
+		} else if ( xy != NULL && strncmp(p, "XY", 2) == 0 ) {
+
+			dis_puts(buf, len, &pos, xy);
+			p += 2;
+		} else if ( xycb && strncmp(p, "(HL)", 4) == 0 ) {
+
+			dis_puts(buf, len, &pos, "(");
+			dis_puts(buf, len, &pos, xy);
+			dis_disp(buf, len, &pos, code[2]);
+			dis_puts(buf, len, &pos, ")");
+			p += 4;
+		} else {
+
+			if ( pos + 1 < len ) {
+
+				buf[pos++] = *p;
+				buf[pos] = '\0';
+			}
+			p++;
+		}
+	}
+
+	return n;
+}
+
+/** Disassemble an instruction in the memory of a machine.
+    @param[in]  cpu  the machine
+    @param[in]  addr address of the instruction
+    @param[out] buf  the instruction
+    @param[in]  len  size of buf
+    @return length of the instruction in bytes
+ */
+int
+disasm_ram(struct z80_cpu *cpu, WORD addr, char *buf, size_t len){
+	BYTE code[DISASM_MAX];
+	int i;
+
+	for(i = 0; i < DISASM_MAX; ++i)
+		code[i] = RAM(addr + i);
+	return disasm(code, addr, buf, len);
+}
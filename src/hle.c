@@ -0,0 +1,548 @@
+/*
+   SWORD Emurator  high-level emulation
+
+   The first time an address is called, the bytes there are hashed and
+   looked up in a table of library routines which S-OS programs carry
+   in one form or another: multiply, divide, fill a block, compare
+   strings.  The call of a routine found is run by a C function
+   instead, which leaves the registers, the flags, the memory and the
+   T-states as the Z80 code would, so that the rest of the session
+   does not see the difference; the R register follows from the
+   T-states.
+
+   A routine is run natively only if it would return before the run
+   stops (the end of the slice, an event, an interrupt request), and
+   while the machine is neither profiled nor traced; else, and where
+   the C function declines (e.g. a fill which would overwrite the
+   routine), the Z80 code runs.  The stack is written as CALL and RET
+   do: a routine reading the return address reads it.
+
+   The code found is checked against the table at every call, so that
+   a routine overwritten by the program is not run natively.  Writes
+   by the host (loading a program or a file) and block moves of Z80
+   code (LDIR, LDDR) make the addresses written be looked at again.
+*/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "simz80.h"
+#include "bbcache.h"
+#include "hle.h"
+
+#define	HLE_FNV_BASIS	(2166136261UL)	/* FNV-1a, 32 bits */
+#define	HLE_FNV_PRIME	(16777619UL)
+
+/* the registers of a call run natively */
+struct hle_regs {
+	unsigned int af, bc, de, hl;
+	WORD	sp;			/* after the CALL */
+	WORD	ret;			/* the return address, at sp */
+	unsigned long cyc;		/* T-states of the routine, the
+					   returning RET included; the
+					   CALL counts its own */
+};
+
+/* a known routine */
+struct hle_routine {
+	const BYTE *code;
+	unsigned int len;
+	/* compute the effect of a call, -1 to run the Z80 code instead;
+	   the memory is not written yet */
+	int	(*run)(const struct z80_cpu *, WORD, struct hle_regs *);
+	/* write the memory, NULL if the routine does not */
+	void	(*store)(struct z80_cpu *, struct hle_regs *);
+};
+
+/* T-states of the conditional op-codes, as simz80.pl adds them */
+#define	HLE_CC_JR	(5)		/* JR cc and DJNZ taken */
+#define	HLE_CC_RET	(6)		/* RET cc taken */
+
+/** Read a byte as the routine would.
+    @param[in] cpu the machine
+    @param[in] r   the registers, with the return address on the stack
+    @param[in] a   the address
+    @return the byte
+ */
+static BYTE
+hle_peek(const struct z80_cpu *cpu, const struct hle_regs *r, unsigned int a){
+
+	a &= 0xffff;
+	if ( a == r->sp )
+		return r->ret & 0xff;
+	if ( a == (WORD)( r->sp + 1 ) )
+		return r->ret >> 8;
+	return cpu->ram[a];
+}
+
+/** ADD HL,rr
+    @param[in] r the registers
+    @param[in] v the other operand
+ */
+static void
+hle_add16(struct hle_regs *r, unsigned int v){
+	unsigned int sum, cbits;
+
+	sum = r->hl + v;
+	cbits = ( r->hl ^ v ^ sum ) >> 8;
+	r->hl = sum & 0xffff;
+	r->af = ( r->af & ~0x3b ) | ( ( sum >> 8 ) & 0x28 ) |
+	    ( cbits & 0x10 ) | ( ( cbits >> 8 ) & 1 );
+}
+
+/** ADD A,A
+    @param[in] r the registers
+ */
+static void
+hle_add_a_a(struct hle_regs *r){
+	unsigned int acu, sum, cbits;
+
+	acu = r->af >> 8;
+	sum = acu + acu;
+	cbits = acu ^ acu ^ sum;
+	r->af = ( ( sum & 0xff ) << 8 ) | ( sum & 0xa8 ) |
+	    ( ( ( sum & 0xff ) == 0 ) << 6 ) | ( cbits & 0x10 ) |
+	    ( ( ( cbits >> 6 ) ^ ( cbits >> 5 ) ) & 4 ) |
+	    ( ( cbits >> 8 ) & 1 );
+}
+
+/** SUB or CP
+    @param[in] r    the registers
+    @param[in] v    the operand
+    @param[in] keep CP: leave A alone
+ */
+static void
+hle_sub(struct hle_regs *r, unsigned int v, int keep){
+	unsigned int acu, sum, cbits;
+
+	acu = r->af >> 8;
+	sum = acu - v;
+	cbits = acu ^ v ^ sum;
+	if ( keep )
+		r->af = ( r->af & ~0xff ) | ( sum & 0x80 ) |
+		    ( ( ( sum & 0xff ) == 0 ) << 6 ) | ( v & 0x28 ) |
+		    ( ( ( cbits >> 6 ) ^ ( cbits >> 5 ) ) & 4 ) | 2 |
+		    ( cbits & 0x10 ) | ( ( cbits >> 8 ) & 1 );
+	else
+		r->af = ( ( sum & 0xff ) << 8 ) | ( sum & 0xa8 ) |
+		    ( ( ( sum & 0xff ) == 0 ) << 6 ) | ( cbits & 0x10 ) |
+		    ( ( ( cbits >> 6 ) ^ ( cbits >> 5 ) ) & 4 ) | 2 |
+		    ( ( cbits >> 8 ) & 1 );
+}
+
+/** AND, OR or XOR, with the result in A
+    @param[in] r the registers
+ */
+static void
+hle_logic(struct hle_regs *r){
+	unsigned int v = r->af >> 8, p = v;
+
+	p ^= p >> 4;
+	p ^= p >> 2;
+	p ^= p >> 1;
+	r->af = ( v << 8 ) | ( v & 0xa8 ) | ( ( v == 0 ) << 6 ) |
+	    ( ( ~p & 1 ) << 2 );
+}
+
+/* the flags tested */
+#define	HLE_Z(_r)	( (_r)->af & FLAG_Z )
+#define	HLE_C(_r)	( (_r)->af & FLAG_C )
+
+/** HL = DE * A, the low 16 bits; B = 0, A = 0
+
+	LD HL,0
+	LD B,8
+   1:	ADD HL,HL
+	ADD A,A
+	JR NC,2F
+	ADD HL,DE
+   2:	DJNZ 1B
+	RET
+ */
+static const BYTE hle_code_mul8[] = {
+	0x21, 0x00, 0x00, 0x06, 0x08, 0x29, 0x87, 0x30, 0x01, 0x19,
+	0x10, 0xf9, 0xc9,
+};
+
+static int
+hle_mul8(const struct z80_cpu *cpu, WORD org, struct hle_regs *r){
+	int	b;
+
+	r->hl = 0;
+	r->cyc = z80_cc_op[0x21] + z80_cc_op[0x06];
+	for(b = 8; b > 0; --b) {
+
+		hle_add16(r, r->hl);
+		hle_add_a_a(r);
+		r->cyc += z80_cc_op[0x29] + z80_cc_op[0x87] + z80_cc_op[0x30]
+		    + z80_cc_op[0x10] + ( b > 1 ? HLE_CC_JR : 0 );
+		if ( HLE_C(r) ) {
+
+			hle_add16(r, r->de);
+			r->cyc += z80_cc_op[0x19];
+		} else
+			r->cyc += HLE_CC_JR;
+	}
+	r->bc &= 0xff;
+	r->cyc += z80_cc_op[0xc9];
+	return 0;
+}
+
+/** HL = HL / C, A = the remainder; B = 0
+
+	XOR A
+	LD B,16
+   1:	ADD HL,HL
+	RLA
+	CP C
+	JR C,2F
+	SUB C
+	INC L
+   2:	DJNZ 1B
+	RET
+ */
+static const BYTE hle_code_div8[] = {
+	0xaf, 0x06, 0x10, 0x29, 0x17, 0xb9, 0x38, 0x02, 0x91, 0x2c,
+	0x10, 0xf7, 0xc9,
+};
+
+static int
+hle_div8(const struct z80_cpu *cpu, WORD org, struct hle_regs *r){
+	unsigned int c = r->bc & 0xff, l;
+	int	b;
+
+	r->af = 0;
+	hle_logic(r);
+	r->cyc = z80_cc_op[0xaf] + z80_cc_op[0x06];
+	for(b = 16; b > 0; --b) {
+
+		hle_add16(r, r->hl);
+		/* RLA */
+		r->af = ( ( r->af << 8 ) & 0x0100 ) | ( ( r->af >> 7 ) & 0x28 )
+		    | ( ( r->af << 1 ) & 0xfe00 ) | ( r->af & 0xc4 )
+		    | ( ( r->af >> 15 ) & 1 );
+		hle_sub(r, c, 1);
+		r->cyc += z80_cc_op[0x29] + z80_cc_op[0x17] + z80_cc_op[0xb9]
+		    + z80_cc_op[0x38] + z80_cc_op[0x10]
+		    + ( b > 1 ? HLE_CC_JR : 0 );
+		if ( HLE_C(r) ) {
+
+			r->cyc += HLE_CC_JR;
+			continue;
+		}
+		hle_sub(r, c, 0);
+		/* INC L */
+		l = ( r->hl + 1 ) & 0xff;
+		r->hl = ( r->hl & 0xff00 ) | l;
+		r->af = ( r->af & ~0xfe ) | ( l & 0xa8 ) | ( ( l == 0 ) << 6 ) |
+		    ( ( ( l & 0xf ) == 0 ) << 4 ) | ( ( l == 0x80 ) << 2 );
+		r->cyc += z80_cc_op[0x91] + z80_cc_op[0x2c];
+	}
+	r->bc = c;
+	r->cyc += z80_cc_op[0xc9];
+	return 0;
+}
+
+/** Fill BC bytes from HL with A; HL = the last byte, DE = HL + 1,
+    BC = 0
+
+	LD (HL),A
+	LD D,H
+	LD E,L
+	INC DE
+	DEC BC
+	LDIR
+	RET
+ */
+static const BYTE hle_code_fill[] = {
+	0x77, 0x54, 0x5d, 0x13, 0x0b, 0xed, 0xb0, 0xc9,
+};
+
+static int
+hle_fill(const struct z80_cpu *cpu, WORD org, struct hle_regs *r){
+	unsigned int n = r->bc;
+
+	/* BC = 1 fills the whole memory; nor may the routine fill itself */
+	if ( n < 2 || (WORD)( org - r->hl ) < n
+	    || (WORD)( r->hl - org ) < sizeof(hle_code_fill) )
+		return -1;
+	r->cyc = z80_cc_op[0x77] + z80_cc_op[0x54] + z80_cc_op[0x5d]
+	    + z80_cc_op[0x13] + z80_cc_op[0x0b] + z80_cc_ed[0xb0]
+	    + 21 * ( n - 2 ) + z80_cc_op[0xc9];
+	return 0;
+}
+
+static void
+hle_fill_store(struct z80_cpu *cpu, struct hle_regs *r){
+	unsigned int n = r->bc - 1, acu;
+
+	PutBYTE(r->hl, r->af >> 8);
+	trap_move_block(cpu, r->hl + 1, r->hl, n, 0);
+	r->de = ( r->hl + 1 + n ) & 0xffff;
+	r->hl = ( r->hl + n ) & 0xffff;
+	r->bc = 0;
+	acu = RAM(r->de - 1) + ( r->af >> 8 );
+	r->af = ( r->af & ~0x3e ) | ( acu & 8 ) | ( ( acu & 2 ) << 4 );
+}
+
+/** Compare B bytes from DE with those from HL: Z if they are the same,
+    else the flags of CP with the first pair which is not, DE and HL
+    on it
+
+   1:	LD A,(DE)
+	CP (HL)
+	RET NZ
+	INC DE
+	INC HL
+	DJNZ 1B
+	RET
+ */
+static const BYTE hle_code_cmpn[] = {
+	0x1a, 0xbe, 0xc0, 0x13, 0x23, 0x10, 0xf9, 0xc9,
+};
+
+static int
+hle_cmpn(const struct z80_cpu *cpu, WORD org, struct hle_regs *r){
+	unsigned int b = r->bc >> 8;
+
+	r->cyc = 0;
+	do {
+		r->af = ( hle_peek(cpu, r, r->de) << 8 ) | ( r->af & 0xff );
+		hle_sub(r, hle_peek(cpu, r, r->hl), 1);
+		r->cyc += z80_cc_op[0x1a] + z80_cc_op[0xbe] + z80_cc_op[0xc0];
+		if ( !HLE_Z(r) ) {
+
+			r->cyc += HLE_CC_RET;
+			r->bc = ( b << 8 ) | ( r->bc & 0xff );
+			return 0;
+		}
+		r->de = ( r->de + 1 ) & 0xffff;
+		r->hl = ( r->hl + 1 ) & 0xffff;
+		b = ( b - 1 ) & 0xff;
+		r->cyc += z80_cc_op[0x13] + z80_cc_op[0x23] + z80_cc_op[0x10]
+		    + ( b != 0 ? HLE_CC_JR : 0 );
+	} while( b != 0 );
+	r->bc &= 0xff;
+	r->cyc += z80_cc_op[0xc9];
+	return 0;
+}
+
+/** Compare the string ending in 0 from DE with that from HL: Z if they
+    are the same, else the flags of CP with the first pair which is
+    not, DE and HL on it
+
+   1:	LD A,(DE)
+	CP (HL)
+	RET NZ
+	OR A
+	RET Z
+	INC DE
+	INC HL
+	JR 1B
+ */
+static const BYTE hle_code_strcmp[] = {
+	0x1a, 0xbe, 0xc0, 0xb7, 0xc8, 0x13, 0x23, 0x18, 0xf7,
+};
+
+static int
+hle_strcmp(const struct z80_cpu *cpu, WORD org, struct hle_regs *r){
+	unsigned long n;
+
+	r->cyc = 0;
+	for(n = 0; n < 0x10000; ++n) {
+
+		r->af = ( hle_peek(cpu, r, r->de) << 8 ) | ( r->af & 0xff );
+		hle_sub(r, hle_peek(cpu, r, r->hl), 1);
+		r->cyc += z80_cc_op[0x1a] + z80_cc_op[0xbe] + z80_cc_op[0xc0];
+		if ( !HLE_Z(r) ) {
+
+			r->cyc += HLE_CC_RET;
+			return 0;
+		}
+		hle_logic(r);
+		r->cyc += z80_cc_op[0xb7] + z80_cc_op[0xc8];
+		if ( HLE_Z(r) ) {
+
+			r->cyc += HLE_CC_RET;
+			return 0;
+		}
+		r->de = ( r->de + 1 ) & 0xffff;
+		r->hl = ( r->hl + 1 ) & 0xffff;
+		r->cyc += z80_cc_op[0x13] + z80_cc_op[0x23] + z80_cc_op[0x18];
+	}
+	return -1;		/* no end in the whole memory */
+}
+
+/* the routines known, the shortest first */
+static const struct hle_routine hle_routines[HLE_NR] = {
+	{ hle_code_fill, sizeof(hle_code_fill), hle_fill, hle_fill_store },
+	{ hle_code_cmpn, sizeof(hle_code_cmpn), hle_cmpn, NULL },
+	{ hle_code_strcmp, sizeof(hle_code_strcmp), hle_strcmp, NULL },
+	{ hle_code_mul8, sizeof(hle_code_mul8), hle_mul8, NULL },
+	{ hle_code_div8, sizeof(hle_code_div8), hle_div8, NULL },
+};
+
+/** Hash bytes, one at a time.
+    @param[in] h the hash of the bytes before
+    @param[in] c the byte
+    @return the hash
+ */
+static unsigned long
+hle_hash(unsigned long h, BYTE c){
+
+	return ( ( h ^ c ) * HLE_FNV_PRIME ) & 0xffffffffUL;
+}
+
+/** Find the routine at an address.
+    @param[in] cpu  the machine
+    @param[in] addr Z80 address called
+    @return 1 + the routine, HLE_NONE if none is known
+ */
+static int
+hle_identify(const struct z80_cpu *cpu, WORD addr){
+	const struct hle *h = cpu->hle;
+	const struct hle_routine *rt;
+	unsigned long hash = HLE_FNV_BASIS;
+	unsigned int n = 0;
+	int	i;
+
+	for(i = 0; i < HLE_NR; ++i) {
+
+		rt = &hle_routines[i];
+		if ( addr + rt->len > 0x10000 )
+			break;
+		for(; n < rt->len; ++n)
+			hash = hle_hash(hash, cpu->ram[addr + n]);
+		if ( hash == h->hash[i]
+		    && memcmp(&cpu->ram[addr], rt->code, rt->len) == 0 )
+			return i + 1;
+	}
+	return HLE_NONE;
+}
+
+/** Start running the known routines of a machine natively.
+    @param[in] cpu the machine
+    @retval 0 success
+    @retval -1 out of memory, or high-level emulation is not compiled in
+ */
+int
+hle_start(struct z80_cpu *cpu){
+#ifdef OPT_HLE
+	struct hle *h;
+	unsigned int n;
+	int	i;
+
+	if ( cpu->hle != NULL )
+		return 0;
+
+	h = calloc(1, sizeof(struct hle));
+	if ( h == NULL )
+		return -1;
+	for(i = 0; i < HLE_NR; ++i) {
+
+		h->hash[i] = HLE_FNV_BASIS;
+		for(n = 0; n < hle_routines[i].len; ++n)
+			h->hash[i] = hle_hash(h->hash[i], hle_routines[i].code[n]);
+	}
+	cpu->hle = h;
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/** Run every routine of a machine as Z80 code again.
+    @param[in] cpu the machine
+ */
+void
+hle_stop(struct z80_cpu *cpu){
+
+	free(cpu->hle);
+	cpu->hle = NULL;
+}
+
+/** Run a call natively if it goes to a known routine.  If it does not,
+    the machine is left alone.
+    @param[in] cpu      the machine, its registers at the CALL, which
+                        has been counted
+    @param[in] addr     Z80 address called
+    @param[in] ret      the return address
+    @param[in] deadline T-states at which the run is to stop
+    @retval 1 the routine has returned, to cpu->pc
+    @retval 0 run the CALL
+ */
+int
+hle_call(struct z80_cpu *cpu, WORD addr, WORD ret,
+    unsigned long long deadline){
+	struct hle *h = cpu->hle;
+	const struct hle_routine *rt;
+	struct hle_regs r;
+	int	i;
+
+	if ( cpu->prof != NULL || cpu->trace != NULL )
+		return 0;	/* they see every instruction */
+
+	i = h->map[addr];
+	if ( i == HLE_NONE )
+		return 0;
+	if ( i == HLE_UNKNOWN || memcmp(&cpu->ram[addr],
+	    hle_routines[i - 1].code, hle_routines[i - 1].len) != 0 ) {
+
+		i = hle_identify(cpu, addr);
+		h->map[addr] = i;
+		if ( i == HLE_NONE )
+			return 0;
+	}
+	rt = &hle_routines[i - 1];
+
+	r.af = cpu->af[cpu->af_sel];
+	r.bc = cpu->regs[cpu->regs_sel].bc;
+	r.de = cpu->regs[cpu->regs_sel].de;
+	r.hl = cpu->regs[cpu->regs_sel].hl;
+	r.sp = cpu->sp - 2;
+	r.ret = ret;
+	if ( (WORD)( r.sp + 1 - addr ) < rt->len + 1 )
+		return 0;	/* the CALL would overwrite the routine */
+	if ( rt->run(cpu, addr, &r) || cpu->cycles + r.cyc > deadline )
+		return 0;
+
+	/* CALL */
+	RAM(r.sp + 1) = ret >> 8;
+	RAM(r.sp) = ret & 0xff;
+	BB_CHECK(r.sp);
+	BB_CHECK(r.sp + 1);
+	if ( rt->store != NULL )
+		rt->store(cpu, &r);
+
+	cpu->af[cpu->af_sel] = r.af;
+	cpu->regs[cpu->regs_sel].bc = r.bc;
+	cpu->regs[cpu->regs_sel].de = r.de;
+	cpu->regs[cpu->regs_sel].hl = r.hl;
+	cpu->cycles += r.cyc;
+
+	/* RET */
+	cpu->pc = RAM(r.sp) | ( RAM(r.sp + 1) << 8 );
+	cpu->sp = r.sp + 2;
+	return 1;
+}
+
+/** Look at the routines again after a write.
+    @param[in] cpu  the machine
+    @param[in] addr the first address written
+    @param[in] len  the number of bytes written
+ */
+void
+hle_written(struct z80_cpu *cpu, WORD addr, unsigned int len){
+	unsigned int n;
+
+	if ( len + HLE_MAXLEN >= 0x10000 ) {
+
+		memset(cpu->hle->map, HLE_UNKNOWN, sizeof(cpu->hle->map));
+		return;
+	}
+	/* the routines which may begin before the first address, too */
+	addr -= HLE_MAXLEN - 1;
+	for(n = 0; n < len + HLE_MAXLEN - 1; ++n)
+		cpu->hle->map[(WORD)( addr + n )] = HLE_UNKNOWN;
+}
@@ -0,0 +1,857 @@
+/*
+   SWORD Emurator  x86-64 dynamic recompiler
+
+   Blocks of the basic block cache (bbcache.c) are translated into host
+   code in an mmap'd arena.  While a block runs, the Z80 registers are
+   kept in host registers:
+
+	A  %ah   F  %al   B  %ch   C  %cl
+	D  %dh   E  %dl   H  %bh   L  %bl
+
+   SP stays in the jit_regs of the machine, which the host code
+   addresses through %r13; %rbp points to the Z80 memory of the
+   machine, %r14 to the flag tables and %r12 to its cycle count.  Loads,
+   8 bit arithmetic, 16 bit increments and branches are expanded
+   inline; every other op-code stores the registers into jit_regs and
+   calls the helper generated from the block executor's handler by
+   simz80.pl, so that the interpreter stays the reference for the
+   semantics.  F is not built for an inline instruction whose flags
+   are all overwritten before the block reads them or leaves.
+
+   The T-states of the inline instructions are added to the count
+   before a helper is called and when the block leaves; a block which
+   loops onto itself leaves once the cycle budget is spent.
+
+   The arena is never writable and executable at once: the pages a
+   block goes in are made writable while it is emitted, and executable
+   again before it runs.
+
+   A translated block returns the next Z80 PC, with JIT_HALT set if it
+   stopped at HALT.  jit_run() chains blocks until it reaches code
+   which is not translated, or the budget is spent.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef OPT_BATCH
+#include <pthread.h>
+#endif
+#include "simz80.h"
+#include "bbcache.h"
+#include "jit.h"
+
+#ifdef OPT_JIT
+
+typedef FASTWORK (*jit_code)(struct jit_regs *_r);
+
+#define	JIT_INSN_MAX	(160)		/* max host code for an instruction */
+#define	JIT_BLOCK_MAX	(32 + JIT_INSN_MAX * (BB_MAX_INSNS + 1))
+
+#define	JIT_OFF_SP	(offsetof(struct jit_regs, sp))
+#define	JIT_OFF_STALE	(offsetof(struct jit_regs, stale))
+#define	JIT_OFF_DEADLINE	(offsetof(struct jit_regs, deadline))
+/* the memory and the cycle count of the machine, seen from its jit_regs */
+#define	JIT_OFF_RAM	\
+	(offsetof(struct z80_cpu, ram) - offsetof(struct z80_cpu, jit))
+#define	JIT_OFF_CYCLES	\
+	((long)offsetof(struct z80_cpu, cycles) - (long)offsetof(struct z80_cpu, jit))
+
+#define	JIT_EPILOGUE_LEN	(9)
+#define	JIT_SPILL_LEN		(20)
+#define	JIT_EXIT_LEN		(JIT_SPILL_LEN + 5 + JIT_EPILOGUE_LEN)
+#define	JIT_CYCLES_LEN		(8)
+#define	JIT_LOOP_LEN		(14)
+
+/* host registers */
+#define	X86_AX	(0)		/* AF */
+#define	X86_CX	(1)		/* BC */
+#define	X86_DX	(2)		/* DE */
+#define	X86_BX	(3)		/* HL */
+#define	X86_AH	(4)		/* A */
+
+/* flags of a result, except C */
+static struct {
+	BYTE	szp[256];		/* S Z 5 3 P of logical operations */
+	BYTE	inc[256];		/* S Z 5 3 H V of INC */
+	BYTE	dec[256];		/* S Z 5 3 H V N of DEC */
+} jit_ftab;
+
+#define	JIT_FTAB_SZP	(offsetof(__typeof__(jit_ftab), szp))
+#define	JIT_FTAB_INC	(offsetof(__typeof__(jit_ftab), inc))
+#define	JIT_FTAB_DEC	(offsetof(__typeof__(jit_ftab), dec))
+
+/* a block is translated by the thread which runs its machine */
+static __thread BYTE	*jit_p;		/* emit pointer */
+static __thread int	 jit_pending;	/* T-states not added to the count */
+
+/* host registers of B, C, D, E, H, L, (HL), A */
+static const int jit_reg8[8] = {
+	5, 1, 6, 2, 7, 3, -1, X86_AH		/* %ch %cl %dh %dl %bh %bl - %ah */
+};
+
+/* host registers of BC, DE, HL (SP is kept in memory) */
+static const int jit_reg16[4] = {
+	X86_CX, X86_DX, X86_BX, -1
+};
+
+/* ADD, ADC, SUB, SBC, AND, XOR, OR, CP: register form and /digit of
+   the immediate form */
+static const BYTE jit_alu_rm[8] = {
+	0x00, 0x10, 0x28, 0x18, 0x20, 0x30, 0x08, 0x38
+};
+static const BYTE jit_alu_ext[8] = {
+	0, 2, 5, 3, 4, 6, 1, 7
+};
+
+/* flag tested by NZ, Z, NC, C, PO, PE, P, M */
+static const int jit_ccflag[8] = {
+	FLAG_Z, FLAG_Z, FLAG_C, FLAG_C, FLAG_P, FLAG_P, FLAG_S, FLAG_S
+};
+
+static void
+emit1(int b){
+
+	*jit_p++ = (BYTE)b;
+}
+
+static void
+emit2(int b1, int b2){
+
+	emit1(b1);
+	emit1(b2);
+}
+
+static void
+emit4(uint32_t v){
+
+	memcpy(jit_p, &v, 4);
+	jit_p += 4;
+}
+
+static void
+emit8(uint64_t v){
+
+	memcpy(jit_p, &v, 8);
+	jit_p += 8;
+}
+
+/** Store AF, BC, DE and HL into jit_regs.
+ */
+static void
+emit_spill(void){
+	int r;
+
+	for(r = X86_AX; r <= X86_BX; ++r) {
+
+		emit2(0x66, 0x41); emit1(0x89);
+		emit2(0x45 | ( r << 3 ), r * 2);	/* mov %r, r(%r13) */
+	}
+}
+
+/** Load AF, BC, DE and HL from jit_regs.
+ */
+static void
+emit_reload(void){
+	int r;
+
+	for(r = X86_AX; r <= X86_BX; ++r) {
+
+		emit2(0x66, 0x41); emit1(0x8b);
+		emit2(0x45 | ( r << 3 ), r * 2);	/* mov r(%r13), %r */
+	}
+}
+
+/** Add T-states to the cycle count.
+    @param[in] n T-states
+ */
+static void
+emit_cycles(int n){
+
+	if ( n == 0 )
+		return;
+	emit2(0x49, 0x81); emit2(0x04, 0x24);
+	emit4(n);				/* addq $n, (%r12) */
+}
+
+/** Length of the code emitted by emit_cycles().
+ */
+static int
+cycles_len(int n){
+
+	return ( n != 0 ) ? JIT_CYCLES_LEN : 0;
+}
+
+/** Return to jit_run() with the PC in %eax.
+ */
+static void
+emit_epilogue(void){
+
+	emit2(0x41, 0x5c);			/* pop %r12 */
+	emit2(0x41, 0x5e);			/* pop %r14 */
+	emit2(0x41, 0x5d);			/* pop %r13 */
+	emit1(0x5d);				/* pop %rbp */
+	emit1(0x5b);				/* pop %rbx */
+	emit1(0xc3);				/* ret */
+}
+
+/** Return to jit_run() with a constant PC.
+    @param[in] pc  the next Z80 PC
+    @param[in] cyc T-states to account for before leaving
+ */
+static void
+emit_exit(uint32_t pc, int cyc){
+
+	emit_cycles(cyc);
+	emit_spill();
+	emit1(0xb8); emit4(pc);			/* mov $pc, %eax */
+	emit_epilogue();
+}
+
+/** Return to jit_run() with the PC in %esi after a helper call, when
+    jit_regs is up to date.
+ */
+static void
+emit_exit_esi(void){
+
+	emit2(0x89, 0xf0);			/* mov %esi, %eax */
+	emit_epilogue();
+}
+
+/** Continue at a branch target.
+    @param[in] pc   the target Z80 PC
+    @param[in] cyc  T-states to account for before going there
+    @param[in] b    the block being translated
+    @param[in] body host address of the first instruction of the block
+ */
+static void
+emit_goto(uint32_t pc, int cyc, struct bb_block *b, BYTE *body){
+
+	if ( pc == b->start ) {
+
+		emit_cycles(cyc);
+		emit2(0x49, 0x8b); emit2(0x34, 0x24);	/* mov (%r12), %rsi */
+		emit2(0x49, 0x3b); emit2(0x75, JIT_OFF_DEADLINE);
+					/* cmp deadline(%r13), %rsi */
+		emit2(0x0f, 0x82);	/* jb body */
+		emit4((uint32_t)(body - (jit_p + 4)));
+		emit_exit(pc, 0);	/* the budget is spent */
+	} else
+		emit_exit(pc, cyc);
+}
+
+/** Length of the code emitted by emit_goto().
+ */
+static int
+goto_len(uint32_t pc, int cyc, struct bb_block *b){
+
+	if ( pc == b->start )
+		return cycles_len(cyc) + JIT_LOOP_LEN + JIT_EXIT_LEN;
+	return cycles_len(cyc) + JIT_EXIT_LEN;
+}
+
+/** Call the helper of an op-code.
+    @param[in] ins  pre-decoded instruction
+    @param[in] last 1 if the instruction is the last one of the block
+ */
+static void
+emit_helper(const struct bb_insn *ins, int last){
+	int op;
+
+	op = ins->op;
+	emit_cycles(jit_pending);
+	jit_pending = 0;
+	emit_spill();
+	emit2(0x4c, 0x89); emit1(0xef);		/* mov %r13, %rdi */
+	emit1(0xbe); emit4(ins->addr + 1);	/* mov $pc, %esi */
+	emit2(0x48, 0xba);			/* movabs $ins, %rdx */
+	emit8((uint64_t)(uintptr_t)ins);
+	emit2(0x48, 0xb8);			/* movabs $helper, %rax */
+	emit8((uint64_t)(uintptr_t)jit_optab[op]);
+	emit2(0xff, 0xd0);			/* call *%rax */
+	emit2(0x89, 0xc6);			/* mov %eax, %esi */
+	if ( last ) {
+
+		emit_exit_esi();
+		return;
+	}
+
+	/* leave the block if the helper threw it away */
+	emit2(0x41, 0x80); emit1(0x7d);
+	emit2(JIT_OFF_STALE, 0x00);		/* cmpb $0, stale(%r13) */
+	emit2(0x74, 2 + JIT_EPILOGUE_LEN);	/* je 1f */
+	emit_exit_esi();			/* 1: */
+	emit_reload();
+	if ( op == 0xcb || op == 0xdd || op == 0xed || op == 0xfd ) {
+
+		/* prefixed op-codes may move PC anywhere */
+		emit2(0x81, 0xfe); emit4(ins->next);	/* cmp $next, %esi */
+		emit2(0x74, 2 + JIT_EPILOGUE_LEN);	/* je 1f */
+		emit_exit_esi();			/* 1: */
+	}
+}
+
+/** Build F in %al from the host flags of an 8 bit arithmetic operation.
+    The host keeps SF ZF AF CF where the Z80 keeps S Z H C, and OF for V;
+    the undocumented bits 5 and 3 are taken from %edi.
+    @param[in] set flags to set (N)
+ */
+static void
+emit_flags(int set){
+
+	emit1(0x9c);				/* pushf */
+	emit1(0x5e);				/* pop %rsi */
+	emit1(0x41); emit2(0x89, 0xf0);		/* mov %esi, %r8d */
+	emit1(0x41); emit2(0xc1, 0xe8); emit1(9);	/* shr $9, %r8d (OF) */
+	emit1(0x41); emit2(0x83, 0xe0); emit1(FLAG_P);	/* and $V, %r8d */
+	emit2(0x81, 0xe6); emit4(FLAG_S|FLAG_Z|FLAG_H|FLAG_C);
+						/* and $SZHC, %esi */
+	emit1(0x44); emit2(0x09, 0xc6);		/* or %r8d, %esi */
+	emit2(0x83, 0xe7); emit1(0x28);		/* and $0x28, %edi */
+	emit2(0x09, 0xfe);			/* or %edi, %esi */
+	if ( set ) {
+
+		emit2(0x83, 0xce); emit1(set);	/* or $set, %esi */
+	}
+	emit1(0x25); emit4(0xff00);		/* and $A, %eax */
+	emit2(0x09, 0xf0);			/* or %esi, %eax */
+}
+
+/** Replace F, but C if requested, with an entry of a flag table.
+    @param[in] r     host register holding the result
+    @param[in] tab   offset of the table in jit_ftab
+    @param[in] set   flags to set (H)
+    @param[in] keepc 1 to keep C of the old F
+ */
+static void
+emit_ftab(int r, int tab, int set, int keepc){
+
+	emit2(0x0f, 0xb6); emit1(0xf8 | r);	/* movzbl %r, %edi */
+	emit2(0x41, 0x0f); emit2(0xb6, 0xb4); emit1(0x3e);
+	emit4(tab);				/* movzbl tab(%r14,%rdi), %esi */
+	if ( set ) {
+
+		emit2(0x83, 0xce); emit1(set);	/* or $set, %esi */
+	}
+	emit1(0x25); emit4(keepc ? 0xff00|FLAG_C : 0xff00);
+						/* and $A(|C), %eax */
+	emit2(0x09, 0xf0);			/* or %esi, %eax */
+}
+
+/** Translate an 8 bit arithmetic or logical operation on A.
+    @param[in] k     ADD, ADC, SUB, SBC, AND, XOR, OR, CP
+    @param[in] src   host register of the operand, -1 for an immediate
+    @param[in] imm   immediate operand
+    @param[in] fdead 1 if the flags are never read
+ */
+static void
+emit_alu(int k, int src, int imm, int fdead){
+	int arith;
+
+	arith = ( k < 4 ) || ( k == 7 );
+	if ( ( k == 1 ) || ( k == 3 ) ) {
+
+		emit2(0x0f, 0xba); emit2(0xe0, 0x00);	/* bt $0, %eax (CF = C) */
+	}
+	if ( src >= 0 ) {
+
+		emit1(jit_alu_rm[k]); emit1(0xc0 | ( src << 3 ) | X86_AH);
+						/* op %src, %ah */
+	} else {
+
+		emit1(0x80); emit1(0xc0 | ( jit_alu_ext[k] << 3 ) | X86_AH);
+		emit1(imm);			/* op $imm, %ah */
+	}
+
+	if ( fdead )
+		return;
+	if ( !arith ) {
+
+		emit_ftab(X86_AH, JIT_FTAB_SZP, ( k == 4 ) ? FLAG_H : 0, 0);
+		return;
+	}
+
+	/* bits 5 and 3 come from the result, or from the operand of CP */
+	if ( k == 7 && src < 0 ) {
+
+		emit1(0xbf); emit4(imm);	/* mov $imm, %edi */
+	} else {
+
+		emit2(0x0f, 0xb6);
+		emit1(0xf8 | ( ( k == 7 ) ? src : X86_AH ));
+					/* movzbl %r, %edi (flags unchanged) */
+	}
+	/* CP leaves A alone, so does the host */
+	emit_flags(( ( k == 2 ) || ( k == 3 ) || ( k == 7 ) ) ? FLAG_N : 0);
+}
+
+/** Translate INC r or DEC r.
+    @param[in] dec   1 for DEC
+    @param[in] r     host register
+    @param[in] fdead 1 if the flags are never read
+ */
+static void
+emit_incdec(int dec, int r, int fdead){
+
+	emit2(0xfe, ( dec ? 0xc8 : 0xc0 ) | r);		/* inc/dec %r */
+	if ( !fdead )
+		emit_ftab(r, ( dec ? JIT_FTAB_DEC : JIT_FTAB_INC ), 0, 1);
+}
+
+/** Translate ADD HL,ss.
+    @param[in] r     host register of ss
+    @param[in] fdead 1 if the flags are never read
+ */
+static void
+emit_addhl(int r, int fdead){
+
+	if ( fdead ) {
+
+		emit2(0x66, 0x01); emit1(0xc3 | ( r << 3 ));
+						/* add %r, %bx */
+		return;
+	}
+	emit2(0x0f, 0xb7); emit1(0xfb);		/* movzwl %bx, %edi */
+	emit2(0x31, 0xc7 | ( r << 3 ));		/* xor %r, %edi */
+	emit2(0x66, 0x01); emit1(0xc3 | ( r << 3 ));	/* add %r, %bx */
+	emit2(0x19, 0xf6);			/* sbb %esi, %esi */
+	emit2(0x83, 0xe6); emit1(FLAG_C);	/* and $C, %esi */
+	emit2(0x31, 0xdf);			/* xor %ebx, %edi */
+	emit2(0xc1, 0xef); emit1(8);		/* shr $8, %edi */
+	emit2(0x83, 0xe7); emit1(FLAG_H);	/* and $H, %edi */
+	emit2(0x09, 0xfe);			/* or %edi, %esi */
+	emit2(0x0f, 0xb6); emit1(0xff);		/* movzbl %bh, %edi */
+	emit2(0x83, 0xe7); emit1(0x28);		/* and $0x28, %edi */
+	emit2(0x09, 0xfe);			/* or %edi, %esi */
+	emit1(0x25); emit4(0xff00|FLAG_S|FLAG_Z|FLAG_P);
+						/* and $A|SZP, %eax */
+	emit2(0x09, 0xf0);			/* or %esi, %eax */
+}
+
+/** Load an 8 bit register from the memory pointed by a register pair.
+    @param[in] dst host register to load
+    @param[in] rp  host register of the pair
+ */
+static void
+emit_load(int dst, int rp){
+
+	emit2(0x0f, 0xb7); emit1(0xf8 | rp);	/* movzwl %rp, %edi */
+	emit2(0x8a, 0x44 | ( dst << 3 )); emit2(0x3d, 0x00);
+						/* mov (%rbp,%rdi), %dst */
+}
+
+/** Translate a conditional branch.
+    @param[in] cc     condition code (NZ, Z, NC, C, PO, PE, P, M)
+    @param[in] target branch target
+    @param[in] next   address of the next instruction
+    @param[in] taken  T-states added when the branch is taken
+ */
+static void
+emit_branch(int cc, uint32_t target, uint32_t next, int taken,
+    struct bb_block *b, BYTE *body){
+
+	emit2(0xa8, jit_ccflag[cc]);		/* test $flag, %al */
+	emit1( ( cc & 1 ) ? 0x74 : 0x75 );	/* skip if not taken */
+	emit1(goto_len(target, jit_pending + taken, b));
+	emit_goto(target, jit_pending + taken, b, body);
+	emit_exit(next, jit_pending);
+}
+
+/** Determine the flags an instruction reads and writes, if it is
+    expanded inline.
+    @param[in]  ins    pre-decoded instruction
+    @param[out] writes flags replaced by the instruction
+    @return flags read by the instruction (all for helpers)
+ */
+static int
+insn_flags(const struct bb_insn *ins, int *writes){
+	int op, k;
+
+	op = ins->op;
+	*writes = 0;
+	if ( ( ( op & 0xc0 ) == 0x80 && ( op & 7 ) != 6 )
+	    || ( op & 0xc7 ) == 0xc6 ) {		/* ALU A,r / ALU A,nn */
+
+		*writes = 0xff;
+		k = ( op >> 3 ) & 7;
+		return ( ( k == 1 ) || ( k == 3 ) ) ? FLAG_C : 0;	/* ADC, SBC */
+	}
+	if ( ( op & 0xc6 ) == 0x04 && ( op & 0x38 ) != 0x30 ) {
+						/* INC r, DEC r */
+		*writes = 0xff & ~FLAG_C;
+		return 0;
+	}
+	if ( ( op & 0xcf ) == 0x09 && op != 0x39 ) {	/* ADD HL,ss */
+
+		*writes = 0x28 | FLAG_H | FLAG_N | FLAG_C;
+		return 0;
+	}
+	if ( ( ( op & 0xc0 ) == 0x40 && op != 0x76 )	/* LD r,r', LD r,(HL) */
+	    || ( ( op & 0xc7 ) == 0x06 && op != 0x36 )	/* LD r,nn */
+	    || ( op & 0xcf ) == 0x01			/* LD dd,nnnn */
+	    || ( op & 0xc7 ) == 0x03 )			/* INC dd, DEC dd */
+		return 0;
+	switch( op ) {
+
+	case 0x00: case 0x0a: case 0x1a: case 0x3a:	/* NOP, LD A,(rr) */
+	case 0x2a: case 0xeb: case 0x10:		/* LD HL,(nn), EX, DJNZ */
+		return 0;
+	default:
+		break;
+	}
+	return 0xff;
+}
+
+/** Translate an instruction.
+    @param[in] ins   pre-decoded instruction
+    @param[in] last  1 if the instruction is the last one of the block
+    @param[in] fdead 1 if the flags written by the instruction are never read
+ */
+static void
+emit_insn(const struct bb_insn *ins, int last, int fdead, struct bb_block *b,
+    BYTE *body){
+	int op, dst, src, r;
+
+	op = ins->op;
+	jit_pending += z80_cc_op[op];	/* taken back for a helper */
+
+	if ( ( op & 0xc0 ) == 0x40 && op != 0x76 ) {	/* LD r,r' */
+
+		dst = jit_reg8[(op >> 3) & 7];
+		src = jit_reg8[op & 7];
+		if ( dst >= 0 && src >= 0 ) {
+
+			if ( dst != src )
+				emit2(0x88, 0xc0 | ( src << 3 ) | dst);
+						/* mov %src, %dst */
+			goto fall_through;
+		}
+	}
+	if ( ( op & 0xc7 ) == 0x06 && op != 0x36 ) {	/* LD r,nn */
+
+		emit2(0xb0 | jit_reg8[(op >> 3) & 7], ins->imm);
+						/* mov $nn, %r */
+		goto fall_through;
+	}
+	if ( ( op & 0xc0 ) == 0x80 && ( op & 7 ) != 6 ) {	/* ALU A,r */
+
+		emit_alu((op >> 3) & 7, jit_reg8[op & 7], 0, fdead);
+		goto fall_through;
+	}
+	if ( ( op & 0xc7 ) == 0xc6 ) {			/* ALU A,nn */
+
+		emit_alu((op >> 3) & 7, -1, ins->imm, fdead);
+		goto fall_through;
+	}
+	if ( ( op & 0xc6 ) == 0x04 && ( op & 0x38 ) != 0x30 ) {
+						/* INC r, DEC r */
+		emit_incdec(op & 1, jit_reg8[(op >> 3) & 7], fdead);
+		goto fall_through;
+	}
+	if ( ( op & 0xcf ) == 0x01 ) {			/* LD dd,nnnn */
+
+		r = jit_reg16[(op >> 4) & 3];
+		emit1(0x66);
+		if ( r >= 0 )
+			emit1(0xb8 | r);	/* mov $nnnn, %r */
+		else {
+
+			emit2(0x41, 0xc7); emit2(0x45, JIT_OFF_SP);
+						/* movw $nnnn, SP(%r13) */
+		}
+		emit2(ins->imm & 0xff, ins->imm >> 8);
+		goto fall_through;
+	}
+	if ( ( op & 0xc7 ) == 0x03 ) {			/* INC dd, DEC dd */
+
+		r = jit_reg16[(op >> 4) & 3];
+		emit1(0x66);
+		if ( r >= 0 )
+			emit2(0xff, ( ( op & 0x08 ) ? 0xc8 : 0xc0 ) | r);
+						/* inc/dec %r */
+		else {
+
+			emit2(0x41, 0xff);
+			emit2(( op & 0x08 ) ? 0x4d : 0x45, JIT_OFF_SP);
+						/* incw/decw SP(%r13) */
+		}
+		goto fall_through;
+	}
+
+	if ( ( op & 0xc7 ) == 0x46 && op != 0x76 ) {	/* LD r,(HL) */
+
+		emit_load(jit_reg8[(op >> 3) & 7], X86_BX);
+		goto fall_through;
+	}
+	if ( ( op & 0xcf ) == 0x09 && op != 0x39 ) {	/* ADD HL,ss */
+
+		emit_addhl(jit_reg16[(op >> 4) & 3], fdead);
+		goto fall_through;
+	}
+
+	switch( op ) {
+
+	case 0x00:				/* NOP */
+		goto fall_through;
+	case 0x0a:				/* LD A,(BC) */
+		emit_load(X86_AH, X86_CX);
+		goto fall_through;
+	case 0x1a:				/* LD A,(DE) */
+		emit_load(X86_AH, X86_DX);
+		goto fall_through;
+	case 0x3a:				/* LD A,(nnnn) */
+		emit2(0x8a, 0xa5); emit4(ins->imm);	/* mov nnnn(%rbp), %ah */
+		goto fall_through;
+	case 0x2a:				/* LD HL,(nnnn) */
+		if ( ins->imm == 0xffff )
+			break;			/* wraps around */
+		/* byte loads forward from the byte stores of PutBYTE() */
+		emit2(0x8a, 0x9d); emit4(ins->imm);	/* mov nnnn(%rbp), %bl */
+		emit2(0x8a, 0xbd); emit4(ins->imm + 1);
+						/* mov nnnn+1(%rbp), %bh */
+		goto fall_through;
+	case 0xeb:				/* EX DE,HL */
+		emit2(0x66, 0x87); emit1(0xd3);	/* xchg %dx, %bx */
+		goto fall_through;
+	case 0x10:				/* DJNZ dd */
+		emit2(0xfe, 0xc8 | jit_reg8[0]);	/* dec %ch */
+		emit1(0x74);			/* jz 1f */
+		emit1(goto_len(ins->target, jit_pending + 5, b));
+		emit_goto(ins->target, jit_pending + 5, b, body);
+		emit_exit(ins->next, jit_pending);	/* 1: */
+		return;
+	case 0x18:				/* JR dd */
+		emit_goto(ins->target, jit_pending, b, body);
+		return;
+	case 0x20: case 0x28: case 0x30: case 0x38:	/* JR cc,dd */
+		emit_branch((op >> 3) & 3, ins->target, ins->next, 5, b, body);
+		return;
+	case 0xc3:				/* JP nnnn */
+		emit_goto(ins->imm, jit_pending, b, body);
+		return;
+	case 0xc2: case 0xca: case 0xd2: case 0xda:	/* JP cc,nnnn */
+	case 0xe2: case 0xea: case 0xf2: case 0xfa:
+		emit_branch((op >> 3) & 7, ins->imm, ins->next, 0, b, body);
+		return;
+	case 0x76:				/* HALT: back to trap() */
+		emit_exit(( ( ins->addr + 1 ) & 0xffff ) | JIT_HALT,
+		    jit_pending);
+		return;
+	default:
+		break;
+	}
+
+	/* everything else runs the interpreter's code, which counts
+	   its own T-states */
+	jit_pending -= z80_cc_op[op];
+	emit_helper(ins, last);
+	return;
+
+fall_through:
+	if ( last )
+		emit_exit(ins->next, jit_pending);
+}
+
+/** Translate a block.
+    @param[in] cpu the machine
+    @param[in] b   the block
+    @retval NULL the arena is full
+    @return the host code
+ */
+static jit_code
+jit_translate(struct z80_cpu *cpu, struct bb_block *b){
+	BYTE *start, *body, *lo, *hi;
+	BYTE  fdead[BB_MAX_INSNS];
+	int   i, live, reads, writes;
+	uintptr_t page;
+
+	if ( cpu->jit.used + JIT_BLOCK_MAX > JIT_ARENA_SIZE ) {
+
+		bb_flush(cpu);		/* also resets the arena */
+		return NULL;
+	}
+
+	start = jit_p = cpu->jit.arena + cpu->jit.used;
+
+	/* the pages the block may go in */
+	page = (uintptr_t)sysconf(_SC_PAGESIZE);
+	lo = (BYTE *)( (uintptr_t)start & ~( page - 1 ) );
+	hi = (BYTE *)( ( (uintptr_t)start + JIT_BLOCK_MAX + page - 1 ) &
+	    ~( page - 1 ) );
+	if ( hi > cpu->jit.arena + JIT_ARENA_SIZE )
+		hi = cpu->jit.arena + JIT_ARENA_SIZE;
+	if ( mprotect(lo, (size_t)( hi - lo ), PROT_READ|PROT_WRITE) != 0 )
+		return NULL;
+
+	emit1(0x53);				/* push %rbx */
+	emit1(0x55);				/* push %rbp */
+	emit2(0x41, 0x55);			/* push %r13 */
+	emit2(0x41, 0x56);			/* push %r14 */
+	emit2(0x41, 0x54);			/* push %r12 */
+	emit2(0x49, 0x89); emit1(0xfd);		/* mov %rdi, %r13 */
+	emit2(0x49, 0x8d); emit1(0xad);		/* lea ram(%r13), %rbp */
+	emit4(JIT_OFF_RAM);
+	emit2(0x49, 0xbe);			/* movabs $jit_ftab, %r14 */
+	emit8((uint64_t)(uintptr_t)&jit_ftab);
+	emit2(0x4d, 0x8d); emit1(0xa5);		/* lea cycles(%r13), %r12 */
+	emit4((uint32_t)JIT_OFF_CYCLES);
+	emit_reload();
+	body = jit_p;
+	jit_pending = 0;
+
+	/* the flags are live when the block leaves */
+	for(i = b->ninsn - 1, live = 0xff; i >= 0; --i) {
+
+		reads = insn_flags(&b->insn[i], &writes);
+		fdead[i] = ( writes != 0 ) && ( ( writes & live ) == 0 );
+		live = ( live & ~writes ) | reads;
+	}
+
+	for(i = 0; i < b->ninsn; ++i)
+		emit_insn(&b->insn[i], ( i == b->ninsn - 1 ), fdead[i], b, body);
+
+	if ( mprotect(lo, (size_t)( hi - lo ), PROT_READ|PROT_EXEC) != 0 )
+		return NULL;	/* left to the interpreter */
+
+	cpu->jit.used = (size_t)(jit_p - cpu->jit.arena);
+	b->native = start;
+
+	return (jit_code)start;
+}
+
+/** Fill the flag tables shared by all machines.
+ */
+static void
+jit_ftab_init(void){
+	int i, p, b;
+
+	for(i = 0; i < 256; ++i) {
+
+		for(p = 0, b = i; b != 0; b >>= 1)
+			p ^= b & 1;
+		jit_ftab.szp[i] = ( i & 0xa8 ) | ( ( i == 0 ) << 6 ) |
+		    ( p ? 0 : FLAG_P );
+		jit_ftab.inc[i] = ( i & 0xa8 ) | ( ( i == 0 ) << 6 ) |
+		    ( ( ( i & 0xf ) == 0 ) << 4 ) | ( ( i == 0x80 ) << 2 );
+		jit_ftab.dec[i] = ( i & 0xa8 ) | ( ( i == 0 ) << 6 ) |
+		    ( ( ( i & 0xf ) == 0xf ) << 4 ) | ( ( i == 0x7f ) << 2 ) |
+		    FLAG_N;
+	}
+}
+
+/** Allocate the code arena of a machine.
+    @param[in] cpu the machine
+    @retval 0 success
+    @retval -1 mmap failed
+ */
+int
+jit_init(struct z80_cpu *cpu){
+#ifdef OPT_BATCH
+	static pthread_once_t ftab_once = PTHREAD_ONCE_INIT;
+
+	pthread_once(&ftab_once, jit_ftab_init);  /* machines of a batch run */
+#else
+	jit_ftab_init();
+#endif
+
+	if ( cpu->bb == NULL )
+		return -1;	/* nothing to translate */
+
+	cpu->jit.arena = mmap(NULL, JIT_ARENA_SIZE,
+	    PROT_READ|PROT_EXEC, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if ( cpu->jit.arena == MAP_FAILED ) {
+
+		cpu->jit.arena = NULL;
+		return -1;
+	}
+	cpu->jit.used = 0;
+
+	return 0;
+}
+
+/** Release the code arena of a machine.
+    @param[in] cpu the machine
+ */
+void
+jit_free(struct z80_cpu *cpu){
+
+	if ( cpu->jit.arena != NULL )
+		munmap(cpu->jit.arena, JIT_ARENA_SIZE);
+	cpu->jit.arena = NULL;
+	cpu->jit.used = 0;
+}
+
+/** Throw away all translated code.
+    @param[in] cpu the machine
+ */
+void
+jit_flush(struct z80_cpu *cpu){
+
+	cpu->jit.used = 0;
+}
+
+/** Run translated code.
+    @param[in] cpu      the machine
+    @param[in] pc       Z80 address
+    @param[in] deadline value of the cycle count to stop at
+    @return the PC of the first untranslated instruction or of the
+            instruction to continue at, or the PC after HALT with
+            JIT_HALT set
+ */
+FASTWORK
+jit_run(struct z80_cpu *cpu, FASTREG pc, unsigned long long deadline){
+	struct bb_block *b;
+	jit_code         code;
+
+	cpu->jit.deadline = deadline;
+	for(;;) {
+
+#ifdef DEBUG
+		if ( stopsim )
+			return pc & 0xffff;
+#endif
+		if ( cpu->cycles >= cpu->jit.deadline )	/* helpers may cut it */
+			return pc & 0xffff;
+		b = cpu->bb->map[pc & 0xffff];
+		if ( b == NULL )
+			return pc & 0xffff;
+		code = (jit_code)b->native;
+		if ( ( code == NULL )
+		    && ( ( code = jit_translate(cpu, b) ) == NULL ) )
+			return pc & 0xffff;
+
+		cpu->jit.stale = 0;
+		pc = code(&cpu->jit);
+		if ( pc & JIT_HALT )
+			return pc;
+	}
+}
+
+#else  /*  !OPT_JIT  */
+
+int
+jit_init(struct z80_cpu *cpu){
+
+	return -1;
+}
+
+void
+jit_free(struct z80_cpu *cpu){
+}
+
+void
+jit_flush(struct z80_cpu *cpu){
+}
+
+FASTWORK
+jit_run(struct z80_cpu *cpu, FASTREG pc, unsigned long long deadline){
+
+	return pc & 0xffff;
+}
+
+#endif  /*  OPT_JIT  */
@@ -0,0 +1,48 @@
+/*
+   SWORD Emurator  I/O ports
+
+   Each machine has a table of the handlers of its 256 I/O ports.
+   IN and OUT look the port up inline (see port_in() in simz80.h), so
+   a port without handlers costs a load and a test.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include "simz80.h"
+#include "port.h"
+
+/** Handle an I/O port.
+    @param[in] cpu  the machine
+    @param[in] port the port
+    @param[in] in   the function to call on IN, NULL to read 0
+    @param[in] out  the function to call on OUT, NULL to ignore writes
+    @param[in] arg  argument of in and out
+    @retval  0 success
+    @retval -1 the port has handlers already
+ */
+int
+port_add(struct z80_cpu *cpu, BYTE port, port_in_fn in, port_out_fn out,
+    void *arg){
+	struct port *p = &cpu->port[port];
+
+	if ( p->in != NULL || p->out != NULL )
+		return -1;
+	p->in = in;
+	p->out = out;
+	p->arg = arg;
+	return 0;
+}
+
+/** Remove the handlers of an I/O port.
+    @param[in] cpu  the machine
+    @param[in] port the port
+ */
+void
+port_del(struct z80_cpu *cpu, BYTE port){
+	struct port *p = &cpu->port[port];
+
+	p->in = NULL;
+	p->out = NULL;
+	p->arg = NULL;
+}
@@ -0,0 +1,332 @@
+/*
+   SWORD Emurator  execution profiler
+
+   While a machine is profiled, simz80_run() interprets every
+   instruction and calls prof_insn() before it runs; the cached blocks
+   and the translated code are left alone.  The T-states of an
+   instruction are known when the next one is counted, and charged to
+   its address and to the function on top of the call stack.
+
+   The call stack follows the CALL, RST and RET instructions which are
+   taken, which is seen from the stack pointer.  A RET goes back to the
+   call whose return address it jumps to; a RET which matches no call
+   (a computed jump through the stack) leaves the stack alone.
+
+   prof_write() writes the profile in the callgrind format, which
+   KCachegrind and the like read, or as folded stacks, one line per call
+   stack, for flame graph tools.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simz80.h"
+#include "disasm.h"
+#include "prof.h"
+
+/** Find or add the node of a function called from another one.
+    @param[in] p      the profile
+    @param[in] parent the caller
+    @param[in] func   entry address of the callee
+    @return the node, PROF_NONE if out of memory
+ */
+static int
+prof_node(struct prof *p, int parent, WORD func){
+	struct prof_node *n;
+	int i;
+
+	if ( parent != PROF_NONE ) {
+
+		for(i = p->node[parent].child; i != PROF_NONE;
+		    i = p->node[i].sibling) {
+
+			if ( p->node[i].func == func )
+				return i;
+		}
+	}
+
+	if ( p->nnodes == p->maxnodes ) {
+
+		n = realloc(p->node, sizeof(*n) * ( p->maxnodes * 2 ));
+		if ( n == NULL )
+			return PROF_NONE;
+		p->node = n;
+		p->maxnodes *= 2;
+	}
+
+	i = p->nnodes++;
+	n = &p->node[i];
+	memset(n, 0, sizeof(*n));
+	n->func = func;
+	n->parent = parent;
+	n->child = PROF_NONE;
+	n->sibling = PROF_NONE;
+	if ( parent != PROF_NONE ) {
+
+		n->sibling = p->node[parent].child;
+		p->node[parent].child = i;
+	}
+	return i;
+}
+
+/** Start profiling a machine.
+    @param[in] cpu the machine
+    @retval 0 success
+    @retval -1 out of memory, or the profiler is not compiled in
+ */
+int
+prof_start(struct z80_cpu *cpu){
+#ifdef OPT_PROFILE
+	struct prof *p;
+	int i;
+
+	if ( cpu->prof != NULL )
+		return 0;
+
+	p = calloc(1, sizeof(struct prof));
+	if ( p == NULL )
+		return -1;
+	p->maxnodes = 256;
+	p->node = malloc(sizeof(struct prof_node) * p->maxnodes);
+	if ( p->node == NULL ) {
+
+		free(p);
+		return -1;
+	}
+	for(i = 0; i < 64*1024; ++i)
+		p->func[i] = PROF_NONE;
+	cpu->prof = p;
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/** Stop profiling a machine and throw the profile away.
+    @param[in] cpu the machine
+ */
+void
+prof_stop(struct z80_cpu *cpu){
+
+	if ( cpu->prof == NULL )
+		return;
+	free(cpu->prof->node);
+	free(cpu->prof);
+	cpu->prof = NULL;
+}
+
+/** Follow a CALL or a RET which has been taken.
+    @param[in] p  the profile
+    @param[in] pc where it went
+    @param[in] sp the stack pointer after it
+ */
+static void
+prof_call_ret(struct prof *p, WORD pc, WORD sp){
+	int op = p->op;
+	int n, d;
+
+	if ( ( op == 0xcd || ( op & 0xc7 ) == 0xc4 || ( op & 0xc7 ) == 0xc7 )
+	    && sp == (WORD)( p->sp - 2 ) ) {
+
+		/* CALL, CALL cc, RST */
+		if ( p->depth + 1 >= PROF_DEPTH )
+			return;		/* charged to the caller */
+		n = prof_node(p, p->stack[p->depth], pc);
+		if ( n == PROF_NONE )
+			return;
+		p->node[n].calls++;
+		p->node[n].site = p->pc;
+		p->stack[++p->depth] = n;
+		p->ret[p->depth] = p->pc + ( ( ( op & 0xc7 ) == 0xc7 ) ? 1 : 3 );
+		return;
+	}
+
+	if ( ( op == 0xc9 || ( op & 0xc7 ) == 0xc0
+		|| ( op == 0xed && ( p->op2 & 0xc7 ) == 0x45 ) )
+	    && sp == (WORD)( p->sp + 2 ) ) {
+
+		/* RET, RET cc, RETN, RETI */
+		for(d = p->depth; d > 0; --d) {
+
+			if ( p->ret[d] == pc ) {
+
+				p->depth = d - 1;
+				break;
+			}
+		}
+	}
+}
+
+/** Count an instruction which is about to run, and charge the T-states
+    of the previous one.
+    @param[in] cpu the machine
+    @param[in] pc  address of the instruction
+    @param[in] sp  the stack pointer
+    @param[in] cyc the cycle count
+ */
+void
+prof_insn(struct z80_cpu *cpu, WORD pc, WORD sp, unsigned long long cyc){
+	struct prof *p = cpu->prof;
+	struct prof_node *n;
+
+	if ( p->started ) {
+
+		n = &p->node[p->stack[p->depth]];
+		n->cycles += cyc - p->cyc;
+		n->insns++;
+		p->cycles[p->pc] += cyc - p->cyc;
+		if ( sp != p->sp )
+			prof_call_ret(p, pc, sp);
+	} else {
+
+		p->stack[0] = prof_node(p, PROF_NONE, pc);	/* the root */
+		p->depth = 0;
+		p->started = 1;
+	}
+
+	p->count[pc]++;
+	p->pc = pc;
+	p->sp = sp;
+	p->op = RAM(pc);
+	p->op2 = RAM(pc + 1);
+	p->ops[p->op]++;
+	p->func[pc] = p->node[p->stack[p->depth]].func;
+	p->cyc = cyc;
+}
+
+/** Write the call stacks as folded stacks.
+    @param[in] p  the profile
+    @param[in] fp the file
+ */
+static void
+prof_write_folded(const struct prof *p, FILE *fp){
+	int path[PROF_DEPTH];
+	int i, j, d;
+
+	for(i = 0; i < p->nnodes; ++i) {
+
+		if ( p->node[i].cycles == 0 )
+			continue;
+		for(d = 0, j = i; j != PROF_NONE && d < PROF_DEPTH;
+		    j = p->node[j].parent)
+			path[d++] = j;
+		while( d-- > 0 )
+			fprintf(fp, "%04X%s", p->node[path[d]].func,
+			    ( d > 0 ) ? ";" : "");
+		fprintf(fp, " %llu\n", p->node[i].cycles);
+	}
+}
+
+/** Write the profile in the callgrind format.
+    @param[in] cpu the machine, whose memory is disassembled
+    @param[in] p   the profile
+    @param[in] fp  the file
+    @retval 0 success
+    @retval -1 out of memory
+ */
+static int
+prof_write_callgrind(struct z80_cpu *cpu, const struct prof *p, FILE *fp){
+	unsigned long long *cycles, *insns;
+	const struct prof_node *n;
+	char insn[DISASM_BUFSIZ];
+	int i, func;
+
+	/* inclusive costs; a callee is always added after its caller */
+	cycles = malloc(sizeof(*cycles) * p->nnodes);
+	insns = malloc(sizeof(*insns) * p->nnodes);
+	if ( cycles == NULL || insns == NULL ) {
+
+		free(cycles);
+		free(insns);
+		return -1;
+	}
+	for(i = 0; i < p->nnodes; ++i) {
+
+		cycles[i] = p->node[i].cycles;
+		insns[i] = p->node[i].insns;
+	}
+	for(i = p->nnodes - 1; i > 0; --i) {
+
+		cycles[p->node[i].parent] += cycles[i];
+		insns[p->node[i].parent] += insns[i];
+	}
+
+	fprintf(fp, "# callgrind format\n");
+	fprintf(fp, "version: 1\n");
+	fprintf(fp, "creator: sos\n");
+	fprintf(fp, "positions: instr\n");
+	fprintf(fp, "events: Cycles Instructions\n");
+	fprintf(fp, "# executions of each op-code\n");
+	for(i = 0; i < 256; ++i)
+		if ( p->ops[i] != 0 )
+			fprintf(fp, "# op %02x %llu\n", i, p->ops[i]);
+
+	/* the cost of each address, in the function it ran in last,
+	   after the instruction there as a comment */
+	fprintf(fp, "\nfl=z80\n");
+	func = PROF_NONE;
+	for(i = 0; i < 64*1024; ++i) {
+
+		if ( p->count[i] == 0 )
+			continue;
+		if ( p->func[i] != func ) {
+
+			func = p->func[i];
+			fprintf(fp, "fn=0x%04x\n", func);
+		}
+		(void)disasm_ram(cpu, i, insn, sizeof(insn));
+		fprintf(fp, "# %s\n", insn);
+		fprintf(fp, "0x%04x %llu %llu\n", i, p->cycles[i], p->count[i]);
+	}
+
+	/* the calls of every call stack */
+	for(i = 1; i < p->nnodes; ++i) {
+
+		n = &p->node[i];
+		fprintf(fp, "fn=0x%04x\n", p->node[n->parent].func);
+		fprintf(fp, "cfn=0x%04x\n", n->func);
+		fprintf(fp, "calls=%llu 0x%04x\n", n->calls, n->func);
+		fprintf(fp, "0x%04x %llu %llu\n", n->site, cycles[i], insns[i]);
+	}
+
+	free(cycles);
+	free(insns);
+	return 0;
+}
+
+/** Write the profile of a machine.
+    @param[in] cpu  the machine
+    @param[in] name file name; folded stacks if it ends with ".folded",
+                    the callgrind format otherwise
+    @retval 0 success
+    @retval -1 the machine is not profiled, or the file can not be
+               written
+ */
+int
+prof_write(struct z80_cpu *cpu, const char *name){
+	const struct prof *p = cpu->prof;
+	size_t len, slen;
+	FILE *fp;
+	int rc;
+
+	if ( p == NULL || !p->started )
+		return -1;
+
+	fp = fopen(name, "w");
+	if ( fp == NULL )
+		return -1;
+
+	len = strlen(name);
+	slen = strlen(PROF_FOLDED);
+	rc = 0;
+	if ( len >= slen && strcmp(name + len - slen, PROF_FOLDED) == 0 )
+		prof_write_folded(p, fp);
+	else
+		rc = prof_write_callgrind(cpu, p, fp);
+
+	if ( fclose(fp) != 0 )
+		rc = -1;
+	return rc;
+}
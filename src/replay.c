@@ -0,0 +1,239 @@
+/*
+   SWORD Emurator  record and replay
+
+   Everything a session does follows from the machine, but for a few
+   inputs: the keys read from the terminal, and whether and when they
+   were typed.  While a session is recorded, each
+   of them is written to a log with its position, the T-states run
+   since the recording started; the count goes on the same way on every
+   run, in the interpreter and in the translated code alike.  While a
+   session is replayed, the inputs are taken from the log instead, so
+   that the run is the same as the recorded one without a terminal,
+   and as fast as the host goes.
+
+   A log is REPLAY_MAGIC and a byte of REPLAY_VERSION, then one record
+   per input:
+
+	kind		one byte, REPLAY_ZERO is set if the value is 0
+	position	T-states since the last record
+	value		if it is not 0
+
+   the numbers written 7 bits a byte, the lowest first, with the top
+   bit set on every byte but the last.  Only a press of the break key
+   is logged; #BRKEY reads no press where the log has none.
+
+   The replay must start from the same machine as the recording did:
+   the same dos file or snapshot and the same program.  If the
+   session asks for another input than the log has at that point, or
+   for one after the end of the log, the replay stops and the session
+   goes on with live input.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simz80.h"
+#include "screen.h"
+#include "replay.h"
+
+#define	REPLAY_ZERO	(0x80)		/* the value is 0 and not written */
+
+/** Write a number.
+    @param[in] fp the log
+    @param[in] n  the number
+ */
+static void
+replay_putnum(FILE *fp, unsigned long long n){
+
+	while( n >= 0x80 ) {
+
+		putc((int)( n & 0x7f ) | 0x80, fp);
+		n >>= 7;
+	}
+	putc((int)n, fp);
+}
+
+/** Read a number.
+    @param[in]  fp the log
+    @param[out] n  the number
+    @retval 0 success
+    @retval -1 end of the log
+ */
+static int
+replay_getnum(FILE *fp, unsigned long long *n){
+	int	c, shift;
+
+	*n = 0;
+	for(shift = 0; shift < 64; shift += 7) {
+
+		if ( ( c = getc(fp) ) == EOF )
+			return -1;
+		*n |= (unsigned long long)( c & 0x7f ) << shift;
+		if ( ( c & 0x80 ) == 0 )
+			return 0;
+	}
+	return -1;
+}
+
+/** Read the next record to replay; its kind is 0 at the end of the log.
+    @param[in] r the replay
+ */
+static void
+replay_next(struct replay *r){
+	unsigned long long delta, v = 0;
+	int	c;
+
+	r->kind = 0;
+	if ( ( c = getc(r->fp) ) == EOF || replay_getnum(r->fp, &delta) )
+		return;
+	if ( ( c & REPLAY_ZERO ) == 0 && replay_getnum(r->fp, &v) )
+		return;
+	r->kind = c & ~REPLAY_ZERO;
+	r->pos = r->last + delta;
+	r->last = r->pos;
+	r->value = (int)v;
+}
+
+/** Start recording or replaying a machine, from where it is.
+    @param[in] cpu  the machine
+    @param[in] file the log
+    @param[in] mode REPLAY_RECORD or REPLAY_PLAY
+    @retval 0 success
+    @retval -1 out of memory, or the log can not be opened or is not
+               a log of this version
+ */
+int
+replay_start(struct z80_cpu *cpu, const char *file, int mode){
+	struct replay *r;
+	char	magic[sizeof(REPLAY_MAGIC)];
+
+	(void)replay_stop(cpu);
+
+	r = calloc(1, sizeof(struct replay));
+	if ( r == NULL )
+		return -1;
+	r->file = strdup(file);
+	r->mode = mode;
+	r->base = cpu->cycles;
+	if ( r->file == NULL )
+		goto err_out;
+
+	if ( mode == REPLAY_RECORD ) {
+
+		r->fp = fopen(file, "wb");
+		if ( r->fp == NULL )
+			goto err_out;
+		fwrite(REPLAY_MAGIC, 1, sizeof(magic) - 1, r->fp);
+		putc(REPLAY_VERSION, r->fp);
+	} else {
+
+		r->fp = fopen(file, "rb");
+		if ( r->fp == NULL )
+			goto err_out;
+		if ( fread(magic, 1, sizeof(magic) - 1, r->fp)
+		    != sizeof(magic) - 1
+		    || memcmp(magic, REPLAY_MAGIC, sizeof(magic) - 1) != 0
+		    || getc(r->fp) != REPLAY_VERSION )
+			goto err_out;
+		replay_next(r);
+	}
+
+	cpu->replay = r;
+	return 0;
+
+err_out:
+	if ( r->fp != NULL )
+		fclose(r->fp);
+	free(r->file);
+	free(r);
+	return -1;
+}
+
+/** Stop recording or replaying a machine.
+    @param[in] cpu the machine
+    @retval 0 success
+    @retval -1 the log of a recording can not be written
+ */
+int
+replay_stop(struct z80_cpu *cpu){
+	struct replay *r = cpu->replay;
+	int	rc;
+
+	if ( r == NULL )
+		return 0;
+
+	rc = ( r->mode == REPLAY_RECORD && ferror(r->fp) ) ? -1 : 0;
+	if ( fclose(r->fp) != 0 && r->mode == REPLAY_RECORD )
+		rc = -1;
+	free(r->file);
+	free(r);
+	cpu->replay = NULL;
+	return rc;
+}
+
+/** Take an input of a replayed machine from the log.  The replay stops
+    at the end of the log, or if the log has another input there.
+    @param[in]  cpu  the machine
+    @param[in]  kind what is read, REPLAY_*
+    @param[in]  pos  T-states run by the machine
+    @param[out] v    the input
+    @retval 1 the input is replayed
+    @retval 0 the machine is not replayed, read the input as usual
+ */
+int
+replay_get(struct z80_cpu *cpu, int kind, unsigned long long pos, int *v){
+	struct replay *r = cpu->replay;
+	char	buf[80];
+
+	if ( r->mode != REPLAY_PLAY )
+		return 0;
+
+	pos -= r->base;
+	if ( r->kind == kind && r->pos == pos ) {
+
+		*v = r->value;
+		replay_next(r);
+		return 1;
+	}
+	if ( r->kind == 0 ) {
+
+		(void)replay_stop(cpu);		/* live from here */
+		return 0;
+	}
+	if ( kind == REPLAY_BRKEY && r->pos >= pos ) {
+
+		*v = 0;				/* not pressed */
+		return 1;
+	}
+
+	snprintf(buf, sizeof(buf), "replay: the session left <%s> after "
+	    "%llu T-states\r", r->file, pos);
+	(void)replay_stop(cpu);
+	scr_puts(buf);
+	return 0;
+}
+
+/** Log an input read for a recorded machine.
+    @param[in] cpu  the machine
+    @param[in] kind what was read, REPLAY_*
+    @param[in] pos  T-states run by the machine
+    @param[in] v    the input
+ */
+void
+replay_put(struct z80_cpu *cpu, int kind, unsigned long long pos, int v){
+	struct replay *r = cpu->replay;
+
+	if ( r->mode != REPLAY_RECORD )
+		return;
+	if ( kind == REPLAY_BRKEY && v == 0 )
+		return;
+
+	pos -= r->base;
+	putc(kind | ( ( v == 0 ) ? REPLAY_ZERO : 0 ), r->fp);
+	replay_putnum(r->fp, pos - r->last);
+	if ( v != 0 )
+		replay_putnum(r->fp, (unsigned int)v);
+	r->last = pos;
+}
@@ -0,0 +1,258 @@
+/*
+   SWORD Emurator  event scheduler and maskable interrupts
+
+   Host devices add events at a value of the cycle count, and raise
+   interrupt request lines.  The main loop passes the cycle budget of
+   simz80_run() through sched_budget(), so that the run stops when the
+   next event is due, and calls sched_run() between the runs.  The
+   interpreter itself only looks at the scheduler after EI, RETI, RETN
+   and IN/OUT, the places where an interrupt may become acceptable or
+   a device may have changed the schedule; so the scheduler costs
+   nothing while no event is pending.  A run stopped right after EI
+   does not accept the interrupt: the Z80 runs the instruction after
+   EI first, so the next run is given one T-state to do it.
+
+   The vsync timer is the device which comes with it: an event which
+   adds itself again every frame, and raises SCHED_VSYNC_LINE.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include "simz80.h"
+#include "bbcache.h"
+#include "sched.h"
+
+/** Determine whether no instruction has run since EI, so that an
+    interrupt may not be accepted yet.
+    @param[in] cpu the machine
+ */
+static int
+sched_ei(struct z80_cpu *cpu){
+
+	return cpu->cycles == cpu->sched.ei;
+}
+
+/** Work out when sched_run() has to be called next.
+    @param[in] cpu the machine
+ */
+static void
+sched_next(struct z80_cpu *cpu){
+	struct sched *s = &cpu->sched;
+	int i;
+
+	s->next = SIMZ80_FOREVER;
+	for(i = 0; i < SCHED_NR; ++i) {
+
+		if ( s->ev[i].fn != NULL && s->ev[i].at < s->next )
+			s->next = s->ev[i].at;
+	}
+	if ( s->irq != 0 && ( cpu->IFF & 1 ) )
+		s->next = sched_ei(cpu) ? cpu->cycles + 1 : 0;
+}
+
+/** Accept an interrupt: push PC and jump as the interrupt mode says.
+    @param[in] cpu the machine
+    @note In IM 0 only an RST instruction may be on the data bus;
+          anything else runs as RST 38H.
+ */
+static void
+sched_intr(struct z80_cpu *cpu){
+	struct sched *s = &cpu->sched;
+	int  line;
+	BYTE vector;
+
+	for(line = 0; !( s->irq & ( 1 << line ) ); ++line)
+		;
+	s->irq &= ~( 1 << line );	/* acknowledged */
+	vector = s->vector[line];
+
+	cpu->IFF = 0;
+	cpu->sp -= 2;
+	PutWORD(cpu->sp, cpu->pc);
+	switch( cpu->im ) {
+
+	case 2:
+		cpu->pc = GetWORD( ( cpu->ir & 0xff00 ) | vector );
+		cpu->cycles += 19;
+		break;
+	case 1:
+		cpu->pc = 0x38;
+		cpu->cycles += 13;
+		break;
+	default:
+		cpu->pc = ( ( vector & 0xc7 ) == 0xc7 ) ? ( vector & 0x38 ) : 0x38;
+		cpu->cycles += 13;
+		break;
+	}
+}
+
+/** Initialize the scheduler: no events, no interrupt requests.
+    @param[in] cpu the machine
+ */
+void
+sched_init(struct z80_cpu *cpu){
+	struct sched *s = &cpu->sched;
+	int i;
+
+	for(i = 0; i < SCHED_NR; ++i)
+		s->ev[i].fn = NULL;
+	s->irq = 0;
+	s->next = SIMZ80_FOREVER;
+	s->ei = SIMZ80_FOREVER;
+	s->vsync = 0;
+}
+
+/** Add an event.
+    @param[in] cpu the machine
+    @param[in] at  value of the cycle count to run the event at
+    @param[in] fn  the function to call
+    @param[in] arg argument of fn
+    @return event ID
+    @retval -1 too many events
+ */
+int
+sched_add(struct z80_cpu *cpu, unsigned long long at, sched_fn fn,
+    void *arg){
+	struct sched *s = &cpu->sched;
+	int i;
+
+	for(i = 0; i < SCHED_NR; ++i) {
+
+		if ( s->ev[i].fn == NULL )
+			break;
+	}
+	if ( i == SCHED_NR )
+		return -1;
+
+	s->ev[i].fn = fn;
+	s->ev[i].arg = arg;
+	s->ev[i].at = at;
+	if ( at < s->next )
+		s->next = at;
+	return i;
+}
+
+/** Cancel an event.
+    @param[in] cpu the machine
+    @param[in] id  event ID returned by sched_add()
+ */
+void
+sched_del(struct z80_cpu *cpu, int id){
+
+	if ( id < 0 || id >= SCHED_NR )
+		return;
+	cpu->sched.ev[id].fn = NULL;
+	sched_next(cpu);
+}
+
+/** Raise an interrupt request line.
+    The line stays raised until the Z80 accepts the interrupt or
+    sched_irq_clear() lowers it.
+    @param[in] cpu    the machine
+    @param[in] line   the line, 0 has the highest priority
+    @param[in] vector data bus while the interrupt is acknowledged:
+                      an RST op-code for IM 0, the low byte of the
+                      vector address for IM 2
+ */
+void
+sched_irq(struct z80_cpu *cpu, int line, BYTE vector){
+
+	if ( line < 0 || line >= SCHED_LINES )
+		return;
+	cpu->sched.irq |= ( 1 << line );
+	cpu->sched.vector[line] = vector;
+	cpu->sched.next = 0;	/* have a look as soon as possible */
+}
+
+/** Lower an interrupt request line.
+    @param[in] cpu  the machine
+    @param[in] line the line
+ */
+void
+sched_irq_clear(struct z80_cpu *cpu, int line){
+
+	if ( line < 0 || line >= SCHED_LINES )
+		return;
+	cpu->sched.irq &= ~( 1 << line );
+}
+
+/** Cut a cycle budget for simz80_run() at the next event.
+    @param[in] cpu    the machine
+    @param[in] budget T-states the caller would run for
+    @return T-states to run for
+ */
+unsigned long long
+sched_budget(struct z80_cpu *cpu, unsigned long long budget){
+	unsigned long long left;
+
+	if ( cpu->sched.next <= cpu->cycles )
+		return 0;
+	left = cpu->sched.next - cpu->cycles;
+	return ( left < budget ) ? left : budget;
+}
+
+/** Run the events which are due, and accept an interrupt if one is
+    requested and enabled.
+    @param[in] cpu the machine
+ */
+void
+sched_run(struct z80_cpu *cpu){
+	struct sched *s = &cpu->sched;
+	struct sched_event *e;
+	sched_fn fn;
+	int i;
+
+	if ( cpu->cycles < s->next && !( s->irq != 0 && ( cpu->IFF & 1 ) ) )
+		return;
+
+	for(i = 0; i < SCHED_NR; ++i) {
+
+		e = &s->ev[i];
+		if ( e->fn == NULL || e->at > cpu->cycles )
+			continue;
+		fn = e->fn;
+		e->fn = NULL;		/* the callback may add it again */
+		fn(cpu, e->arg);
+	}
+	if ( s->irq != 0 && ( cpu->IFF & 1 ) && !sched_ei(cpu) )
+		sched_intr(cpu);
+	sched_next(cpu);
+}
+
+/** Event of the vsync timer: interrupt, and come again next frame.
+    @param[in] cpu the machine
+    @param[in] arg not used
+ */
+static void
+sched_vsync_tick(struct z80_cpu *cpu, void *arg){
+	struct sched *s = &cpu->sched;
+
+	sched_irq(cpu, SCHED_VSYNC_LINE, SCHED_VSYNC_VECTOR);
+	s->vsync_at += s->vsync;	/* a late event does not shift the frames */
+	if ( s->vsync_at <= cpu->cycles )
+		s->vsync_at = cpu->cycles + s->vsync;
+	(void)sched_add(cpu, s->vsync_at, sched_vsync_tick, NULL);
+}
+
+/** Start the vsync timer.
+    @param[in] cpu    the machine
+    @param[in] period T-states of a frame
+    @retval  0 success
+    @retval -1 no period, or too many events
+ */
+int
+sched_vsync(struct z80_cpu *cpu, unsigned long long period){
+	struct sched *s = &cpu->sched;
+
+	if ( period == 0 || s->vsync != 0 )
+		return -1;
+	s->vsync = period;
+	s->vsync_at = cpu->cycles + period;
+	if ( sched_add(cpu, s->vsync_at, sched_vsync_tick, NULL) < 0 ) {
+
+		s->vsync = 0;
+		return -1;
+	}
+	return 0;
+}
@@ -29,6 +29,10 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <signal.h>
+#include <time.h>
+#ifdef	HAVE_POLL
+# include <poll.h>
+#endif
 
 #ifdef HAVE_CURSES_H
 # include <curses.h>		/* need only termcap facility, however major */
@@ -58,13 +62,6 @@
 #include "trap.h"
 #include "simz80.h"
 
-#ifndef SCR_MAXLINES
-# define SCR_MAXLINES	(25)	/* maximam lines of virtual screen */
-#endif
-#ifndef	SCR_MAXWIDTH
-# define SCR_MAXWIDTH	(80)	/* maximam width of virtual screen */
-#endif
-
 #ifdef	OPT_DELAY_FLUSH
 # ifndef OPT_DELAY_FLUSH_TIME	/* interval time of flush in usec */
 #  define OPT_DELAY_FLUSH_TIME	20	/* 1/60 sec */
@@ -73,6 +70,13 @@
 
 #define	SCR_TABLEN	(8)	/* length of tab */
 
+/* idle #GETKY loop: a program polling for a key without doing
+   anything else is made to wait for the key, not to spin */
+#define	SCR_IDLE_POLLS	(64)	/* empty polls in a row before waiting */
+#define	SCR_IDLE_CYCLES	(100)	/* T-states between polls of a loop */
+#define	SCR_IDLE_WAIT	(10)	/* time to wait for a key in msec */
+#define	SCR_NSEC	(1000000000LL)
+
 #define	SCREEN		(1)		/* stdout */
 /* flags */
 #define	SCR_F_NONE	(0)
@@ -89,13 +93,31 @@
 #define	SCR_LA_DIRTY	(1)	/* this line is darty (not flushed) */
 #define	SCR_LA_CONT	(2)	/* this line is contine to next line */
 
-static unsigned char *scr_vchr[SCR_MAXLINES+1];	/* virtual screen */
-static unsigned char *scr_vattr[SCR_MAXLINES+1];/* virtual screen attribute */
-static unsigned char scr_vlattr[SCR_MAXLINES+1];/* virtual line attribute */
-static int scr_vx, scr_vy;	/* cursor posision on virtual screen */
-static int scr_px, scr_py;	/* cursor posision on physical screen */
-static int scr_vw, scr_vh;	/* Width and Height of virtual screen */
-static int scr_pw, scr_ph;	/* Width and Height of physical screen */
+/* the screen of a batch session belongs to the thread which runs it */
+static __thread unsigned char *scr_vchr[SCR_MAXLINES+1];	/* virtual screen */
+static __thread unsigned char *scr_vattr[SCR_MAXLINES+1];/* virtual screen attribute */
+static __thread unsigned char scr_vlattr[SCR_MAXLINES+1];/* virtual line attribute */
+static __thread int scr_vx, scr_vy;	/* cursor posision on virtual screen */
+static __thread int scr_px, scr_py;	/* cursor posision on physical screen */
+static __thread int scr_vw, scr_vh;	/* Width and Height of virtual screen */
+static __thread int scr_pw, scr_ph;	/* Width and Height of physical screen */
+
+/* batch session: no terminal, keys are typed from a buffer */
+static __thread int	scr_batch = 0;		/* screen is headless */
+static __thread const unsigned char *scr_keys;	/* keys not typed yet */
+static __thread size_t	scr_nkeys;		/* length of scr_keys */
+static __thread int	scr_keys_eof;		/* waited after the last key */
+static __thread char	*scr_log;		/* lines which left the screen */
+static __thread size_t	scr_loglen, scr_logsize;
+
+/* idle loop detection of scr_getky() */
+static __thread int	scr_idle_polls;		/* empty polls in a row */
+static __thread unsigned long long scr_idle_last; /* cycle count of last poll */
+static __thread struct timespec scr_idle_time;	/* host time of last poll */
+static __thread long long scr_idle_ahead;	/* nsec the emulated time of
+						   the polls is ahead of the
+						   host time */
+static unsigned long	scr_idle_hz = SCHED_CLOCK;	/* emulated clock */
 
 /* termcap entries */
 static char *scr_tc_sf_str;	/* scroll commmand */
@@ -118,7 +140,7 @@ static int	out_flags;
 static int	out_blocking = 1;	/* now, terminal is blocking mode */
 static int	out_blocking_orig;
 
-static int	breaked = 0;
+static __thread int	breaked = 0;
 
 /* declaration of signal handler */
 RETSIGTYPE	scr_stopr();
@@ -128,7 +150,7 @@ RETSIGTYPE	scr_alrm();
 #endif
 
 /* key input conversion */
-static int	scr_capson = 0;
+static __thread int	scr_capson = 0;
 
 /* against signals in critical region */
 #define	ON_CRITICAL	{ (void)sigprocmask(SIG_BLOCK, &scr_intset, NULL); }
@@ -137,13 +159,13 @@ static sigset_t	scr_intset;
 static int scr_in_signal = 0;	/* "in signal hander" flag */
 
 /* cursor control status */
-static int scr_cur_visible = 1;
+static __thread int scr_cur_visible = 1;
 
 /* cut & paste buffer */
-static unsigned char	scr_cutbuf[SCR_MAXLINES * SCR_MAXWIDTH + 1];
+static __thread unsigned char	scr_cutbuf[SCR_MAXLINES * SCR_MAXWIDTH + 1];
 
 /* screen modes */
-static int scr_mode_insert = 1;	/* insert mode */
+static __thread int scr_mode_insert = 1;	/* insert mode */
 
 /* keyboard functions for screen edit */
 void	scr_key_backspace(void), scr_key_delete(void),
@@ -262,10 +284,14 @@ static int unix2sword_tbl[]={
 	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
 };
 
-static int	keymap[(int)' '];
+static __thread int	keymap[(int)' '];
+
+static __thread struct z80_cpu *scr_cpu;	/* machine shown on the screen */
 
 static void scr_vkill(int _flag);
 static void scr_delete(int _flag);
+static void scr_logline(int _y);
+static void scr_logscreen(void);
 
 /** Sync virtual cursor position to XYADR work space.
     @param[in] y Cursor Y position
@@ -274,8 +300,99 @@ static void scr_delete(int _flag);
 static void
 sync_xyadr(int y, int x){
 
-	trap_write_workarea_without_sync(EM_XYADR, x);
-	trap_write_workarea_without_sync(EM_XYADR + 1, y);
+	if ( scr_cpu == NULL )
+		return;
+	trap_write_workarea_without_sync(scr_cpu, EM_XYADR, x);
+	trap_write_workarea_without_sync(scr_cpu, EM_XYADR + 1, y);
+}
+
+/*
+   allocate blank virtual screen
+*/
+static int
+scr_alloc(void){
+    int	y;
+
+    for (y=0; y<SCR_MAXLINES; y++){
+	if (scr_vchr[y] != NULL)
+	    free(scr_vchr[y]);
+	if (scr_vattr[y] != NULL)
+	    free(scr_vattr[y]);
+	scr_vchr[y] = (unsigned char *)malloc(SCR_MAXWIDTH + 1);
+	scr_vattr[y] = (unsigned char *)malloc(SCR_MAXWIDTH + 1);
+	if (scr_vchr[y] == NULL || scr_vattr[y] == NULL){
+	    perror("malloc");
+	    return(1);
+	}
+	memset(scr_vchr[y], (int) ' ', SCR_MAXWIDTH);	/* blank */
+	(scr_vchr[y])[SCR_MAXWIDTH] = '\0';
+	memset(scr_vattr[y], (int) SCR_A_CLEAN, SCR_MAXWIDTH);
+	(scr_vattr[y])[SCR_MAXWIDTH] = '\0';
+    }
+    return(0);
+}
+
+/** Append a line of the virtual screen to the output of a batch session.
+    Trailing blanks are dropped.
+    @param[in] y line number
+ */
+static void
+scr_logline(int y){
+	size_t	 len, size;
+	char	*p;
+
+	for(len = scr_vw; ( len > 0 ) && ( scr_vchr[y][len - 1] == ' ' ); --len)
+		;
+
+	if ( scr_loglen + len + 1 > scr_logsize ) {
+
+		size = ( scr_logsize == 0 ) ? 1024 : scr_logsize * 2;
+		while( scr_loglen + len + 1 > size )
+			size *= 2;
+		p = realloc(scr_log, size);
+		if ( p == NULL )
+			return;		/* lose the line */
+		scr_log = p;
+		scr_logsize = size;
+	}
+	memcpy(scr_log + scr_loglen, scr_vchr[y], len);
+	scr_loglen += len;
+	scr_log[scr_loglen++] = '\n';
+}
+
+/** Append the lines on the virtual screen up to the last one which is
+    not blank to the output of a batch session.
+ */
+static void
+scr_logscreen(void){
+	int	x, y, last;
+
+	last = -1;
+	for(y = 0; y < scr_vh; ++y) {
+
+		for(x = 0; x < scr_vw; ++x)
+			if ( scr_vchr[y][x] != ' ' )
+				break;
+		if ( x < scr_vw )
+			last = y;
+	}
+	for(y = 0; y <= last; ++y)
+		scr_logline(y);
+}
+
+/** Type the next key of a batch session.
+    @param[out] c the key
+    @retval 1 a key is typed
+    @retval 0 no key is left
+ */
+static int
+scr_batchkey(char *c){
+
+	if ( scr_nkeys == 0 )
+		return 0;
+	*c = (char)*scr_keys++;
+	--scr_nkeys;
+	return 1;
 }
 
 /*
@@ -444,8 +561,8 @@ scr_pputchar(int c){
 */
 void
 scr_pmove(int y, int x){
-    if (scr_py == y && scr_px == x)
-	return;		/* nothing to do */
+    if (scr_batch || (scr_py == y && scr_px == x))
+	return;		/* no terminal or nothing to do */
 
     tputs(tgoto(scr_tc_cm_str, x, y), 1, scr_pputchar);
     scr_term_fflush();
@@ -462,6 +579,9 @@ scr_pmove(int y, int x){
 */
 void
 scr_pput(int y, int x, int c){
+    if (scr_batch)
+	return;		/* no terminal */
+
     ON_CRITICAL;
     scr_pmove(y, x);
     scr_pputchar(c);
@@ -484,6 +604,9 @@ void
 scr_clear(void){
     int	v;
 
+    if (scr_batch)
+	scr_logscreen();	/* keep the cleared text */
+
     for (v=0; v<scr_vh; v++){
 	memset(scr_vchr[v], (int) ' ', scr_vw);
 	(scr_vchr[v])[scr_vw] = '\0';
@@ -493,11 +616,13 @@ scr_clear(void){
     }
     scr_vx = scr_vy = 0;
 
-    ON_CRITICAL;
-    tputs(scr_tc_cl_str, 1, scr_pputchar);
-    scr_term_fflush();
-    scr_px = scr_py = 0;
-    OFF_CRITICAL;
+    if (! scr_batch){
+	ON_CRITICAL;
+	tputs(scr_tc_cl_str, 1, scr_pputchar);
+	scr_term_fflush();
+	scr_px = scr_py = 0;
+	OFF_CRITICAL;
+    }
 
     sync_xyadr(scr_vy, scr_vx);
 }
@@ -510,11 +635,14 @@ scr_clear(void){
 */
 void
 scr_home(void){
-    ON_CRITICAL;
-    scr_vx = scr_vy = scr_px = scr_py = 0;
-    tputs(scr_tc_ho_str, 1, scr_pputchar);
-    scr_term_fflush();
-    OFF_CRITICAL;
+    scr_vx = scr_vy = 0;
+    if (! scr_batch){
+	ON_CRITICAL;
+	scr_px = scr_py = 0;
+	tputs(scr_tc_ho_str, 1, scr_pputchar);
+	scr_term_fflush();
+	OFF_CRITICAL;
+    }
     sync_xyadr(scr_vy, scr_vx);
 }
 
@@ -532,6 +660,9 @@ scr_scroll(void){
     unsigned char	*ctop, *atop;
     int	v;
 
+    if (scr_batch)
+	scr_logline(0);		/* the top line leaves the screen */
+
     ctop = scr_vchr[0];
     atop = scr_vattr[0];
     for (v=0; v<scr_vh - 1; v++){
@@ -547,6 +678,9 @@ scr_scroll(void){
     scr_vattr[scr_vh - 1] = atop;
     scr_vlattr[scr_vh] = SCR_LA_NONE;
 
+    if (scr_batch)
+	return;			/* no terminal */
+
     ON_CRITICAL;
     tputs(tgoto(scr_tc_cm_str, 0, scr_ph - 1), 1, scr_pputchar);
     tputs(scr_tc_sf_str, 1, scr_pputchar);
@@ -611,6 +745,9 @@ scr_invisible(void){
 */
 void
 scr_pbell(void){
+    if (scr_batch)
+	return;		/* no terminal */
+
     ON_CRITICAL;
     tputs(scr_tc_bl_str, 1, scr_pputchar);
     OFF_CRITICAL;
@@ -636,6 +773,9 @@ scr_realflush(void){
     register unsigned char	*p;
     int wlen;
 
+    if (scr_batch)
+	return;		/* no terminal */
+
     ON_CRITICAL;
     for (v=0; v<scr_vh; v++){
 	if (!(scr_vlattr[v] & SCR_LA_DIRTY))
@@ -689,6 +829,9 @@ scr_redraw(void){
     int sx,len;
     int wlen;
 
+    if (scr_batch)
+	return;		/* no terminal */
+
     if (! scr_in_signal)
 	ON_CRITICAL;
     tputs(scr_tc_cl_str, 1, scr_pputchar);	/* clear screen */
@@ -742,6 +885,54 @@ scr_locate_cursor(int y, int x){
 #endif
 }
 
+/** Copy the virtual screen out for a snapshot.
+    @param[out] st the screen
+ */
+void
+scr_save(struct scr_state *st){
+    int	y;
+
+    memset(st, 0, sizeof(*st));
+    st->w = scr_vw;
+    st->h = scr_vh;
+    st->y = scr_vy;
+    st->x = scr_vx;
+    st->capson = scr_capson;
+    for (y=0; y<scr_vh && y<SCR_MAXLINES; y++){
+	st->lattr[y] = scr_vlattr[y] & ~SCR_LA_DIRTY;
+	memcpy(st->chr[y], scr_vchr[y], SCR_MAXWIDTH);
+    }
+}
+
+/** Put a virtual screen saved by scr_save() back and redraw it.  The
+    height of the screen is kept; lines which do not fit are dropped.
+    @param[in] st the screen
+ */
+void
+scr_load(const struct scr_state *st){
+    int	y, x;
+
+    if ((st->w <= scr_pw) && (st->w <= SCR_MAXWIDTH) && (st->w > 0))
+	scr_vw = st->w;
+    for (y=0; y<scr_vh; y++){
+	if (y < st->h && y < SCR_MAXLINES){
+	    memcpy(scr_vchr[y], st->chr[y], SCR_MAXWIDTH);
+	    scr_vlattr[y] = st->lattr[y];
+	} else {
+	    memset(scr_vchr[y], (int) ' ', SCR_MAXWIDTH);
+	    scr_vlattr[y] = SCR_LA_NONE;
+	}
+	memset(scr_vattr[y], (int) SCR_A_CLEAN, SCR_MAXWIDTH);
+    }
+    scr_capson = st->capson;
+    y = st->y;
+    x = st->x;
+    scr_fixxy(&y, &x);
+    scr_vy = y;
+    scr_vx = x;
+    scr_redraw();
+}
+
 /*
    scr_vright:
    move virtual cursor to right
@@ -1312,14 +1503,27 @@ scr_conv(char oc){
 */
 int scr_winkey(void){
     char	c;
+    int		v;
 
     scr_visible();
-    scr_term_wait();		/* make input to wait */
-    while (read(0, &c, 1) <= 0)
-	;		/* wait until read something */
+    if (scr_cpu != NULL &&
+	REPLAY_GET(scr_cpu, REPLAY_WAITKY, scr_cpu->cycles, &v))
+	return(v);
+    if (scr_batch){
+	if (! scr_batchkey(&c)){
+	    scr_keys_eof = 1;	/* the session ends after this trap */
+	    return(SCR_SOS_BREAK);
+	}
+    } else {
+	scr_term_wait();	/* make input to wait */
+	while (read(0, &c, 1) <= 0)
+	    ;		/* wait until read something */
+    }
     c = scr_conv(c);
     if (c == SCR_SOS_BREAK)
 	breaked = 0;
+    if (scr_cpu != NULL)
+	REPLAY_PUT(scr_cpu, REPLAY_WAITKY, scr_cpu->cycles, c);
     return(c);
 }
 
@@ -1345,18 +1549,40 @@ inkey_internal(void){
 
 /*
    get a key datum, not wait even if no datum for scr_brkey() and scr_pause()
+   wait up to `wait' msec for a key if poll() is available
     NON PORTABLE FUNCTION
 */
 static int
-getky_internal(void){
+getky_internal(int wait){
     char	c;
-
-    /* XXX: this is simple, but brain-damaged algorithm in multitask system */
-    /* we need some tricks such as constat() in yaze:bios.c */
+    int		n, v;
+#ifdef	HAVE_POLL
+    struct pollfd	fds;
+#endif
 
     scr_invisible();
-    scr_term_nowait();			/* make input as nowait */
-    if (read(0, &c, 1) > 0){
+    if (scr_cpu != NULL &&
+	REPLAY_GET(scr_cpu, REPLAY_GETKY, scr_cpu->cycles, &v))
+	return(v);
+    if (scr_batch){
+	n = scr_batchkey(&c);
+    } else {
+#ifdef	HAVE_POLL
+	/* read() only if a key is there, so the terminal may stay blocking */
+	fds.fd = 0;
+	fds.events = POLLIN;
+	fds.revents = 0;
+	n = 0;
+	if (poll(&fds, 1, wait) > 0)
+	    n = read(0, &c, 1);
+#else
+	/* XXX: this is simple, but brain-damaged algorithm in multitask system */
+	scr_term_nowait();		/* make input as nowait */
+	n = read(0, &c, 1);
+	scr_term_wait();
+#endif
+    }
+    if (n > 0){
 	c = scr_conv(c);
 	if (c == SCR_SOS_BREAK){
 	    if (breaked)		/* code inserted by scr_intr() */
@@ -1364,12 +1590,61 @@ getky_internal(void){
 	    else			/* ESC key, so tell scr_brkey */
 		breaked = 1;
 	}
-	scr_term_wait();
-	return(c);
     } else {
-	scr_term_wait();
+	c = 0;
+    }
+    if (scr_cpu != NULL)
+	REPLAY_PUT(scr_cpu, REPLAY_GETKY, scr_cpu->cycles, c);
+    return(c);
+}
+
+/** How long scr_getky() may wait for a key.
+    A program which polls again and again, almost back to back and
+    calling nothing else in between (see scr_busy()), is waiting for a
+    key and nothing else, so the poll blocks for a while instead of
+    burning the host CPU.  It waits only for the emulated time of the
+    polls, at the clock of scr_clock(), which the host has not spent
+    yet: the emulated time never runs slower than the real one.  What
+    the program reads is the same, only the host time between the polls
+    changes.
+    @retval wait time in msec, 0 if not idle
+ */
+static int
+getky_idle(void){
+    unsigned long long	now, gap;
+    struct timespec	t;
+    long long		real;
+
+    if (scr_batch || scr_cpu == NULL)
+	return(0);
+
+    now = scr_cpu->cycles;
+    gap = now - scr_idle_last;
+    scr_idle_last = now;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    real = (t.tv_sec - scr_idle_time.tv_sec) * SCR_NSEC
+	+ (t.tv_nsec - scr_idle_time.tv_nsec);
+    scr_idle_time = t;
+
+    if (gap > SCR_IDLE_CYCLES){
+	scr_idle_polls = 0;		/* did some work since the last poll */
+	scr_idle_ahead = 0;
+	return(0);
+    }
+    if (scr_idle_polls < SCR_IDLE_POLLS){
+	scr_idle_polls++;
 	return(0);
     }
+
+    /* a wait, or a late poll, is taken from what the polls are ahead */
+    scr_idle_ahead += (long long)(gap * SCR_NSEC / scr_idle_hz) - real;
+    if (scr_idle_ahead > SCR_IDLE_WAIT * (SCR_NSEC / 1000))
+	scr_idle_ahead = SCR_IDLE_WAIT * (SCR_NSEC / 1000);
+    if (scr_idle_ahead < -SCR_IDLE_WAIT * (SCR_NSEC / 1000))
+	scr_idle_ahead = -SCR_IDLE_WAIT * (SCR_NSEC / 1000);
+    if (scr_idle_ahead < SCR_IDLE_WAIT * (SCR_NSEC / 1000))
+	return(0);
+    return(SCR_IDLE_WAIT);
 }
 
 
@@ -1385,7 +1660,6 @@ int
 scr_initx(void){
     char	bp[1024];
     char	cp[1024],*cpp;
-    int		y;
     struct winsize	ws;
     struct sigaction	sact;
 
@@ -1496,18 +1770,8 @@ scr_initx(void){
     scr_term_makeraw();
 
     /* allocate buffer */
-    for (y=0; y<SCR_MAXLINES; y++){
-	if (scr_vchr[y] != NULL)
-	    free(scr_vchr[y]);
-	if (scr_vattr[y] != NULL)
-	    free(scr_vattr[y]);
-	scr_vchr[y] = (unsigned char *)malloc(SCR_MAXWIDTH + 1);
-	scr_vattr[y] = (unsigned char *)malloc(SCR_MAXWIDTH + 1);
-	if (scr_vchr[y] == NULL || scr_vattr[y] == NULL){
-	    perror("malloc");
-	    return(1);
-	}
-    }
+    if (scr_alloc())
+	return(1);
     scr_clear();
 
     /* clear keymap */
@@ -1551,6 +1815,110 @@ scr_initx(void){
     return(0);
 }
 
+/** Connect the screen to a machine, whose work area follows the cursor.
+    @param[in] cpu the machine
+ */
+void
+scr_attach(struct z80_cpu *cpu){
+
+	scr_cpu = cpu;
+}
+
+/** Initialize a headless screen for a batch session on this thread.
+    Nothing is written to the terminal; keys are read from a buffer.
+    @param[in] keys keys to type, one byte per key
+    @param[in] len  number of keys
+    @retval 0 success
+    @retval 1 out of memory
+ */
+int
+scr_initbatch(const char *keys, size_t len){
+
+	scr_batch = 1;
+	scr_keys = (const unsigned char *)keys;
+	scr_nkeys = len;
+	scr_keys_eof = 0;
+	scr_loglen = 0;
+
+	scr_pw = scr_vw = EM_WIDTH;
+	scr_ph = scr_vh = EM_MAXLN;
+	scr_px = scr_py = 0;
+	scr_cur_visible = 1;
+	scr_mode_insert = 1;
+	scr_cutbuf[0] = '\0';
+	breaked = 0;
+	scr_cpu = NULL;
+
+	if ( scr_alloc() )
+		return 1;
+	scr_clear();
+	scr_mapclear();
+
+	return 0;
+}
+
+/** Give the batch session on this thread other keys to type.  The
+    screen is kept.
+    @param[in] keys keys to type, one byte per key
+    @param[in] len  number of keys
+ */
+void
+scr_batchkeys(const char *keys, size_t len){
+
+	scr_keys = (const unsigned char *)keys;
+	scr_nkeys = len;
+	scr_keys_eof = 0;
+}
+
+/** Finish the batch session on this thread.
+    @param[out] len length of the screen output
+    @return the lines which left the screen followed by the lines left
+            on it, one newline terminated line per screen line, or NULL if
+            there is no output.  The caller frees it.
+ */
+char *
+scr_endbatch(size_t *len){
+	char	*log;
+	int	 y;
+
+	scr_logscreen();
+	log = scr_log;
+	*len = scr_loglen;
+	scr_log = NULL;
+	scr_loglen = scr_logsize = 0;
+
+	for(y = 0; y < SCR_MAXLINES; ++y) {
+
+		free(scr_vchr[y]);
+		free(scr_vattr[y]);
+		scr_vchr[y] = scr_vattr[y] = NULL;
+	}
+	scr_cpu = NULL;
+	scr_batch = 0;
+
+	return log;
+}
+
+/** Tell whether the screen belongs to a batch session.
+    @retval 1 batch session
+    @retval 0 terminal
+ */
+int
+scr_isbatch(void){
+
+	return scr_batch;
+}
+
+/** Tell whether a batch session waited for a key after the last one.
+    @retval 1 the keys are exhausted
+    @retval 0 otherwise
+ */
+int
+scr_keys_exhausted(void){
+
+	return scr_keys_eof;
+}
+
 /*
   scr_finish:
   terminate screen module
@@ -1768,20 +2136,46 @@ int scr_getl(char *buf){
     NON PORTABLE FUNCTION
 */
 int scr_getky(void){
+	int c;
 
+	c = getky_internal(getky_idle());
+	if (c != 0)
+		scr_busy();		/* a key: the loop is over */
 	/* convert to external representation */
-	return unix2sword_tbl[ ( getky_internal() ) & 0xff ];
+	return unix2sword_tbl[ c & 0xff ];
+}
+
+/** Tell the idle loop detection that the program has called a
+    function other than #GETKY and #BRKEY, so that its next poll is not
+    idle whatever the T-states in between.
+ */
+void scr_busy(void){
+	scr_idle_polls = 0;
+	scr_idle_ahead = 0;
+}
+
+/** Set the emulated clock an idle #GETKY loop may wait for.
+    @param[in] hz T-states a second
+ */
+void scr_clock(unsigned long hz){
+	scr_idle_hz = hz;
 }
 
 /* return TRUE if break */
 int scr_brkey(void){
-    int	c;
+    int	c, b;
 
-    if (! breaked)
+    if (scr_cpu == NULL ||
+	! REPLAY_GET(scr_cpu, REPLAY_BRKEY, scr_cpu->cycles, &b)){
+	b = breaked;
+	if (scr_cpu != NULL)
+	    REPLAY_PUT(scr_cpu, REPLAY_BRKEY, scr_cpu->cycles, b);
+    }
+    if (! b)
 	return(0);
 
     /* already pressed break key, so eat up till break code */
-    while((c = getky_internal()) != SCR_SOS_BREAK && c != '\0')
+    while((c = getky_internal(0)) != SCR_SOS_BREAK && c != '\0')
 	; /* eat up */
     breaked = 0;
     return(1);
@@ -1808,7 +2202,7 @@ int scr_pause(void){
     int	c;
 
     /* eat up input queue */
-    while((c = getky_internal()) != 0 &&
+    while((c = getky_internal(0)) != 0 &&
 	  c != ' ' &&
 	  c != SCR_SOS_BREAK)
 	/* nothing to do */
@@ -1894,6 +2288,7 @@ scr_intr(int sig){
     char	c;
 
     breaked = 1;		/* mark as pressed */
+    trace_intr(sig);		/* dump the traces of the machines */
 
     /* remove input queue */
 #ifdef	HAVE_TERMIOS_H
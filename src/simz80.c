@@ -22,18 +22,23 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA. */
     1999/2/28	Takamichi Tateoka <tate@spa.is.uec.ac.jp>
 */
 
-/* This file was generated from ./simz80.pl
+/* This file was generated from simz80.pl
    with the following choice of options */
 char *perl_params =
     "combine=0,"
-    "optab=0,"
-    "cb_inline=0,"
-    "dfd_inline=0,"
-    "ed_inline=1";
+    "optab=2,"
+    "cb_inline=1,"
+    "dfd_inline=1,"
+    "ed_inline=1,"
+    "fuse_max=16";
+
+#include "config.h"
 
 #include <stdlib.h>
 
 #include "simz80.h"
+#include "bbcache.h"
+#include "jit.h"
 
 static const unsigned char partab[256] = {
 	4,0,0,4,0,4,4,0,0,4,4,0,4,0,0,4,
@@ -56,6 +61,202 @@ static const unsigned char partab[256] = {
 
 #define parity(x)	partab[(x)&0xff]
 
+const BYTE z80_cc_op[256] = {
+	4,10,7,6,4,4,7,4,4,11,7,6,4,4,7,4,
+	8,10,7,6,4,4,7,4,12,11,7,6,4,4,7,4,
+	7,10,16,6,4,4,7,4,7,11,16,6,4,4,7,4,
+	7,10,13,6,11,11,10,4,7,11,13,6,4,4,7,4,
+	4,4,4,4,4,4,7,4,4,4,4,4,4,4,7,4,
+	4,4,4,4,4,4,7,4,4,4,4,4,4,4,7,4,
+	4,4,4,4,4,4,7,4,4,4,4,4,4,4,7,4,
+	7,7,7,7,7,7,4,7,4,4,4,4,4,4,7,4,
+	4,4,4,4,4,4,7,4,4,4,4,4,4,4,7,4,
+	4,4,4,4,4,4,7,4,4,4,4,4,4,4,7,4,
+	4,4,4,4,4,4,7,4,4,4,4,4,4,4,7,4,
+	4,4,4,4,4,4,7,4,4,4,4,4,4,4,7,4,
+	5,10,10,10,10,11,7,11,5,10,10,0,10,17,7,11,
+	5,10,10,11,10,11,7,11,5,4,10,11,10,0,7,11,
+	5,10,10,19,10,11,7,11,5,4,10,4,10,0,7,11,
+	5,10,10,4,10,11,7,11,5,6,10,4,10,0,7,11,
+};
+
+const BYTE z80_cc_cb[256] = {
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,12,8,8,8,8,8,8,8,12,8,
+	8,8,8,8,8,8,12,8,8,8,8,8,8,8,12,8,
+	8,8,8,8,8,8,12,8,8,8,8,8,8,8,12,8,
+	8,8,8,8,8,8,12,8,8,8,8,8,8,8,12,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+	8,8,8,8,8,8,15,8,8,8,8,8,8,8,15,8,
+};
+
+const BYTE z80_cc_ed[256] = {
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	12,12,15,20,8,14,8,9,12,12,15,20,8,14,8,9,
+	12,12,15,20,8,14,8,9,12,12,15,20,8,14,8,9,
+	12,12,15,20,8,14,8,18,12,12,15,20,8,14,8,18,
+	12,12,15,20,8,14,8,8,12,12,15,20,8,14,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	16,16,16,16,8,8,8,8,16,16,16,16,8,8,8,8,
+	16,16,16,16,8,8,8,8,16,16,16,16,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+};
+
+const BYTE z80_cc_xy[256] = {
+	4,4,4,4,4,4,4,4,4,15,4,4,4,4,4,4,
+	4,4,4,4,4,4,4,4,4,15,4,4,4,4,4,4,
+	4,14,20,10,8,8,11,4,4,15,20,10,8,8,11,4,
+	4,4,4,4,23,23,19,4,4,15,4,4,4,4,4,4,
+	4,4,4,4,8,8,19,4,4,4,4,4,8,8,19,4,
+	4,4,4,4,8,8,19,4,4,4,4,4,8,8,19,4,
+	8,8,8,8,8,8,19,8,8,8,8,8,8,8,19,8,
+	19,19,19,19,19,19,4,19,4,4,4,4,8,8,19,4,
+	4,4,4,4,8,8,19,4,4,4,4,4,8,8,19,4,
+	4,4,4,4,8,8,19,4,4,4,4,4,8,8,19,4,
+	4,4,4,4,8,8,19,4,4,4,4,4,8,8,19,4,
+	4,4,4,4,8,8,19,4,4,4,4,4,8,8,19,4,
+	4,4,4,4,4,4,4,4,4,4,4,0,4,4,4,4,
+	4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+	4,14,4,23,4,15,4,4,4,8,4,4,4,4,4,4,
+	4,4,4,4,4,4,4,4,4,10,4,4,4,4,4,4,
+};
+
+const BYTE z80_cc_xycb[256] = {
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,
+	20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,
+	20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,
+	20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+	23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,23,
+};
+
+#ifdef OPT_FUSION
+const BYTE z80_fuse_pairs[][2] = {
+	{ 0x05, 0x20 },
+	{ 0x7e, 0x23 },
+	{ 0xb7, 0x28 },
+	{ 0xeb, 0x19 },
+	{ 0x2b, 0x7c },
+	{ 0xb5, 0x20 },
+	{ 0x0b, 0x78 },
+	{ 0xb1, 0x20 },
+	{ 0x77, 0x23 },
+	{ 0x1a, 0x13 },
+	{ 0x12, 0x13 },
+	{ 0xfe, 0x28 },
+	{ 0xfe, 0x20 },
+	{ 0xb7, 0x20 },
+	{ 0x23, 0x10 },
+	{ 0x7c, 0xb5 },
+};
+const int z80_nfuse = 16;
+#endif
+
+/* the count of the machine is kept in the local CYC while simz80_run()
+   runs */
+#define CYCLES(n)	(CYC += (n))
+
+/* every instruction is counted while the machine is profiled, and
+   recorded while it is traced */
+#define INSN_HOOK()	do {						\
+	PROF_INSN(PC & 0xffff, SP, CYC);				\
+	TRACE_INSN(PC & 0xffff, (SYNC_FLAGS(), AF), BC, DE, HL,	\
+	    IX, IY, SP);					\
+    } while (0)
+
+#ifdef OPT_LAZY_FLAGS
+/* operations whose flags other than the carry are not worked out yet */
+#define LF_ADD	1
+#define LF_SUB	2
+#define LF_CP	3
+#define LF_AND	4
+#define LF_LOG	5
+#define LF_INC	6
+#define LF_DEC	7
+
+#define LAZY_FLAGS(op, res, x, y) do {					\
+    lf_op = (op);							\
+    lf_res = (res);							\
+    lf_x = (x);								\
+    lf_y = (y);								\
+} while (0)
+
+/* flags S, Z, H, P/V and N (and the undocumented bits 3 and 5) of an
+   operation recorded by LAZY_FLAGS(), exactly as the eager code sets them */
+static inline FASTWORK
+lazy_flags(FASTWORK op, FASTWORK res, FASTWORK x, FASTWORK y)
+{
+    switch (op) {
+    case LF_ADD:
+	return (res & 0xa8) | (((res & 0xff) == 0) << 6) | (x & 0x10) |
+		(((x >> 6) ^ (x >> 5)) & 4);
+    case LF_SUB:
+	return (res & 0xa8) | (((res & 0xff) == 0) << 6) | (x & 0x10) |
+		(((x >> 6) ^ (x >> 5)) & 4) | 2;
+    case LF_CP:
+	return (res & 0x80) | (((res & 0xff) == 0) << 6) | (y & 0x28) |
+		(((x >> 6) ^ (x >> 5)) & 4) | 2 | (x & 0x10);
+    case LF_AND:
+	return (res & 0xa8) | ((res == 0) << 6) | 0x10 | partab[res];
+    case LF_LOG:
+	return (res & 0xa8) | ((res == 0) << 6) | partab[res];
+    case LF_INC:
+	return (res & 0xa8) | (((res & 0xff) == 0) << 6) |
+		(((res & 0xf) == 0) << 4) | ((res == 0x80) << 2);
+    default:		/* LF_DEC */
+	return (res & 0xa8) | (((res & 0xff) == 0) << 6) |
+		(((res & 0xf) == 0xf) << 4) | ((res == 0x7f) << 2) | 2;
+    }
+}
+
+/* bring the flags in AF up to date */
+#define FLAGS_SYNCED()							\
+    (lf_op ? (AF = (AF & ~0xfe) | lazy_flags(lf_op, lf_res, lf_x, lf_y),\
+	      lf_op = 0) : 0)
+#define SYNC_FLAGS()	((void)FLAGS_SYNCED())
+
+/* S and Z follow from the result alone, and C is always in AF */
+#undef TSTFLAG
+#undef SETFLAG
+#define TSTFLAG(f)	LF_TST_ ## f
+#define LF_TST_C	((AF & FLAG_C) != 0)
+#define LF_TST_Z	(lf_op ? (lf_res & 0xff) == 0 : (AF & FLAG_Z) != 0)
+#define LF_TST_S	(lf_op ? (lf_res & 0x80) != 0 : (AF & FLAG_S) != 0)
+#define LF_TST_P	(FLAGS_SYNCED(), (AF & FLAG_P) != 0)
+#define LF_TST_H	(FLAGS_SYNCED(), (AF & FLAG_H) != 0)
+#define LF_TST_N	(FLAGS_SYNCED(), (AF & FLAG_N) != 0)
+#define SETFLAG(f,c)							\
+    (FLAGS_SYNCED(), AF = (c) ? AF | FLAG_ ## f : AF & ~FLAG_ ## f)
+#else
+#define SYNC_FLAGS()	((void)0)
+#endif
+
 #ifdef DEBUG
 volatile int stopsim;
 #endif
@@ -68,821 +269,694 @@ volatile int stopsim;
 #define PUSH(x) do {							\
 	RAM(--SP) = (x) >> 8;						\
 	RAM(--SP) = x;							\
+	BB_CHECK(SP);							\
+	BB_CHECK(SP + 1);						\
 } while (0)
 
 #define JPC(cond) PC = cond ? GetWORD(PC) : PC+2
 
-#define CALLC(cond) {							\
+#define JRC(cond) {							\
     if (cond) {								\
-	FASTREG adrr = GetWORD(PC);					\
+	PC += (signed char) GetBYTE(PC) + 1;				\
+	CYCLES(5);							\
+    }									\
+    else								\
+	PC++;								\
+}
+
+#ifdef OPT_HLE
+/* a known library routine runs as host code instead, see hle.c */
+#define HLE_DEADLINE	deadline
+
+#define CALL() {							\
+    FASTREG adrr = GetWORD(PC);						\
+    int hle_ran = 0;							\
+    if (HLE_MAYBE(adrr)) {						\
+	SAVE_STATE();							\
+	hle_ran = hle_call(cpu, adrr, PC+2, HLE_DEADLINE);		\
+	LOAD_STATE();							\
+    }									\
+    if (!hle_ran) {							\
 	PUSH(PC+2);							\
 	PC = adrr;							\
     }									\
+}
+#else
+#define CALL() {							\
+    FASTREG adrr = GetWORD(PC);						\
+    PUSH(PC+2);								\
+    PC = adrr;								\
+}
+#endif
+
+#define CALLC(cond) {							\
+    if (cond) {								\
+	CALL();								\
+	CYCLES(7);							\
+    }									\
+    else								\
+	PC += 2;							\
+}
+
+#define RETC(cond) {							\
+    if (cond) {								\
+	POP(PC);							\
+	CYCLES(6);							\
+    }									\
+}
+
+#ifdef OPT_BBCACHE
+/* the same with the operand taken from the pre-decoded record */
+#define BB_IMM		(ins->imm)
+
+#define BB_JPC(cond) PC = cond ? BB_IMM : PC+2
+
+#define BB_JRC(cond) {							\
+    if (cond) {								\
+	PC = ins->target;						\
+	CYCLES(5);							\
+    }									\
+    else								\
+	PC = ins->next;							\
+}
+
+#ifdef OPT_HLE
+#define BB_CALL() {							\
+    int hle_ran = 0;							\
+    if (HLE_MAYBE(BB_IMM)) {						\
+	SAVE_STATE();							\
+	hle_ran = hle_call(cpu, BB_IMM, PC+2, HLE_DEADLINE);		\
+	LOAD_STATE();							\
+    }									\
+    if (!hle_ran) {							\
+	PUSH(PC+2);							\
+	PC = BB_IMM;							\
+    }									\
+}
+#else
+#define BB_CALL() {							\
+    PUSH(PC+2);								\
+    PC = BB_IMM;							\
+}
+#endif
+
+#define BB_CALLC(cond) {						\
+    if (cond) {								\
+	BB_CALL();							\
+	CYCLES(7);							\
+    }									\
     else								\
 	PC += 2;							\
 }
+#endif
 
 /* load Z80 registers into (we hope) host registers */
 #define LOAD_STATE()							\
-    PC = pc;								\
-    AF = af[af_sel];							\
-    BC = regs[regs_sel].bc;						\
-    DE = regs[regs_sel].de;						\
-    HL = regs[regs_sel].hl;						\
-    SP = sp
+    PC = cpu->pc;							\
+    CYC = cpu->cycles;							\
+    AF = cpu->af[cpu->af_sel];						\
+    BC = cpu->regs[cpu->regs_sel].bc;					\
+    DE = cpu->regs[cpu->regs_sel].de;					\
+    HL = cpu->regs[cpu->regs_sel].hl;					\
+    IX = cpu->ix;							\
+    IY = cpu->iy;							\
+    SP = cpu->sp
 
 /* load Z80 registers into (we hope) host registers */
 #define DECLARE_STATE()							\
-    FASTREG PC = pc;							\
-    FASTREG AF = af[af_sel];						\
-    FASTREG BC = regs[regs_sel].bc;					\
-    FASTREG DE = regs[regs_sel].de;					\
-    FASTREG HL = regs[regs_sel].hl;					\
-    FASTREG SP = sp
+    FASTREG PC = cpu->pc;						\
+    unsigned long long CYC = cpu->cycles;				\
+    FASTREG AF = cpu->af[cpu->af_sel];					\
+    FASTREG BC = cpu->regs[cpu->regs_sel].bc;				\
+    FASTREG DE = cpu->regs[cpu->regs_sel].de;				\
+    FASTREG HL = cpu->regs[cpu->regs_sel].hl;				\
+    FASTREG IX = cpu->ix;						\
+    FASTREG IY = cpu->iy;						\
+    FASTREG SP = cpu->sp
+
+#ifdef OPT_JIT
+/* hand the registers over to translated code and back */
+#define JIT_SAVE()							\
+    SYNC_FLAGS();							\
+    cpu->cycles = CYC;							\
+    cpu->jit.af = AF;							\
+    cpu->jit.bc = BC;							\
+    cpu->jit.de = DE;							\
+    cpu->jit.hl = HL;							\
+    cpu->ix = IX;							\
+    cpu->iy = IY;							\
+    cpu->jit.sp = SP
+
+#define JIT_LOAD()							\
+    CYC = cpu->cycles;							\
+    AF = cpu->jit.af;							\
+    BC = cpu->jit.bc;							\
+    DE = cpu->jit.de;							\
+    HL = cpu->jit.hl;							\
+    IX = cpu->ix;							\
+    IY = cpu->iy;							\
+    SP = cpu->jit.sp
+
+/* the same for a helper called from translated code; the registers
+   are accessed one by one, as the translated code stores them so */
+#define JIT_DECLARE_STATE()						\
+    struct z80_cpu *cpu = JIT_CPU(r);					\
+    volatile struct jit_regs *vr = r;					\
+    unsigned long long CYC = cpu->cycles;				\
+    FASTREG AF = vr->af;						\
+    FASTREG BC = vr->bc;						\
+    FASTREG DE = vr->de;						\
+    FASTREG HL = vr->hl;						\
+    FASTREG SP = vr->sp
+
+#define JIT_STORE_STATE()						\
+    SYNC_FLAGS();							\
+    cpu->cycles = CYC;							\
+    vr->af = AF;							\
+    vr->bc = BC;							\
+    vr->de = DE;							\
+    vr->hl = HL;							\
+    vr->sp = SP
+#endif
 
 /* save Z80 registers back into memory */
 #define SAVE_STATE()							\
-    pc = PC;								\
-    af[af_sel] = AF;							\
-    regs[regs_sel].bc = BC;						\
-    regs[regs_sel].de = DE;						\
-    regs[regs_sel].hl = HL;						\
-    sp = SP
+    SYNC_FLAGS();							\
+    cpu->cycles = CYC;							\
+    cpu->pc = PC;							\
+    cpu->af[cpu->af_sel] = AF;						\
+    cpu->regs[cpu->regs_sel].bc = BC;					\
+    cpu->regs[cpu->regs_sel].de = DE;					\
+    cpu->regs[cpu->regs_sel].hl = HL;					\
+    cpu->ix = IX;							\
+    cpu->iy = IY;							\
+    cpu->sp = SP
 
-static void
-cb_prefix(FASTREG adr)
-{
-    DECLARE_STATE();
-    FASTWORK temp, acu, op, cbits;
+#ifdef OPT_DISPATCH_THREADED
+/* threaded code: each handler jumps straight to the next one */
+#define DISPATCH()	WRAP_CHECK(); INSN_HOOK(); goto *optab[RAM(PC++)];
+#define OPCODE(op)	op_ ## op
+#ifdef DEBUG
+#define NEXT		continue	/* go round the loop to check stopsim */
+#else
+#define NEXT		do {						\
+    WRAP_CHECK();							\
+    INSN_HOOK();							\
+    goto *optab[RAM(PC++)];						\
+} while (0)
+#endif
+#define BB_DISPATCH()	goto *bbtab[ins->xop];
+#define BB_OPCODE(op)	bb_op_ ## op
+#define BB_NEXT do {							\
+    ins++;								\
+    PC++;								\
+    goto *bbtab[ins->xop];						\
+} while (0)
+#else
+#define DISPATCH()	WRAP_CHECK(); INSN_HOOK(); switch(RAM(PC++))
+#define OPCODE(op)	case 0x ## op
+#define NEXT		break
+#define BB_DISPATCH()	switch(ins->xop)
+#define BB_OPCODE(op)	case 0x ## op
+#define BB_NEXT		break
+#endif
 
-		switch ((op = GetBYTE(PC++)) & 7) {
-		case 0: acu = hreg(BC); break;
-		case 1: acu = lreg(BC); break;
-		case 2: acu = hreg(DE); break;
-		case 3: acu = lreg(DE); break;
-		case 4: acu = hreg(HL); break;
-		case 5: acu = lreg(HL); break;
-		case 6: acu = GetBYTE(adr);  break;
-		case 7: acu = hreg(AF); break;
-		}
-		switch (op & 0xc0) {
-		case 0x00:		/* shift/rotate */
-			switch (op & 0x38) {
-			case 0x00:	/* RLC */
-				temp = (acu << 1) | (acu >> 7);
-				cbits = temp & 1;
-				goto cbshflg1;
-			case 0x08:	/* RRC */
-				temp = (acu >> 1) | (acu << 7);
-				cbits = temp & 0x80;
-				goto cbshflg1;
-			case 0x10:	/* RL */
-				temp = (acu << 1) | TSTFLAG(C);
-				cbits = acu & 0x80;
-				goto cbshflg1;
-			case 0x18:	/* RR */
-				temp = (acu >> 1) | (TSTFLAG(C) << 7);
-				cbits = acu & 1;
-				goto cbshflg1;
-			case 0x20:	/* SLA */
-				temp = acu << 1;
-				cbits = acu & 0x80;
-				goto cbshflg1;
-			case 0x28:	/* SRA */
-				temp = (acu >> 1) | (acu & 0x80);
-				cbits = acu & 1;
-				goto cbshflg1;
-			case 0x30:	/* SLIA */
-				temp = (acu << 1) | 1;
-				cbits = acu & 0x80;
-				goto cbshflg1;
-			case 0x38:	/* SRL */
-				temp = acu >> 1;
-				cbits = acu & 1;
-			cbshflg1:
-				AF = (AF & ~0xff) | (temp & 0xa8) |
-					(((temp & 0xff) == 0) << 6) |
-					parity(temp) | !!cbits;
-			}
-			break;
-		case 0x40:		/* BIT */
-			if (acu & (1 << ((op >> 3) & 7)))
-				AF = (AF & ~0xfe) | 0x10 |
-				(((op & 0x38) == 0x38) << 7);
-			else
-				AF = (AF & ~0xfe) | 0x54;
-			if ((op&7) != 6)
-				AF |= (acu & 0x28);
-			temp = acu;
-			break;
-		case 0x80:		/* RES */
-			temp = acu & ~(1 << ((op >> 3) & 7));
-			break;
-		case 0xc0:		/* SET */
-			temp = acu | (1 << ((op >> 3) & 7));
-			break;
-		}
-		switch (op & 7) {
-		case 0: Sethreg(BC, temp); break;
-		case 1: Setlreg(BC, temp); break;
-		case 2: Sethreg(DE, temp); break;
-		case 3: Setlreg(DE, temp); break;
-		case 4: Sethreg(HL, temp); break;
-		case 5: Setlreg(HL, temp); break;
-		case 6: PutBYTE(adr, temp);  break;
-		case 7: Sethreg(AF, temp); break;
-		}
-    SAVE_STATE();
-}
+/* prefixed op-codes may move PC anywhere */
+#define BB_NEXT_CHECK							\
+    if ((PC & 0xffff) != ins[1].addr)					\
+	goto bb_enter;							\
+    else								\
+	BB_NEXT
 
-static FASTREG
-dfd_prefix(FASTREG IXY)
+/* go on with the second op-code of a fused pair, unless the first one
+   has thrown the block away */
+#define BB_FUSE_NEXT(op)						\
+    if (ins[1].xop != 0x ## op)						\
+	BB_NEXT;							\
+    ins++;								\
+    PC++
+
+/* every loop goes through a branch, a prefixed op-code or the wrap of
+   PC past 0FFFFH, where simz80_run() checks the cycle budget; code
+   without branches runs round the memory */
+#define WRAP_CHECK() do {						\
+    if (PC > 0xffff)							\
+	goto wrapped;							\
+} while (0)
+
+#define CHECK_NEXT							\
+    if (CYC >= deadline)						\
+	goto expired;							\
+    else								\
+	NEXT
+
+/* a taken branch may enter a cached block, which checks the budget */
+#ifdef OPT_BBCACHE
+#define BRANCH_NEXT	goto bb_enter
+#else
+#define BRANCH_NEXT	CHECK_NEXT
+#endif
+
+/** Run Z80 code until HALT or until a number of T-states have passed.
+    The budget is checked at branches and where PC wraps round, so that
+    it may be exceeded by the length of a basic block.
+    @param[in] cpu        the machine
+    @param[in] PC         Z80 address to start at
+    @param[in] max_cycles T-states to run for
+    @return the address of the HALT instruction, or the PC to continue
+            at with SIMZ80_STOP set
+ */
+FASTWORK
+simz80_run(struct z80_cpu *cpu, FASTREG PC, unsigned long long max_cycles)
 {
-    DECLARE_STATE();
-    FASTWORK temp, adr, acu, op, sum, cbits;
+    unsigned long long CYC = cpu->cycles;
+    unsigned long long deadline = (max_cycles > SIMZ80_FOREVER - CYC) ?
+	SIMZ80_FOREVER : CYC + max_cycles;
+    FASTREG AF = cpu->af[cpu->af_sel];
+    FASTREG BC = cpu->regs[cpu->regs_sel].bc;
+    FASTREG DE = cpu->regs[cpu->regs_sel].de;
+    FASTREG HL = cpu->regs[cpu->regs_sel].hl;
+    FASTREG SP = cpu->sp;
+    FASTREG IX = cpu->ix;
+    FASTREG IY = cpu->iy;
+    FASTWORK temp, acu, sum, cbits;
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK op, adr;
+#ifdef OPT_BBCACHE
+    const struct bb_insn *ins = NULL;
+#endif
+#ifdef OPT_DISPATCH_THREADED
+static void *optab[256] = {
+	&&op_00,&&op_01,&&op_02,&&op_03,&&op_04,&&op_05,&&op_06,&&op_07,
+	&&op_08,&&op_09,&&op_0a,&&op_0b,&&op_0c,&&op_0d,&&op_0e,&&op_0f,
+	&&op_10,&&op_11,&&op_12,&&op_13,&&op_14,&&op_15,&&op_16,&&op_17,
+	&&op_18,&&op_19,&&op_1a,&&op_1b,&&op_1c,&&op_1d,&&op_1e,&&op_1f,
+	&&op_20,&&op_21,&&op_22,&&op_23,&&op_24,&&op_25,&&op_26,&&op_27,
+	&&op_28,&&op_29,&&op_2a,&&op_2b,&&op_2c,&&op_2d,&&op_2e,&&op_2f,
+	&&op_30,&&op_31,&&op_32,&&op_33,&&op_34,&&op_35,&&op_36,&&op_37,
+	&&op_38,&&op_39,&&op_3a,&&op_3b,&&op_3c,&&op_3d,&&op_3e,&&op_3f,
+	&&op_40,&&op_41,&&op_42,&&op_43,&&op_44,&&op_45,&&op_46,&&op_47,
+	&&op_48,&&op_49,&&op_4a,&&op_4b,&&op_4c,&&op_4d,&&op_4e,&&op_4f,
+	&&op_50,&&op_51,&&op_52,&&op_53,&&op_54,&&op_55,&&op_56,&&op_57,
+	&&op_58,&&op_59,&&op_5a,&&op_5b,&&op_5c,&&op_5d,&&op_5e,&&op_5f,
+	&&op_60,&&op_61,&&op_62,&&op_63,&&op_64,&&op_65,&&op_66,&&op_67,
+	&&op_68,&&op_69,&&op_6a,&&op_6b,&&op_6c,&&op_6d,&&op_6e,&&op_6f,
+	&&op_70,&&op_71,&&op_72,&&op_73,&&op_74,&&op_75,&&op_76,&&op_77,
+	&&op_78,&&op_79,&&op_7a,&&op_7b,&&op_7c,&&op_7d,&&op_7e,&&op_7f,
+	&&op_80,&&op_81,&&op_82,&&op_83,&&op_84,&&op_85,&&op_86,&&op_87,
+	&&op_88,&&op_89,&&op_8a,&&op_8b,&&op_8c,&&op_8d,&&op_8e,&&op_8f,
+	&&op_90,&&op_91,&&op_92,&&op_93,&&op_94,&&op_95,&&op_96,&&op_97,
+	&&op_98,&&op_99,&&op_9a,&&op_9b,&&op_9c,&&op_9d,&&op_9e,&&op_9f,
+	&&op_a0,&&op_a1,&&op_a2,&&op_a3,&&op_a4,&&op_a5,&&op_a6,&&op_a7,
+	&&op_a8,&&op_a9,&&op_aa,&&op_ab,&&op_ac,&&op_ad,&&op_ae,&&op_af,
+	&&op_b0,&&op_b1,&&op_b2,&&op_b3,&&op_b4,&&op_b5,&&op_b6,&&op_b7,
+	&&op_b8,&&op_b9,&&op_ba,&&op_bb,&&op_bc,&&op_bd,&&op_be,&&op_bf,
+	&&op_c0,&&op_c1,&&op_c2,&&op_c3,&&op_c4,&&op_c5,&&op_c6,&&op_c7,
+	&&op_c8,&&op_c9,&&op_ca,&&op_cb,&&op_cc,&&op_cd,&&op_ce,&&op_cf,
+	&&op_d0,&&op_d1,&&op_d2,&&op_d3,&&op_d4,&&op_d5,&&op_d6,&&op_d7,
+	&&op_d8,&&op_d9,&&op_da,&&op_db,&&op_dc,&&op_dd,&&op_de,&&op_df,
+	&&op_e0,&&op_e1,&&op_e2,&&op_e3,&&op_e4,&&op_e5,&&op_e6,&&op_e7,
+	&&op_e8,&&op_e9,&&op_ea,&&op_eb,&&op_ec,&&op_ed,&&op_ee,&&op_ef,
+	&&op_f0,&&op_f1,&&op_f2,&&op_f3,&&op_f4,&&op_f5,&&op_f6,&&op_f7,
+	&&op_f8,&&op_f9,&&op_fa,&&op_fb,&&op_fc,&&op_fd,&&op_fe,&&op_ff,
+};
+#ifdef OPT_BBCACHE
+#ifdef OPT_FUSION
+static void *bbtab[273] = {
+	&&bb_op_00,&&bb_op_01,&&bb_op_02,&&bb_op_03,&&bb_op_04,&&bb_op_05,&&bb_op_06,&&bb_op_07,
+	&&bb_op_08,&&bb_op_09,&&bb_op_0a,&&bb_op_0b,&&bb_op_0c,&&bb_op_0d,&&bb_op_0e,&&bb_op_0f,
+	&&bb_op_10,&&bb_op_11,&&bb_op_12,&&bb_op_13,&&bb_op_14,&&bb_op_15,&&bb_op_16,&&bb_op_17,
+	&&bb_op_18,&&bb_op_19,&&bb_op_1a,&&bb_op_1b,&&bb_op_1c,&&bb_op_1d,&&bb_op_1e,&&bb_op_1f,
+	&&bb_op_20,&&bb_op_21,&&bb_op_22,&&bb_op_23,&&bb_op_24,&&bb_op_25,&&bb_op_26,&&bb_op_27,
+	&&bb_op_28,&&bb_op_29,&&bb_op_2a,&&bb_op_2b,&&bb_op_2c,&&bb_op_2d,&&bb_op_2e,&&bb_op_2f,
+	&&bb_op_30,&&bb_op_31,&&bb_op_32,&&bb_op_33,&&bb_op_34,&&bb_op_35,&&bb_op_36,&&bb_op_37,
+	&&bb_op_38,&&bb_op_39,&&bb_op_3a,&&bb_op_3b,&&bb_op_3c,&&bb_op_3d,&&bb_op_3e,&&bb_op_3f,
+	&&bb_op_40,&&bb_op_41,&&bb_op_42,&&bb_op_43,&&bb_op_44,&&bb_op_45,&&bb_op_46,&&bb_op_47,
+	&&bb_op_48,&&bb_op_49,&&bb_op_4a,&&bb_op_4b,&&bb_op_4c,&&bb_op_4d,&&bb_op_4e,&&bb_op_4f,
+	&&bb_op_50,&&bb_op_51,&&bb_op_52,&&bb_op_53,&&bb_op_54,&&bb_op_55,&&bb_op_56,&&bb_op_57,
+	&&bb_op_58,&&bb_op_59,&&bb_op_5a,&&bb_op_5b,&&bb_op_5c,&&bb_op_5d,&&bb_op_5e,&&bb_op_5f,
+	&&bb_op_60,&&bb_op_61,&&bb_op_62,&&bb_op_63,&&bb_op_64,&&bb_op_65,&&bb_op_66,&&bb_op_67,
+	&&bb_op_68,&&bb_op_69,&&bb_op_6a,&&bb_op_6b,&&bb_op_6c,&&bb_op_6d,&&bb_op_6e,&&bb_op_6f,
+	&&bb_op_70,&&bb_op_71,&&bb_op_72,&&bb_op_73,&&bb_op_74,&&bb_op_75,&&bb_op_76,&&bb_op_77,
+	&&bb_op_78,&&bb_op_79,&&bb_op_7a,&&bb_op_7b,&&bb_op_7c,&&bb_op_7d,&&bb_op_7e,&&bb_op_7f,
+	&&bb_op_80,&&bb_op_81,&&bb_op_82,&&bb_op_83,&&bb_op_84,&&bb_op_85,&&bb_op_86,&&bb_op_87,
+	&&bb_op_88,&&bb_op_89,&&bb_op_8a,&&bb_op_8b,&&bb_op_8c,&&bb_op_8d,&&bb_op_8e,&&bb_op_8f,
+	&&bb_op_90,&&bb_op_91,&&bb_op_92,&&bb_op_93,&&bb_op_94,&&bb_op_95,&&bb_op_96,&&bb_op_97,
+	&&bb_op_98,&&bb_op_99,&&bb_op_9a,&&bb_op_9b,&&bb_op_9c,&&bb_op_9d,&&bb_op_9e,&&bb_op_9f,
+	&&bb_op_a0,&&bb_op_a1,&&bb_op_a2,&&bb_op_a3,&&bb_op_a4,&&bb_op_a5,&&bb_op_a6,&&bb_op_a7,
+	&&bb_op_a8,&&bb_op_a9,&&bb_op_aa,&&bb_op_ab,&&bb_op_ac,&&bb_op_ad,&&bb_op_ae,&&bb_op_af,
+	&&bb_op_b0,&&bb_op_b1,&&bb_op_b2,&&bb_op_b3,&&bb_op_b4,&&bb_op_b5,&&bb_op_b6,&&bb_op_b7,
+	&&bb_op_b8,&&bb_op_b9,&&bb_op_ba,&&bb_op_bb,&&bb_op_bc,&&bb_op_bd,&&bb_op_be,&&bb_op_bf,
+	&&bb_op_c0,&&bb_op_c1,&&bb_op_c2,&&bb_op_c3,&&bb_op_c4,&&bb_op_c5,&&bb_op_c6,&&bb_op_c7,
+	&&bb_op_c8,&&bb_op_c9,&&bb_op_ca,&&bb_op_cb,&&bb_op_cc,&&bb_op_cd,&&bb_op_ce,&&bb_op_cf,
+	&&bb_op_d0,&&bb_op_d1,&&bb_op_d2,&&bb_op_d3,&&bb_op_d4,&&bb_op_d5,&&bb_op_d6,&&bb_op_d7,
+	&&bb_op_d8,&&bb_op_d9,&&bb_op_da,&&bb_op_db,&&bb_op_dc,&&bb_op_dd,&&bb_op_de,&&bb_op_df,
+	&&bb_op_e0,&&bb_op_e1,&&bb_op_e2,&&bb_op_e3,&&bb_op_e4,&&bb_op_e5,&&bb_op_e6,&&bb_op_e7,
+	&&bb_op_e8,&&bb_op_e9,&&bb_op_ea,&&bb_op_eb,&&bb_op_ec,&&bb_op_ed,&&bb_op_ee,&&bb_op_ef,
+	&&bb_op_f0,&&bb_op_f1,&&bb_op_f2,&&bb_op_f3,&&bb_op_f4,&&bb_op_f5,&&bb_op_f6,&&bb_op_f7,
+	&&bb_op_f8,&&bb_op_f9,&&bb_op_fa,&&bb_op_fb,&&bb_op_fc,&&bb_op_fd,&&bb_op_fe,&&bb_op_ff,
+	&&bb_op_100,&&bb_op_101,&&bb_op_102,&&bb_op_103,&&bb_op_104,&&bb_op_105,&&bb_op_106,&&bb_op_107,
+	&&bb_op_108,&&bb_op_109,&&bb_op_10a,&&bb_op_10b,&&bb_op_10c,&&bb_op_10d,&&bb_op_10e,&&bb_op_10f,
+	&&bb_op_110,
+};
+#else
+static void *bbtab[257] = {
+	&&bb_op_00,&&bb_op_01,&&bb_op_02,&&bb_op_03,&&bb_op_04,&&bb_op_05,&&bb_op_06,&&bb_op_07,
+	&&bb_op_08,&&bb_op_09,&&bb_op_0a,&&bb_op_0b,&&bb_op_0c,&&bb_op_0d,&&bb_op_0e,&&bb_op_0f,
+	&&bb_op_10,&&bb_op_11,&&bb_op_12,&&bb_op_13,&&bb_op_14,&&bb_op_15,&&bb_op_16,&&bb_op_17,
+	&&bb_op_18,&&bb_op_19,&&bb_op_1a,&&bb_op_1b,&&bb_op_1c,&&bb_op_1d,&&bb_op_1e,&&bb_op_1f,
+	&&bb_op_20,&&bb_op_21,&&bb_op_22,&&bb_op_23,&&bb_op_24,&&bb_op_25,&&bb_op_26,&&bb_op_27,
+	&&bb_op_28,&&bb_op_29,&&bb_op_2a,&&bb_op_2b,&&bb_op_2c,&&bb_op_2d,&&bb_op_2e,&&bb_op_2f,
+	&&bb_op_30,&&bb_op_31,&&bb_op_32,&&bb_op_33,&&bb_op_34,&&bb_op_35,&&bb_op_36,&&bb_op_37,
+	&&bb_op_38,&&bb_op_39,&&bb_op_3a,&&bb_op_3b,&&bb_op_3c,&&bb_op_3d,&&bb_op_3e,&&bb_op_3f,
+	&&bb_op_40,&&bb_op_41,&&bb_op_42,&&bb_op_43,&&bb_op_44,&&bb_op_45,&&bb_op_46,&&bb_op_47,
+	&&bb_op_48,&&bb_op_49,&&bb_op_4a,&&bb_op_4b,&&bb_op_4c,&&bb_op_4d,&&bb_op_4e,&&bb_op_4f,
+	&&bb_op_50,&&bb_op_51,&&bb_op_52,&&bb_op_53,&&bb_op_54,&&bb_op_55,&&bb_op_56,&&bb_op_57,
+	&&bb_op_58,&&bb_op_59,&&bb_op_5a,&&bb_op_5b,&&bb_op_5c,&&bb_op_5d,&&bb_op_5e,&&bb_op_5f,
+	&&bb_op_60,&&bb_op_61,&&bb_op_62,&&bb_op_63,&&bb_op_64,&&bb_op_65,&&bb_op_66,&&bb_op_67,
+	&&bb_op_68,&&bb_op_69,&&bb_op_6a,&&bb_op_6b,&&bb_op_6c,&&bb_op_6d,&&bb_op_6e,&&bb_op_6f,
+	&&bb_op_70,&&bb_op_71,&&bb_op_72,&&bb_op_73,&&bb_op_74,&&bb_op_75,&&bb_op_76,&&bb_op_77,
+	&&bb_op_78,&&bb_op_79,&&bb_op_7a,&&bb_op_7b,&&bb_op_7c,&&bb_op_7d,&&bb_op_7e,&&bb_op_7f,
+	&&bb_op_80,&&bb_op_81,&&bb_op_82,&&bb_op_83,&&bb_op_84,&&bb_op_85,&&bb_op_86,&&bb_op_87,
+	&&bb_op_88,&&bb_op_89,&&bb_op_8a,&&bb_op_8b,&&bb_op_8c,&&bb_op_8d,&&bb_op_8e,&&bb_op_8f,
+	&&bb_op_90,&&bb_op_91,&&bb_op_92,&&bb_op_93,&&bb_op_94,&&bb_op_95,&&bb_op_96,&&bb_op_97,
+	&&bb_op_98,&&bb_op_99,&&bb_op_9a,&&bb_op_9b,&&bb_op_9c,&&bb_op_9d,&&bb_op_9e,&&bb_op_9f,
+	&&bb_op_a0,&&bb_op_a1,&&bb_op_a2,&&bb_op_a3,&&bb_op_a4,&&bb_op_a5,&&bb_op_a6,&&bb_op_a7,
+	&&bb_op_a8,&&bb_op_a9,&&bb_op_aa,&&bb_op_ab,&&bb_op_ac,&&bb_op_ad,&&bb_op_ae,&&bb_op_af,
+	&&bb_op_b0,&&bb_op_b1,&&bb_op_b2,&&bb_op_b3,&&bb_op_b4,&&bb_op_b5,&&bb_op_b6,&&bb_op_b7,
+	&&bb_op_b8,&&bb_op_b9,&&bb_op_ba,&&bb_op_bb,&&bb_op_bc,&&bb_op_bd,&&bb_op_be,&&bb_op_bf,
+	&&bb_op_c0,&&bb_op_c1,&&bb_op_c2,&&bb_op_c3,&&bb_op_c4,&&bb_op_c5,&&bb_op_c6,&&bb_op_c7,
+	&&bb_op_c8,&&bb_op_c9,&&bb_op_ca,&&bb_op_cb,&&bb_op_cc,&&bb_op_cd,&&bb_op_ce,&&bb_op_cf,
+	&&bb_op_d0,&&bb_op_d1,&&bb_op_d2,&&bb_op_d3,&&bb_op_d4,&&bb_op_d5,&&bb_op_d6,&&bb_op_d7,
+	&&bb_op_d8,&&bb_op_d9,&&bb_op_da,&&bb_op_db,&&bb_op_dc,&&bb_op_dd,&&bb_op_de,&&bb_op_df,
+	&&bb_op_e0,&&bb_op_e1,&&bb_op_e2,&&bb_op_e3,&&bb_op_e4,&&bb_op_e5,&&bb_op_e6,&&bb_op_e7,
+	&&bb_op_e8,&&bb_op_e9,&&bb_op_ea,&&bb_op_eb,&&bb_op_ec,&&bb_op_ed,&&bb_op_ee,&&bb_op_ef,
+	&&bb_op_f0,&&bb_op_f1,&&bb_op_f2,&&bb_op_f3,&&bb_op_f4,&&bb_op_f5,&&bb_op_f6,&&bb_op_f7,
+	&&bb_op_f8,&&bb_op_f9,&&bb_op_fa,&&bb_op_fb,&&bb_op_fc,&&bb_op_fd,&&bb_op_fe,&&bb_op_ff,
+	&&bb_op_100,
+};
+#endif
+#endif
+#endif
 
-		switch (op = GetBYTE(PC++)) {
-		case 0x09:			/* ADD IXY,BC */
-			IXY &= 0xffff;
-			BC &= 0xffff;
-			sum = IXY + BC;
-			cbits = (IXY ^ BC ^ sum) >> 8;
-			IXY = sum;
-			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
-				(cbits & 0x10) | ((cbits >> 8) & 1);
-			break;
-		case 0x19:			/* ADD IXY,DE */
-			IXY &= 0xffff;
-			DE &= 0xffff;
-			sum = IXY + DE;
-			cbits = (IXY ^ DE ^ sum) >> 8;
-			IXY = sum;
-			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
-				(cbits & 0x10) | ((cbits >> 8) & 1);
-			break;
-		case 0x21:			/* LD IXY,nnnn */
-			IXY = GetWORD(PC);
-			PC += 2;
-			break;
-		case 0x22:			/* LD (nnnn),IXY */
-			temp = GetWORD(PC);
-			PutWORD(temp, IXY);
-			PC += 2;
-			break;
-		case 0x23:			/* INC IXY */
-			++IXY;
-			break;
-		case 0x24:			/* INC IXYH */
-			IXY += 0x100;
-			temp = hreg(IXY);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				(((temp & 0xf) == 0) << 4) |
-				((temp == 0x80) << 2);
-			break;
-		case 0x25:			/* DEC IXYH */
-			IXY -= 0x100;
-			temp = hreg(IXY);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				(((temp & 0xf) == 0xf) << 4) |
-				((temp == 0x7f) << 2) | 2;
-			break;
-		case 0x26:			/* LD IXYH,nn */
-			Sethreg(IXY, GetBYTE(PC++));
-			break;
-		case 0x29:			/* ADD IXY,IXY */
-			IXY &= 0xffff;
-			sum = IXY + IXY;
-			cbits = (IXY ^ IXY ^ sum) >> 8;
-			IXY = sum;
-			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
-				(cbits & 0x10) | ((cbits >> 8) & 1);
-			break;
-		case 0x2A:			/* LD IXY,(nnnn) */
-			temp = GetWORD(PC);
-			IXY = GetWORD(temp);
-			PC += 2;
-			break;
-		case 0x2B:			/* DEC IXY */
-			--IXY;
-			break;
-		case 0x2C:			/* INC IXYL */
-			temp = lreg(IXY)+1;
-			Setlreg(IXY, temp);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				(((temp & 0xf) == 0) << 4) |
-				((temp == 0x80) << 2);
-			break;
-		case 0x2D:			/* DEC IXYL */
-			temp = lreg(IXY)-1;
-			Setlreg(IXY, temp);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				(((temp & 0xf) == 0xf) << 4) |
-				((temp == 0x7f) << 2) | 2;
-			break;
-		case 0x2E:			/* LD IXYL,nn */
-			Setlreg(IXY, GetBYTE(PC++));
-			break;
-		case 0x34:			/* INC (IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			temp = GetBYTE(adr)+1;
-			PutBYTE(adr, temp);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				(((temp & 0xf) == 0) << 4) |
-				((temp == 0x80) << 2);
-			break;
-		case 0x35:			/* DEC (IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			temp = GetBYTE(adr)-1;
-			PutBYTE(adr, temp);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				(((temp & 0xf) == 0xf) << 4) |
-				((temp == 0x7f) << 2) | 2;
-			break;
-		case 0x36:			/* LD (IXY+dd),nn */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			PutBYTE(adr, GetBYTE(PC++));
-			break;
-		case 0x39:			/* ADD IXY,SP */
-			IXY &= 0xffff;
-			SP &= 0xffff;
-			sum = IXY + SP;
-			cbits = (IXY ^ SP ^ sum) >> 8;
-			IXY = sum;
-			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
-				(cbits & 0x10) | ((cbits >> 8) & 1);
-			break;
-		case 0x44:			/* LD B,IXYH */
-			Sethreg(BC, hreg(IXY));
-			break;
-		case 0x45:			/* LD B,IXYL */
-			Sethreg(BC, lreg(IXY));
-			break;
-		case 0x46:			/* LD B,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			Sethreg(BC, GetBYTE(adr));
-			break;
-		case 0x4C:			/* LD C,IXYH */
-			Setlreg(BC, hreg(IXY));
-			break;
-		case 0x4D:			/* LD C,IXYL */
-			Setlreg(BC, lreg(IXY));
-			break;
-		case 0x4E:			/* LD C,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			Setlreg(BC, GetBYTE(adr));
-			break;
-		case 0x54:			/* LD D,IXYH */
-			Sethreg(DE, hreg(IXY));
-			break;
-		case 0x55:			/* LD D,IXYL */
-			Sethreg(DE, lreg(IXY));
-			break;
-		case 0x56:			/* LD D,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			Sethreg(DE, GetBYTE(adr));
-			break;
-		case 0x5C:			/* LD E,H */
-			Setlreg(DE, hreg(IXY));
-			break;
-		case 0x5D:			/* LD E,L */
-			Setlreg(DE, lreg(IXY));
-			break;
-		case 0x5E:			/* LD E,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			Setlreg(DE, GetBYTE(adr));
-			break;
-		case 0x60:			/* LD IXYH,B */
-			Sethreg(IXY, hreg(BC));
-			break;
-		case 0x61:			/* LD IXYH,C */
-			Sethreg(IXY, lreg(BC));
-			break;
-		case 0x62:			/* LD IXYH,D */
-			Sethreg(IXY, hreg(DE));
-			break;
-		case 0x63:			/* LD IXYH,E */
-			Sethreg(IXY, lreg(DE));
-			break;
-		case 0x64:			/* LD IXYH,IXYH */
-			/* nop */
-			break;
-		case 0x65:			/* LD IXYH,IXYL */
-			Sethreg(IXY, lreg(IXY));
-			break;
-		case 0x66:			/* LD H,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			Sethreg(HL, GetBYTE(adr));
-			break;
-		case 0x67:			/* LD IXYH,A */
-			Sethreg(IXY, hreg(AF));
-			break;
-		case 0x68:			/* LD IXYL,B */
-			Setlreg(IXY, hreg(BC));
-			break;
-		case 0x69:			/* LD IXYL,C */
-			Setlreg(IXY, lreg(BC));
-			break;
-		case 0x6A:			/* LD IXYL,D */
-			Setlreg(IXY, hreg(DE));
-			break;
-		case 0x6B:			/* LD IXYL,E */
-			Setlreg(IXY, lreg(DE));
-			break;
-		case 0x6C:			/* LD IXYL,IXYH */
-			Setlreg(IXY, hreg(IXY));
-			break;
-		case 0x6D:			/* LD IXYL,IXYL */
-			/* nop */
-			break;
-		case 0x6E:			/* LD L,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			Setlreg(HL, GetBYTE(adr));
-			break;
-		case 0x6F:			/* LD IXYL,A */
-			Setlreg(IXY, hreg(AF));
-			break;
-		case 0x70:			/* LD (IXY+dd),B */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			PutBYTE(adr, hreg(BC));
-			break;
-		case 0x71:			/* LD (IXY+dd),C */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			PutBYTE(adr, lreg(BC));
-			break;
-		case 0x72:			/* LD (IXY+dd),D */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			PutBYTE(adr, hreg(DE));
-			break;
-		case 0x73:			/* LD (IXY+dd),E */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			PutBYTE(adr, lreg(DE));
-			break;
-		case 0x74:			/* LD (IXY+dd),H */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			PutBYTE(adr, hreg(HL));
-			break;
-		case 0x75:			/* LD (IXY+dd),L */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			PutBYTE(adr, lreg(HL));
-			break;
-		case 0x77:			/* LD (IXY+dd),A */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			PutBYTE(adr, hreg(AF));
-			break;
-		case 0x7C:			/* LD A,IXYH */
-			Sethreg(AF, hreg(IXY));
-			break;
-		case 0x7D:			/* LD A,IXYL */
-			Sethreg(AF, lreg(IXY));
-			break;
-		case 0x7E:			/* LD A,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			Sethreg(AF, GetBYTE(adr));
-			break;
-		case 0x84:			/* ADD A,IXYH */
-			temp = hreg(IXY);
-			acu = hreg(AF);
-			sum = acu + temp;
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				((cbits >> 8) & 1);
-			break;
-		case 0x85:			/* ADD A,IXYL */
-			temp = lreg(IXY);
-			acu = hreg(AF);
-			sum = acu + temp;
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				((cbits >> 8) & 1);
-			break;
-		case 0x86:			/* ADD A,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			temp = GetBYTE(adr);
-			acu = hreg(AF);
-			sum = acu + temp;
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				((cbits >> 8) & 1);
-			break;
-		case 0x8C:			/* ADC A,IXYH */
-			temp = hreg(IXY);
-			acu = hreg(AF);
-			sum = acu + temp + TSTFLAG(C);
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				((cbits >> 8) & 1);
-			break;
-		case 0x8D:			/* ADC A,IXYL */
-			temp = lreg(IXY);
-			acu = hreg(AF);
-			sum = acu + temp + TSTFLAG(C);
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				((cbits >> 8) & 1);
-			break;
-		case 0x8E:			/* ADC A,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			temp = GetBYTE(adr);
-			acu = hreg(AF);
-			sum = acu + temp + TSTFLAG(C);
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				((cbits >> 8) & 1);
-			break;
-		case 0x94:			/* SUB IXYH */
-			temp = hreg(IXY);
-			acu = hreg(AF);
-			sum = acu - temp;
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-				((cbits >> 8) & 1);
-			break;
-		case 0x95:			/* SUB IXYL */
-			temp = lreg(IXY);
-			acu = hreg(AF);
-			sum = acu - temp;
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-				((cbits >> 8) & 1);
-			break;
-		case 0x96:			/* SUB (IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			temp = GetBYTE(adr);
-			acu = hreg(AF);
-			sum = acu - temp;
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-				((cbits >> 8) & 1);
-			break;
-		case 0x9C:			/* SBC A,IXYH */
-			temp = hreg(IXY);
-			acu = hreg(AF);
-			sum = acu - temp - TSTFLAG(C);
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-				((cbits >> 8) & 1);
-			break;
-		case 0x9D:			/* SBC A,IXYL */
-			temp = lreg(IXY);
-			acu = hreg(AF);
-			sum = acu - temp - TSTFLAG(C);
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-				((cbits >> 8) & 1);
-			break;
-		case 0x9E:			/* SBC A,(IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			temp = GetBYTE(adr);
-			acu = hreg(AF);
-			sum = acu - temp - TSTFLAG(C);
-			cbits = acu ^ temp ^ sum;
-			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-				((cbits >> 8) & 1);
-			break;
-		case 0xA4:			/* AND IXYH */
-			sum = ((AF & (IXY)) >> 8) & 0xff;
-			AF = (sum << 8) | (sum & 0xa8) |
-				((sum == 0) << 6) | 0x10 | partab[sum];
-			break;
-		case 0xA5:			/* AND IXYL */
-			sum = ((AF >> 8) & IXY) & 0xff;
-			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
-				((sum == 0) << 6) | partab[sum];
-			break;
-		case 0xA6:			/* AND (IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			sum = ((AF >> 8) & GetBYTE(adr)) & 0xff;
-			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
-				((sum == 0) << 6) | partab[sum];
-			break;
-		case 0xAC:			/* XOR IXYH */
-			sum = ((AF ^ (IXY)) >> 8) & 0xff;
-			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-			break;
-		case 0xAD:			/* XOR IXYL */
-			sum = ((AF >> 8) ^ IXY) & 0xff;
-			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-			break;
-		case 0xAE:			/* XOR (IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			sum = ((AF >> 8) ^ GetBYTE(adr)) & 0xff;
-			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-			break;
-		case 0xB4:			/* OR IXYH */
-			sum = ((AF | (IXY)) >> 8) & 0xff;
-			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-			break;
-		case 0xB5:			/* OR IXYL */
-			sum = ((AF >> 8) | IXY) & 0xff;
-			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-			break;
-		case 0xB6:			/* OR (IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			sum = ((AF >> 8) | GetBYTE(adr)) & 0xff;
-			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-			break;
-		case 0xBC:			/* CP IXYH */
-			temp = hreg(IXY);
-			AF = (AF & ~0x28) | (temp & 0x28);
-			acu = hreg(AF);
-			sum = acu - temp;
-			cbits = acu ^ temp ^ sum;
-			AF = (AF & ~0xff) | (sum & 0x80) |
-				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-				(cbits & 0x10) | ((cbits >> 8) & 1);
-			break;
-		case 0xBD:			/* CP IXYL */
-			temp = lreg(IXY);
-			AF = (AF & ~0x28) | (temp & 0x28);
-			acu = hreg(AF);
-			sum = acu - temp;
-			cbits = acu ^ temp ^ sum;
-			AF = (AF & ~0xff) | (sum & 0x80) |
-				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-				(cbits & 0x10) | ((cbits >> 8) & 1);
-			break;
-		case 0xBE:			/* CP (IXY+dd) */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			temp = GetBYTE(adr);
-			AF = (AF & ~0x28) | (temp & 0x28);
-			acu = hreg(AF);
-			sum = acu - temp;
-			cbits = acu ^ temp ^ sum;
-			AF = (AF & ~0xff) | (sum & 0x80) |
-				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-				(cbits & 0x10) | ((cbits >> 8) & 1);
-			break;
-		case 0xCB:			/* CB prefix */
-			adr = IXY + (signed char) GetBYTE(PC++);
-			SAVE_STATE();
-			cb_prefix(adr);
-			LOAD_STATE();
-			break;
-		case 0xE1:			/* POP IXY */
-			POP(IXY);
-			break;
-		case 0xE3:			/* EX (SP),IXY */
-			temp = IXY; POP(IXY); PUSH(temp);
-			break;
-		case 0xE5:			/* PUSH IXY */
-			PUSH(IXY);
-			break;
-		case 0xE9:			/* JP (IXY) */
-			PC = IXY;
-			break;
-		case 0xF9:			/* LD SP,IXY */
-			SP = IXY;
-			break;
-		default: PC--;		/* ignore DD */
-		}
-    SAVE_STATE();
-    return(IXY);
-}
-
-FASTWORK
-simz80(FASTREG PC)
-{
-    FASTREG AF = af[af_sel];
-    FASTREG BC = regs[regs_sel].bc;
-    FASTREG DE = regs[regs_sel].de;
-    FASTREG HL = regs[regs_sel].hl;
-    FASTREG SP = sp;
-    FASTWORK temp, acu, sum, cbits;
-    FASTWORK op, adr;
+#ifdef OPT_BBCACHE
+    goto bb_enter;
+#endif
 
 #ifdef DEBUG
     while (!stopsim) {
 #else
     while (1) {
 #endif
-    switch(RAM(PC++)) {
-	case 0x00:			/* NOP */
-		break;
-	case 0x01:			/* LD BC,nnnn */
+#ifdef OPT_BBCACHE
+bb_interp:
+#endif
+dispatch:
+    DISPATCH() {
+	OPCODE(00):			/* NOP */
+		CYCLES(z80_cc_op[0x00]);
+		NEXT;
+	OPCODE(01):			/* LD BC,nnnn */
+		CYCLES(z80_cc_op[0x01]);
 		BC = GetWORD(PC);
 		PC += 2;
-		break;
-	case 0x02:			/* LD (BC),A */
+		NEXT;
+	OPCODE(02):			/* LD (BC),A */
+		CYCLES(z80_cc_op[0x02]);
 		PutBYTE(BC, hreg(AF));
-		break;
-	case 0x03:			/* INC BC */
+		NEXT;
+	OPCODE(03):			/* INC BC */
+		CYCLES(z80_cc_op[0x03]);
 		++BC;
-		break;
-	case 0x04:			/* INC B */
+		NEXT;
+	OPCODE(04):			/* INC B */
+		CYCLES(z80_cc_op[0x04]);
 		BC += 0x100;
 		temp = hreg(BC);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0) << 4) |
 			((temp == 0x80) << 2);
-		break;
-	case 0x05:			/* DEC B */
+#endif
+		NEXT;
+	OPCODE(05):			/* DEC B */
+		CYCLES(z80_cc_op[0x05]);
 		BC -= 0x100;
 		temp = hreg(BC);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0xf) << 4) |
 			((temp == 0x7f) << 2) | 2;
-		break;
-	case 0x06:			/* LD B,nn */
+#endif
+		NEXT;
+	OPCODE(06):			/* LD B,nn */
+		CYCLES(z80_cc_op[0x06]);
 		Sethreg(BC, GetBYTE(PC++));
-		break;
-	case 0x07:			/* RLCA */
+		NEXT;
+	OPCODE(07):			/* RLCA */
+		CYCLES(z80_cc_op[0x07]);
+		SYNC_FLAGS();
 		AF = ((AF >> 7) & 0x0128) | ((AF << 1) & ~0x1ff) |
 			(AF & 0xc4) | ((AF >> 15) & 1);
-		break;
-	case 0x08:			/* EX AF,AF' */
-		af[af_sel] = AF;
-		af_sel = 1 - af_sel;
-		AF = af[af_sel];
-		break;
-	case 0x09:			/* ADD HL,BC */
+		NEXT;
+	OPCODE(08):			/* EX AF,AF' */
+		CYCLES(z80_cc_op[0x08]);
+		SYNC_FLAGS();
+		cpu->af[cpu->af_sel] = AF;
+		cpu->af_sel = 1 - cpu->af_sel;
+		AF = cpu->af[cpu->af_sel];
+		NEXT;
+	OPCODE(09):			/* ADD HL,BC */
+		CYCLES(z80_cc_op[0x09]);
 		HL &= 0xffff;
 		BC &= 0xffff;
 		sum = HL + BC;
 		cbits = (HL ^ BC ^ sum) >> 8;
 		HL = sum;
+		SYNC_FLAGS();
 		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0x0A:			/* LD A,(BC) */
+		NEXT;
+	OPCODE(0a):			/* LD A,(BC) */
+		CYCLES(z80_cc_op[0x0a]);
 		Sethreg(AF, GetBYTE(BC));
-		break;
-	case 0x0B:			/* DEC BC */
+		NEXT;
+	OPCODE(0b):			/* DEC BC */
+		CYCLES(z80_cc_op[0x0b]);
 		--BC;
-		break;
-	case 0x0C:			/* INC C */
+		NEXT;
+	OPCODE(0c):			/* INC C */
+		CYCLES(z80_cc_op[0x0c]);
 		temp = lreg(BC)+1;
 		Setlreg(BC, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0) << 4) |
 			((temp == 0x80) << 2);
-		break;
-	case 0x0D:			/* DEC C */
+#endif
+		NEXT;
+	OPCODE(0d):			/* DEC C */
+		CYCLES(z80_cc_op[0x0d]);
 		temp = lreg(BC)-1;
 		Setlreg(BC, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0xf) << 4) |
 			((temp == 0x7f) << 2) | 2;
-		break;
-	case 0x0E:			/* LD C,nn */
+#endif
+		NEXT;
+	OPCODE(0e):			/* LD C,nn */
+		CYCLES(z80_cc_op[0x0e]);
 		Setlreg(BC, GetBYTE(PC++));
-		break;
-	case 0x0F:			/* RRCA */
+		NEXT;
+	OPCODE(0f):			/* RRCA */
+		CYCLES(z80_cc_op[0x0f]);
+		SYNC_FLAGS();
 		temp = hreg(AF);
 		sum = temp >> 1;
 		AF = ((temp & 1) << 15) | (sum << 8) |
 			(sum & 0x28) | (AF & 0xc4) | (temp & 1);
-		break;
-	case 0x10:			/* DJNZ dd */
-		PC += ((BC -= 0x100) & 0xff00) ? (signed char) GetBYTE(PC) + 1 : 1;
-		break;
-	case 0x11:			/* LD DE,nnnn */
+		NEXT;
+	OPCODE(10):			/* DJNZ dd */
+		CYCLES(z80_cc_op[0x10]);
+		JRC((BC -= 0x100) & 0xff00);
+		BRANCH_NEXT;
+	OPCODE(11):			/* LD DE,nnnn */
+		CYCLES(z80_cc_op[0x11]);
 		DE = GetWORD(PC);
 		PC += 2;
-		break;
-	case 0x12:			/* LD (DE),A */
+		NEXT;
+	OPCODE(12):			/* LD (DE),A */
+		CYCLES(z80_cc_op[0x12]);
 		PutBYTE(DE, hreg(AF));
-		break;
-	case 0x13:			/* INC DE */
+		NEXT;
+	OPCODE(13):			/* INC DE */
+		CYCLES(z80_cc_op[0x13]);
 		++DE;
-		break;
-	case 0x14:			/* INC D */
+		NEXT;
+	OPCODE(14):			/* INC D */
+		CYCLES(z80_cc_op[0x14]);
 		DE += 0x100;
 		temp = hreg(DE);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0) << 4) |
 			((temp == 0x80) << 2);
-		break;
-	case 0x15:			/* DEC D */
+#endif
+		NEXT;
+	OPCODE(15):			/* DEC D */
+		CYCLES(z80_cc_op[0x15]);
 		DE -= 0x100;
 		temp = hreg(DE);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0xf) << 4) |
 			((temp == 0x7f) << 2) | 2;
-		break;
-	case 0x16:			/* LD D,nn */
+#endif
+		NEXT;
+	OPCODE(16):			/* LD D,nn */
+		CYCLES(z80_cc_op[0x16]);
 		Sethreg(DE, GetBYTE(PC++));
-		break;
-	case 0x17:			/* RLA */
+		NEXT;
+	OPCODE(17):			/* RLA */
+		CYCLES(z80_cc_op[0x17]);
+		SYNC_FLAGS();
 		AF = ((AF << 8) & 0x0100) | ((AF >> 7) & 0x28) | ((AF << 1) & ~0x01ff) |
 			(AF & 0xc4) | ((AF >> 15) & 1);
-		break;
-	case 0x18:			/* JR dd */
-		PC += (1) ? (signed char) GetBYTE(PC) + 1 : 1;
-		break;
-	case 0x19:			/* ADD HL,DE */
+		NEXT;
+	OPCODE(18):			/* JR dd */
+		CYCLES(z80_cc_op[0x18]);
+		PC += (signed char) GetBYTE(PC) + 1;
+		BRANCH_NEXT;
+	OPCODE(19):			/* ADD HL,DE */
+		CYCLES(z80_cc_op[0x19]);
 		HL &= 0xffff;
 		DE &= 0xffff;
 		sum = HL + DE;
 		cbits = (HL ^ DE ^ sum) >> 8;
 		HL = sum;
+		SYNC_FLAGS();
 		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0x1A:			/* LD A,(DE) */
+		NEXT;
+	OPCODE(1a):			/* LD A,(DE) */
+		CYCLES(z80_cc_op[0x1a]);
 		Sethreg(AF, GetBYTE(DE));
-		break;
-	case 0x1B:			/* DEC DE */
+		NEXT;
+	OPCODE(1b):			/* DEC DE */
+		CYCLES(z80_cc_op[0x1b]);
 		--DE;
-		break;
-	case 0x1C:			/* INC E */
+		NEXT;
+	OPCODE(1c):			/* INC E */
+		CYCLES(z80_cc_op[0x1c]);
 		temp = lreg(DE)+1;
 		Setlreg(DE, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0) << 4) |
 			((temp == 0x80) << 2);
-		break;
-	case 0x1D:			/* DEC E */
+#endif
+		NEXT;
+	OPCODE(1d):			/* DEC E */
+		CYCLES(z80_cc_op[0x1d]);
 		temp = lreg(DE)-1;
 		Setlreg(DE, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0xf) << 4) |
 			((temp == 0x7f) << 2) | 2;
-		break;
-	case 0x1E:			/* LD E,nn */
+#endif
+		NEXT;
+	OPCODE(1e):			/* LD E,nn */
+		CYCLES(z80_cc_op[0x1e]);
 		Setlreg(DE, GetBYTE(PC++));
-		break;
-	case 0x1F:			/* RRA */
+		NEXT;
+	OPCODE(1f):			/* RRA */
+		CYCLES(z80_cc_op[0x1f]);
+		SYNC_FLAGS();
 		temp = hreg(AF);
 		sum = temp >> 1;
 		AF = ((AF & 1) << 15) | (sum << 8) |
 			(sum & 0x28) | (AF & 0xc4) | (temp & 1);
-		break;
-	case 0x20:			/* JR NZ,dd */
-		PC += (!TSTFLAG(Z)) ? (signed char) GetBYTE(PC) + 1 : 1;
-		break;
-	case 0x21:			/* LD HL,nnnn */
+		NEXT;
+	OPCODE(20):			/* JR NZ,dd */
+		CYCLES(z80_cc_op[0x20]);
+		JRC(!TSTFLAG(Z));
+		BRANCH_NEXT;
+	OPCODE(21):			/* LD HL,nnnn */
+		CYCLES(z80_cc_op[0x21]);
 		HL = GetWORD(PC);
 		PC += 2;
-		break;
-	case 0x22:			/* LD (nnnn),HL */
+		NEXT;
+	OPCODE(22):			/* LD (nnnn),HL */
+		CYCLES(z80_cc_op[0x22]);
 		temp = GetWORD(PC);
 		PutWORD(temp, HL);
 		PC += 2;
-		break;
-	case 0x23:			/* INC HL */
+		NEXT;
+	OPCODE(23):			/* INC HL */
+		CYCLES(z80_cc_op[0x23]);
 		++HL;
-		break;
-	case 0x24:			/* INC H */
+		NEXT;
+	OPCODE(24):			/* INC H */
+		CYCLES(z80_cc_op[0x24]);
 		HL += 0x100;
 		temp = hreg(HL);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0) << 4) |
 			((temp == 0x80) << 2);
-		break;
-	case 0x25:			/* DEC H */
+#endif
+		NEXT;
+	OPCODE(25):			/* DEC H */
+		CYCLES(z80_cc_op[0x25]);
 		HL -= 0x100;
 		temp = hreg(HL);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0xf) << 4) |
 			((temp == 0x7f) << 2) | 2;
-		break;
-	case 0x26:			/* LD H,nn */
+#endif
+		NEXT;
+	OPCODE(26):			/* LD H,nn */
+		CYCLES(z80_cc_op[0x26]);
 		Sethreg(HL, GetBYTE(PC++));
-		break;
-	case 0x27:			/* DAA */
+		NEXT;
+	OPCODE(27):			/* DAA */
+		CYCLES(z80_cc_op[0x27]);
+		SYNC_FLAGS();
 		acu = hreg(AF);
 		temp = ldig(acu);
 		cbits = TSTFLAG(C);
@@ -909,1481 +983,16006 @@ simz80(FASTREG PC)
 		acu &= 0xff;
 		AF = (acu << 8) | (acu & 0xa8) | ((acu == 0) << 6) |
 			(AF & 0x12) | partab[acu] | cbits;
-		break;
-	case 0x28:			/* JR Z,dd */
-		PC += (TSTFLAG(Z)) ? (signed char) GetBYTE(PC) + 1 : 1;
-		break;
-	case 0x29:			/* ADD HL,HL */
+		NEXT;
+	OPCODE(28):			/* JR Z,dd */
+		CYCLES(z80_cc_op[0x28]);
+		JRC(TSTFLAG(Z));
+		BRANCH_NEXT;
+	OPCODE(29):			/* ADD HL,HL */
+		CYCLES(z80_cc_op[0x29]);
 		HL &= 0xffff;
 		sum = HL + HL;
 		cbits = (HL ^ HL ^ sum) >> 8;
 		HL = sum;
+		SYNC_FLAGS();
 		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0x2A:			/* LD HL,(nnnn) */
+		NEXT;
+	OPCODE(2a):			/* LD HL,(nnnn) */
+		CYCLES(z80_cc_op[0x2a]);
 		temp = GetWORD(PC);
 		HL = GetWORD(temp);
 		PC += 2;
-		break;
-	case 0x2B:			/* DEC HL */
+		NEXT;
+	OPCODE(2b):			/* DEC HL */
+		CYCLES(z80_cc_op[0x2b]);
 		--HL;
-		break;
-	case 0x2C:			/* INC L */
+		NEXT;
+	OPCODE(2c):			/* INC L */
+		CYCLES(z80_cc_op[0x2c]);
 		temp = lreg(HL)+1;
 		Setlreg(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0) << 4) |
 			((temp == 0x80) << 2);
-		break;
-	case 0x2D:			/* DEC L */
+#endif
+		NEXT;
+	OPCODE(2d):			/* DEC L */
+		CYCLES(z80_cc_op[0x2d]);
 		temp = lreg(HL)-1;
 		Setlreg(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0xf) << 4) |
 			((temp == 0x7f) << 2) | 2;
-		break;
-	case 0x2E:			/* LD L,nn */
+#endif
+		NEXT;
+	OPCODE(2e):			/* LD L,nn */
+		CYCLES(z80_cc_op[0x2e]);
 		Setlreg(HL, GetBYTE(PC++));
-		break;
-	case 0x2F:			/* CPL */
+		NEXT;
+	OPCODE(2f):			/* CPL */
+		CYCLES(z80_cc_op[0x2f]);
+		SYNC_FLAGS();
 		AF = (~AF & ~0xff) | (AF & 0xc5) | ((~AF >> 8) & 0x28) | 0x12;
-		break;
-	case 0x30:			/* JR NC,dd */
-		PC += (!TSTFLAG(C)) ? (signed char) GetBYTE(PC) + 1 : 1;
-		break;
-	case 0x31:			/* LD SP,nnnn */
+		NEXT;
+	OPCODE(30):			/* JR NC,dd */
+		CYCLES(z80_cc_op[0x30]);
+		JRC(!TSTFLAG(C));
+		BRANCH_NEXT;
+	OPCODE(31):			/* LD SP,nnnn */
+		CYCLES(z80_cc_op[0x31]);
 		SP = GetWORD(PC);
 		PC += 2;
-		break;
-	case 0x32:			/* LD (nnnn),A */
+		NEXT;
+	OPCODE(32):			/* LD (nnnn),A */
+		CYCLES(z80_cc_op[0x32]);
 		temp = GetWORD(PC);
 		PutBYTE(temp, hreg(AF));
 		PC += 2;
-		break;
-	case 0x33:			/* INC SP */
+		NEXT;
+	OPCODE(33):			/* INC SP */
+		CYCLES(z80_cc_op[0x33]);
 		++SP;
-		break;
-	case 0x34:			/* INC (HL) */
+		NEXT;
+	OPCODE(34):			/* INC (HL) */
+		CYCLES(z80_cc_op[0x34]);
 		temp = GetBYTE(HL)+1;
 		PutBYTE(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0) << 4) |
 			((temp == 0x80) << 2);
-		break;
-	case 0x35:			/* DEC (HL) */
+#endif
+		NEXT;
+	OPCODE(35):			/* DEC (HL) */
+		CYCLES(z80_cc_op[0x35]);
 		temp = GetBYTE(HL)-1;
 		PutBYTE(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0xf) << 4) |
 			((temp == 0x7f) << 2) | 2;
-		break;
-	case 0x36:			/* LD (HL),nn */
+#endif
+		NEXT;
+	OPCODE(36):			/* LD (HL),nn */
+		CYCLES(z80_cc_op[0x36]);
 		PutBYTE(HL, GetBYTE(PC++));
-		break;
-	case 0x37:			/* SCF */
+		NEXT;
+	OPCODE(37):			/* SCF */
+		CYCLES(z80_cc_op[0x37]);
+		SYNC_FLAGS();
 		AF = (AF&~0x3b)|((AF>>8)&0x28)|1;
-		break;
-	case 0x38:			/* JR C,dd */
-		PC += (TSTFLAG(C)) ? (signed char) GetBYTE(PC) + 1 : 1;
-		break;
-	case 0x39:			/* ADD HL,SP */
+		NEXT;
+	OPCODE(38):			/* JR C,dd */
+		CYCLES(z80_cc_op[0x38]);
+		JRC(TSTFLAG(C));
+		BRANCH_NEXT;
+	OPCODE(39):			/* ADD HL,SP */
+		CYCLES(z80_cc_op[0x39]);
 		HL &= 0xffff;
 		SP &= 0xffff;
 		sum = HL + SP;
 		cbits = (HL ^ SP ^ sum) >> 8;
 		HL = sum;
+		SYNC_FLAGS();
 		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0x3A:			/* LD A,(nnnn) */
+		NEXT;
+	OPCODE(3a):			/* LD A,(nnnn) */
+		CYCLES(z80_cc_op[0x3a]);
 		temp = GetWORD(PC);
 		Sethreg(AF, GetBYTE(temp));
 		PC += 2;
-		break;
-	case 0x3B:			/* DEC SP */
+		NEXT;
+	OPCODE(3b):			/* DEC SP */
+		CYCLES(z80_cc_op[0x3b]);
 		--SP;
-		break;
-	case 0x3C:			/* INC A */
+		NEXT;
+	OPCODE(3c):			/* INC A */
+		CYCLES(z80_cc_op[0x3c]);
 		AF += 0x100;
 		temp = hreg(AF);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0) << 4) |
 			((temp == 0x80) << 2);
-		break;
-	case 0x3D:			/* DEC A */
+#endif
+		NEXT;
+	OPCODE(3d):			/* DEC A */
+		CYCLES(z80_cc_op[0x3d]);
 		AF -= 0x100;
 		temp = hreg(AF);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 		AF = (AF & ~0xfe) | (temp & 0xa8) |
 			(((temp & 0xff) == 0) << 6) |
 			(((temp & 0xf) == 0xf) << 4) |
 			((temp == 0x7f) << 2) | 2;
-		break;
-	case 0x3E:			/* LD A,nn */
+#endif
+		NEXT;
+	OPCODE(3e):			/* LD A,nn */
+		CYCLES(z80_cc_op[0x3e]);
 		Sethreg(AF, GetBYTE(PC++));
-		break;
-	case 0x3F:			/* CCF */
+		NEXT;
+	OPCODE(3f):			/* CCF */
+		CYCLES(z80_cc_op[0x3f]);
+		SYNC_FLAGS();
 		AF = (AF&~0x3b)|((AF>>8)&0x28)|((AF&1)<<4)|(~AF&1);
-		break;
-	case 0x40:			/* LD B,B */
+		NEXT;
+	OPCODE(40):			/* LD B,B */
+		CYCLES(z80_cc_op[0x40]);
 		/* nop */
-		break;
-	case 0x41:			/* LD B,C */
+		NEXT;
+	OPCODE(41):			/* LD B,C */
+		CYCLES(z80_cc_op[0x41]);
 		BC = (BC & 255) | ((BC & 255) << 8);
-		break;
-	case 0x42:			/* LD B,D */
+		NEXT;
+	OPCODE(42):			/* LD B,D */
+		CYCLES(z80_cc_op[0x42]);
 		BC = (BC & 255) | (DE & ~255);
-		break;
-	case 0x43:			/* LD B,E */
+		NEXT;
+	OPCODE(43):			/* LD B,E */
+		CYCLES(z80_cc_op[0x43]);
 		BC = (BC & 255) | ((DE & 255) << 8);
-		break;
-	case 0x44:			/* LD B,H */
+		NEXT;
+	OPCODE(44):			/* LD B,H */
+		CYCLES(z80_cc_op[0x44]);
 		BC = (BC & 255) | (HL & ~255);
-		break;
-	case 0x45:			/* LD B,L */
+		NEXT;
+	OPCODE(45):			/* LD B,L */
+		CYCLES(z80_cc_op[0x45]);
 		BC = (BC & 255) | ((HL & 255) << 8);
-		break;
-	case 0x46:			/* LD B,(HL) */
+		NEXT;
+	OPCODE(46):			/* LD B,(HL) */
+		CYCLES(z80_cc_op[0x46]);
 		Sethreg(BC, GetBYTE(HL));
-		break;
-	case 0x47:			/* LD B,A */
+		NEXT;
+	OPCODE(47):			/* LD B,A */
+		CYCLES(z80_cc_op[0x47]);
 		BC = (BC & 255) | (AF & ~255);
-		break;
-	case 0x48:			/* LD C,B */
+		NEXT;
+	OPCODE(48):			/* LD C,B */
+		CYCLES(z80_cc_op[0x48]);
 		BC = (BC & ~255) | ((BC >> 8) & 255);
-		break;
-	case 0x49:			/* LD C,C */
+		NEXT;
+	OPCODE(49):			/* LD C,C */
+		CYCLES(z80_cc_op[0x49]);
 		/* nop */
-		break;
-	case 0x4A:			/* LD C,D */
+		NEXT;
+	OPCODE(4a):			/* LD C,D */
+		CYCLES(z80_cc_op[0x4a]);
 		BC = (BC & ~255) | ((DE >> 8) & 255);
-		break;
-	case 0x4B:			/* LD C,E */
+		NEXT;
+	OPCODE(4b):			/* LD C,E */
+		CYCLES(z80_cc_op[0x4b]);
 		BC = (BC & ~255) | (DE & 255);
-		break;
-	case 0x4C:			/* LD C,H */
+		NEXT;
+	OPCODE(4c):			/* LD C,H */
+		CYCLES(z80_cc_op[0x4c]);
 		BC = (BC & ~255) | ((HL >> 8) & 255);
-		break;
-	case 0x4D:			/* LD C,L */
+		NEXT;
+	OPCODE(4d):			/* LD C,L */
+		CYCLES(z80_cc_op[0x4d]);
 		BC = (BC & ~255) | (HL & 255);
-		break;
-	case 0x4E:			/* LD C,(HL) */
+		NEXT;
+	OPCODE(4e):			/* LD C,(HL) */
+		CYCLES(z80_cc_op[0x4e]);
 		Setlreg(BC, GetBYTE(HL));
-		break;
-	case 0x4F:			/* LD C,A */
+		NEXT;
+	OPCODE(4f):			/* LD C,A */
+		CYCLES(z80_cc_op[0x4f]);
 		BC = (BC & ~255) | ((AF >> 8) & 255);
-		break;
-	case 0x50:			/* LD D,B */
+		NEXT;
+	OPCODE(50):			/* LD D,B */
+		CYCLES(z80_cc_op[0x50]);
 		DE = (DE & 255) | (BC & ~255);
-		break;
-	case 0x51:			/* LD D,C */
+		NEXT;
+	OPCODE(51):			/* LD D,C */
+		CYCLES(z80_cc_op[0x51]);
 		DE = (DE & 255) | ((BC & 255) << 8);
-		break;
-	case 0x52:			/* LD D,D */
+		NEXT;
+	OPCODE(52):			/* LD D,D */
+		CYCLES(z80_cc_op[0x52]);
 		/* nop */
-		break;
-	case 0x53:			/* LD D,E */
+		NEXT;
+	OPCODE(53):			/* LD D,E */
+		CYCLES(z80_cc_op[0x53]);
 		DE = (DE & 255) | ((DE & 255) << 8);
-		break;
-	case 0x54:			/* LD D,H */
+		NEXT;
+	OPCODE(54):			/* LD D,H */
+		CYCLES(z80_cc_op[0x54]);
 		DE = (DE & 255) | (HL & ~255);
-		break;
-	case 0x55:			/* LD D,L */
+		NEXT;
+	OPCODE(55):			/* LD D,L */
+		CYCLES(z80_cc_op[0x55]);
 		DE = (DE & 255) | ((HL & 255) << 8);
-		break;
-	case 0x56:			/* LD D,(HL) */
+		NEXT;
+	OPCODE(56):			/* LD D,(HL) */
+		CYCLES(z80_cc_op[0x56]);
 		Sethreg(DE, GetBYTE(HL));
-		break;
-	case 0x57:			/* LD D,A */
+		NEXT;
+	OPCODE(57):			/* LD D,A */
+		CYCLES(z80_cc_op[0x57]);
 		DE = (DE & 255) | (AF & ~255);
-		break;
-	case 0x58:			/* LD E,B */
+		NEXT;
+	OPCODE(58):			/* LD E,B */
+		CYCLES(z80_cc_op[0x58]);
 		DE = (DE & ~255) | ((BC >> 8) & 255);
-		break;
-	case 0x59:			/* LD E,C */
+		NEXT;
+	OPCODE(59):			/* LD E,C */
+		CYCLES(z80_cc_op[0x59]);
 		DE = (DE & ~255) | (BC & 255);
-		break;
-	case 0x5A:			/* LD E,D */
+		NEXT;
+	OPCODE(5a):			/* LD E,D */
+		CYCLES(z80_cc_op[0x5a]);
 		DE = (DE & ~255) | ((DE >> 8) & 255);
-		break;
-	case 0x5B:			/* LD E,E */
+		NEXT;
+	OPCODE(5b):			/* LD E,E */
+		CYCLES(z80_cc_op[0x5b]);
 		/* nop */
-		break;
-	case 0x5C:			/* LD E,H */
+		NEXT;
+	OPCODE(5c):			/* LD E,H */
+		CYCLES(z80_cc_op[0x5c]);
 		DE = (DE & ~255) | ((HL >> 8) & 255);
-		break;
-	case 0x5D:			/* LD E,L */
+		NEXT;
+	OPCODE(5d):			/* LD E,L */
+		CYCLES(z80_cc_op[0x5d]);
 		DE = (DE & ~255) | (HL & 255);
-		break;
-	case 0x5E:			/* LD E,(HL) */
+		NEXT;
+	OPCODE(5e):			/* LD E,(HL) */
+		CYCLES(z80_cc_op[0x5e]);
 		Setlreg(DE, GetBYTE(HL));
-		break;
-	case 0x5F:			/* LD E,A */
+		NEXT;
+	OPCODE(5f):			/* LD E,A */
+		CYCLES(z80_cc_op[0x5f]);
 		DE = (DE & ~255) | ((AF >> 8) & 255);
-		break;
-	case 0x60:			/* LD H,B */
+		NEXT;
+	OPCODE(60):			/* LD H,B */
+		CYCLES(z80_cc_op[0x60]);
 		HL = (HL & 255) | (BC & ~255);
-		break;
-	case 0x61:			/* LD H,C */
+		NEXT;
+	OPCODE(61):			/* LD H,C */
+		CYCLES(z80_cc_op[0x61]);
 		HL = (HL & 255) | ((BC & 255) << 8);
-		break;
-	case 0x62:			/* LD H,D */
+		NEXT;
+	OPCODE(62):			/* LD H,D */
+		CYCLES(z80_cc_op[0x62]);
 		HL = (HL & 255) | (DE & ~255);
-		break;
-	case 0x63:			/* LD H,E */
+		NEXT;
+	OPCODE(63):			/* LD H,E */
+		CYCLES(z80_cc_op[0x63]);
 		HL = (HL & 255) | ((DE & 255) << 8);
-		break;
-	case 0x64:			/* LD H,H */
+		NEXT;
+	OPCODE(64):			/* LD H,H */
+		CYCLES(z80_cc_op[0x64]);
 		/* nop */
-		break;
-	case 0x65:			/* LD H,L */
+		NEXT;
+	OPCODE(65):			/* LD H,L */
+		CYCLES(z80_cc_op[0x65]);
 		HL = (HL & 255) | ((HL & 255) << 8);
-		break;
-	case 0x66:			/* LD H,(HL) */
+		NEXT;
+	OPCODE(66):			/* LD H,(HL) */
+		CYCLES(z80_cc_op[0x66]);
 		Sethreg(HL, GetBYTE(HL));
-		break;
-	case 0x67:			/* LD H,A */
+		NEXT;
+	OPCODE(67):			/* LD H,A */
+		CYCLES(z80_cc_op[0x67]);
 		HL = (HL & 255) | (AF & ~255);
-		break;
-	case 0x68:			/* LD L,B */
+		NEXT;
+	OPCODE(68):			/* LD L,B */
+		CYCLES(z80_cc_op[0x68]);
 		HL = (HL & ~255) | ((BC >> 8) & 255);
-		break;
-	case 0x69:			/* LD L,C */
+		NEXT;
+	OPCODE(69):			/* LD L,C */
+		CYCLES(z80_cc_op[0x69]);
 		HL = (HL & ~255) | (BC & 255);
-		break;
-	case 0x6A:			/* LD L,D */
+		NEXT;
+	OPCODE(6a):			/* LD L,D */
+		CYCLES(z80_cc_op[0x6a]);
 		HL = (HL & ~255) | ((DE >> 8) & 255);
-		break;
-	case 0x6B:			/* LD L,E */
+		NEXT;
+	OPCODE(6b):			/* LD L,E */
+		CYCLES(z80_cc_op[0x6b]);
 		HL = (HL & ~255) | (DE & 255);
-		break;
-	case 0x6C:			/* LD L,H */
+		NEXT;
+	OPCODE(6c):			/* LD L,H */
+		CYCLES(z80_cc_op[0x6c]);
 		HL = (HL & ~255) | ((HL >> 8) & 255);
-		break;
-	case 0x6D:			/* LD L,L */
+		NEXT;
+	OPCODE(6d):			/* LD L,L */
+		CYCLES(z80_cc_op[0x6d]);
 		/* nop */
-		break;
-	case 0x6E:			/* LD L,(HL) */
+		NEXT;
+	OPCODE(6e):			/* LD L,(HL) */
+		CYCLES(z80_cc_op[0x6e]);
 		Setlreg(HL, GetBYTE(HL));
-		break;
-	case 0x6F:			/* LD L,A */
+		NEXT;
+	OPCODE(6f):			/* LD L,A */
+		CYCLES(z80_cc_op[0x6f]);
 		HL = (HL & ~255) | ((AF >> 8) & 255);
-		break;
-	case 0x70:			/* LD (HL),B */
+		NEXT;
+	OPCODE(70):			/* LD (HL),B */
+		CYCLES(z80_cc_op[0x70]);
 		PutBYTE(HL, hreg(BC));
-		break;
-	case 0x71:			/* LD (HL),C */
+		NEXT;
+	OPCODE(71):			/* LD (HL),C */
+		CYCLES(z80_cc_op[0x71]);
 		PutBYTE(HL, lreg(BC));
-		break;
-	case 0x72:			/* LD (HL),D */
+		NEXT;
+	OPCODE(72):			/* LD (HL),D */
+		CYCLES(z80_cc_op[0x72]);
 		PutBYTE(HL, hreg(DE));
-		break;
-	case 0x73:			/* LD (HL),E */
+		NEXT;
+	OPCODE(73):			/* LD (HL),E */
+		CYCLES(z80_cc_op[0x73]);
 		PutBYTE(HL, lreg(DE));
-		break;
-	case 0x74:			/* LD (HL),H */
+		NEXT;
+	OPCODE(74):			/* LD (HL),H */
+		CYCLES(z80_cc_op[0x74]);
 		PutBYTE(HL, hreg(HL));
-		break;
-	case 0x75:			/* LD (HL),L */
+		NEXT;
+	OPCODE(75):			/* LD (HL),L */
+		CYCLES(z80_cc_op[0x75]);
 		PutBYTE(HL, lreg(HL));
-		break;
-	case 0x76:			/* HALT */
+		NEXT;
+	OPCODE(76):			/* HALT */
+		CYCLES(z80_cc_op[0x76]);
 		SAVE_STATE();
 		return PC&0xffff;
-	case 0x77:			/* LD (HL),A */
+	OPCODE(77):			/* LD (HL),A */
+		CYCLES(z80_cc_op[0x77]);
 		PutBYTE(HL, hreg(AF));
-		break;
-	case 0x78:			/* LD A,B */
+		NEXT;
+	OPCODE(78):			/* LD A,B */
+		CYCLES(z80_cc_op[0x78]);
 		AF = (AF & 255) | (BC & ~255);
-		break;
-	case 0x79:			/* LD A,C */
+		NEXT;
+	OPCODE(79):			/* LD A,C */
+		CYCLES(z80_cc_op[0x79]);
 		AF = (AF & 255) | ((BC & 255) << 8);
-		break;
-	case 0x7A:			/* LD A,D */
+		NEXT;
+	OPCODE(7a):			/* LD A,D */
+		CYCLES(z80_cc_op[0x7a]);
 		AF = (AF & 255) | (DE & ~255);
-		break;
-	case 0x7B:			/* LD A,E */
+		NEXT;
+	OPCODE(7b):			/* LD A,E */
+		CYCLES(z80_cc_op[0x7b]);
 		AF = (AF & 255) | ((DE & 255) << 8);
-		break;
-	case 0x7C:			/* LD A,H */
+		NEXT;
+	OPCODE(7c):			/* LD A,H */
+		CYCLES(z80_cc_op[0x7c]);
 		AF = (AF & 255) | (HL & ~255);
-		break;
-	case 0x7D:			/* LD A,L */
+		NEXT;
+	OPCODE(7d):			/* LD A,L */
+		CYCLES(z80_cc_op[0x7d]);
 		AF = (AF & 255) | ((HL & 255) << 8);
-		break;
-	case 0x7E:			/* LD A,(HL) */
+		NEXT;
+	OPCODE(7e):			/* LD A,(HL) */
+		CYCLES(z80_cc_op[0x7e]);
 		Sethreg(AF, GetBYTE(HL));
-		break;
-	case 0x7F:			/* LD A,A */
+		NEXT;
+	OPCODE(7f):			/* LD A,A */
+		CYCLES(z80_cc_op[0x7f]);
 		/* nop */
-		break;
-	case 0x80:			/* ADD A,B */
+		NEXT;
+	OPCODE(80):			/* ADD A,B */
+		CYCLES(z80_cc_op[0x80]);
 		temp = hreg(BC);
 		acu = hreg(AF);
 		sum = acu + temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x81:			/* ADD A,C */
+#endif
+		NEXT;
+	OPCODE(81):			/* ADD A,C */
+		CYCLES(z80_cc_op[0x81]);
 		temp = lreg(BC);
 		acu = hreg(AF);
 		sum = acu + temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x82:			/* ADD A,D */
+#endif
+		NEXT;
+	OPCODE(82):			/* ADD A,D */
+		CYCLES(z80_cc_op[0x82]);
 		temp = hreg(DE);
 		acu = hreg(AF);
 		sum = acu + temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x83:			/* ADD A,E */
+#endif
+		NEXT;
+	OPCODE(83):			/* ADD A,E */
+		CYCLES(z80_cc_op[0x83]);
 		temp = lreg(DE);
 		acu = hreg(AF);
 		sum = acu + temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x84:			/* ADD A,H */
+#endif
+		NEXT;
+	OPCODE(84):			/* ADD A,H */
+		CYCLES(z80_cc_op[0x84]);
 		temp = hreg(HL);
 		acu = hreg(AF);
 		sum = acu + temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x85:			/* ADD A,L */
+#endif
+		NEXT;
+	OPCODE(85):			/* ADD A,L */
+		CYCLES(z80_cc_op[0x85]);
 		temp = lreg(HL);
 		acu = hreg(AF);
 		sum = acu + temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x86:			/* ADD A,(HL) */
+#endif
+		NEXT;
+	OPCODE(86):			/* ADD A,(HL) */
+		CYCLES(z80_cc_op[0x86]);
 		temp = GetBYTE(HL);
 		acu = hreg(AF);
 		sum = acu + temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x87:			/* ADD A,A */
+#endif
+		NEXT;
+	OPCODE(87):			/* ADD A,A */
+		CYCLES(z80_cc_op[0x87]);
 		temp = hreg(AF);
 		acu = hreg(AF);
 		sum = acu + temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x88:			/* ADC A,B */
+#endif
+		NEXT;
+	OPCODE(88):			/* ADC A,B */
+		CYCLES(z80_cc_op[0x88]);
 		temp = hreg(BC);
 		acu = hreg(AF);
 		sum = acu + temp + TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x89:			/* ADC A,C */
+#endif
+		NEXT;
+	OPCODE(89):			/* ADC A,C */
+		CYCLES(z80_cc_op[0x89]);
 		temp = lreg(BC);
 		acu = hreg(AF);
 		sum = acu + temp + TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x8A:			/* ADC A,D */
+#endif
+		NEXT;
+	OPCODE(8a):			/* ADC A,D */
+		CYCLES(z80_cc_op[0x8a]);
 		temp = hreg(DE);
 		acu = hreg(AF);
 		sum = acu + temp + TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x8B:			/* ADC A,E */
+#endif
+		NEXT;
+	OPCODE(8b):			/* ADC A,E */
+		CYCLES(z80_cc_op[0x8b]);
 		temp = lreg(DE);
 		acu = hreg(AF);
 		sum = acu + temp + TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x8C:			/* ADC A,H */
+#endif
+		NEXT;
+	OPCODE(8c):			/* ADC A,H */
+		CYCLES(z80_cc_op[0x8c]);
 		temp = hreg(HL);
 		acu = hreg(AF);
 		sum = acu + temp + TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x8D:			/* ADC A,L */
+#endif
+		NEXT;
+	OPCODE(8d):			/* ADC A,L */
+		CYCLES(z80_cc_op[0x8d]);
 		temp = lreg(HL);
 		acu = hreg(AF);
 		sum = acu + temp + TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x8E:			/* ADC A,(HL) */
+#endif
+		NEXT;
+	OPCODE(8e):			/* ADC A,(HL) */
+		CYCLES(z80_cc_op[0x8e]);
 		temp = GetBYTE(HL);
 		acu = hreg(AF);
 		sum = acu + temp + TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x8F:			/* ADC A,A */
+#endif
+		NEXT;
+	OPCODE(8f):			/* ADC A,A */
+		CYCLES(z80_cc_op[0x8f]);
 		temp = hreg(AF);
 		acu = hreg(AF);
 		sum = acu + temp + TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0x90:			/* SUB B */
+#endif
+		NEXT;
+	OPCODE(90):			/* SUB B */
+		CYCLES(z80_cc_op[0x90]);
 		temp = hreg(BC);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x91:			/* SUB C */
+#endif
+		NEXT;
+	OPCODE(91):			/* SUB C */
+		CYCLES(z80_cc_op[0x91]);
 		temp = lreg(BC);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x92:			/* SUB D */
+#endif
+		NEXT;
+	OPCODE(92):			/* SUB D */
+		CYCLES(z80_cc_op[0x92]);
 		temp = hreg(DE);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x93:			/* SUB E */
+#endif
+		NEXT;
+	OPCODE(93):			/* SUB E */
+		CYCLES(z80_cc_op[0x93]);
 		temp = lreg(DE);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x94:			/* SUB H */
+#endif
+		NEXT;
+	OPCODE(94):			/* SUB H */
+		CYCLES(z80_cc_op[0x94]);
 		temp = hreg(HL);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x95:			/* SUB L */
+#endif
+		NEXT;
+	OPCODE(95):			/* SUB L */
+		CYCLES(z80_cc_op[0x95]);
 		temp = lreg(HL);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x96:			/* SUB (HL) */
+#endif
+		NEXT;
+	OPCODE(96):			/* SUB (HL) */
+		CYCLES(z80_cc_op[0x96]);
 		temp = GetBYTE(HL);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x97:			/* SUB A */
+#endif
+		NEXT;
+	OPCODE(97):			/* SUB A */
+		CYCLES(z80_cc_op[0x97]);
 		temp = hreg(AF);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x98:			/* SBC A,B */
+#endif
+		NEXT;
+	OPCODE(98):			/* SBC A,B */
+		CYCLES(z80_cc_op[0x98]);
 		temp = hreg(BC);
 		acu = hreg(AF);
 		sum = acu - temp - TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x99:			/* SBC A,C */
+#endif
+		NEXT;
+	OPCODE(99):			/* SBC A,C */
+		CYCLES(z80_cc_op[0x99]);
 		temp = lreg(BC);
 		acu = hreg(AF);
 		sum = acu - temp - TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x9A:			/* SBC A,D */
+#endif
+		NEXT;
+	OPCODE(9a):			/* SBC A,D */
+		CYCLES(z80_cc_op[0x9a]);
 		temp = hreg(DE);
 		acu = hreg(AF);
 		sum = acu - temp - TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x9B:			/* SBC A,E */
+#endif
+		NEXT;
+	OPCODE(9b):			/* SBC A,E */
+		CYCLES(z80_cc_op[0x9b]);
 		temp = lreg(DE);
 		acu = hreg(AF);
 		sum = acu - temp - TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x9C:			/* SBC A,H */
+#endif
+		NEXT;
+	OPCODE(9c):			/* SBC A,H */
+		CYCLES(z80_cc_op[0x9c]);
 		temp = hreg(HL);
 		acu = hreg(AF);
 		sum = acu - temp - TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x9D:			/* SBC A,L */
+#endif
+		NEXT;
+	OPCODE(9d):			/* SBC A,L */
+		CYCLES(z80_cc_op[0x9d]);
 		temp = lreg(HL);
 		acu = hreg(AF);
 		sum = acu - temp - TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x9E:			/* SBC A,(HL) */
+#endif
+		NEXT;
+	OPCODE(9e):			/* SBC A,(HL) */
+		CYCLES(z80_cc_op[0x9e]);
 		temp = GetBYTE(HL);
 		acu = hreg(AF);
 		sum = acu - temp - TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0x9F:			/* SBC A,A */
+#endif
+		NEXT;
+	OPCODE(9f):			/* SBC A,A */
+		CYCLES(z80_cc_op[0x9f]);
 		temp = hreg(AF);
 		acu = hreg(AF);
 		sum = acu - temp - TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0xA0:			/* AND B */
+#endif
+		NEXT;
+	OPCODE(a0):			/* AND B */
+		CYCLES(z80_cc_op[0xa0]);
 		sum = ((AF & (BC)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) |
 			((sum == 0) << 6) | 0x10 | partab[sum];
-		break;
-	case 0xA1:			/* AND C */
+#endif
+		NEXT;
+	OPCODE(a1):			/* AND C */
+		CYCLES(z80_cc_op[0xa1]);
 		sum = ((AF >> 8) & BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
 			((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xA2:			/* AND D */
+#endif
+		NEXT;
+	OPCODE(a2):			/* AND D */
+		CYCLES(z80_cc_op[0xa2]);
 		sum = ((AF & (DE)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) |
 			((sum == 0) << 6) | 0x10 | partab[sum];
-		break;
-	case 0xA3:			/* AND E */
+#endif
+		NEXT;
+	OPCODE(a3):			/* AND E */
+		CYCLES(z80_cc_op[0xa3]);
 		sum = ((AF >> 8) & DE) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
 			((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xA4:			/* AND H */
+#endif
+		NEXT;
+	OPCODE(a4):			/* AND H */
+		CYCLES(z80_cc_op[0xa4]);
 		sum = ((AF & (HL)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) |
 			((sum == 0) << 6) | 0x10 | partab[sum];
-		break;
-	case 0xA5:			/* AND L */
+#endif
+		NEXT;
+	OPCODE(a5):			/* AND L */
+		CYCLES(z80_cc_op[0xa5]);
 		sum = ((AF >> 8) & HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
 			((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xA6:			/* AND (HL) */
+#endif
+		NEXT;
+	OPCODE(a6):			/* AND (HL) */
+		CYCLES(z80_cc_op[0xa6]);
 		sum = ((AF >> 8) & GetBYTE(HL)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
 			((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xA7:			/* AND A */
+#endif
+		NEXT;
+	OPCODE(a7):			/* AND A */
+		CYCLES(z80_cc_op[0xa7]);
 		sum = ((AF & (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) |
 			((sum == 0) << 6) | 0x10 | partab[sum];
-		break;
-	case 0xA8:			/* XOR B */
+#endif
+		NEXT;
+	OPCODE(a8):			/* XOR B */
+		CYCLES(z80_cc_op[0xa8]);
 		sum = ((AF ^ (BC)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xA9:			/* XOR C */
+#endif
+		NEXT;
+	OPCODE(a9):			/* XOR C */
+		CYCLES(z80_cc_op[0xa9]);
 		sum = ((AF >> 8) ^ BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xAA:			/* XOR D */
+#endif
+		NEXT;
+	OPCODE(aa):			/* XOR D */
+		CYCLES(z80_cc_op[0xaa]);
 		sum = ((AF ^ (DE)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xAB:			/* XOR E */
+#endif
+		NEXT;
+	OPCODE(ab):			/* XOR E */
+		CYCLES(z80_cc_op[0xab]);
 		sum = ((AF >> 8) ^ DE) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xAC:			/* XOR H */
+#endif
+		NEXT;
+	OPCODE(ac):			/* XOR H */
+		CYCLES(z80_cc_op[0xac]);
 		sum = ((AF ^ (HL)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xAD:			/* XOR L */
+#endif
+		NEXT;
+	OPCODE(ad):			/* XOR L */
+		CYCLES(z80_cc_op[0xad]);
 		sum = ((AF >> 8) ^ HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xAE:			/* XOR (HL) */
+#endif
+		NEXT;
+	OPCODE(ae):			/* XOR (HL) */
+		CYCLES(z80_cc_op[0xae]);
 		sum = ((AF >> 8) ^ GetBYTE(HL)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xAF:			/* XOR A */
+#endif
+		NEXT;
+	OPCODE(af):			/* XOR A */
+		CYCLES(z80_cc_op[0xaf]);
 		sum = ((AF ^ (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xB0:			/* OR B */
+#endif
+		NEXT;
+	OPCODE(b0):			/* OR B */
+		CYCLES(z80_cc_op[0xb0]);
 		sum = ((AF | (BC)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xB1:			/* OR C */
+#endif
+		NEXT;
+	OPCODE(b1):			/* OR C */
+		CYCLES(z80_cc_op[0xb1]);
 		sum = ((AF >> 8) | BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xB2:			/* OR D */
+#endif
+		NEXT;
+	OPCODE(b2):			/* OR D */
+		CYCLES(z80_cc_op[0xb2]);
 		sum = ((AF | (DE)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xB3:			/* OR E */
+#endif
+		NEXT;
+	OPCODE(b3):			/* OR E */
+		CYCLES(z80_cc_op[0xb3]);
 		sum = ((AF >> 8) | DE) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xB4:			/* OR H */
+#endif
+		NEXT;
+	OPCODE(b4):			/* OR H */
+		CYCLES(z80_cc_op[0xb4]);
 		sum = ((AF | (HL)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xB5:			/* OR L */
+#endif
+		NEXT;
+	OPCODE(b5):			/* OR L */
+		CYCLES(z80_cc_op[0xb5]);
 		sum = ((AF >> 8) | HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xB6:			/* OR (HL) */
+#endif
+		NEXT;
+	OPCODE(b6):			/* OR (HL) */
+		CYCLES(z80_cc_op[0xb6]);
 		sum = ((AF >> 8) | GetBYTE(HL)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xB7:			/* OR A */
+#endif
+		NEXT;
+	OPCODE(b7):			/* OR A */
+		CYCLES(z80_cc_op[0xb7]);
 		sum = ((AF | (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
 		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xB8:			/* CP B */
+#endif
+		NEXT;
+	OPCODE(b8):			/* CP B */
+		CYCLES(z80_cc_op[0xb8]);
 		temp = hreg(BC);
 		AF = (AF & ~0x28) | (temp & 0x28);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
 		AF = (AF & ~0xff) | (sum & 0x80) |
 			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0xB9:			/* CP C */
+#endif
+		NEXT;
+	OPCODE(b9):			/* CP C */
+		CYCLES(z80_cc_op[0xb9]);
 		temp = lreg(BC);
 		AF = (AF & ~0x28) | (temp & 0x28);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
 		AF = (AF & ~0xff) | (sum & 0x80) |
 			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0xBA:			/* CP D */
+#endif
+		NEXT;
+	OPCODE(ba):			/* CP D */
+		CYCLES(z80_cc_op[0xba]);
 		temp = hreg(DE);
 		AF = (AF & ~0x28) | (temp & 0x28);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
 		AF = (AF & ~0xff) | (sum & 0x80) |
 			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0xBB:			/* CP E */
+#endif
+		NEXT;
+	OPCODE(bb):			/* CP E */
+		CYCLES(z80_cc_op[0xbb]);
 		temp = lreg(DE);
 		AF = (AF & ~0x28) | (temp & 0x28);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
 		AF = (AF & ~0xff) | (sum & 0x80) |
 			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0xBC:			/* CP H */
+#endif
+		NEXT;
+	OPCODE(bc):			/* CP H */
+		CYCLES(z80_cc_op[0xbc]);
 		temp = hreg(HL);
 		AF = (AF & ~0x28) | (temp & 0x28);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
 		AF = (AF & ~0xff) | (sum & 0x80) |
 			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0xBD:			/* CP L */
+#endif
+		NEXT;
+	OPCODE(bd):			/* CP L */
+		CYCLES(z80_cc_op[0xbd]);
 		temp = lreg(HL);
 		AF = (AF & ~0x28) | (temp & 0x28);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
 		AF = (AF & ~0xff) | (sum & 0x80) |
 			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0xBE:			/* CP (HL) */
+#endif
+		NEXT;
+	OPCODE(be):			/* CP (HL) */
+		CYCLES(z80_cc_op[0xbe]);
 		temp = GetBYTE(HL);
 		AF = (AF & ~0x28) | (temp & 0x28);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
 		AF = (AF & ~0xff) | (sum & 0x80) |
 			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0xBF:			/* CP A */
+#endif
+		NEXT;
+	OPCODE(bf):			/* CP A */
+		CYCLES(z80_cc_op[0xbf]);
 		temp = hreg(AF);
 		AF = (AF & ~0x28) | (temp & 0x28);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
 		AF = (AF & ~0xff) | (sum & 0x80) |
 			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0xC0:			/* RET NZ */
-		if (!TSTFLAG(Z)) POP(PC);
-		break;
-	case 0xC1:			/* POP BC */
+#endif
+		NEXT;
+	OPCODE(c0):			/* RET NZ */
+		CYCLES(z80_cc_op[0xc0]);
+		RETC(!TSTFLAG(Z));
+		BRANCH_NEXT;
+	OPCODE(c1):			/* POP BC */
+		CYCLES(z80_cc_op[0xc1]);
 		POP(BC);
-		break;
-	case 0xC2:			/* JP NZ,nnnn */
+		NEXT;
+	OPCODE(c2):			/* JP NZ,nnnn */
+		CYCLES(z80_cc_op[0xc2]);
 		JPC(!TSTFLAG(Z));
-		break;
-	case 0xC3:			/* JP nnnn */
+		BRANCH_NEXT;
+	OPCODE(c3):			/* JP nnnn */
+		CYCLES(z80_cc_op[0xc3]);
 		JPC(1);
-		break;
-	case 0xC4:			/* CALL NZ,nnnn */
+		BRANCH_NEXT;
+	OPCODE(c4):			/* CALL NZ,nnnn */
+		CYCLES(z80_cc_op[0xc4]);
 		CALLC(!TSTFLAG(Z));
-		break;
-	case 0xC5:			/* PUSH BC */
+		BRANCH_NEXT;
+	OPCODE(c5):			/* PUSH BC */
+		CYCLES(z80_cc_op[0xc5]);
 		PUSH(BC);
-		break;
-	case 0xC6:			/* ADD A,nn */
+		NEXT;
+	OPCODE(c6):			/* ADD A,nn */
+		CYCLES(z80_cc_op[0xc6]);
 		temp = GetBYTE(PC++);
 		acu = hreg(AF);
 		sum = acu + temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0xC7:			/* RST 0 */
+#endif
+		NEXT;
+	OPCODE(c7):			/* RST 0 */
+		CYCLES(z80_cc_op[0xc7]);
 		PUSH(PC); PC = 0;
-		break;
-	case 0xC8:			/* RET Z */
-		if (TSTFLAG(Z)) POP(PC);
-		break;
-	case 0xC9:			/* RET */
+		BRANCH_NEXT;
+	OPCODE(c8):			/* RET Z */
+		CYCLES(z80_cc_op[0xc8]);
+		RETC(TSTFLAG(Z));
+		BRANCH_NEXT;
+	OPCODE(c9):			/* RET */
+		CYCLES(z80_cc_op[0xc9]);
 		POP(PC);
-		break;
-	case 0xCA:			/* JP Z,nnnn */
+		BRANCH_NEXT;
+	OPCODE(ca):			/* JP Z,nnnn */
+		CYCLES(z80_cc_op[0xca]);
 		JPC(TSTFLAG(Z));
-		break;
-	case 0xCB:			/* CB prefix */
-		SAVE_STATE();
-		cb_prefix(HL);
-		LOAD_STATE();
-		break;
-	case 0xCC:			/* CALL Z,nnnn */
+		BRANCH_NEXT;
+	OPCODE(cb):			/* CB prefix */
+		adr = HL;
+		SYNC_FLAGS();
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_cb[op]);
+		switch (op & 7) {
+		case 0: acu = hreg(BC); break;
+		case 1: acu = lreg(BC); break;
+		case 2: acu = hreg(DE); break;
+		case 3: acu = lreg(DE); break;
+		case 4: acu = hreg(HL); break;
+		case 5: acu = lreg(HL); break;
+		case 6: acu = GetBYTE(adr);  break;
+		case 7: acu = hreg(AF); break;
+		}
+		switch (op & 0xc0) {
+		case 0x00:		/* shift/rotate */
+			switch (op & 0x38) {
+			case 0x00:	/* RLC */
+				temp = (acu << 1) | (acu >> 7);
+				cbits = temp & 1;
+				goto cbshflg1;
+			case 0x08:	/* RRC */
+				temp = (acu >> 1) | (acu << 7);
+				cbits = temp & 0x80;
+				goto cbshflg1;
+			case 0x10:	/* RL */
+				temp = (acu << 1) | TSTFLAG(C);
+				cbits = acu & 0x80;
+				goto cbshflg1;
+			case 0x18:	/* RR */
+				temp = (acu >> 1) | (TSTFLAG(C) << 7);
+				cbits = acu & 1;
+				goto cbshflg1;
+			case 0x20:	/* SLA */
+				temp = acu << 1;
+				cbits = acu & 0x80;
+				goto cbshflg1;
+			case 0x28:	/* SRA */
+				temp = (acu >> 1) | (acu & 0x80);
+				cbits = acu & 1;
+				goto cbshflg1;
+			case 0x30:	/* SLIA */
+				temp = (acu << 1) | 1;
+				cbits = acu & 0x80;
+				goto cbshflg1;
+			default:	/* SRL (0x38) */
+				temp = acu >> 1;
+				cbits = acu & 1;
+			cbshflg1:
+				AF = (AF & ~0xff) | (temp & 0xa8) |
+					(((temp & 0xff) == 0) << 6) |
+					parity(temp) | !!cbits;
+			}
+			break;
+		case 0x40:		/* BIT */
+			if (acu & (1 << ((op >> 3) & 7)))
+				AF = (AF & ~0xfe) | 0x10 |
+				(((op & 0x38) == 0x38) << 7);
+			else
+				AF = (AF & ~0xfe) | 0x54;
+			if ((op&7) != 6)
+				AF |= (acu & 0x28);
+			temp = acu;
+			break;
+		case 0x80:		/* RES */
+			temp = acu & ~(1 << ((op >> 3) & 7));
+			break;
+		default:		/* SET (0xc0) */
+			temp = acu | (1 << ((op >> 3) & 7));
+			break;
+		}
+		switch (op & 7) {
+		case 0: Sethreg(BC, temp); break;
+		case 1: Setlreg(BC, temp); break;
+		case 2: Sethreg(DE, temp); break;
+		case 3: Setlreg(DE, temp); break;
+		case 4: Sethreg(HL, temp); break;
+		case 5: Setlreg(HL, temp); break;
+		case 6: PutBYTE(adr, temp);  break;
+		case 7: Sethreg(AF, temp); break;
+		}
+		NEXT;
+	OPCODE(cc):			/* CALL Z,nnnn */
+		CYCLES(z80_cc_op[0xcc]);
 		CALLC(TSTFLAG(Z));
-		break;
-	case 0xCD:			/* CALL nnnn */
-		CALLC(1);
-		break;
-	case 0xCE:			/* ADC A,nn */
+		BRANCH_NEXT;
+	OPCODE(cd):			/* CALL nnnn */
+		CYCLES(z80_cc_op[0xcd]);
+		CALL();
+		BRANCH_NEXT;
+	OPCODE(ce):			/* ADC A,nn */
+		CYCLES(z80_cc_op[0xce]);
 		temp = GetBYTE(PC++);
 		acu = hreg(AF);
 		sum = acu + temp + TSTFLAG(C);
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 			((cbits >> 8) & 1);
-		break;
-	case 0xCF:			/* RST 8 */
+#endif
+		NEXT;
+	OPCODE(cf):			/* RST 8 */
+		CYCLES(z80_cc_op[0xcf]);
 		PUSH(PC); PC = 8;
-		break;
-	case 0xD0:			/* RET NC */
-		if (!TSTFLAG(C)) POP(PC);
-		break;
-	case 0xD1:			/* POP DE */
+		BRANCH_NEXT;
+	OPCODE(d0):			/* RET NC */
+		CYCLES(z80_cc_op[0xd0]);
+		RETC(!TSTFLAG(C));
+		BRANCH_NEXT;
+	OPCODE(d1):			/* POP DE */
+		CYCLES(z80_cc_op[0xd1]);
 		POP(DE);
-		break;
-	case 0xD2:			/* JP NC,nnnn */
+		NEXT;
+	OPCODE(d2):			/* JP NC,nnnn */
+		CYCLES(z80_cc_op[0xd2]);
 		JPC(!TSTFLAG(C));
-		break;
-	case 0xD3:			/* OUT (nn),A */
+		BRANCH_NEXT;
+	OPCODE(d3):			/* OUT (nn),A */
+		CYCLES(z80_cc_op[0xd3]);
 		Output(GetBYTE(PC++), hreg(AF));
-		break;
-	case 0xD4:			/* CALL NC,nnnn */
+		if (cpu->sched.next < deadline)
+			deadline = cpu->sched.next;
+		NEXT;
+	OPCODE(d4):			/* CALL NC,nnnn */
+		CYCLES(z80_cc_op[0xd4]);
 		CALLC(!TSTFLAG(C));
-		break;
-	case 0xD5:			/* PUSH DE */
+		BRANCH_NEXT;
+	OPCODE(d5):			/* PUSH DE */
+		CYCLES(z80_cc_op[0xd5]);
 		PUSH(DE);
-		break;
-	case 0xD6:			/* SUB nn */
+		NEXT;
+	OPCODE(d6):			/* SUB nn */
+		CYCLES(z80_cc_op[0xd6]);
 		temp = GetBYTE(PC++);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
 		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			((cbits >> 8) & 1);
-		break;
-	case 0xD7:			/* RST 10H */
+#endif
+		NEXT;
+	OPCODE(d7):			/* RST 10H */
+		CYCLES(z80_cc_op[0xd7]);
 		PUSH(PC); PC = 0x10;
-		break;
-	case 0xD8:			/* RET C */
-		if (TSTFLAG(C)) POP(PC);
-		break;
-	case 0xD9:			/* EXX */
-		regs[regs_sel].bc = BC;
-		regs[regs_sel].de = DE;
-		regs[regs_sel].hl = HL;
-		regs_sel = 1 - regs_sel;
-		BC = regs[regs_sel].bc;
-		DE = regs[regs_sel].de;
-		HL = regs[regs_sel].hl;
-		break;
-	case 0xDA:			/* JP C,nnnn */
+		BRANCH_NEXT;
+	OPCODE(d8):			/* RET C */
+		CYCLES(z80_cc_op[0xd8]);
+		RETC(TSTFLAG(C));
+		BRANCH_NEXT;
+	OPCODE(d9):			/* EXX */
+		CYCLES(z80_cc_op[0xd9]);
+		cpu->regs[cpu->regs_sel].bc = BC;
+		cpu->regs[cpu->regs_sel].de = DE;
+		cpu->regs[cpu->regs_sel].hl = HL;
+		cpu->regs_sel = 1 - cpu->regs_sel;
+		BC = cpu->regs[cpu->regs_sel].bc;
+		DE = cpu->regs[cpu->regs_sel].de;
+		HL = cpu->regs[cpu->regs_sel].hl;
+		NEXT;
+	OPCODE(da):			/* JP C,nnnn */
+		CYCLES(z80_cc_op[0xda]);
 		JPC(TSTFLAG(C));
-		break;
-	case 0xDB:			/* IN A,(nn) */
+		BRANCH_NEXT;
+	OPCODE(db):			/* IN A,(nn) */
+		CYCLES(z80_cc_op[0xdb]);
 		Sethreg(AF, Input(GetBYTE(PC++)));
-		break;
-	case 0xDC:			/* CALL C,nnnn */
+		if (cpu->sched.next < deadline)
+			deadline = cpu->sched.next;
+		NEXT;
+	OPCODE(dc):			/* CALL C,nnnn */
+		CYCLES(z80_cc_op[0xdc]);
 		CALLC(TSTFLAG(C));
-		break;
-	case 0xDD:			/* DD prefix */
-		SAVE_STATE();
-		ix = dfd_prefix(ix);
-		LOAD_STATE();
-		break;
-	case 0xDE:			/* SBC A,nn */
-		temp = GetBYTE(PC++);
-		acu = hreg(AF);
-		sum = acu - temp - TSTFLAG(C);
-		cbits = acu ^ temp ^ sum;
-		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
-			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
-			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
-			((cbits >> 8) & 1);
-		break;
-	case 0xDF:			/* RST 18H */
-		PUSH(PC); PC = 0x18;
-		break;
-	case 0xE0:			/* RET PO */
-		if (!TSTFLAG(P)) POP(PC);
-		break;
-	case 0xE1:			/* POP HL */
-		POP(HL);
-		break;
-	case 0xE2:			/* JP PO,nnnn */
-		JPC(!TSTFLAG(P));
-		break;
-	case 0xE3:			/* EX (SP),HL */
-		temp = HL; POP(HL); PUSH(temp);
-		break;
-	case 0xE4:			/* CALL PO,nnnn */
-		CALLC(!TSTFLAG(P));
-		break;
-	case 0xE5:			/* PUSH HL */
-		PUSH(HL);
-		break;
-	case 0xE6:			/* AND nn */
-		sum = ((AF >> 8) & GetBYTE(PC++)) & 0xff;
-		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
-			((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xE7:			/* RST 20H */
-		PUSH(PC); PC = 0x20;
-		break;
-	case 0xE8:			/* RET PE */
-		if (TSTFLAG(P)) POP(PC);
-		break;
-	case 0xE9:			/* JP (HL) */
-		PC = HL;
-		break;
-	case 0xEA:			/* JP PE,nnnn */
-		JPC(TSTFLAG(P));
-		break;
-	case 0xEB:			/* EX DE,HL */
-		temp = HL; HL = DE; DE = temp;
-		break;
-	case 0xEC:			/* CALL PE,nnnn */
-		CALLC(TSTFLAG(P));
-		break;
-	case 0xED:			/* ED prefix */
-		switch (op = GetBYTE(PC++)) {
-		case 0x40:			/* IN B,(C) */
-			temp = Input(lreg(BC));
-			Sethreg(BC, temp);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				parity(temp);
+		BRANCH_NEXT;
+	OPCODE(dd):			/* DD prefix */
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_xy[op]);
+		switch (op) {
+		case 0x09:			/* ADD IX,BC */
+			IX &= 0xffff;
+			BC &= 0xffff;
+			sum = IX + BC;
+			cbits = (IX ^ BC ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
 			break;
-		case 0x41:			/* OUT (C),B */
-			Output(lreg(BC), BC);
+		case 0x19:			/* ADD IX,DE */
+			IX &= 0xffff;
+			DE &= 0xffff;
+			sum = IX + DE;
+			cbits = (IX ^ DE ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
 			break;
-		case 0x42:			/* SBC HL,BC */
-			HL &= 0xffff;
-			BC &= 0xffff;
-			sum = HL - BC - TSTFLAG(C);
-			cbits = (HL ^ BC ^ sum) >> 8;
-			HL = sum;
-			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
-				(((sum & 0xffff) == 0) << 6) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+		case 0x21:			/* LD IX,nnnn */
+			IX = GetWORD(PC);
+			PC += 2;
 			break;
-		case 0x43:			/* LD (nnnn),BC */
+		case 0x22:			/* LD (nnnn),IX */
 			temp = GetWORD(PC);
-			PutWORD(temp, BC);
+			PutWORD(temp, IX);
 			PC += 2;
 			break;
-		case 0x44:			/* NEG */
-			temp = hreg(AF);
-			AF = (-(AF & 0xff00) & 0xff00);
-			AF |= ((AF >> 8) & 0xa8) | (((AF & 0xff00) == 0) << 6) |
-				(((temp & 0x0f) != 0) << 4) | ((temp == 0x80) << 2) |
-				2 | (temp != 0);
-			break;
-		case 0x45:			/* RETN */
-			IFF |= IFF >> 1;
-			POP(PC);
+		case 0x23:			/* INC IX */
+			++IX;
 			break;
-		case 0x46:			/* IM 0 */
-			/* interrupt mode 0 */
-			break;
-		case 0x47:			/* LD I,A */
-			ir = (ir & 255) | (AF & ~255);
+		case 0x24:			/* INC IXH */
+			IX += 0x100;
+			temp = hreg(IX);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
 			break;
-		case 0x48:			/* IN C,(C) */
-			temp = Input(lreg(BC));
-			Setlreg(BC, temp);
+		case 0x25:			/* DEC IXH */
+			IX -= 0x100;
+			temp = hreg(IX);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 			AF = (AF & ~0xfe) | (temp & 0xa8) |
 				(((temp & 0xff) == 0) << 6) |
-				parity(temp);
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
 			break;
-		case 0x49:			/* OUT (C),C */
-			Output(lreg(BC), BC);
+		case 0x26:			/* LD IXH,nn */
+			Sethreg(IX, GetBYTE(PC++));
 			break;
-		case 0x4A:			/* ADC HL,BC */
-			HL &= 0xffff;
-			BC &= 0xffff;
-			sum = HL + BC + TSTFLAG(C);
-			cbits = (HL ^ BC ^ sum) >> 8;
-			HL = sum;
-			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
-				(((sum & 0xffff) == 0) << 6) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+		case 0x29:			/* ADD IX,IX */
+			IX &= 0xffff;
+			sum = IX + IX;
+			cbits = (IX ^ IX ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
 				(cbits & 0x10) | ((cbits >> 8) & 1);
 			break;
-		case 0x4B:			/* LD BC,(nnnn) */
+		case 0x2A:			/* LD IX,(nnnn) */
 			temp = GetWORD(PC);
-			BC = GetWORD(temp);
+			IX = GetWORD(temp);
 			PC += 2;
 			break;
-		case 0x4D:			/* RETI */
-			IFF |= IFF >> 1;
-			POP(PC);
-			break;
-		case 0x4F:			/* LD R,A */
-			ir = (ir & ~255) | ((AF >> 8) & 255);
+		case 0x2B:			/* DEC IX */
+			--IX;
 			break;
-		case 0x50:			/* IN D,(C) */
-			temp = Input(lreg(BC));
-			Sethreg(DE, temp);
+		case 0x2C:			/* INC IXL */
+			temp = lreg(IX)+1;
+			Setlreg(IX, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
 			AF = (AF & ~0xfe) | (temp & 0xa8) |
 				(((temp & 0xff) == 0) << 6) |
-				parity(temp);
-			break;
-		case 0x51:			/* OUT (C),D */
-			Output(lreg(BC), DE);
-			break;
-		case 0x52:			/* SBC HL,DE */
-			HL &= 0xffff;
-			DE &= 0xffff;
-			sum = HL - DE - TSTFLAG(C);
-			cbits = (HL ^ DE ^ sum) >> 8;
-			HL = sum;
-			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
-				(((sum & 0xffff) == 0) << 6) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
 			break;
-		case 0x53:			/* LD (nnnn),DE */
-			temp = GetWORD(PC);
-			PutWORD(temp, DE);
-			PC += 2;
+		case 0x2D:			/* DEC IXL */
+			temp = lreg(IX)-1;
+			Setlreg(IX, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
 			break;
-		case 0x56:			/* IM 1 */
-			/* interrupt mode 1 */
+		case 0x2E:			/* LD IXL,nn */
+			Setlreg(IX, GetBYTE(PC++));
 			break;
-		case 0x57:			/* LD A,I */
-			AF = (AF & 255) | (ir & ~255);
+		case 0x34:			/* INC (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)+1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
 			break;
-		case 0x58:			/* IN E,(C) */
-			temp = Input(lreg(BC));
-			Setlreg(DE, temp);
+		case 0x35:			/* DEC (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)-1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
 			AF = (AF & ~0xfe) | (temp & 0xa8) |
 				(((temp & 0xff) == 0) << 6) |
-				parity(temp);
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
 			break;
-		case 0x59:			/* OUT (C),E */
-			Output(lreg(BC), DE);
+		case 0x36:			/* LD (IX+dd),nn */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, GetBYTE(PC++));
 			break;
-		case 0x5A:			/* ADC HL,DE */
-			HL &= 0xffff;
-			DE &= 0xffff;
-			sum = HL + DE + TSTFLAG(C);
-			cbits = (HL ^ DE ^ sum) >> 8;
-			HL = sum;
-			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
-				(((sum & 0xffff) == 0) << 6) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+		case 0x39:			/* ADD IX,SP */
+			IX &= 0xffff;
+			SP &= 0xffff;
+			sum = IX + SP;
+			cbits = (IX ^ SP ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
 				(cbits & 0x10) | ((cbits >> 8) & 1);
 			break;
-		case 0x5B:			/* LD DE,(nnnn) */
-			temp = GetWORD(PC);
-			DE = GetWORD(temp);
-			PC += 2;
+		case 0x44:			/* LD B,IXH */
+			Sethreg(BC, hreg(IX));
 			break;
-		case 0x5E:			/* IM 2 */
-			/* interrupt mode 2 */
+		case 0x45:			/* LD B,IXL */
+			Sethreg(BC, lreg(IX));
 			break;
-		case 0x5F:			/* LD A,R */
-			AF = (AF & 255) | (rand() & 0xff00);
+		case 0x46:			/* LD B,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(BC, GetBYTE(adr));
 			break;
-		case 0x60:			/* IN H,(C) */
-			temp = Input(lreg(BC));
-			Sethreg(HL, temp);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				parity(temp);
+		case 0x4C:			/* LD C,IXH */
+			Setlreg(BC, hreg(IX));
 			break;
-		case 0x61:			/* OUT (C),H */
-			Output(lreg(BC), HL);
+		case 0x4D:			/* LD C,IXL */
+			Setlreg(BC, lreg(IX));
 			break;
-		case 0x62:			/* SBC HL,HL */
-			HL &= 0xffff;
-			sum = HL - HL - TSTFLAG(C);
-			cbits = (HL ^ HL ^ sum) >> 8;
-			HL = sum;
-			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
-				(((sum & 0xffff) == 0) << 6) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+		case 0x4E:			/* LD C,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Setlreg(BC, GetBYTE(adr));
 			break;
-		case 0x63:			/* LD (nnnn),HL */
-			temp = GetWORD(PC);
-			PutWORD(temp, HL);
-			PC += 2;
+		case 0x54:			/* LD D,IXH */
+			Sethreg(DE, hreg(IX));
 			break;
-		case 0x67:			/* RRD */
-			temp = GetBYTE(HL);
-			acu = hreg(AF);
-			PutBYTE(HL, hdig(temp) | (ldig(acu) << 4));
-			acu = (acu & 0xf0) | ldig(temp);
-			AF = (acu << 8) | (acu & 0xa8) | (((acu & 0xff) == 0) << 6) |
-				partab[acu] | (AF & 1);
+		case 0x55:			/* LD D,IXL */
+			Sethreg(DE, lreg(IX));
 			break;
-		case 0x68:			/* IN L,(C) */
-			temp = Input(lreg(BC));
-			Setlreg(HL, temp);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				parity(temp);
+		case 0x56:			/* LD D,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(DE, GetBYTE(adr));
 			break;
-		case 0x69:			/* OUT (C),L */
-			Output(lreg(BC), HL);
+		case 0x5C:			/* LD E,IXH */
+			Setlreg(DE, hreg(IX));
 			break;
-		case 0x6A:			/* ADC HL,HL */
-			HL &= 0xffff;
-			sum = HL + HL + TSTFLAG(C);
-			cbits = (HL ^ HL ^ sum) >> 8;
-			HL = sum;
-			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
-				(((sum & 0xffff) == 0) << 6) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				(cbits & 0x10) | ((cbits >> 8) & 1);
+		case 0x5D:			/* LD E,IXL */
+			Setlreg(DE, lreg(IX));
 			break;
-		case 0x6B:			/* LD HL,(nnnn) */
-			temp = GetWORD(PC);
-			HL = GetWORD(temp);
-			PC += 2;
+		case 0x5E:			/* LD E,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Setlreg(DE, GetBYTE(adr));
 			break;
-		case 0x6F:			/* RLD */
-			temp = GetBYTE(HL);
-			acu = hreg(AF);
-			PutBYTE(HL, (ldig(temp) << 4) | ldig(acu));
-			acu = (acu & 0xf0) | hdig(temp);
-			AF = (acu << 8) | (acu & 0xa8) | (((acu & 0xff) == 0) << 6) |
-				partab[acu] | (AF & 1);
+		case 0x60:			/* LD IXH,B */
+			Sethreg(IX, hreg(BC));
 			break;
-		case 0x70:			/* IN (C) */
-			temp = Input(lreg(BC));
-			Setlreg(temp, temp);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				parity(temp);
+		case 0x61:			/* LD IXH,C */
+			Sethreg(IX, lreg(BC));
 			break;
-		case 0x71:			/* OUT (C),0 */
-			Output(lreg(BC), 0);
+		case 0x62:			/* LD IXH,D */
+			Sethreg(IX, hreg(DE));
 			break;
-		case 0x72:			/* SBC HL,SP */
-			HL &= 0xffff;
-			SP &= 0xffff;
-			sum = HL - SP - TSTFLAG(C);
-			cbits = (HL ^ SP ^ sum) >> 8;
-			HL = sum;
-			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
-				(((sum & 0xffff) == 0) << 6) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+		case 0x63:			/* LD IXH,E */
+			Sethreg(IX, lreg(DE));
 			break;
-		case 0x73:			/* LD (nnnn),SP */
-			temp = GetWORD(PC);
-			PutWORD(temp, SP);
-			PC += 2;
+		case 0x64:			/* LD IXH,IXH */
+			/* nop */
 			break;
-		case 0x78:			/* IN A,(C) */
-			temp = Input(lreg(BC));
-			Sethreg(AF, temp);
-			AF = (AF & ~0xfe) | (temp & 0xa8) |
-				(((temp & 0xff) == 0) << 6) |
-				parity(temp);
+		case 0x65:			/* LD IXH,IXL */
+			Sethreg(IX, lreg(IX));
 			break;
-		case 0x79:			/* OUT (C),A */
-			Output(lreg(BC), AF);
+		case 0x66:			/* LD H,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(HL, GetBYTE(adr));
 			break;
-		case 0x7A:			/* ADC HL,SP */
-			HL &= 0xffff;
-			SP &= 0xffff;
-			sum = HL + SP + TSTFLAG(C);
-			cbits = (HL ^ SP ^ sum) >> 8;
-			HL = sum;
-			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
-				(((sum & 0xffff) == 0) << 6) |
-				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
-				(cbits & 0x10) | ((cbits >> 8) & 1);
+		case 0x67:			/* LD IXH,A */
+			Sethreg(IX, hreg(AF));
 			break;
-		case 0x7B:			/* LD SP,(nnnn) */
-			temp = GetWORD(PC);
-			SP = GetWORD(temp);
-			PC += 2;
+		case 0x68:			/* LD IXL,B */
+			Setlreg(IX, hreg(BC));
 			break;
-		case 0xA0:			/* LDI */
-			acu = GetBYTE(HL++);
-			PutBYTE(DE++, acu);
-			acu += hreg(AF);
-			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4) |
-				(((--BC & 0xffff) != 0) << 2);
+		case 0x69:			/* LD IXL,C */
+			Setlreg(IX, lreg(BC));
 			break;
-		case 0xA1:			/* CPI */
-			acu = hreg(AF);
-			temp = GetBYTE(HL++);
-			sum = acu - temp;
-			cbits = acu ^ temp ^ sum;
-			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
-				(((sum - ((cbits&16)>>4))&2) << 4) | (cbits & 16) |
-				(sum & 8) | ((--BC & 0xffff) != 0) << 2 | 2;
-			if ((sum & 15) == 8 && (cbits & 16) != 0)
-				AF &= ~8;
+		case 0x6A:			/* LD IXL,D */
+			Setlreg(IX, hreg(DE));
 			break;
-		case 0xA2:			/* INI */
-			PutBYTE(HL++, Input(lreg(BC)));
-			SETFLAG(N, 1);
-			SETFLAG(P, (--BC & 0xffff) != 0);
+		case 0x6B:			/* LD IXL,E */
+			Setlreg(IX, lreg(DE));
 			break;
-		case 0xA3:			/* OUTI */
-			Output(lreg(BC), GetBYTE(HL++));
-			SETFLAG(N, 1);
-			Sethreg(BC, lreg(BC) - 1);
-			SETFLAG(Z, lreg(BC) == 0);
+		case 0x6C:			/* LD IXL,IXH */
+			Setlreg(IX, hreg(IX));
 			break;
-		case 0xA8:			/* LDD */
-			acu = GetBYTE(HL--);
-			PutBYTE(DE--, acu);
-			acu += hreg(AF);
-			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4) |
-				(((--BC & 0xffff) != 0) << 2);
+		case 0x6D:			/* LD IXL,IXL */
+			/* nop */
 			break;
-		case 0xA9:			/* CPD */
-			acu = hreg(AF);
-			temp = GetBYTE(HL--);
-			sum = acu - temp;
-			cbits = acu ^ temp ^ sum;
-			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
-				(((sum - ((cbits&16)>>4))&2) << 4) | (cbits & 16) |
-				(sum & 8) | ((--BC & 0xffff) != 0) << 2 | 2;
-			if ((sum & 15) == 8 && (cbits & 16) != 0)
-				AF &= ~8;
+		case 0x6E:			/* LD L,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Setlreg(HL, GetBYTE(adr));
 			break;
-		case 0xAA:			/* IND */
+		case 0x6F:			/* LD IXL,A */
+			Setlreg(IX, hreg(AF));
+			break;
+		case 0x70:			/* LD (IX+dd),B */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(BC));
+			break;
+		case 0x71:			/* LD (IX+dd),C */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(BC));
+			break;
+		case 0x72:			/* LD (IX+dd),D */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(DE));
+			break;
+		case 0x73:			/* LD (IX+dd),E */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(DE));
+			break;
+		case 0x74:			/* LD (IX+dd),H */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(HL));
+			break;
+		case 0x75:			/* LD (IX+dd),L */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(HL));
+			break;
+		case 0x77:			/* LD (IX+dd),A */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(AF));
+			break;
+		case 0x7C:			/* LD A,IXH */
+			Sethreg(AF, hreg(IX));
+			break;
+		case 0x7D:			/* LD A,IXL */
+			Sethreg(AF, lreg(IX));
+			break;
+		case 0x7E:			/* LD A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(AF, GetBYTE(adr));
+			break;
+		case 0x84:			/* ADD A,IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x85:			/* ADD A,IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x86:			/* ADD A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8C:			/* ADC A,IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8D:			/* ADC A,IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8E:			/* ADC A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x94:			/* SUB IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x95:			/* SUB IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x96:			/* SUB (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9C:			/* SBC A,IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9D:			/* SBC A,IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9E:			/* SBC A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xA4:			/* AND IXH */
+			sum = ((AF & (IX)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) |
+				((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+			break;
+		case 0xA5:			/* AND IXL */
+			sum = ((AF >> 8) & IX) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xA6:			/* AND (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) & GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAC:			/* XOR IXH */
+			sum = ((AF ^ (IX)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAD:			/* XOR IXL */
+			sum = ((AF >> 8) ^ IX) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAE:			/* XOR (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) ^ GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB4:			/* OR IXH */
+			sum = ((AF | (IX)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB5:			/* OR IXL */
+			sum = ((AF >> 8) | IX) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB6:			/* OR (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) | GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xBC:			/* CP IXH */
+			temp = hreg(IX);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBD:			/* CP IXL */
+			temp = lreg(IX);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBE:			/* CP (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xCB:			/* CB prefix */
+			adr = IX + (signed char) GetBYTE(PC++);
+			adr = adr;
+			SYNC_FLAGS();
+			op = GetBYTE(PC++);
+			CYCLES(z80_cc_xycb[op]);
+			switch (op & 7) {
+			case 0: acu = hreg(BC); break;
+			case 1: acu = lreg(BC); break;
+			case 2: acu = hreg(DE); break;
+			case 3: acu = lreg(DE); break;
+			case 4: acu = hreg(HL); break;
+			case 5: acu = lreg(HL); break;
+			case 6: acu = GetBYTE(adr);  break;
+			case 7: acu = hreg(AF); break;
+			}
+			switch (op & 0xc0) {
+			case 0x00:		/* shift/rotate */
+				switch (op & 0x38) {
+				case 0x00:	/* RLC */
+					temp = (acu << 1) | (acu >> 7);
+					cbits = temp & 1;
+					goto cbshflg2;
+				case 0x08:	/* RRC */
+					temp = (acu >> 1) | (acu << 7);
+					cbits = temp & 0x80;
+					goto cbshflg2;
+				case 0x10:	/* RL */
+					temp = (acu << 1) | TSTFLAG(C);
+					cbits = acu & 0x80;
+					goto cbshflg2;
+				case 0x18:	/* RR */
+					temp = (acu >> 1) | (TSTFLAG(C) << 7);
+					cbits = acu & 1;
+					goto cbshflg2;
+				case 0x20:	/* SLA */
+					temp = acu << 1;
+					cbits = acu & 0x80;
+					goto cbshflg2;
+				case 0x28:	/* SRA */
+					temp = (acu >> 1) | (acu & 0x80);
+					cbits = acu & 1;
+					goto cbshflg2;
+				case 0x30:	/* SLIA */
+					temp = (acu << 1) | 1;
+					cbits = acu & 0x80;
+					goto cbshflg2;
+				default:	/* SRL (0x38) */
+					temp = acu >> 1;
+					cbits = acu & 1;
+				cbshflg2:
+					AF = (AF & ~0xff) | (temp & 0xa8) |
+						(((temp & 0xff) == 0) << 6) |
+						parity(temp) | !!cbits;
+				}
+				break;
+			case 0x40:		/* BIT */
+				if (acu & (1 << ((op >> 3) & 7)))
+					AF = (AF & ~0xfe) | 0x10 |
+					(((op & 0x38) == 0x38) << 7);
+				else
+					AF = (AF & ~0xfe) | 0x54;
+				if ((op&7) != 6)
+					AF |= (acu & 0x28);
+				temp = acu;
+				break;
+			case 0x80:		/* RES */
+				temp = acu & ~(1 << ((op >> 3) & 7));
+				break;
+			default:		/* SET (0xc0) */
+				temp = acu | (1 << ((op >> 3) & 7));
+				break;
+			}
+			switch (op & 7) {
+			case 0: Sethreg(BC, temp); break;
+			case 1: Setlreg(BC, temp); break;
+			case 2: Sethreg(DE, temp); break;
+			case 3: Setlreg(DE, temp); break;
+			case 4: Sethreg(HL, temp); break;
+			case 5: Setlreg(HL, temp); break;
+			case 6: PutBYTE(adr, temp);  break;
+			case 7: Sethreg(AF, temp); break;
+			}
+			break;
+		case 0xE1:			/* POP IX */
+			POP(IX);
+			break;
+		case 0xE3:			/* EX (SP),IX */
+			temp = IX; POP(IX); PUSH(temp);
+			break;
+		case 0xE5:			/* PUSH IX */
+			PUSH(IX);
+			break;
+		case 0xE9:			/* JP (IX) */
+			PC = IX;
+			break;
+		case 0xF9:			/* LD SP,IX */
+			SP = IX;
+			break;
+		default: PC--;		/* ignore DD */
+		}
+		CHECK_NEXT;
+	OPCODE(de):			/* SBC A,nn */
+		CYCLES(z80_cc_op[0xde]);
+		temp = GetBYTE(PC++);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		NEXT;
+	OPCODE(df):			/* RST 18H */
+		CYCLES(z80_cc_op[0xdf]);
+		PUSH(PC); PC = 0x18;
+		BRANCH_NEXT;
+	OPCODE(e0):			/* RET PO */
+		CYCLES(z80_cc_op[0xe0]);
+		RETC(!TSTFLAG(P));
+		BRANCH_NEXT;
+	OPCODE(e1):			/* POP HL */
+		CYCLES(z80_cc_op[0xe1]);
+		POP(HL);
+		NEXT;
+	OPCODE(e2):			/* JP PO,nnnn */
+		CYCLES(z80_cc_op[0xe2]);
+		JPC(!TSTFLAG(P));
+		BRANCH_NEXT;
+	OPCODE(e3):			/* EX (SP),HL */
+		CYCLES(z80_cc_op[0xe3]);
+		temp = HL; POP(HL); PUSH(temp);
+		NEXT;
+	OPCODE(e4):			/* CALL PO,nnnn */
+		CYCLES(z80_cc_op[0xe4]);
+		CALLC(!TSTFLAG(P));
+		BRANCH_NEXT;
+	OPCODE(e5):			/* PUSH HL */
+		CYCLES(z80_cc_op[0xe5]);
+		PUSH(HL);
+		NEXT;
+	OPCODE(e6):			/* AND nn */
+		CYCLES(z80_cc_op[0xe6]);
+		sum = ((AF >> 8) & GetBYTE(PC++)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+		NEXT;
+	OPCODE(e7):			/* RST 20H */
+		CYCLES(z80_cc_op[0xe7]);
+		PUSH(PC); PC = 0x20;
+		BRANCH_NEXT;
+	OPCODE(e8):			/* RET PE */
+		CYCLES(z80_cc_op[0xe8]);
+		RETC(TSTFLAG(P));
+		BRANCH_NEXT;
+	OPCODE(e9):			/* JP (HL) */
+		CYCLES(z80_cc_op[0xe9]);
+		PC = HL;
+		BRANCH_NEXT;
+	OPCODE(ea):			/* JP PE,nnnn */
+		CYCLES(z80_cc_op[0xea]);
+		JPC(TSTFLAG(P));
+		BRANCH_NEXT;
+	OPCODE(eb):			/* EX DE,HL */
+		CYCLES(z80_cc_op[0xeb]);
+		temp = HL; HL = DE; DE = temp;
+		NEXT;
+	OPCODE(ec):			/* CALL PE,nnnn */
+		CYCLES(z80_cc_op[0xec]);
+		CALLC(TSTFLAG(P));
+		BRANCH_NEXT;
+	OPCODE(ed):			/* ED prefix */
+		SYNC_FLAGS();
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_ed[op]);
+		switch (op) {
+		case 0x40:			/* IN B,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(BC, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x41:			/* OUT (C),B */
+			Output(lreg(BC), BC);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x42:			/* SBC HL,BC */
+			HL &= 0xffff;
+			BC &= 0xffff;
+			sum = HL - BC - TSTFLAG(C);
+			cbits = (HL ^ BC ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x43:			/* LD (nnnn),BC */
+			temp = GetWORD(PC);
+			PutWORD(temp, BC);
+			PC += 2;
+			break;
+		case 0x44:			/* NEG */
+			temp = hreg(AF);
+			AF = (-(AF & 0xff00) & 0xff00);
+			AF |= ((AF >> 8) & 0xa8) | (((AF & 0xff00) == 0) << 6) |
+				(((temp & 0x0f) != 0) << 4) | ((temp == 0x80) << 2) |
+				2 | (temp != 0);
+			break;
+		case 0x45:			/* RETN */
+			cpu->IFF |= cpu->IFF >> 1;
+			if (cpu->sched.irq)
+				deadline = CYC;
+			POP(PC);
+			break;
+		case 0x46:			/* IM 0 */
+			cpu->im = 0;
+			break;
+		case 0x47:			/* LD I,A */
+			cpu->ir = (cpu->ir & 255) | (AF & ~255);
+			break;
+		case 0x48:			/* IN C,(C) */
+			temp = Input(lreg(BC));
+			Setlreg(BC, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x49:			/* OUT (C),C */
+			Output(lreg(BC), BC);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x4A:			/* ADC HL,BC */
+			HL &= 0xffff;
+			BC &= 0xffff;
+			sum = HL + BC + TSTFLAG(C);
+			cbits = (HL ^ BC ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x4B:			/* LD BC,(nnnn) */
+			temp = GetWORD(PC);
+			BC = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x4D:			/* RETI */
+			cpu->IFF |= cpu->IFF >> 1;
+			if (cpu->sched.irq)
+				deadline = CYC;
+			POP(PC);
+			break;
+		case 0x4F:			/* LD R,A */
+			cpu->ir = (cpu->ir & ~255) | ((AF >> 8) & 255);
+			cpu->rbase = CYC;
+			break;
+		case 0x50:			/* IN D,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(DE, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x51:			/* OUT (C),D */
+			Output(lreg(BC), DE);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x52:			/* SBC HL,DE */
+			HL &= 0xffff;
+			DE &= 0xffff;
+			sum = HL - DE - TSTFLAG(C);
+			cbits = (HL ^ DE ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x53:			/* LD (nnnn),DE */
+			temp = GetWORD(PC);
+			PutWORD(temp, DE);
+			PC += 2;
+			break;
+		case 0x56:			/* IM 1 */
+			cpu->im = 1;
+			break;
+		case 0x57:			/* LD A,I */
+			AF = (AF & 255) | (cpu->ir & ~255);
+			break;
+		case 0x58:			/* IN E,(C) */
+			temp = Input(lreg(BC));
+			Setlreg(DE, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x59:			/* OUT (C),E */
+			Output(lreg(BC), DE);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x5A:			/* ADC HL,DE */
+			HL &= 0xffff;
+			DE &= 0xffff;
+			sum = HL + DE + TSTFLAG(C);
+			cbits = (HL ^ DE ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x5B:			/* LD DE,(nnnn) */
+			temp = GetWORD(PC);
+			DE = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x5E:			/* IM 2 */
+			cpu->im = 2;
+			break;
+		case 0x5F:			/* LD A,R */
+			AF = (AF & 255) | (Z80_R(cpu, CYC) << 8);
+			break;
+		case 0x60:			/* IN H,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(HL, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x61:			/* OUT (C),H */
+			Output(lreg(BC), HL);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x62:			/* SBC HL,HL */
+			HL &= 0xffff;
+			sum = HL - HL - TSTFLAG(C);
+			cbits = (HL ^ HL ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x63:			/* LD (nnnn),HL */
+			temp = GetWORD(PC);
+			PutWORD(temp, HL);
+			PC += 2;
+			break;
+		case 0x67:			/* RRD */
+			temp = GetBYTE(HL);
+			acu = hreg(AF);
+			PutBYTE(HL, hdig(temp) | (ldig(acu) << 4));
+			acu = (acu & 0xf0) | ldig(temp);
+			AF = (acu << 8) | (acu & 0xa8) | (((acu & 0xff) == 0) << 6) |
+				partab[acu] | (AF & 1);
+			break;
+		case 0x68:			/* IN L,(C) */
+			temp = Input(lreg(BC));
+			Setlreg(HL, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x69:			/* OUT (C),L */
+			Output(lreg(BC), HL);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x6A:			/* ADC HL,HL */
+			HL &= 0xffff;
+			sum = HL + HL + TSTFLAG(C);
+			cbits = (HL ^ HL ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x6B:			/* LD HL,(nnnn) */
+			temp = GetWORD(PC);
+			HL = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x6F:			/* RLD */
+			temp = GetBYTE(HL);
+			acu = hreg(AF);
+			PutBYTE(HL, (ldig(temp) << 4) | ldig(acu));
+			acu = (acu & 0xf0) | hdig(temp);
+			AF = (acu << 8) | (acu & 0xa8) | (((acu & 0xff) == 0) << 6) |
+				partab[acu] | (AF & 1);
+			break;
+		case 0x70:			/* IN (C) */
+			temp = Input(lreg(BC));
+			Setlreg(temp, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x71:			/* OUT (C),0 */
+			Output(lreg(BC), 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x72:			/* SBC HL,SP */
+			HL &= 0xffff;
+			SP &= 0xffff;
+			sum = HL - SP - TSTFLAG(C);
+			cbits = (HL ^ SP ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x73:			/* LD (nnnn),SP */
+			temp = GetWORD(PC);
+			PutWORD(temp, SP);
+			PC += 2;
+			break;
+		case 0x78:			/* IN A,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(AF, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x79:			/* OUT (C),A */
+			Output(lreg(BC), AF);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x7A:			/* ADC HL,SP */
+			HL &= 0xffff;
+			SP &= 0xffff;
+			sum = HL + SP + TSTFLAG(C);
+			cbits = (HL ^ SP ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x7B:			/* LD SP,(nnnn) */
+			temp = GetWORD(PC);
+			SP = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0xA0:			/* LDI */
+			acu = GetBYTE(HL++);
+			PutBYTE(DE++, acu);
+			acu += hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4) |
+				(((--BC & 0xffff) != 0) << 2);
+			break;
+		case 0xA1:			/* CPI */
+			acu = hreg(AF);
+			temp = GetBYTE(HL++);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) | (cbits & 16) |
+				(sum & 8) | ((--BC & 0xffff) != 0) << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xA2:			/* INI */
+			PutBYTE(HL++, Input(lreg(BC)));
+			SETFLAG(N, 1);
+			SETFLAG(P, (--BC & 0xffff) != 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xA3:			/* OUTI */
+			Output(lreg(BC), GetBYTE(HL++));
+			SETFLAG(N, 1);
+			Sethreg(BC, lreg(BC) - 1);
+			SETFLAG(Z, lreg(BC) == 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xA8:			/* LDD */
+			acu = GetBYTE(HL--);
+			PutBYTE(DE--, acu);
+			acu += hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4) |
+				(((--BC & 0xffff) != 0) << 2);
+			break;
+		case 0xA9:			/* CPD */
+			acu = hreg(AF);
+			temp = GetBYTE(HL--);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) | (cbits & 16) |
+				(sum & 8) | ((--BC & 0xffff) != 0) << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xAA:			/* IND */
+			PutBYTE(HL--, Input(lreg(BC)));
+			SETFLAG(N, 1);
+			Sethreg(BC, lreg(BC) - 1);
+			SETFLAG(Z, lreg(BC) == 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xAB:			/* OUTD */
+			Output(lreg(BC), GetBYTE(HL--));
+			SETFLAG(N, 1);
+			Sethreg(BC, lreg(BC) - 1);
+			SETFLAG(Z, lreg(BC) == 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xB0:			/* LDIR */
+			adr = BC & 0xffff ? BC & 0xffff : 0x10000;
+			CYCLES(21 * (adr - 1));
+			trap_move_block(cpu, DE, HL, adr, 0);
+			HL += adr;
+			DE += adr;
+			BC = 0;
+			acu = RAM(DE - 1) + hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
+			break;
+		case 0xB1:			/* CPIR */
+			acu = hreg(AF);
+			adr = trap_find_byte(cpu, HL, BC & 0xffff ? BC & 0xffff : 0x10000,
+					     acu, 0);
+			CYCLES(21 * (adr - 1));
+			HL += adr;
+			BC = (BC - adr) & 0xffff;
+			temp = RAM(HL - 1);
+			op = BC != 0;
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) |
+				(cbits & 16) | (sum & 8) | op << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xB2:			/* INIR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				PutBYTE(HL++, Input(lreg(BC)));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xB3:			/* OTIR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				Output(lreg(BC), GetBYTE(HL++));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xB8:			/* LDDR */
+			adr = BC & 0xffff ? BC & 0xffff : 0x10000;
+			CYCLES(21 * (adr - 1));
+			trap_move_block(cpu, DE, HL, adr, 1);
+			HL -= adr;
+			DE -= adr;
+			BC = 0;
+			acu = RAM(DE + 1) + hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
+			break;
+		case 0xB9:			/* CPDR */
+			acu = hreg(AF);
+			adr = trap_find_byte(cpu, HL, BC & 0xffff ? BC & 0xffff : 0x10000,
+					     acu, 1);
+			CYCLES(21 * (adr - 1));
+			HL -= adr;
+			BC = (BC - adr) & 0xffff;
+			temp = RAM(HL + 1);
+			op = BC != 0;
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) |
+				(cbits & 16) | (sum & 8) | op << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xBA:			/* INDR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				PutBYTE(HL--, Input(lreg(BC)));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xBB:			/* OTDR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				Output(lreg(BC), GetBYTE(HL--));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		default: if (0x40 <= op && op <= 0x7f) PC--;		/* ignore ED */
+		}
+		CHECK_NEXT;
+	OPCODE(ee):			/* XOR nn */
+		CYCLES(z80_cc_op[0xee]);
+		sum = ((AF >> 8) ^ GetBYTE(PC++)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		NEXT;
+	OPCODE(ef):			/* RST 28H */
+		CYCLES(z80_cc_op[0xef]);
+		PUSH(PC); PC = 0x28;
+		BRANCH_NEXT;
+	OPCODE(f0):			/* RET P */
+		CYCLES(z80_cc_op[0xf0]);
+		RETC(!TSTFLAG(S));
+		BRANCH_NEXT;
+	OPCODE(f1):			/* POP AF */
+		CYCLES(z80_cc_op[0xf1]);
+		SYNC_FLAGS(); POP(AF);
+		NEXT;
+	OPCODE(f2):			/* JP P,nnnn */
+		CYCLES(z80_cc_op[0xf2]);
+		JPC(!TSTFLAG(S));
+		BRANCH_NEXT;
+	OPCODE(f3):			/* DI */
+		CYCLES(z80_cc_op[0xf3]);
+		cpu->IFF = 0;
+		NEXT;
+	OPCODE(f4):			/* CALL P,nnnn */
+		CYCLES(z80_cc_op[0xf4]);
+		CALLC(!TSTFLAG(S));
+		BRANCH_NEXT;
+	OPCODE(f5):			/* PUSH AF */
+		CYCLES(z80_cc_op[0xf5]);
+		SYNC_FLAGS(); PUSH(AF);
+		NEXT;
+	OPCODE(f6):			/* OR nn */
+		CYCLES(z80_cc_op[0xf6]);
+		sum = ((AF >> 8) | GetBYTE(PC++)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		NEXT;
+	OPCODE(f7):			/* RST 30H */
+		CYCLES(z80_cc_op[0xf7]);
+		PUSH(PC); PC = 0x30;
+		BRANCH_NEXT;
+	OPCODE(f8):			/* RET M */
+		CYCLES(z80_cc_op[0xf8]);
+		RETC(TSTFLAG(S));
+		BRANCH_NEXT;
+	OPCODE(f9):			/* LD SP,HL */
+		CYCLES(z80_cc_op[0xf9]);
+		SP = HL;
+		NEXT;
+	OPCODE(fa):			/* JP M,nnnn */
+		CYCLES(z80_cc_op[0xfa]);
+		JPC(TSTFLAG(S));
+		BRANCH_NEXT;
+	OPCODE(fb):			/* EI */
+		CYCLES(z80_cc_op[0xfb]);
+		cpu->IFF = 3;
+		cpu->sched.ei = CYC;
+		if (cpu->sched.irq)
+			deadline = CYC;
+		NEXT;
+	OPCODE(fc):			/* CALL M,nnnn */
+		CYCLES(z80_cc_op[0xfc]);
+		CALLC(TSTFLAG(S));
+		BRANCH_NEXT;
+	OPCODE(fd):			/* FD prefix */
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_xy[op]);
+		switch (op) {
+		case 0x09:			/* ADD IY,BC */
+			IY &= 0xffff;
+			BC &= 0xffff;
+			sum = IY + BC;
+			cbits = (IY ^ BC ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x19:			/* ADD IY,DE */
+			IY &= 0xffff;
+			DE &= 0xffff;
+			sum = IY + DE;
+			cbits = (IY ^ DE ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x21:			/* LD IY,nnnn */
+			IY = GetWORD(PC);
+			PC += 2;
+			break;
+		case 0x22:			/* LD (nnnn),IY */
+			temp = GetWORD(PC);
+			PutWORD(temp, IY);
+			PC += 2;
+			break;
+		case 0x23:			/* INC IY */
+			++IY;
+			break;
+		case 0x24:			/* INC IYH */
+			IY += 0x100;
+			temp = hreg(IY);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x25:			/* DEC IYH */
+			IY -= 0x100;
+			temp = hreg(IY);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x26:			/* LD IYH,nn */
+			Sethreg(IY, GetBYTE(PC++));
+			break;
+		case 0x29:			/* ADD IY,IY */
+			IY &= 0xffff;
+			sum = IY + IY;
+			cbits = (IY ^ IY ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x2A:			/* LD IY,(nnnn) */
+			temp = GetWORD(PC);
+			IY = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x2B:			/* DEC IY */
+			--IY;
+			break;
+		case 0x2C:			/* INC IYL */
+			temp = lreg(IY)+1;
+			Setlreg(IY, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x2D:			/* DEC IYL */
+			temp = lreg(IY)-1;
+			Setlreg(IY, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x2E:			/* LD IYL,nn */
+			Setlreg(IY, GetBYTE(PC++));
+			break;
+		case 0x34:			/* INC (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)+1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x35:			/* DEC (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)-1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x36:			/* LD (IY+dd),nn */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, GetBYTE(PC++));
+			break;
+		case 0x39:			/* ADD IY,SP */
+			IY &= 0xffff;
+			SP &= 0xffff;
+			sum = IY + SP;
+			cbits = (IY ^ SP ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x44:			/* LD B,IYH */
+			Sethreg(BC, hreg(IY));
+			break;
+		case 0x45:			/* LD B,IYL */
+			Sethreg(BC, lreg(IY));
+			break;
+		case 0x46:			/* LD B,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(BC, GetBYTE(adr));
+			break;
+		case 0x4C:			/* LD C,IYH */
+			Setlreg(BC, hreg(IY));
+			break;
+		case 0x4D:			/* LD C,IYL */
+			Setlreg(BC, lreg(IY));
+			break;
+		case 0x4E:			/* LD C,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Setlreg(BC, GetBYTE(adr));
+			break;
+		case 0x54:			/* LD D,IYH */
+			Sethreg(DE, hreg(IY));
+			break;
+		case 0x55:			/* LD D,IYL */
+			Sethreg(DE, lreg(IY));
+			break;
+		case 0x56:			/* LD D,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(DE, GetBYTE(adr));
+			break;
+		case 0x5C:			/* LD E,IYH */
+			Setlreg(DE, hreg(IY));
+			break;
+		case 0x5D:			/* LD E,IYL */
+			Setlreg(DE, lreg(IY));
+			break;
+		case 0x5E:			/* LD E,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Setlreg(DE, GetBYTE(adr));
+			break;
+		case 0x60:			/* LD IYH,B */
+			Sethreg(IY, hreg(BC));
+			break;
+		case 0x61:			/* LD IYH,C */
+			Sethreg(IY, lreg(BC));
+			break;
+		case 0x62:			/* LD IYH,D */
+			Sethreg(IY, hreg(DE));
+			break;
+		case 0x63:			/* LD IYH,E */
+			Sethreg(IY, lreg(DE));
+			break;
+		case 0x64:			/* LD IYH,IYH */
+			/* nop */
+			break;
+		case 0x65:			/* LD IYH,IYL */
+			Sethreg(IY, lreg(IY));
+			break;
+		case 0x66:			/* LD H,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(HL, GetBYTE(adr));
+			break;
+		case 0x67:			/* LD IYH,A */
+			Sethreg(IY, hreg(AF));
+			break;
+		case 0x68:			/* LD IYL,B */
+			Setlreg(IY, hreg(BC));
+			break;
+		case 0x69:			/* LD IYL,C */
+			Setlreg(IY, lreg(BC));
+			break;
+		case 0x6A:			/* LD IYL,D */
+			Setlreg(IY, hreg(DE));
+			break;
+		case 0x6B:			/* LD IYL,E */
+			Setlreg(IY, lreg(DE));
+			break;
+		case 0x6C:			/* LD IYL,IYH */
+			Setlreg(IY, hreg(IY));
+			break;
+		case 0x6D:			/* LD IYL,IYL */
+			/* nop */
+			break;
+		case 0x6E:			/* LD L,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Setlreg(HL, GetBYTE(adr));
+			break;
+		case 0x6F:			/* LD IYL,A */
+			Setlreg(IY, hreg(AF));
+			break;
+		case 0x70:			/* LD (IY+dd),B */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(BC));
+			break;
+		case 0x71:			/* LD (IY+dd),C */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(BC));
+			break;
+		case 0x72:			/* LD (IY+dd),D */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(DE));
+			break;
+		case 0x73:			/* LD (IY+dd),E */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(DE));
+			break;
+		case 0x74:			/* LD (IY+dd),H */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(HL));
+			break;
+		case 0x75:			/* LD (IY+dd),L */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(HL));
+			break;
+		case 0x77:			/* LD (IY+dd),A */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(AF));
+			break;
+		case 0x7C:			/* LD A,IYH */
+			Sethreg(AF, hreg(IY));
+			break;
+		case 0x7D:			/* LD A,IYL */
+			Sethreg(AF, lreg(IY));
+			break;
+		case 0x7E:			/* LD A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(AF, GetBYTE(adr));
+			break;
+		case 0x84:			/* ADD A,IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x85:			/* ADD A,IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x86:			/* ADD A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8C:			/* ADC A,IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8D:			/* ADC A,IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8E:			/* ADC A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x94:			/* SUB IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x95:			/* SUB IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x96:			/* SUB (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9C:			/* SBC A,IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9D:			/* SBC A,IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9E:			/* SBC A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xA4:			/* AND IYH */
+			sum = ((AF & (IY)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) |
+				((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+			break;
+		case 0xA5:			/* AND IYL */
+			sum = ((AF >> 8) & IY) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xA6:			/* AND (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) & GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAC:			/* XOR IYH */
+			sum = ((AF ^ (IY)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAD:			/* XOR IYL */
+			sum = ((AF >> 8) ^ IY) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAE:			/* XOR (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) ^ GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB4:			/* OR IYH */
+			sum = ((AF | (IY)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB5:			/* OR IYL */
+			sum = ((AF >> 8) | IY) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB6:			/* OR (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) | GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xBC:			/* CP IYH */
+			temp = hreg(IY);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBD:			/* CP IYL */
+			temp = lreg(IY);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBE:			/* CP (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xCB:			/* CB prefix */
+			adr = IY + (signed char) GetBYTE(PC++);
+			adr = adr;
+			SYNC_FLAGS();
+			op = GetBYTE(PC++);
+			CYCLES(z80_cc_xycb[op]);
+			switch (op & 7) {
+			case 0: acu = hreg(BC); break;
+			case 1: acu = lreg(BC); break;
+			case 2: acu = hreg(DE); break;
+			case 3: acu = lreg(DE); break;
+			case 4: acu = hreg(HL); break;
+			case 5: acu = lreg(HL); break;
+			case 6: acu = GetBYTE(adr);  break;
+			case 7: acu = hreg(AF); break;
+			}
+			switch (op & 0xc0) {
+			case 0x00:		/* shift/rotate */
+				switch (op & 0x38) {
+				case 0x00:	/* RLC */
+					temp = (acu << 1) | (acu >> 7);
+					cbits = temp & 1;
+					goto cbshflg3;
+				case 0x08:	/* RRC */
+					temp = (acu >> 1) | (acu << 7);
+					cbits = temp & 0x80;
+					goto cbshflg3;
+				case 0x10:	/* RL */
+					temp = (acu << 1) | TSTFLAG(C);
+					cbits = acu & 0x80;
+					goto cbshflg3;
+				case 0x18:	/* RR */
+					temp = (acu >> 1) | (TSTFLAG(C) << 7);
+					cbits = acu & 1;
+					goto cbshflg3;
+				case 0x20:	/* SLA */
+					temp = acu << 1;
+					cbits = acu & 0x80;
+					goto cbshflg3;
+				case 0x28:	/* SRA */
+					temp = (acu >> 1) | (acu & 0x80);
+					cbits = acu & 1;
+					goto cbshflg3;
+				case 0x30:	/* SLIA */
+					temp = (acu << 1) | 1;
+					cbits = acu & 0x80;
+					goto cbshflg3;
+				default:	/* SRL (0x38) */
+					temp = acu >> 1;
+					cbits = acu & 1;
+				cbshflg3:
+					AF = (AF & ~0xff) | (temp & 0xa8) |
+						(((temp & 0xff) == 0) << 6) |
+						parity(temp) | !!cbits;
+				}
+				break;
+			case 0x40:		/* BIT */
+				if (acu & (1 << ((op >> 3) & 7)))
+					AF = (AF & ~0xfe) | 0x10 |
+					(((op & 0x38) == 0x38) << 7);
+				else
+					AF = (AF & ~0xfe) | 0x54;
+				if ((op&7) != 6)
+					AF |= (acu & 0x28);
+				temp = acu;
+				break;
+			case 0x80:		/* RES */
+				temp = acu & ~(1 << ((op >> 3) & 7));
+				break;
+			default:		/* SET (0xc0) */
+				temp = acu | (1 << ((op >> 3) & 7));
+				break;
+			}
+			switch (op & 7) {
+			case 0: Sethreg(BC, temp); break;
+			case 1: Setlreg(BC, temp); break;
+			case 2: Sethreg(DE, temp); break;
+			case 3: Setlreg(DE, temp); break;
+			case 4: Sethreg(HL, temp); break;
+			case 5: Setlreg(HL, temp); break;
+			case 6: PutBYTE(adr, temp);  break;
+			case 7: Sethreg(AF, temp); break;
+			}
+			break;
+		case 0xE1:			/* POP IY */
+			POP(IY);
+			break;
+		case 0xE3:			/* EX (SP),IY */
+			temp = IY; POP(IY); PUSH(temp);
+			break;
+		case 0xE5:			/* PUSH IY */
+			PUSH(IY);
+			break;
+		case 0xE9:			/* JP (IY) */
+			PC = IY;
+			break;
+		case 0xF9:			/* LD SP,IY */
+			SP = IY;
+			break;
+		default: PC--;		/* ignore DD */
+		}
+		CHECK_NEXT;
+	OPCODE(fe):			/* CP nn */
+		CYCLES(z80_cc_op[0xfe]);
+		temp = GetBYTE(PC++);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		NEXT;
+	OPCODE(ff):			/* RST 38H */
+		CYCLES(z80_cc_op[0xff]);
+		PUSH(PC); PC = 0x38;
+	BRANCH_NEXT;
+    }
+    }
+    /* PC has run past 0FFFFH; kept apart from the dispatch, so that
+       it costs the dispatch no registers */
+wrapped:
+    PC &= 0xffff;
+    if (CYC < deadline)
+	goto dispatch;
+/* make registers visible for debugging if interrupted */
+expired:
+    SAVE_STATE();
+    return (PC&0xffff)|SIMZ80_STOP;	/* flag non-bios stop */
+
+#ifdef OPT_BBCACHE
+    /* run pre-decoded basic blocks while the code stays in the cache */
+bb_enter:
+#ifdef DEBUG
+    if (stopsim) {
+	SAVE_STATE();
+	return (PC&0xffff)|SIMZ80_STOP;
+    }
+#endif
+    if (CYC >= deadline)
+	goto expired;
+#if defined(OPT_PROFILE) || defined(OPT_TRACE)
+    if (cpu->prof != NULL || cpu->trace != NULL)
+	goto bb_interp;		/* see every instruction */
+#endif
+#ifdef OPT_JIT
+    if (cpu->jit.arena != NULL && cpu->bb->map[PC & 0xffff] != NULL) {
+	JIT_SAVE();
+	PC = jit_run(cpu, PC, deadline);
+	JIT_LOAD();
+	if (cpu->jit.deadline < deadline)
+	    deadline = cpu->jit.deadline;	/* cut by a helper */
+	if (PC & JIT_HALT) {
+	    PC &= 0xffff;
+	    SAVE_STATE();
+	    return PC;
+	}
+	if (CYC >= deadline)
+	    goto expired;
+    }
+#endif
+    if ((ins = bb_lookup(cpu, PC & 0xffff)) == NULL)
+	goto bb_interp;
+#ifdef OPT_FUSION
+    if (cpu->bb->pairs != NULL)
+	bb_count_pairs(cpu, ins);
+#endif
+    PC++;
+    for (;;) {
+	BB_DISPATCH() {
+	BB_OPCODE(00):			/* NOP */
+		CYCLES(z80_cc_op[0x00]);
+		BB_NEXT;
+	BB_OPCODE(01):			/* LD BC,nnnn */
+		CYCLES(z80_cc_op[0x01]);
+		BC = BB_IMM;
+		PC += 2;
+		BB_NEXT;
+	BB_OPCODE(02):			/* LD (BC),A */
+		CYCLES(z80_cc_op[0x02]);
+		PutBYTE(BC, hreg(AF));
+		BB_NEXT;
+	BB_OPCODE(03):			/* INC BC */
+		CYCLES(z80_cc_op[0x03]);
+		++BC;
+		BB_NEXT;
+	BB_OPCODE(04):			/* INC B */
+		CYCLES(z80_cc_op[0x04]);
+		BC += 0x100;
+		temp = hreg(BC);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+		BB_NEXT;
+	BB_OPCODE(05):			/* DEC B */
+		CYCLES(z80_cc_op[0x05]);
+		BC -= 0x100;
+		temp = hreg(BC);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+		BB_NEXT;
+	BB_OPCODE(06):			/* LD B,nn */
+		CYCLES(z80_cc_op[0x06]);
+		Sethreg(BC, (PC++, BB_IMM));
+		BB_NEXT;
+	BB_OPCODE(07):			/* RLCA */
+		CYCLES(z80_cc_op[0x07]);
+		SYNC_FLAGS();
+		AF = ((AF >> 7) & 0x0128) | ((AF << 1) & ~0x1ff) |
+			(AF & 0xc4) | ((AF >> 15) & 1);
+		BB_NEXT;
+	BB_OPCODE(08):			/* EX AF,AF' */
+		CYCLES(z80_cc_op[0x08]);
+		SYNC_FLAGS();
+		cpu->af[cpu->af_sel] = AF;
+		cpu->af_sel = 1 - cpu->af_sel;
+		AF = cpu->af[cpu->af_sel];
+		BB_NEXT;
+	BB_OPCODE(09):			/* ADD HL,BC */
+		CYCLES(z80_cc_op[0x09]);
+		HL &= 0xffff;
+		BC &= 0xffff;
+		sum = HL + BC;
+		cbits = (HL ^ BC ^ sum) >> 8;
+		HL = sum;
+		SYNC_FLAGS();
+		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+		BB_NEXT;
+	BB_OPCODE(0a):			/* LD A,(BC) */
+		CYCLES(z80_cc_op[0x0a]);
+		Sethreg(AF, GetBYTE(BC));
+		BB_NEXT;
+	BB_OPCODE(0b):			/* DEC BC */
+		CYCLES(z80_cc_op[0x0b]);
+		--BC;
+		BB_NEXT;
+	BB_OPCODE(0c):			/* INC C */
+		CYCLES(z80_cc_op[0x0c]);
+		temp = lreg(BC)+1;
+		Setlreg(BC, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+		BB_NEXT;
+	BB_OPCODE(0d):			/* DEC C */
+		CYCLES(z80_cc_op[0x0d]);
+		temp = lreg(BC)-1;
+		Setlreg(BC, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+		BB_NEXT;
+	BB_OPCODE(0e):			/* LD C,nn */
+		CYCLES(z80_cc_op[0x0e]);
+		Setlreg(BC, (PC++, BB_IMM));
+		BB_NEXT;
+	BB_OPCODE(0f):			/* RRCA */
+		CYCLES(z80_cc_op[0x0f]);
+		SYNC_FLAGS();
+		temp = hreg(AF);
+		sum = temp >> 1;
+		AF = ((temp & 1) << 15) | (sum << 8) |
+			(sum & 0x28) | (AF & 0xc4) | (temp & 1);
+		BB_NEXT;
+	BB_OPCODE(10):			/* DJNZ dd */
+		CYCLES(z80_cc_op[0x10]);
+		BB_JRC((BC -= 0x100) & 0xff00);
+		goto bb_enter;
+	BB_OPCODE(11):			/* LD DE,nnnn */
+		CYCLES(z80_cc_op[0x11]);
+		DE = BB_IMM;
+		PC += 2;
+		BB_NEXT;
+	BB_OPCODE(12):			/* LD (DE),A */
+		CYCLES(z80_cc_op[0x12]);
+		PutBYTE(DE, hreg(AF));
+		BB_NEXT;
+	BB_OPCODE(13):			/* INC DE */
+		CYCLES(z80_cc_op[0x13]);
+		++DE;
+		BB_NEXT;
+	BB_OPCODE(14):			/* INC D */
+		CYCLES(z80_cc_op[0x14]);
+		DE += 0x100;
+		temp = hreg(DE);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+		BB_NEXT;
+	BB_OPCODE(15):			/* DEC D */
+		CYCLES(z80_cc_op[0x15]);
+		DE -= 0x100;
+		temp = hreg(DE);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+		BB_NEXT;
+	BB_OPCODE(16):			/* LD D,nn */
+		CYCLES(z80_cc_op[0x16]);
+		Sethreg(DE, (PC++, BB_IMM));
+		BB_NEXT;
+	BB_OPCODE(17):			/* RLA */
+		CYCLES(z80_cc_op[0x17]);
+		SYNC_FLAGS();
+		AF = ((AF << 8) & 0x0100) | ((AF >> 7) & 0x28) | ((AF << 1) & ~0x01ff) |
+			(AF & 0xc4) | ((AF >> 15) & 1);
+		BB_NEXT;
+	BB_OPCODE(18):			/* JR dd */
+		CYCLES(z80_cc_op[0x18]);
+		PC = ins->target;
+		goto bb_enter;
+	BB_OPCODE(19):			/* ADD HL,DE */
+		CYCLES(z80_cc_op[0x19]);
+		HL &= 0xffff;
+		DE &= 0xffff;
+		sum = HL + DE;
+		cbits = (HL ^ DE ^ sum) >> 8;
+		HL = sum;
+		SYNC_FLAGS();
+		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+		BB_NEXT;
+	BB_OPCODE(1a):			/* LD A,(DE) */
+		CYCLES(z80_cc_op[0x1a]);
+		Sethreg(AF, GetBYTE(DE));
+		BB_NEXT;
+	BB_OPCODE(1b):			/* DEC DE */
+		CYCLES(z80_cc_op[0x1b]);
+		--DE;
+		BB_NEXT;
+	BB_OPCODE(1c):			/* INC E */
+		CYCLES(z80_cc_op[0x1c]);
+		temp = lreg(DE)+1;
+		Setlreg(DE, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+		BB_NEXT;
+	BB_OPCODE(1d):			/* DEC E */
+		CYCLES(z80_cc_op[0x1d]);
+		temp = lreg(DE)-1;
+		Setlreg(DE, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+		BB_NEXT;
+	BB_OPCODE(1e):			/* LD E,nn */
+		CYCLES(z80_cc_op[0x1e]);
+		Setlreg(DE, (PC++, BB_IMM));
+		BB_NEXT;
+	BB_OPCODE(1f):			/* RRA */
+		CYCLES(z80_cc_op[0x1f]);
+		SYNC_FLAGS();
+		temp = hreg(AF);
+		sum = temp >> 1;
+		AF = ((AF & 1) << 15) | (sum << 8) |
+			(sum & 0x28) | (AF & 0xc4) | (temp & 1);
+		BB_NEXT;
+	BB_OPCODE(20):			/* JR NZ,dd */
+		CYCLES(z80_cc_op[0x20]);
+		BB_JRC(!TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(21):			/* LD HL,nnnn */
+		CYCLES(z80_cc_op[0x21]);
+		HL = BB_IMM;
+		PC += 2;
+		BB_NEXT;
+	BB_OPCODE(22):			/* LD (nnnn),HL */
+		CYCLES(z80_cc_op[0x22]);
+		temp = BB_IMM;
+		PutWORD(temp, HL);
+		PC += 2;
+		BB_NEXT;
+	BB_OPCODE(23):			/* INC HL */
+		CYCLES(z80_cc_op[0x23]);
+		++HL;
+		BB_NEXT;
+	BB_OPCODE(24):			/* INC H */
+		CYCLES(z80_cc_op[0x24]);
+		HL += 0x100;
+		temp = hreg(HL);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+		BB_NEXT;
+	BB_OPCODE(25):			/* DEC H */
+		CYCLES(z80_cc_op[0x25]);
+		HL -= 0x100;
+		temp = hreg(HL);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+		BB_NEXT;
+	BB_OPCODE(26):			/* LD H,nn */
+		CYCLES(z80_cc_op[0x26]);
+		Sethreg(HL, (PC++, BB_IMM));
+		BB_NEXT;
+	BB_OPCODE(27):			/* DAA */
+		CYCLES(z80_cc_op[0x27]);
+		SYNC_FLAGS();
+		acu = hreg(AF);
+		temp = ldig(acu);
+		cbits = TSTFLAG(C);
+		if (TSTFLAG(N)) {	/* last operation was a subtract */
+			int hd = cbits || acu > 0x99;
+			if (TSTFLAG(H) || (temp > 9)) { /* adjust low digit */
+				if (temp > 5)
+					SETFLAG(H, 0);
+				acu -= 6;
+				acu &= 0xff;
+			}
+			if (hd)		/* adjust high digit */
+				acu -= 0x160;
+		}
+		else {			/* last operation was an add */
+			if (TSTFLAG(H) || (temp > 9)) { /* adjust low digit */
+				SETFLAG(H, (temp > 9));
+				acu += 6;
+			}
+			if (cbits || ((acu & 0x1f0) > 0x90)) /* adjust high digit */
+				acu += 0x60;
+		}
+		cbits |= (acu >> 8) & 1;
+		acu &= 0xff;
+		AF = (acu << 8) | (acu & 0xa8) | ((acu == 0) << 6) |
+			(AF & 0x12) | partab[acu] | cbits;
+		BB_NEXT;
+	BB_OPCODE(28):			/* JR Z,dd */
+		CYCLES(z80_cc_op[0x28]);
+		BB_JRC(TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(29):			/* ADD HL,HL */
+		CYCLES(z80_cc_op[0x29]);
+		HL &= 0xffff;
+		sum = HL + HL;
+		cbits = (HL ^ HL ^ sum) >> 8;
+		HL = sum;
+		SYNC_FLAGS();
+		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+		BB_NEXT;
+	BB_OPCODE(2a):			/* LD HL,(nnnn) */
+		CYCLES(z80_cc_op[0x2a]);
+		temp = BB_IMM;
+		HL = GetWORD(temp);
+		PC += 2;
+		BB_NEXT;
+	BB_OPCODE(2b):			/* DEC HL */
+		CYCLES(z80_cc_op[0x2b]);
+		--HL;
+		BB_NEXT;
+	BB_OPCODE(2c):			/* INC L */
+		CYCLES(z80_cc_op[0x2c]);
+		temp = lreg(HL)+1;
+		Setlreg(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+		BB_NEXT;
+	BB_OPCODE(2d):			/* DEC L */
+		CYCLES(z80_cc_op[0x2d]);
+		temp = lreg(HL)-1;
+		Setlreg(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+		BB_NEXT;
+	BB_OPCODE(2e):			/* LD L,nn */
+		CYCLES(z80_cc_op[0x2e]);
+		Setlreg(HL, (PC++, BB_IMM));
+		BB_NEXT;
+	BB_OPCODE(2f):			/* CPL */
+		CYCLES(z80_cc_op[0x2f]);
+		SYNC_FLAGS();
+		AF = (~AF & ~0xff) | (AF & 0xc5) | ((~AF >> 8) & 0x28) | 0x12;
+		BB_NEXT;
+	BB_OPCODE(30):			/* JR NC,dd */
+		CYCLES(z80_cc_op[0x30]);
+		BB_JRC(!TSTFLAG(C));
+		goto bb_enter;
+	BB_OPCODE(31):			/* LD SP,nnnn */
+		CYCLES(z80_cc_op[0x31]);
+		SP = BB_IMM;
+		PC += 2;
+		BB_NEXT;
+	BB_OPCODE(32):			/* LD (nnnn),A */
+		CYCLES(z80_cc_op[0x32]);
+		temp = BB_IMM;
+		PutBYTE(temp, hreg(AF));
+		PC += 2;
+		BB_NEXT;
+	BB_OPCODE(33):			/* INC SP */
+		CYCLES(z80_cc_op[0x33]);
+		++SP;
+		BB_NEXT;
+	BB_OPCODE(34):			/* INC (HL) */
+		CYCLES(z80_cc_op[0x34]);
+		temp = GetBYTE(HL)+1;
+		PutBYTE(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+		BB_NEXT;
+	BB_OPCODE(35):			/* DEC (HL) */
+		CYCLES(z80_cc_op[0x35]);
+		temp = GetBYTE(HL)-1;
+		PutBYTE(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+		BB_NEXT;
+	BB_OPCODE(36):			/* LD (HL),nn */
+		CYCLES(z80_cc_op[0x36]);
+		PutBYTE(HL, (PC++, BB_IMM));
+		BB_NEXT;
+	BB_OPCODE(37):			/* SCF */
+		CYCLES(z80_cc_op[0x37]);
+		SYNC_FLAGS();
+		AF = (AF&~0x3b)|((AF>>8)&0x28)|1;
+		BB_NEXT;
+	BB_OPCODE(38):			/* JR C,dd */
+		CYCLES(z80_cc_op[0x38]);
+		BB_JRC(TSTFLAG(C));
+		goto bb_enter;
+	BB_OPCODE(39):			/* ADD HL,SP */
+		CYCLES(z80_cc_op[0x39]);
+		HL &= 0xffff;
+		SP &= 0xffff;
+		sum = HL + SP;
+		cbits = (HL ^ SP ^ sum) >> 8;
+		HL = sum;
+		SYNC_FLAGS();
+		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+		BB_NEXT;
+	BB_OPCODE(3a):			/* LD A,(nnnn) */
+		CYCLES(z80_cc_op[0x3a]);
+		temp = BB_IMM;
+		Sethreg(AF, GetBYTE(temp));
+		PC += 2;
+		BB_NEXT;
+	BB_OPCODE(3b):			/* DEC SP */
+		CYCLES(z80_cc_op[0x3b]);
+		--SP;
+		BB_NEXT;
+	BB_OPCODE(3c):			/* INC A */
+		CYCLES(z80_cc_op[0x3c]);
+		AF += 0x100;
+		temp = hreg(AF);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+		BB_NEXT;
+	BB_OPCODE(3d):			/* DEC A */
+		CYCLES(z80_cc_op[0x3d]);
+		AF -= 0x100;
+		temp = hreg(AF);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+		BB_NEXT;
+	BB_OPCODE(3e):			/* LD A,nn */
+		CYCLES(z80_cc_op[0x3e]);
+		Sethreg(AF, (PC++, BB_IMM));
+		BB_NEXT;
+	BB_OPCODE(3f):			/* CCF */
+		CYCLES(z80_cc_op[0x3f]);
+		SYNC_FLAGS();
+		AF = (AF&~0x3b)|((AF>>8)&0x28)|((AF&1)<<4)|(~AF&1);
+		BB_NEXT;
+	BB_OPCODE(40):			/* LD B,B */
+		CYCLES(z80_cc_op[0x40]);
+		/* nop */
+		BB_NEXT;
+	BB_OPCODE(41):			/* LD B,C */
+		CYCLES(z80_cc_op[0x41]);
+		BC = (BC & 255) | ((BC & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(42):			/* LD B,D */
+		CYCLES(z80_cc_op[0x42]);
+		BC = (BC & 255) | (DE & ~255);
+		BB_NEXT;
+	BB_OPCODE(43):			/* LD B,E */
+		CYCLES(z80_cc_op[0x43]);
+		BC = (BC & 255) | ((DE & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(44):			/* LD B,H */
+		CYCLES(z80_cc_op[0x44]);
+		BC = (BC & 255) | (HL & ~255);
+		BB_NEXT;
+	BB_OPCODE(45):			/* LD B,L */
+		CYCLES(z80_cc_op[0x45]);
+		BC = (BC & 255) | ((HL & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(46):			/* LD B,(HL) */
+		CYCLES(z80_cc_op[0x46]);
+		Sethreg(BC, GetBYTE(HL));
+		BB_NEXT;
+	BB_OPCODE(47):			/* LD B,A */
+		CYCLES(z80_cc_op[0x47]);
+		BC = (BC & 255) | (AF & ~255);
+		BB_NEXT;
+	BB_OPCODE(48):			/* LD C,B */
+		CYCLES(z80_cc_op[0x48]);
+		BC = (BC & ~255) | ((BC >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(49):			/* LD C,C */
+		CYCLES(z80_cc_op[0x49]);
+		/* nop */
+		BB_NEXT;
+	BB_OPCODE(4a):			/* LD C,D */
+		CYCLES(z80_cc_op[0x4a]);
+		BC = (BC & ~255) | ((DE >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(4b):			/* LD C,E */
+		CYCLES(z80_cc_op[0x4b]);
+		BC = (BC & ~255) | (DE & 255);
+		BB_NEXT;
+	BB_OPCODE(4c):			/* LD C,H */
+		CYCLES(z80_cc_op[0x4c]);
+		BC = (BC & ~255) | ((HL >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(4d):			/* LD C,L */
+		CYCLES(z80_cc_op[0x4d]);
+		BC = (BC & ~255) | (HL & 255);
+		BB_NEXT;
+	BB_OPCODE(4e):			/* LD C,(HL) */
+		CYCLES(z80_cc_op[0x4e]);
+		Setlreg(BC, GetBYTE(HL));
+		BB_NEXT;
+	BB_OPCODE(4f):			/* LD C,A */
+		CYCLES(z80_cc_op[0x4f]);
+		BC = (BC & ~255) | ((AF >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(50):			/* LD D,B */
+		CYCLES(z80_cc_op[0x50]);
+		DE = (DE & 255) | (BC & ~255);
+		BB_NEXT;
+	BB_OPCODE(51):			/* LD D,C */
+		CYCLES(z80_cc_op[0x51]);
+		DE = (DE & 255) | ((BC & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(52):			/* LD D,D */
+		CYCLES(z80_cc_op[0x52]);
+		/* nop */
+		BB_NEXT;
+	BB_OPCODE(53):			/* LD D,E */
+		CYCLES(z80_cc_op[0x53]);
+		DE = (DE & 255) | ((DE & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(54):			/* LD D,H */
+		CYCLES(z80_cc_op[0x54]);
+		DE = (DE & 255) | (HL & ~255);
+		BB_NEXT;
+	BB_OPCODE(55):			/* LD D,L */
+		CYCLES(z80_cc_op[0x55]);
+		DE = (DE & 255) | ((HL & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(56):			/* LD D,(HL) */
+		CYCLES(z80_cc_op[0x56]);
+		Sethreg(DE, GetBYTE(HL));
+		BB_NEXT;
+	BB_OPCODE(57):			/* LD D,A */
+		CYCLES(z80_cc_op[0x57]);
+		DE = (DE & 255) | (AF & ~255);
+		BB_NEXT;
+	BB_OPCODE(58):			/* LD E,B */
+		CYCLES(z80_cc_op[0x58]);
+		DE = (DE & ~255) | ((BC >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(59):			/* LD E,C */
+		CYCLES(z80_cc_op[0x59]);
+		DE = (DE & ~255) | (BC & 255);
+		BB_NEXT;
+	BB_OPCODE(5a):			/* LD E,D */
+		CYCLES(z80_cc_op[0x5a]);
+		DE = (DE & ~255) | ((DE >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(5b):			/* LD E,E */
+		CYCLES(z80_cc_op[0x5b]);
+		/* nop */
+		BB_NEXT;
+	BB_OPCODE(5c):			/* LD E,H */
+		CYCLES(z80_cc_op[0x5c]);
+		DE = (DE & ~255) | ((HL >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(5d):			/* LD E,L */
+		CYCLES(z80_cc_op[0x5d]);
+		DE = (DE & ~255) | (HL & 255);
+		BB_NEXT;
+	BB_OPCODE(5e):			/* LD E,(HL) */
+		CYCLES(z80_cc_op[0x5e]);
+		Setlreg(DE, GetBYTE(HL));
+		BB_NEXT;
+	BB_OPCODE(5f):			/* LD E,A */
+		CYCLES(z80_cc_op[0x5f]);
+		DE = (DE & ~255) | ((AF >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(60):			/* LD H,B */
+		CYCLES(z80_cc_op[0x60]);
+		HL = (HL & 255) | (BC & ~255);
+		BB_NEXT;
+	BB_OPCODE(61):			/* LD H,C */
+		CYCLES(z80_cc_op[0x61]);
+		HL = (HL & 255) | ((BC & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(62):			/* LD H,D */
+		CYCLES(z80_cc_op[0x62]);
+		HL = (HL & 255) | (DE & ~255);
+		BB_NEXT;
+	BB_OPCODE(63):			/* LD H,E */
+		CYCLES(z80_cc_op[0x63]);
+		HL = (HL & 255) | ((DE & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(64):			/* LD H,H */
+		CYCLES(z80_cc_op[0x64]);
+		/* nop */
+		BB_NEXT;
+	BB_OPCODE(65):			/* LD H,L */
+		CYCLES(z80_cc_op[0x65]);
+		HL = (HL & 255) | ((HL & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(66):			/* LD H,(HL) */
+		CYCLES(z80_cc_op[0x66]);
+		Sethreg(HL, GetBYTE(HL));
+		BB_NEXT;
+	BB_OPCODE(67):			/* LD H,A */
+		CYCLES(z80_cc_op[0x67]);
+		HL = (HL & 255) | (AF & ~255);
+		BB_NEXT;
+	BB_OPCODE(68):			/* LD L,B */
+		CYCLES(z80_cc_op[0x68]);
+		HL = (HL & ~255) | ((BC >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(69):			/* LD L,C */
+		CYCLES(z80_cc_op[0x69]);
+		HL = (HL & ~255) | (BC & 255);
+		BB_NEXT;
+	BB_OPCODE(6a):			/* LD L,D */
+		CYCLES(z80_cc_op[0x6a]);
+		HL = (HL & ~255) | ((DE >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(6b):			/* LD L,E */
+		CYCLES(z80_cc_op[0x6b]);
+		HL = (HL & ~255) | (DE & 255);
+		BB_NEXT;
+	BB_OPCODE(6c):			/* LD L,H */
+		CYCLES(z80_cc_op[0x6c]);
+		HL = (HL & ~255) | ((HL >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(6d):			/* LD L,L */
+		CYCLES(z80_cc_op[0x6d]);
+		/* nop */
+		BB_NEXT;
+	BB_OPCODE(6e):			/* LD L,(HL) */
+		CYCLES(z80_cc_op[0x6e]);
+		Setlreg(HL, GetBYTE(HL));
+		BB_NEXT;
+	BB_OPCODE(6f):			/* LD L,A */
+		CYCLES(z80_cc_op[0x6f]);
+		HL = (HL & ~255) | ((AF >> 8) & 255);
+		BB_NEXT;
+	BB_OPCODE(70):			/* LD (HL),B */
+		CYCLES(z80_cc_op[0x70]);
+		PutBYTE(HL, hreg(BC));
+		BB_NEXT;
+	BB_OPCODE(71):			/* LD (HL),C */
+		CYCLES(z80_cc_op[0x71]);
+		PutBYTE(HL, lreg(BC));
+		BB_NEXT;
+	BB_OPCODE(72):			/* LD (HL),D */
+		CYCLES(z80_cc_op[0x72]);
+		PutBYTE(HL, hreg(DE));
+		BB_NEXT;
+	BB_OPCODE(73):			/* LD (HL),E */
+		CYCLES(z80_cc_op[0x73]);
+		PutBYTE(HL, lreg(DE));
+		BB_NEXT;
+	BB_OPCODE(74):			/* LD (HL),H */
+		CYCLES(z80_cc_op[0x74]);
+		PutBYTE(HL, hreg(HL));
+		BB_NEXT;
+	BB_OPCODE(75):			/* LD (HL),L */
+		CYCLES(z80_cc_op[0x75]);
+		PutBYTE(HL, lreg(HL));
+		BB_NEXT;
+	BB_OPCODE(76):			/* HALT */
+		CYCLES(z80_cc_op[0x76]);
+		SAVE_STATE();
+		return PC&0xffff;
+	BB_OPCODE(77):			/* LD (HL),A */
+		CYCLES(z80_cc_op[0x77]);
+		PutBYTE(HL, hreg(AF));
+		BB_NEXT;
+	BB_OPCODE(78):			/* LD A,B */
+		CYCLES(z80_cc_op[0x78]);
+		AF = (AF & 255) | (BC & ~255);
+		BB_NEXT;
+	BB_OPCODE(79):			/* LD A,C */
+		CYCLES(z80_cc_op[0x79]);
+		AF = (AF & 255) | ((BC & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(7a):			/* LD A,D */
+		CYCLES(z80_cc_op[0x7a]);
+		AF = (AF & 255) | (DE & ~255);
+		BB_NEXT;
+	BB_OPCODE(7b):			/* LD A,E */
+		CYCLES(z80_cc_op[0x7b]);
+		AF = (AF & 255) | ((DE & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(7c):			/* LD A,H */
+		CYCLES(z80_cc_op[0x7c]);
+		AF = (AF & 255) | (HL & ~255);
+		BB_NEXT;
+	BB_OPCODE(7d):			/* LD A,L */
+		CYCLES(z80_cc_op[0x7d]);
+		AF = (AF & 255) | ((HL & 255) << 8);
+		BB_NEXT;
+	BB_OPCODE(7e):			/* LD A,(HL) */
+		CYCLES(z80_cc_op[0x7e]);
+		Sethreg(AF, GetBYTE(HL));
+		BB_NEXT;
+	BB_OPCODE(7f):			/* LD A,A */
+		CYCLES(z80_cc_op[0x7f]);
+		/* nop */
+		BB_NEXT;
+	BB_OPCODE(80):			/* ADD A,B */
+		CYCLES(z80_cc_op[0x80]);
+		temp = hreg(BC);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(81):			/* ADD A,C */
+		CYCLES(z80_cc_op[0x81]);
+		temp = lreg(BC);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(82):			/* ADD A,D */
+		CYCLES(z80_cc_op[0x82]);
+		temp = hreg(DE);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(83):			/* ADD A,E */
+		CYCLES(z80_cc_op[0x83]);
+		temp = lreg(DE);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(84):			/* ADD A,H */
+		CYCLES(z80_cc_op[0x84]);
+		temp = hreg(HL);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(85):			/* ADD A,L */
+		CYCLES(z80_cc_op[0x85]);
+		temp = lreg(HL);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(86):			/* ADD A,(HL) */
+		CYCLES(z80_cc_op[0x86]);
+		temp = GetBYTE(HL);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(87):			/* ADD A,A */
+		CYCLES(z80_cc_op[0x87]);
+		temp = hreg(AF);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(88):			/* ADC A,B */
+		CYCLES(z80_cc_op[0x88]);
+		temp = hreg(BC);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(89):			/* ADC A,C */
+		CYCLES(z80_cc_op[0x89]);
+		temp = lreg(BC);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(8a):			/* ADC A,D */
+		CYCLES(z80_cc_op[0x8a]);
+		temp = hreg(DE);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(8b):			/* ADC A,E */
+		CYCLES(z80_cc_op[0x8b]);
+		temp = lreg(DE);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(8c):			/* ADC A,H */
+		CYCLES(z80_cc_op[0x8c]);
+		temp = hreg(HL);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(8d):			/* ADC A,L */
+		CYCLES(z80_cc_op[0x8d]);
+		temp = lreg(HL);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(8e):			/* ADC A,(HL) */
+		CYCLES(z80_cc_op[0x8e]);
+		temp = GetBYTE(HL);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(8f):			/* ADC A,A */
+		CYCLES(z80_cc_op[0x8f]);
+		temp = hreg(AF);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(90):			/* SUB B */
+		CYCLES(z80_cc_op[0x90]);
+		temp = hreg(BC);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(91):			/* SUB C */
+		CYCLES(z80_cc_op[0x91]);
+		temp = lreg(BC);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(92):			/* SUB D */
+		CYCLES(z80_cc_op[0x92]);
+		temp = hreg(DE);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(93):			/* SUB E */
+		CYCLES(z80_cc_op[0x93]);
+		temp = lreg(DE);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(94):			/* SUB H */
+		CYCLES(z80_cc_op[0x94]);
+		temp = hreg(HL);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(95):			/* SUB L */
+		CYCLES(z80_cc_op[0x95]);
+		temp = lreg(HL);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(96):			/* SUB (HL) */
+		CYCLES(z80_cc_op[0x96]);
+		temp = GetBYTE(HL);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(97):			/* SUB A */
+		CYCLES(z80_cc_op[0x97]);
+		temp = hreg(AF);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(98):			/* SBC A,B */
+		CYCLES(z80_cc_op[0x98]);
+		temp = hreg(BC);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(99):			/* SBC A,C */
+		CYCLES(z80_cc_op[0x99]);
+		temp = lreg(BC);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(9a):			/* SBC A,D */
+		CYCLES(z80_cc_op[0x9a]);
+		temp = hreg(DE);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(9b):			/* SBC A,E */
+		CYCLES(z80_cc_op[0x9b]);
+		temp = lreg(DE);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(9c):			/* SBC A,H */
+		CYCLES(z80_cc_op[0x9c]);
+		temp = hreg(HL);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(9d):			/* SBC A,L */
+		CYCLES(z80_cc_op[0x9d]);
+		temp = lreg(HL);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(9e):			/* SBC A,(HL) */
+		CYCLES(z80_cc_op[0x9e]);
+		temp = GetBYTE(HL);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(9f):			/* SBC A,A */
+		CYCLES(z80_cc_op[0x9f]);
+		temp = hreg(AF);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(a0):			/* AND B */
+		CYCLES(z80_cc_op[0xa0]);
+		sum = ((AF & (BC)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) |
+			((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(a1):			/* AND C */
+		CYCLES(z80_cc_op[0xa1]);
+		sum = ((AF >> 8) & BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(a2):			/* AND D */
+		CYCLES(z80_cc_op[0xa2]);
+		sum = ((AF & (DE)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) |
+			((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(a3):			/* AND E */
+		CYCLES(z80_cc_op[0xa3]);
+		sum = ((AF >> 8) & DE) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(a4):			/* AND H */
+		CYCLES(z80_cc_op[0xa4]);
+		sum = ((AF & (HL)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) |
+			((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(a5):			/* AND L */
+		CYCLES(z80_cc_op[0xa5]);
+		sum = ((AF >> 8) & HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(a6):			/* AND (HL) */
+		CYCLES(z80_cc_op[0xa6]);
+		sum = ((AF >> 8) & GetBYTE(HL)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(a7):			/* AND A */
+		CYCLES(z80_cc_op[0xa7]);
+		sum = ((AF & (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) |
+			((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(a8):			/* XOR B */
+		CYCLES(z80_cc_op[0xa8]);
+		sum = ((AF ^ (BC)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(a9):			/* XOR C */
+		CYCLES(z80_cc_op[0xa9]);
+		sum = ((AF >> 8) ^ BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(aa):			/* XOR D */
+		CYCLES(z80_cc_op[0xaa]);
+		sum = ((AF ^ (DE)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(ab):			/* XOR E */
+		CYCLES(z80_cc_op[0xab]);
+		sum = ((AF >> 8) ^ DE) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(ac):			/* XOR H */
+		CYCLES(z80_cc_op[0xac]);
+		sum = ((AF ^ (HL)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(ad):			/* XOR L */
+		CYCLES(z80_cc_op[0xad]);
+		sum = ((AF >> 8) ^ HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(ae):			/* XOR (HL) */
+		CYCLES(z80_cc_op[0xae]);
+		sum = ((AF >> 8) ^ GetBYTE(HL)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(af):			/* XOR A */
+		CYCLES(z80_cc_op[0xaf]);
+		sum = ((AF ^ (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(b0):			/* OR B */
+		CYCLES(z80_cc_op[0xb0]);
+		sum = ((AF | (BC)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(b1):			/* OR C */
+		CYCLES(z80_cc_op[0xb1]);
+		sum = ((AF >> 8) | BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(b2):			/* OR D */
+		CYCLES(z80_cc_op[0xb2]);
+		sum = ((AF | (DE)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(b3):			/* OR E */
+		CYCLES(z80_cc_op[0xb3]);
+		sum = ((AF >> 8) | DE) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(b4):			/* OR H */
+		CYCLES(z80_cc_op[0xb4]);
+		sum = ((AF | (HL)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(b5):			/* OR L */
+		CYCLES(z80_cc_op[0xb5]);
+		sum = ((AF >> 8) | HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(b6):			/* OR (HL) */
+		CYCLES(z80_cc_op[0xb6]);
+		sum = ((AF >> 8) | GetBYTE(HL)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(b7):			/* OR A */
+		CYCLES(z80_cc_op[0xb7]);
+		sum = ((AF | (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(b8):			/* CP B */
+		CYCLES(z80_cc_op[0xb8]);
+		temp = hreg(BC);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(b9):			/* CP C */
+		CYCLES(z80_cc_op[0xb9]);
+		temp = lreg(BC);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(ba):			/* CP D */
+		CYCLES(z80_cc_op[0xba]);
+		temp = hreg(DE);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(bb):			/* CP E */
+		CYCLES(z80_cc_op[0xbb]);
+		temp = lreg(DE);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(bc):			/* CP H */
+		CYCLES(z80_cc_op[0xbc]);
+		temp = hreg(HL);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(bd):			/* CP L */
+		CYCLES(z80_cc_op[0xbd]);
+		temp = lreg(HL);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(be):			/* CP (HL) */
+		CYCLES(z80_cc_op[0xbe]);
+		temp = GetBYTE(HL);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(bf):			/* CP A */
+		CYCLES(z80_cc_op[0xbf]);
+		temp = hreg(AF);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(c0):			/* RET NZ */
+		CYCLES(z80_cc_op[0xc0]);
+		RETC(!TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(c1):			/* POP BC */
+		CYCLES(z80_cc_op[0xc1]);
+		POP(BC);
+		BB_NEXT;
+	BB_OPCODE(c2):			/* JP NZ,nnnn */
+		CYCLES(z80_cc_op[0xc2]);
+		BB_JPC(!TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(c3):			/* JP nnnn */
+		CYCLES(z80_cc_op[0xc3]);
+		BB_JPC(1);
+		goto bb_enter;
+	BB_OPCODE(c4):			/* CALL NZ,nnnn */
+		CYCLES(z80_cc_op[0xc4]);
+		BB_CALLC(!TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(c5):			/* PUSH BC */
+		CYCLES(z80_cc_op[0xc5]);
+		PUSH(BC);
+		BB_NEXT;
+	BB_OPCODE(c6):			/* ADD A,nn */
+		CYCLES(z80_cc_op[0xc6]);
+		temp = (PC++, BB_IMM);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(c7):			/* RST 0 */
+		CYCLES(z80_cc_op[0xc7]);
+		PUSH(PC); PC = 0;
+		goto bb_enter;
+	BB_OPCODE(c8):			/* RET Z */
+		CYCLES(z80_cc_op[0xc8]);
+		RETC(TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(c9):			/* RET */
+		CYCLES(z80_cc_op[0xc9]);
+		POP(PC);
+		goto bb_enter;
+	BB_OPCODE(ca):			/* JP Z,nnnn */
+		CYCLES(z80_cc_op[0xca]);
+		BB_JPC(TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(cb):			/* CB prefix */
+		adr = HL;
+		SYNC_FLAGS();
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_cb[op]);
+		switch (op & 7) {
+		case 0: acu = hreg(BC); break;
+		case 1: acu = lreg(BC); break;
+		case 2: acu = hreg(DE); break;
+		case 3: acu = lreg(DE); break;
+		case 4: acu = hreg(HL); break;
+		case 5: acu = lreg(HL); break;
+		case 6: acu = GetBYTE(adr);  break;
+		case 7: acu = hreg(AF); break;
+		}
+		switch (op & 0xc0) {
+		case 0x00:		/* shift/rotate */
+			switch (op & 0x38) {
+			case 0x00:	/* RLC */
+				temp = (acu << 1) | (acu >> 7);
+				cbits = temp & 1;
+				goto bb_cbshflg1;
+			case 0x08:	/* RRC */
+				temp = (acu >> 1) | (acu << 7);
+				cbits = temp & 0x80;
+				goto bb_cbshflg1;
+			case 0x10:	/* RL */
+				temp = (acu << 1) | TSTFLAG(C);
+				cbits = acu & 0x80;
+				goto bb_cbshflg1;
+			case 0x18:	/* RR */
+				temp = (acu >> 1) | (TSTFLAG(C) << 7);
+				cbits = acu & 1;
+				goto bb_cbshflg1;
+			case 0x20:	/* SLA */
+				temp = acu << 1;
+				cbits = acu & 0x80;
+				goto bb_cbshflg1;
+			case 0x28:	/* SRA */
+				temp = (acu >> 1) | (acu & 0x80);
+				cbits = acu & 1;
+				goto bb_cbshflg1;
+			case 0x30:	/* SLIA */
+				temp = (acu << 1) | 1;
+				cbits = acu & 0x80;
+				goto bb_cbshflg1;
+			default:	/* SRL (0x38) */
+				temp = acu >> 1;
+				cbits = acu & 1;
+			bb_cbshflg1:
+				AF = (AF & ~0xff) | (temp & 0xa8) |
+					(((temp & 0xff) == 0) << 6) |
+					parity(temp) | !!cbits;
+			}
+			break;
+		case 0x40:		/* BIT */
+			if (acu & (1 << ((op >> 3) & 7)))
+				AF = (AF & ~0xfe) | 0x10 |
+				(((op & 0x38) == 0x38) << 7);
+			else
+				AF = (AF & ~0xfe) | 0x54;
+			if ((op&7) != 6)
+				AF |= (acu & 0x28);
+			temp = acu;
+			break;
+		case 0x80:		/* RES */
+			temp = acu & ~(1 << ((op >> 3) & 7));
+			break;
+		default:		/* SET (0xc0) */
+			temp = acu | (1 << ((op >> 3) & 7));
+			break;
+		}
+		switch (op & 7) {
+		case 0: Sethreg(BC, temp); break;
+		case 1: Setlreg(BC, temp); break;
+		case 2: Sethreg(DE, temp); break;
+		case 3: Setlreg(DE, temp); break;
+		case 4: Sethreg(HL, temp); break;
+		case 5: Setlreg(HL, temp); break;
+		case 6: PutBYTE(adr, temp);  break;
+		case 7: Sethreg(AF, temp); break;
+		}
+		BB_NEXT_CHECK;
+	BB_OPCODE(cc):			/* CALL Z,nnnn */
+		CYCLES(z80_cc_op[0xcc]);
+		BB_CALLC(TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(cd):			/* CALL nnnn */
+		CYCLES(z80_cc_op[0xcd]);
+		BB_CALL();
+		goto bb_enter;
+	BB_OPCODE(ce):			/* ADC A,nn */
+		CYCLES(z80_cc_op[0xce]);
+		temp = (PC++, BB_IMM);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(cf):			/* RST 8 */
+		CYCLES(z80_cc_op[0xcf]);
+		PUSH(PC); PC = 8;
+		goto bb_enter;
+	BB_OPCODE(d0):			/* RET NC */
+		CYCLES(z80_cc_op[0xd0]);
+		RETC(!TSTFLAG(C));
+		goto bb_enter;
+	BB_OPCODE(d1):			/* POP DE */
+		CYCLES(z80_cc_op[0xd1]);
+		POP(DE);
+		BB_NEXT;
+	BB_OPCODE(d2):			/* JP NC,nnnn */
+		CYCLES(z80_cc_op[0xd2]);
+		BB_JPC(!TSTFLAG(C));
+		goto bb_enter;
+	BB_OPCODE(d3):			/* OUT (nn),A */
+		CYCLES(z80_cc_op[0xd3]);
+		Output((PC++, BB_IMM), hreg(AF));
+		if (cpu->sched.next < deadline)
+			deadline = cpu->sched.next;
+		BB_NEXT;
+	BB_OPCODE(d4):			/* CALL NC,nnnn */
+		CYCLES(z80_cc_op[0xd4]);
+		BB_CALLC(!TSTFLAG(C));
+		goto bb_enter;
+	BB_OPCODE(d5):			/* PUSH DE */
+		CYCLES(z80_cc_op[0xd5]);
+		PUSH(DE);
+		BB_NEXT;
+	BB_OPCODE(d6):			/* SUB nn */
+		CYCLES(z80_cc_op[0xd6]);
+		temp = (PC++, BB_IMM);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(d7):			/* RST 10H */
+		CYCLES(z80_cc_op[0xd7]);
+		PUSH(PC); PC = 0x10;
+		goto bb_enter;
+	BB_OPCODE(d8):			/* RET C */
+		CYCLES(z80_cc_op[0xd8]);
+		RETC(TSTFLAG(C));
+		goto bb_enter;
+	BB_OPCODE(d9):			/* EXX */
+		CYCLES(z80_cc_op[0xd9]);
+		cpu->regs[cpu->regs_sel].bc = BC;
+		cpu->regs[cpu->regs_sel].de = DE;
+		cpu->regs[cpu->regs_sel].hl = HL;
+		cpu->regs_sel = 1 - cpu->regs_sel;
+		BC = cpu->regs[cpu->regs_sel].bc;
+		DE = cpu->regs[cpu->regs_sel].de;
+		HL = cpu->regs[cpu->regs_sel].hl;
+		BB_NEXT;
+	BB_OPCODE(da):			/* JP C,nnnn */
+		CYCLES(z80_cc_op[0xda]);
+		BB_JPC(TSTFLAG(C));
+		goto bb_enter;
+	BB_OPCODE(db):			/* IN A,(nn) */
+		CYCLES(z80_cc_op[0xdb]);
+		Sethreg(AF, Input((PC++, BB_IMM)));
+		if (cpu->sched.next < deadline)
+			deadline = cpu->sched.next;
+		BB_NEXT;
+	BB_OPCODE(dc):			/* CALL C,nnnn */
+		CYCLES(z80_cc_op[0xdc]);
+		BB_CALLC(TSTFLAG(C));
+		goto bb_enter;
+	BB_OPCODE(dd):			/* DD prefix */
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_xy[op]);
+		switch (op) {
+		case 0x09:			/* ADD IX,BC */
+			IX &= 0xffff;
+			BC &= 0xffff;
+			sum = IX + BC;
+			cbits = (IX ^ BC ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x19:			/* ADD IX,DE */
+			IX &= 0xffff;
+			DE &= 0xffff;
+			sum = IX + DE;
+			cbits = (IX ^ DE ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x21:			/* LD IX,nnnn */
+			IX = GetWORD(PC);
+			PC += 2;
+			break;
+		case 0x22:			/* LD (nnnn),IX */
+			temp = GetWORD(PC);
+			PutWORD(temp, IX);
+			PC += 2;
+			break;
+		case 0x23:			/* INC IX */
+			++IX;
+			break;
+		case 0x24:			/* INC IXH */
+			IX += 0x100;
+			temp = hreg(IX);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x25:			/* DEC IXH */
+			IX -= 0x100;
+			temp = hreg(IX);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x26:			/* LD IXH,nn */
+			Sethreg(IX, GetBYTE(PC++));
+			break;
+		case 0x29:			/* ADD IX,IX */
+			IX &= 0xffff;
+			sum = IX + IX;
+			cbits = (IX ^ IX ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x2A:			/* LD IX,(nnnn) */
+			temp = GetWORD(PC);
+			IX = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x2B:			/* DEC IX */
+			--IX;
+			break;
+		case 0x2C:			/* INC IXL */
+			temp = lreg(IX)+1;
+			Setlreg(IX, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x2D:			/* DEC IXL */
+			temp = lreg(IX)-1;
+			Setlreg(IX, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x2E:			/* LD IXL,nn */
+			Setlreg(IX, GetBYTE(PC++));
+			break;
+		case 0x34:			/* INC (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)+1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x35:			/* DEC (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)-1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x36:			/* LD (IX+dd),nn */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, GetBYTE(PC++));
+			break;
+		case 0x39:			/* ADD IX,SP */
+			IX &= 0xffff;
+			SP &= 0xffff;
+			sum = IX + SP;
+			cbits = (IX ^ SP ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x44:			/* LD B,IXH */
+			Sethreg(BC, hreg(IX));
+			break;
+		case 0x45:			/* LD B,IXL */
+			Sethreg(BC, lreg(IX));
+			break;
+		case 0x46:			/* LD B,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(BC, GetBYTE(adr));
+			break;
+		case 0x4C:			/* LD C,IXH */
+			Setlreg(BC, hreg(IX));
+			break;
+		case 0x4D:			/* LD C,IXL */
+			Setlreg(BC, lreg(IX));
+			break;
+		case 0x4E:			/* LD C,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Setlreg(BC, GetBYTE(adr));
+			break;
+		case 0x54:			/* LD D,IXH */
+			Sethreg(DE, hreg(IX));
+			break;
+		case 0x55:			/* LD D,IXL */
+			Sethreg(DE, lreg(IX));
+			break;
+		case 0x56:			/* LD D,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(DE, GetBYTE(adr));
+			break;
+		case 0x5C:			/* LD E,IXH */
+			Setlreg(DE, hreg(IX));
+			break;
+		case 0x5D:			/* LD E,IXL */
+			Setlreg(DE, lreg(IX));
+			break;
+		case 0x5E:			/* LD E,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Setlreg(DE, GetBYTE(adr));
+			break;
+		case 0x60:			/* LD IXH,B */
+			Sethreg(IX, hreg(BC));
+			break;
+		case 0x61:			/* LD IXH,C */
+			Sethreg(IX, lreg(BC));
+			break;
+		case 0x62:			/* LD IXH,D */
+			Sethreg(IX, hreg(DE));
+			break;
+		case 0x63:			/* LD IXH,E */
+			Sethreg(IX, lreg(DE));
+			break;
+		case 0x64:			/* LD IXH,IXH */
+			/* nop */
+			break;
+		case 0x65:			/* LD IXH,IXL */
+			Sethreg(IX, lreg(IX));
+			break;
+		case 0x66:			/* LD H,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(HL, GetBYTE(adr));
+			break;
+		case 0x67:			/* LD IXH,A */
+			Sethreg(IX, hreg(AF));
+			break;
+		case 0x68:			/* LD IXL,B */
+			Setlreg(IX, hreg(BC));
+			break;
+		case 0x69:			/* LD IXL,C */
+			Setlreg(IX, lreg(BC));
+			break;
+		case 0x6A:			/* LD IXL,D */
+			Setlreg(IX, hreg(DE));
+			break;
+		case 0x6B:			/* LD IXL,E */
+			Setlreg(IX, lreg(DE));
+			break;
+		case 0x6C:			/* LD IXL,IXH */
+			Setlreg(IX, hreg(IX));
+			break;
+		case 0x6D:			/* LD IXL,IXL */
+			/* nop */
+			break;
+		case 0x6E:			/* LD L,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Setlreg(HL, GetBYTE(adr));
+			break;
+		case 0x6F:			/* LD IXL,A */
+			Setlreg(IX, hreg(AF));
+			break;
+		case 0x70:			/* LD (IX+dd),B */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(BC));
+			break;
+		case 0x71:			/* LD (IX+dd),C */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(BC));
+			break;
+		case 0x72:			/* LD (IX+dd),D */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(DE));
+			break;
+		case 0x73:			/* LD (IX+dd),E */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(DE));
+			break;
+		case 0x74:			/* LD (IX+dd),H */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(HL));
+			break;
+		case 0x75:			/* LD (IX+dd),L */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(HL));
+			break;
+		case 0x77:			/* LD (IX+dd),A */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(AF));
+			break;
+		case 0x7C:			/* LD A,IXH */
+			Sethreg(AF, hreg(IX));
+			break;
+		case 0x7D:			/* LD A,IXL */
+			Sethreg(AF, lreg(IX));
+			break;
+		case 0x7E:			/* LD A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(AF, GetBYTE(adr));
+			break;
+		case 0x84:			/* ADD A,IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x85:			/* ADD A,IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x86:			/* ADD A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8C:			/* ADC A,IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8D:			/* ADC A,IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8E:			/* ADC A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x94:			/* SUB IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x95:			/* SUB IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x96:			/* SUB (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9C:			/* SBC A,IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9D:			/* SBC A,IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9E:			/* SBC A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xA4:			/* AND IXH */
+			sum = ((AF & (IX)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) |
+				((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+			break;
+		case 0xA5:			/* AND IXL */
+			sum = ((AF >> 8) & IX) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xA6:			/* AND (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) & GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAC:			/* XOR IXH */
+			sum = ((AF ^ (IX)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAD:			/* XOR IXL */
+			sum = ((AF >> 8) ^ IX) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAE:			/* XOR (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) ^ GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB4:			/* OR IXH */
+			sum = ((AF | (IX)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB5:			/* OR IXL */
+			sum = ((AF >> 8) | IX) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB6:			/* OR (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) | GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xBC:			/* CP IXH */
+			temp = hreg(IX);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBD:			/* CP IXL */
+			temp = lreg(IX);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBE:			/* CP (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xCB:			/* CB prefix */
+			adr = IX + (signed char) GetBYTE(PC++);
+			adr = adr;
+			SYNC_FLAGS();
+			op = GetBYTE(PC++);
+			CYCLES(z80_cc_xycb[op]);
+			switch (op & 7) {
+			case 0: acu = hreg(BC); break;
+			case 1: acu = lreg(BC); break;
+			case 2: acu = hreg(DE); break;
+			case 3: acu = lreg(DE); break;
+			case 4: acu = hreg(HL); break;
+			case 5: acu = lreg(HL); break;
+			case 6: acu = GetBYTE(adr);  break;
+			case 7: acu = hreg(AF); break;
+			}
+			switch (op & 0xc0) {
+			case 0x00:		/* shift/rotate */
+				switch (op & 0x38) {
+				case 0x00:	/* RLC */
+					temp = (acu << 1) | (acu >> 7);
+					cbits = temp & 1;
+					goto bb_cbshflg2;
+				case 0x08:	/* RRC */
+					temp = (acu >> 1) | (acu << 7);
+					cbits = temp & 0x80;
+					goto bb_cbshflg2;
+				case 0x10:	/* RL */
+					temp = (acu << 1) | TSTFLAG(C);
+					cbits = acu & 0x80;
+					goto bb_cbshflg2;
+				case 0x18:	/* RR */
+					temp = (acu >> 1) | (TSTFLAG(C) << 7);
+					cbits = acu & 1;
+					goto bb_cbshflg2;
+				case 0x20:	/* SLA */
+					temp = acu << 1;
+					cbits = acu & 0x80;
+					goto bb_cbshflg2;
+				case 0x28:	/* SRA */
+					temp = (acu >> 1) | (acu & 0x80);
+					cbits = acu & 1;
+					goto bb_cbshflg2;
+				case 0x30:	/* SLIA */
+					temp = (acu << 1) | 1;
+					cbits = acu & 0x80;
+					goto bb_cbshflg2;
+				default:	/* SRL (0x38) */
+					temp = acu >> 1;
+					cbits = acu & 1;
+				bb_cbshflg2:
+					AF = (AF & ~0xff) | (temp & 0xa8) |
+						(((temp & 0xff) == 0) << 6) |
+						parity(temp) | !!cbits;
+				}
+				break;
+			case 0x40:		/* BIT */
+				if (acu & (1 << ((op >> 3) & 7)))
+					AF = (AF & ~0xfe) | 0x10 |
+					(((op & 0x38) == 0x38) << 7);
+				else
+					AF = (AF & ~0xfe) | 0x54;
+				if ((op&7) != 6)
+					AF |= (acu & 0x28);
+				temp = acu;
+				break;
+			case 0x80:		/* RES */
+				temp = acu & ~(1 << ((op >> 3) & 7));
+				break;
+			default:		/* SET (0xc0) */
+				temp = acu | (1 << ((op >> 3) & 7));
+				break;
+			}
+			switch (op & 7) {
+			case 0: Sethreg(BC, temp); break;
+			case 1: Setlreg(BC, temp); break;
+			case 2: Sethreg(DE, temp); break;
+			case 3: Setlreg(DE, temp); break;
+			case 4: Sethreg(HL, temp); break;
+			case 5: Setlreg(HL, temp); break;
+			case 6: PutBYTE(adr, temp);  break;
+			case 7: Sethreg(AF, temp); break;
+			}
+			break;
+		case 0xE1:			/* POP IX */
+			POP(IX);
+			break;
+		case 0xE3:			/* EX (SP),IX */
+			temp = IX; POP(IX); PUSH(temp);
+			break;
+		case 0xE5:			/* PUSH IX */
+			PUSH(IX);
+			break;
+		case 0xE9:			/* JP (IX) */
+			PC = IX;
+			break;
+		case 0xF9:			/* LD SP,IX */
+			SP = IX;
+			break;
+		default: PC--;		/* ignore DD */
+		}
+		BB_NEXT_CHECK;
+	BB_OPCODE(de):			/* SBC A,nn */
+		CYCLES(z80_cc_op[0xde]);
+		temp = (PC++, BB_IMM);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(df):			/* RST 18H */
+		CYCLES(z80_cc_op[0xdf]);
+		PUSH(PC); PC = 0x18;
+		goto bb_enter;
+	BB_OPCODE(e0):			/* RET PO */
+		CYCLES(z80_cc_op[0xe0]);
+		RETC(!TSTFLAG(P));
+		goto bb_enter;
+	BB_OPCODE(e1):			/* POP HL */
+		CYCLES(z80_cc_op[0xe1]);
+		POP(HL);
+		BB_NEXT;
+	BB_OPCODE(e2):			/* JP PO,nnnn */
+		CYCLES(z80_cc_op[0xe2]);
+		BB_JPC(!TSTFLAG(P));
+		goto bb_enter;
+	BB_OPCODE(e3):			/* EX (SP),HL */
+		CYCLES(z80_cc_op[0xe3]);
+		temp = HL; POP(HL); PUSH(temp);
+		BB_NEXT;
+	BB_OPCODE(e4):			/* CALL PO,nnnn */
+		CYCLES(z80_cc_op[0xe4]);
+		BB_CALLC(!TSTFLAG(P));
+		goto bb_enter;
+	BB_OPCODE(e5):			/* PUSH HL */
+		CYCLES(z80_cc_op[0xe5]);
+		PUSH(HL);
+		BB_NEXT;
+	BB_OPCODE(e6):			/* AND nn */
+		CYCLES(z80_cc_op[0xe6]);
+		sum = ((AF >> 8) & (PC++, BB_IMM)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(e7):			/* RST 20H */
+		CYCLES(z80_cc_op[0xe7]);
+		PUSH(PC); PC = 0x20;
+		goto bb_enter;
+	BB_OPCODE(e8):			/* RET PE */
+		CYCLES(z80_cc_op[0xe8]);
+		RETC(TSTFLAG(P));
+		goto bb_enter;
+	BB_OPCODE(e9):			/* JP (HL) */
+		CYCLES(z80_cc_op[0xe9]);
+		PC = HL;
+		goto bb_enter;
+	BB_OPCODE(ea):			/* JP PE,nnnn */
+		CYCLES(z80_cc_op[0xea]);
+		BB_JPC(TSTFLAG(P));
+		goto bb_enter;
+	BB_OPCODE(eb):			/* EX DE,HL */
+		CYCLES(z80_cc_op[0xeb]);
+		temp = HL; HL = DE; DE = temp;
+		BB_NEXT;
+	BB_OPCODE(ec):			/* CALL PE,nnnn */
+		CYCLES(z80_cc_op[0xec]);
+		BB_CALLC(TSTFLAG(P));
+		goto bb_enter;
+	BB_OPCODE(ed):			/* ED prefix */
+		SYNC_FLAGS();
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_ed[op]);
+		switch (op) {
+		case 0x40:			/* IN B,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(BC, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x41:			/* OUT (C),B */
+			Output(lreg(BC), BC);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x42:			/* SBC HL,BC */
+			HL &= 0xffff;
+			BC &= 0xffff;
+			sum = HL - BC - TSTFLAG(C);
+			cbits = (HL ^ BC ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x43:			/* LD (nnnn),BC */
+			temp = GetWORD(PC);
+			PutWORD(temp, BC);
+			PC += 2;
+			break;
+		case 0x44:			/* NEG */
+			temp = hreg(AF);
+			AF = (-(AF & 0xff00) & 0xff00);
+			AF |= ((AF >> 8) & 0xa8) | (((AF & 0xff00) == 0) << 6) |
+				(((temp & 0x0f) != 0) << 4) | ((temp == 0x80) << 2) |
+				2 | (temp != 0);
+			break;
+		case 0x45:			/* RETN */
+			cpu->IFF |= cpu->IFF >> 1;
+			if (cpu->sched.irq)
+				deadline = CYC;
+			POP(PC);
+			break;
+		case 0x46:			/* IM 0 */
+			cpu->im = 0;
+			break;
+		case 0x47:			/* LD I,A */
+			cpu->ir = (cpu->ir & 255) | (AF & ~255);
+			break;
+		case 0x48:			/* IN C,(C) */
+			temp = Input(lreg(BC));
+			Setlreg(BC, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x49:			/* OUT (C),C */
+			Output(lreg(BC), BC);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x4A:			/* ADC HL,BC */
+			HL &= 0xffff;
+			BC &= 0xffff;
+			sum = HL + BC + TSTFLAG(C);
+			cbits = (HL ^ BC ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x4B:			/* LD BC,(nnnn) */
+			temp = GetWORD(PC);
+			BC = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x4D:			/* RETI */
+			cpu->IFF |= cpu->IFF >> 1;
+			if (cpu->sched.irq)
+				deadline = CYC;
+			POP(PC);
+			break;
+		case 0x4F:			/* LD R,A */
+			cpu->ir = (cpu->ir & ~255) | ((AF >> 8) & 255);
+			cpu->rbase = CYC;
+			break;
+		case 0x50:			/* IN D,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(DE, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x51:			/* OUT (C),D */
+			Output(lreg(BC), DE);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x52:			/* SBC HL,DE */
+			HL &= 0xffff;
+			DE &= 0xffff;
+			sum = HL - DE - TSTFLAG(C);
+			cbits = (HL ^ DE ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x53:			/* LD (nnnn),DE */
+			temp = GetWORD(PC);
+			PutWORD(temp, DE);
+			PC += 2;
+			break;
+		case 0x56:			/* IM 1 */
+			cpu->im = 1;
+			break;
+		case 0x57:			/* LD A,I */
+			AF = (AF & 255) | (cpu->ir & ~255);
+			break;
+		case 0x58:			/* IN E,(C) */
+			temp = Input(lreg(BC));
+			Setlreg(DE, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x59:			/* OUT (C),E */
+			Output(lreg(BC), DE);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x5A:			/* ADC HL,DE */
+			HL &= 0xffff;
+			DE &= 0xffff;
+			sum = HL + DE + TSTFLAG(C);
+			cbits = (HL ^ DE ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x5B:			/* LD DE,(nnnn) */
+			temp = GetWORD(PC);
+			DE = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x5E:			/* IM 2 */
+			cpu->im = 2;
+			break;
+		case 0x5F:			/* LD A,R */
+			AF = (AF & 255) | (Z80_R(cpu, CYC) << 8);
+			break;
+		case 0x60:			/* IN H,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(HL, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x61:			/* OUT (C),H */
+			Output(lreg(BC), HL);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x62:			/* SBC HL,HL */
+			HL &= 0xffff;
+			sum = HL - HL - TSTFLAG(C);
+			cbits = (HL ^ HL ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x63:			/* LD (nnnn),HL */
+			temp = GetWORD(PC);
+			PutWORD(temp, HL);
+			PC += 2;
+			break;
+		case 0x67:			/* RRD */
+			temp = GetBYTE(HL);
+			acu = hreg(AF);
+			PutBYTE(HL, hdig(temp) | (ldig(acu) << 4));
+			acu = (acu & 0xf0) | ldig(temp);
+			AF = (acu << 8) | (acu & 0xa8) | (((acu & 0xff) == 0) << 6) |
+				partab[acu] | (AF & 1);
+			break;
+		case 0x68:			/* IN L,(C) */
+			temp = Input(lreg(BC));
+			Setlreg(HL, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x69:			/* OUT (C),L */
+			Output(lreg(BC), HL);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x6A:			/* ADC HL,HL */
+			HL &= 0xffff;
+			sum = HL + HL + TSTFLAG(C);
+			cbits = (HL ^ HL ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x6B:			/* LD HL,(nnnn) */
+			temp = GetWORD(PC);
+			HL = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x6F:			/* RLD */
+			temp = GetBYTE(HL);
+			acu = hreg(AF);
+			PutBYTE(HL, (ldig(temp) << 4) | ldig(acu));
+			acu = (acu & 0xf0) | hdig(temp);
+			AF = (acu << 8) | (acu & 0xa8) | (((acu & 0xff) == 0) << 6) |
+				partab[acu] | (AF & 1);
+			break;
+		case 0x70:			/* IN (C) */
+			temp = Input(lreg(BC));
+			Setlreg(temp, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x71:			/* OUT (C),0 */
+			Output(lreg(BC), 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x72:			/* SBC HL,SP */
+			HL &= 0xffff;
+			SP &= 0xffff;
+			sum = HL - SP - TSTFLAG(C);
+			cbits = (HL ^ SP ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x73:			/* LD (nnnn),SP */
+			temp = GetWORD(PC);
+			PutWORD(temp, SP);
+			PC += 2;
+			break;
+		case 0x78:			/* IN A,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(AF, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x79:			/* OUT (C),A */
+			Output(lreg(BC), AF);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0x7A:			/* ADC HL,SP */
+			HL &= 0xffff;
+			SP &= 0xffff;
+			sum = HL + SP + TSTFLAG(C);
+			cbits = (HL ^ SP ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x7B:			/* LD SP,(nnnn) */
+			temp = GetWORD(PC);
+			SP = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0xA0:			/* LDI */
+			acu = GetBYTE(HL++);
+			PutBYTE(DE++, acu);
+			acu += hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4) |
+				(((--BC & 0xffff) != 0) << 2);
+			break;
+		case 0xA1:			/* CPI */
+			acu = hreg(AF);
+			temp = GetBYTE(HL++);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) | (cbits & 16) |
+				(sum & 8) | ((--BC & 0xffff) != 0) << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xA2:			/* INI */
+			PutBYTE(HL++, Input(lreg(BC)));
+			SETFLAG(N, 1);
+			SETFLAG(P, (--BC & 0xffff) != 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xA3:			/* OUTI */
+			Output(lreg(BC), GetBYTE(HL++));
+			SETFLAG(N, 1);
+			Sethreg(BC, lreg(BC) - 1);
+			SETFLAG(Z, lreg(BC) == 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xA8:			/* LDD */
+			acu = GetBYTE(HL--);
+			PutBYTE(DE--, acu);
+			acu += hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4) |
+				(((--BC & 0xffff) != 0) << 2);
+			break;
+		case 0xA9:			/* CPD */
+			acu = hreg(AF);
+			temp = GetBYTE(HL--);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) | (cbits & 16) |
+				(sum & 8) | ((--BC & 0xffff) != 0) << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xAA:			/* IND */
+			PutBYTE(HL--, Input(lreg(BC)));
+			SETFLAG(N, 1);
+			Sethreg(BC, lreg(BC) - 1);
+			SETFLAG(Z, lreg(BC) == 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xAB:			/* OUTD */
+			Output(lreg(BC), GetBYTE(HL--));
+			SETFLAG(N, 1);
+			Sethreg(BC, lreg(BC) - 1);
+			SETFLAG(Z, lreg(BC) == 0);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xB0:			/* LDIR */
+			adr = BC & 0xffff ? BC & 0xffff : 0x10000;
+			CYCLES(21 * (adr - 1));
+			trap_move_block(cpu, DE, HL, adr, 0);
+			HL += adr;
+			DE += adr;
+			BC = 0;
+			acu = RAM(DE - 1) + hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
+			break;
+		case 0xB1:			/* CPIR */
+			acu = hreg(AF);
+			adr = trap_find_byte(cpu, HL, BC & 0xffff ? BC & 0xffff : 0x10000,
+					     acu, 0);
+			CYCLES(21 * (adr - 1));
+			HL += adr;
+			BC = (BC - adr) & 0xffff;
+			temp = RAM(HL - 1);
+			op = BC != 0;
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) |
+				(cbits & 16) | (sum & 8) | op << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xB2:			/* INIR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				PutBYTE(HL++, Input(lreg(BC)));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xB3:			/* OTIR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				Output(lreg(BC), GetBYTE(HL++));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xB8:			/* LDDR */
+			adr = BC & 0xffff ? BC & 0xffff : 0x10000;
+			CYCLES(21 * (adr - 1));
+			trap_move_block(cpu, DE, HL, adr, 1);
+			HL -= adr;
+			DE -= adr;
+			BC = 0;
+			acu = RAM(DE + 1) + hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
+			break;
+		case 0xB9:			/* CPDR */
+			acu = hreg(AF);
+			adr = trap_find_byte(cpu, HL, BC & 0xffff ? BC & 0xffff : 0x10000,
+					     acu, 1);
+			CYCLES(21 * (adr - 1));
+			HL -= adr;
+			BC = (BC - adr) & 0xffff;
+			temp = RAM(HL + 1);
+			op = BC != 0;
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) |
+				(cbits & 16) | (sum & 8) | op << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xBA:			/* INDR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				PutBYTE(HL--, Input(lreg(BC)));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		case 0xBB:			/* OTDR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				Output(lreg(BC), GetBYTE(HL--));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < deadline)
+				deadline = cpu->sched.next;
+			break;
+		default: if (0x40 <= op && op <= 0x7f) PC--;		/* ignore ED */
+		}
+		BB_NEXT_CHECK;
+	BB_OPCODE(ee):			/* XOR nn */
+		CYCLES(z80_cc_op[0xee]);
+		sum = ((AF >> 8) ^ (PC++, BB_IMM)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(ef):			/* RST 28H */
+		CYCLES(z80_cc_op[0xef]);
+		PUSH(PC); PC = 0x28;
+		goto bb_enter;
+	BB_OPCODE(f0):			/* RET P */
+		CYCLES(z80_cc_op[0xf0]);
+		RETC(!TSTFLAG(S));
+		goto bb_enter;
+	BB_OPCODE(f1):			/* POP AF */
+		CYCLES(z80_cc_op[0xf1]);
+		SYNC_FLAGS(); POP(AF);
+		BB_NEXT;
+	BB_OPCODE(f2):			/* JP P,nnnn */
+		CYCLES(z80_cc_op[0xf2]);
+		BB_JPC(!TSTFLAG(S));
+		goto bb_enter;
+	BB_OPCODE(f3):			/* DI */
+		CYCLES(z80_cc_op[0xf3]);
+		cpu->IFF = 0;
+		BB_NEXT;
+	BB_OPCODE(f4):			/* CALL P,nnnn */
+		CYCLES(z80_cc_op[0xf4]);
+		BB_CALLC(!TSTFLAG(S));
+		goto bb_enter;
+	BB_OPCODE(f5):			/* PUSH AF */
+		CYCLES(z80_cc_op[0xf5]);
+		SYNC_FLAGS(); PUSH(AF);
+		BB_NEXT;
+	BB_OPCODE(f6):			/* OR nn */
+		CYCLES(z80_cc_op[0xf6]);
+		sum = ((AF >> 8) | (PC++, BB_IMM)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+	BB_OPCODE(f7):			/* RST 30H */
+		CYCLES(z80_cc_op[0xf7]);
+		PUSH(PC); PC = 0x30;
+		goto bb_enter;
+	BB_OPCODE(f8):			/* RET M */
+		CYCLES(z80_cc_op[0xf8]);
+		RETC(TSTFLAG(S));
+		goto bb_enter;
+	BB_OPCODE(f9):			/* LD SP,HL */
+		CYCLES(z80_cc_op[0xf9]);
+		SP = HL;
+		BB_NEXT;
+	BB_OPCODE(fa):			/* JP M,nnnn */
+		CYCLES(z80_cc_op[0xfa]);
+		BB_JPC(TSTFLAG(S));
+		goto bb_enter;
+	BB_OPCODE(fb):			/* EI */
+		CYCLES(z80_cc_op[0xfb]);
+		cpu->IFF = 3;
+		cpu->sched.ei = CYC;
+		if (cpu->sched.irq)
+			deadline = CYC;
+		BB_NEXT;
+	BB_OPCODE(fc):			/* CALL M,nnnn */
+		CYCLES(z80_cc_op[0xfc]);
+		BB_CALLC(TSTFLAG(S));
+		goto bb_enter;
+	BB_OPCODE(fd):			/* FD prefix */
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_xy[op]);
+		switch (op) {
+		case 0x09:			/* ADD IY,BC */
+			IY &= 0xffff;
+			BC &= 0xffff;
+			sum = IY + BC;
+			cbits = (IY ^ BC ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x19:			/* ADD IY,DE */
+			IY &= 0xffff;
+			DE &= 0xffff;
+			sum = IY + DE;
+			cbits = (IY ^ DE ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x21:			/* LD IY,nnnn */
+			IY = GetWORD(PC);
+			PC += 2;
+			break;
+		case 0x22:			/* LD (nnnn),IY */
+			temp = GetWORD(PC);
+			PutWORD(temp, IY);
+			PC += 2;
+			break;
+		case 0x23:			/* INC IY */
+			++IY;
+			break;
+		case 0x24:			/* INC IYH */
+			IY += 0x100;
+			temp = hreg(IY);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x25:			/* DEC IYH */
+			IY -= 0x100;
+			temp = hreg(IY);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x26:			/* LD IYH,nn */
+			Sethreg(IY, GetBYTE(PC++));
+			break;
+		case 0x29:			/* ADD IY,IY */
+			IY &= 0xffff;
+			sum = IY + IY;
+			cbits = (IY ^ IY ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x2A:			/* LD IY,(nnnn) */
+			temp = GetWORD(PC);
+			IY = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x2B:			/* DEC IY */
+			--IY;
+			break;
+		case 0x2C:			/* INC IYL */
+			temp = lreg(IY)+1;
+			Setlreg(IY, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x2D:			/* DEC IYL */
+			temp = lreg(IY)-1;
+			Setlreg(IY, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x2E:			/* LD IYL,nn */
+			Setlreg(IY, GetBYTE(PC++));
+			break;
+		case 0x34:			/* INC (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)+1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x35:			/* DEC (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)-1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x36:			/* LD (IY+dd),nn */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, GetBYTE(PC++));
+			break;
+		case 0x39:			/* ADD IY,SP */
+			IY &= 0xffff;
+			SP &= 0xffff;
+			sum = IY + SP;
+			cbits = (IY ^ SP ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x44:			/* LD B,IYH */
+			Sethreg(BC, hreg(IY));
+			break;
+		case 0x45:			/* LD B,IYL */
+			Sethreg(BC, lreg(IY));
+			break;
+		case 0x46:			/* LD B,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(BC, GetBYTE(adr));
+			break;
+		case 0x4C:			/* LD C,IYH */
+			Setlreg(BC, hreg(IY));
+			break;
+		case 0x4D:			/* LD C,IYL */
+			Setlreg(BC, lreg(IY));
+			break;
+		case 0x4E:			/* LD C,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Setlreg(BC, GetBYTE(adr));
+			break;
+		case 0x54:			/* LD D,IYH */
+			Sethreg(DE, hreg(IY));
+			break;
+		case 0x55:			/* LD D,IYL */
+			Sethreg(DE, lreg(IY));
+			break;
+		case 0x56:			/* LD D,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(DE, GetBYTE(adr));
+			break;
+		case 0x5C:			/* LD E,IYH */
+			Setlreg(DE, hreg(IY));
+			break;
+		case 0x5D:			/* LD E,IYL */
+			Setlreg(DE, lreg(IY));
+			break;
+		case 0x5E:			/* LD E,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Setlreg(DE, GetBYTE(adr));
+			break;
+		case 0x60:			/* LD IYH,B */
+			Sethreg(IY, hreg(BC));
+			break;
+		case 0x61:			/* LD IYH,C */
+			Sethreg(IY, lreg(BC));
+			break;
+		case 0x62:			/* LD IYH,D */
+			Sethreg(IY, hreg(DE));
+			break;
+		case 0x63:			/* LD IYH,E */
+			Sethreg(IY, lreg(DE));
+			break;
+		case 0x64:			/* LD IYH,IYH */
+			/* nop */
+			break;
+		case 0x65:			/* LD IYH,IYL */
+			Sethreg(IY, lreg(IY));
+			break;
+		case 0x66:			/* LD H,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(HL, GetBYTE(adr));
+			break;
+		case 0x67:			/* LD IYH,A */
+			Sethreg(IY, hreg(AF));
+			break;
+		case 0x68:			/* LD IYL,B */
+			Setlreg(IY, hreg(BC));
+			break;
+		case 0x69:			/* LD IYL,C */
+			Setlreg(IY, lreg(BC));
+			break;
+		case 0x6A:			/* LD IYL,D */
+			Setlreg(IY, hreg(DE));
+			break;
+		case 0x6B:			/* LD IYL,E */
+			Setlreg(IY, lreg(DE));
+			break;
+		case 0x6C:			/* LD IYL,IYH */
+			Setlreg(IY, hreg(IY));
+			break;
+		case 0x6D:			/* LD IYL,IYL */
+			/* nop */
+			break;
+		case 0x6E:			/* LD L,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Setlreg(HL, GetBYTE(adr));
+			break;
+		case 0x6F:			/* LD IYL,A */
+			Setlreg(IY, hreg(AF));
+			break;
+		case 0x70:			/* LD (IY+dd),B */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(BC));
+			break;
+		case 0x71:			/* LD (IY+dd),C */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(BC));
+			break;
+		case 0x72:			/* LD (IY+dd),D */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(DE));
+			break;
+		case 0x73:			/* LD (IY+dd),E */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(DE));
+			break;
+		case 0x74:			/* LD (IY+dd),H */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(HL));
+			break;
+		case 0x75:			/* LD (IY+dd),L */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(HL));
+			break;
+		case 0x77:			/* LD (IY+dd),A */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(AF));
+			break;
+		case 0x7C:			/* LD A,IYH */
+			Sethreg(AF, hreg(IY));
+			break;
+		case 0x7D:			/* LD A,IYL */
+			Sethreg(AF, lreg(IY));
+			break;
+		case 0x7E:			/* LD A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(AF, GetBYTE(adr));
+			break;
+		case 0x84:			/* ADD A,IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x85:			/* ADD A,IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x86:			/* ADD A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8C:			/* ADC A,IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8D:			/* ADC A,IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8E:			/* ADC A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x94:			/* SUB IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x95:			/* SUB IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x96:			/* SUB (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9C:			/* SBC A,IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9D:			/* SBC A,IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9E:			/* SBC A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xA4:			/* AND IYH */
+			sum = ((AF & (IY)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) |
+				((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+			break;
+		case 0xA5:			/* AND IYL */
+			sum = ((AF >> 8) & IY) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xA6:			/* AND (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) & GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAC:			/* XOR IYH */
+			sum = ((AF ^ (IY)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAD:			/* XOR IYL */
+			sum = ((AF >> 8) ^ IY) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAE:			/* XOR (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) ^ GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB4:			/* OR IYH */
+			sum = ((AF | (IY)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB5:			/* OR IYL */
+			sum = ((AF >> 8) | IY) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB6:			/* OR (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) | GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xBC:			/* CP IYH */
+			temp = hreg(IY);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBD:			/* CP IYL */
+			temp = lreg(IY);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBE:			/* CP (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xCB:			/* CB prefix */
+			adr = IY + (signed char) GetBYTE(PC++);
+			adr = adr;
+			SYNC_FLAGS();
+			op = GetBYTE(PC++);
+			CYCLES(z80_cc_xycb[op]);
+			switch (op & 7) {
+			case 0: acu = hreg(BC); break;
+			case 1: acu = lreg(BC); break;
+			case 2: acu = hreg(DE); break;
+			case 3: acu = lreg(DE); break;
+			case 4: acu = hreg(HL); break;
+			case 5: acu = lreg(HL); break;
+			case 6: acu = GetBYTE(adr);  break;
+			case 7: acu = hreg(AF); break;
+			}
+			switch (op & 0xc0) {
+			case 0x00:		/* shift/rotate */
+				switch (op & 0x38) {
+				case 0x00:	/* RLC */
+					temp = (acu << 1) | (acu >> 7);
+					cbits = temp & 1;
+					goto bb_cbshflg3;
+				case 0x08:	/* RRC */
+					temp = (acu >> 1) | (acu << 7);
+					cbits = temp & 0x80;
+					goto bb_cbshflg3;
+				case 0x10:	/* RL */
+					temp = (acu << 1) | TSTFLAG(C);
+					cbits = acu & 0x80;
+					goto bb_cbshflg3;
+				case 0x18:	/* RR */
+					temp = (acu >> 1) | (TSTFLAG(C) << 7);
+					cbits = acu & 1;
+					goto bb_cbshflg3;
+				case 0x20:	/* SLA */
+					temp = acu << 1;
+					cbits = acu & 0x80;
+					goto bb_cbshflg3;
+				case 0x28:	/* SRA */
+					temp = (acu >> 1) | (acu & 0x80);
+					cbits = acu & 1;
+					goto bb_cbshflg3;
+				case 0x30:	/* SLIA */
+					temp = (acu << 1) | 1;
+					cbits = acu & 0x80;
+					goto bb_cbshflg3;
+				default:	/* SRL (0x38) */
+					temp = acu >> 1;
+					cbits = acu & 1;
+				bb_cbshflg3:
+					AF = (AF & ~0xff) | (temp & 0xa8) |
+						(((temp & 0xff) == 0) << 6) |
+						parity(temp) | !!cbits;
+				}
+				break;
+			case 0x40:		/* BIT */
+				if (acu & (1 << ((op >> 3) & 7)))
+					AF = (AF & ~0xfe) | 0x10 |
+					(((op & 0x38) == 0x38) << 7);
+				else
+					AF = (AF & ~0xfe) | 0x54;
+				if ((op&7) != 6)
+					AF |= (acu & 0x28);
+				temp = acu;
+				break;
+			case 0x80:		/* RES */
+				temp = acu & ~(1 << ((op >> 3) & 7));
+				break;
+			default:		/* SET (0xc0) */
+				temp = acu | (1 << ((op >> 3) & 7));
+				break;
+			}
+			switch (op & 7) {
+			case 0: Sethreg(BC, temp); break;
+			case 1: Setlreg(BC, temp); break;
+			case 2: Sethreg(DE, temp); break;
+			case 3: Setlreg(DE, temp); break;
+			case 4: Sethreg(HL, temp); break;
+			case 5: Setlreg(HL, temp); break;
+			case 6: PutBYTE(adr, temp);  break;
+			case 7: Sethreg(AF, temp); break;
+			}
+			break;
+		case 0xE1:			/* POP IY */
+			POP(IY);
+			break;
+		case 0xE3:			/* EX (SP),IY */
+			temp = IY; POP(IY); PUSH(temp);
+			break;
+		case 0xE5:			/* PUSH IY */
+			PUSH(IY);
+			break;
+		case 0xE9:			/* JP (IY) */
+			PC = IY;
+			break;
+		case 0xF9:			/* LD SP,IY */
+			SP = IY;
+			break;
+		default: PC--;		/* ignore DD */
+		}
+		BB_NEXT_CHECK;
+	BB_OPCODE(fe):			/* CP nn */
+		CYCLES(z80_cc_op[0xfe]);
+		temp = (PC++, BB_IMM);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_NEXT;
+	BB_OPCODE(ff):			/* RST 38H */
+		CYCLES(z80_cc_op[0xff]);
+		PUSH(PC); PC = 0x38;
+	goto bb_enter;
+	BB_OPCODE(100):			/* end of block or stale record */
+		PC--;
+		goto bb_enter;
+#ifdef OPT_FUSION
+	BB_OPCODE(101):			/* DEC B; JR NZ,dd */
+		CYCLES(z80_cc_op[0x05]);
+		BC -= 0x100;
+		temp = hreg(BC);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+		BB_FUSE_NEXT(20);
+		CYCLES(z80_cc_op[0x20]);
+		BB_JRC(!TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(102):			/* LD A,(HL); INC HL */
+		CYCLES(z80_cc_op[0x7e]);
+		Sethreg(AF, GetBYTE(HL));
+		BB_FUSE_NEXT(23);
+		CYCLES(z80_cc_op[0x23]);
+		++HL;
+		BB_NEXT;
+	BB_OPCODE(103):			/* OR A; JR Z,dd */
+		CYCLES(z80_cc_op[0xb7]);
+		sum = ((AF | (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_FUSE_NEXT(28);
+		CYCLES(z80_cc_op[0x28]);
+		BB_JRC(TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(104):			/* EX DE,HL; ADD HL,DE */
+		CYCLES(z80_cc_op[0xeb]);
+		temp = HL; HL = DE; DE = temp;
+		BB_FUSE_NEXT(19);
+		CYCLES(z80_cc_op[0x19]);
+		HL &= 0xffff;
+		DE &= 0xffff;
+		sum = HL + DE;
+		cbits = (HL ^ DE ^ sum) >> 8;
+		HL = sum;
+		SYNC_FLAGS();
+		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+		BB_NEXT;
+	BB_OPCODE(105):			/* DEC HL; LD A,H */
+		CYCLES(z80_cc_op[0x2b]);
+		--HL;
+		BB_FUSE_NEXT(7c);
+		CYCLES(z80_cc_op[0x7c]);
+		AF = (AF & 255) | (HL & ~255);
+		BB_NEXT;
+	BB_OPCODE(106):			/* OR L; JR NZ,dd */
+		CYCLES(z80_cc_op[0xb5]);
+		sum = ((AF >> 8) | HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_FUSE_NEXT(20);
+		CYCLES(z80_cc_op[0x20]);
+		BB_JRC(!TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(107):			/* DEC BC; LD A,B */
+		CYCLES(z80_cc_op[0x0b]);
+		--BC;
+		BB_FUSE_NEXT(78);
+		CYCLES(z80_cc_op[0x78]);
+		AF = (AF & 255) | (BC & ~255);
+		BB_NEXT;
+	BB_OPCODE(108):			/* OR C; JR NZ,dd */
+		CYCLES(z80_cc_op[0xb1]);
+		sum = ((AF >> 8) | BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_FUSE_NEXT(20);
+		CYCLES(z80_cc_op[0x20]);
+		BB_JRC(!TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(109):			/* LD (HL),A; INC HL */
+		CYCLES(z80_cc_op[0x77]);
+		PutBYTE(HL, hreg(AF));
+		BB_FUSE_NEXT(23);
+		CYCLES(z80_cc_op[0x23]);
+		++HL;
+		BB_NEXT;
+	BB_OPCODE(10a):			/* LD A,(DE); INC DE */
+		CYCLES(z80_cc_op[0x1a]);
+		Sethreg(AF, GetBYTE(DE));
+		BB_FUSE_NEXT(13);
+		CYCLES(z80_cc_op[0x13]);
+		++DE;
+		BB_NEXT;
+	BB_OPCODE(10b):			/* LD (DE),A; INC DE */
+		CYCLES(z80_cc_op[0x12]);
+		PutBYTE(DE, hreg(AF));
+		BB_FUSE_NEXT(13);
+		CYCLES(z80_cc_op[0x13]);
+		++DE;
+		BB_NEXT;
+	BB_OPCODE(10c):			/* CP nn; JR Z,dd */
+		CYCLES(z80_cc_op[0xfe]);
+		temp = (PC++, BB_IMM);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_FUSE_NEXT(28);
+		CYCLES(z80_cc_op[0x28]);
+		BB_JRC(TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(10d):			/* CP nn; JR NZ,dd */
+		CYCLES(z80_cc_op[0xfe]);
+		temp = (PC++, BB_IMM);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+		BB_FUSE_NEXT(20);
+		CYCLES(z80_cc_op[0x20]);
+		BB_JRC(!TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(10e):			/* OR A; JR NZ,dd */
+		CYCLES(z80_cc_op[0xb7]);
+		sum = ((AF | (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_FUSE_NEXT(20);
+		CYCLES(z80_cc_op[0x20]);
+		BB_JRC(!TSTFLAG(Z));
+		goto bb_enter;
+	BB_OPCODE(10f):			/* INC HL; DJNZ dd */
+		CYCLES(z80_cc_op[0x23]);
+		++HL;
+		BB_FUSE_NEXT(10);
+		CYCLES(z80_cc_op[0x10]);
+		BB_JRC((BC -= 0x100) & 0xff00);
+		goto bb_enter;
+	BB_OPCODE(110):			/* LD A,H; OR L */
+		CYCLES(z80_cc_op[0x7c]);
+		AF = (AF & 255) | (HL & ~255);
+		BB_FUSE_NEXT(b5);
+		CYCLES(z80_cc_op[0xb5]);
+		sum = ((AF >> 8) | HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+		BB_NEXT;
+#endif
+	}
+	ins++;
+	PC++;
+    }
+#endif
+}
+
+/** Run Z80 code until HALT.
+    @param[in] cpu the machine
+    @param[in] PC  Z80 address to start at
+    @return the address of the HALT instruction
+ */
+FASTWORK
+simz80(struct z80_cpu *cpu, FASTREG PC)
+{
+    return simz80_run(cpu, PC, SIMZ80_FOREVER);
+}
+
+#ifdef OPT_JIT
+#ifdef OPT_HLE
+/* the end of the run is kept for the translated code */
+#undef HLE_DEADLINE
+#define HLE_DEADLINE	cpu->jit.deadline
+#endif
+
+static FASTREG
+jit_op_00(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* NOP */
+		CYCLES(z80_cc_op[0x00]);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_01(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD BC,nnnn */
+		CYCLES(z80_cc_op[0x01]);
+		BC = BB_IMM;
+		PC += 2;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_02(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (BC),A */
+		CYCLES(z80_cc_op[0x02]);
+		PutBYTE(BC, hreg(AF));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_03(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* INC BC */
+		CYCLES(z80_cc_op[0x03]);
+		++BC;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_04(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* INC B */
+		CYCLES(z80_cc_op[0x04]);
+		BC += 0x100;
+		temp = hreg(BC);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_05(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* DEC B */
+		CYCLES(z80_cc_op[0x05]);
+		BC -= 0x100;
+		temp = hreg(BC);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_06(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD B,nn */
+		CYCLES(z80_cc_op[0x06]);
+		Sethreg(BC, (PC++, BB_IMM));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_07(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RLCA */
+		CYCLES(z80_cc_op[0x07]);
+		SYNC_FLAGS();
+		AF = ((AF >> 7) & 0x0128) | ((AF << 1) & ~0x1ff) |
+			(AF & 0xc4) | ((AF >> 15) & 1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_08(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* EX AF,AF' */
+		CYCLES(z80_cc_op[0x08]);
+		SYNC_FLAGS();
+		cpu->af[cpu->af_sel] = AF;
+		cpu->af_sel = 1 - cpu->af_sel;
+		AF = cpu->af[cpu->af_sel];
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_09(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum, cbits;
+
+    /* ADD HL,BC */
+		CYCLES(z80_cc_op[0x09]);
+		HL &= 0xffff;
+		BC &= 0xffff;
+		sum = HL + BC;
+		cbits = (HL ^ BC ^ sum) >> 8;
+		HL = sum;
+		SYNC_FLAGS();
+		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_0a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,(BC) */
+		CYCLES(z80_cc_op[0x0a]);
+		Sethreg(AF, GetBYTE(BC));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_0b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* DEC BC */
+		CYCLES(z80_cc_op[0x0b]);
+		--BC;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_0c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* INC C */
+		CYCLES(z80_cc_op[0x0c]);
+		temp = lreg(BC)+1;
+		Setlreg(BC, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_0d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* DEC C */
+		CYCLES(z80_cc_op[0x0d]);
+		temp = lreg(BC)-1;
+		Setlreg(BC, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_0e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD C,nn */
+		CYCLES(z80_cc_op[0x0e]);
+		Setlreg(BC, (PC++, BB_IMM));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_0f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, sum;
+
+    /* RRCA */
+		CYCLES(z80_cc_op[0x0f]);
+		SYNC_FLAGS();
+		temp = hreg(AF);
+		sum = temp >> 1;
+		AF = ((temp & 1) << 15) | (sum << 8) |
+			(sum & 0x28) | (AF & 0xc4) | (temp & 1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_10(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* DJNZ dd */
+		CYCLES(z80_cc_op[0x10]);
+		BB_JRC((BC -= 0x100) & 0xff00);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_11(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD DE,nnnn */
+		CYCLES(z80_cc_op[0x11]);
+		DE = BB_IMM;
+		PC += 2;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_12(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (DE),A */
+		CYCLES(z80_cc_op[0x12]);
+		PutBYTE(DE, hreg(AF));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_13(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* INC DE */
+		CYCLES(z80_cc_op[0x13]);
+		++DE;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_14(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* INC D */
+		CYCLES(z80_cc_op[0x14]);
+		DE += 0x100;
+		temp = hreg(DE);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_15(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* DEC D */
+		CYCLES(z80_cc_op[0x15]);
+		DE -= 0x100;
+		temp = hreg(DE);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_16(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD D,nn */
+		CYCLES(z80_cc_op[0x16]);
+		Sethreg(DE, (PC++, BB_IMM));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_17(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RLA */
+		CYCLES(z80_cc_op[0x17]);
+		SYNC_FLAGS();
+		AF = ((AF << 8) & 0x0100) | ((AF >> 7) & 0x28) | ((AF << 1) & ~0x01ff) |
+			(AF & 0xc4) | ((AF >> 15) & 1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_18(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JR dd */
+		CYCLES(z80_cc_op[0x18]);
+		PC = ins->target;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_19(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum, cbits;
+
+    /* ADD HL,DE */
+		CYCLES(z80_cc_op[0x19]);
+		HL &= 0xffff;
+		DE &= 0xffff;
+		sum = HL + DE;
+		cbits = (HL ^ DE ^ sum) >> 8;
+		HL = sum;
+		SYNC_FLAGS();
+		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_1a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,(DE) */
+		CYCLES(z80_cc_op[0x1a]);
+		Sethreg(AF, GetBYTE(DE));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_1b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* DEC DE */
+		CYCLES(z80_cc_op[0x1b]);
+		--DE;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_1c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* INC E */
+		CYCLES(z80_cc_op[0x1c]);
+		temp = lreg(DE)+1;
+		Setlreg(DE, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_1d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* DEC E */
+		CYCLES(z80_cc_op[0x1d]);
+		temp = lreg(DE)-1;
+		Setlreg(DE, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_1e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD E,nn */
+		CYCLES(z80_cc_op[0x1e]);
+		Setlreg(DE, (PC++, BB_IMM));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_1f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, sum;
+
+    /* RRA */
+		CYCLES(z80_cc_op[0x1f]);
+		SYNC_FLAGS();
+		temp = hreg(AF);
+		sum = temp >> 1;
+		AF = ((AF & 1) << 15) | (sum << 8) |
+			(sum & 0x28) | (AF & 0xc4) | (temp & 1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_20(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JR NZ,dd */
+		CYCLES(z80_cc_op[0x20]);
+		BB_JRC(!TSTFLAG(Z));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_21(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD HL,nnnn */
+		CYCLES(z80_cc_op[0x21]);
+		HL = BB_IMM;
+		PC += 2;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_22(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* LD (nnnn),HL */
+		CYCLES(z80_cc_op[0x22]);
+		temp = BB_IMM;
+		PutWORD(temp, HL);
+		PC += 2;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_23(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* INC HL */
+		CYCLES(z80_cc_op[0x23]);
+		++HL;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_24(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* INC H */
+		CYCLES(z80_cc_op[0x24]);
+		HL += 0x100;
+		temp = hreg(HL);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_25(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* DEC H */
+		CYCLES(z80_cc_op[0x25]);
+		HL -= 0x100;
+		temp = hreg(HL);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_26(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD H,nn */
+		CYCLES(z80_cc_op[0x26]);
+		Sethreg(HL, (PC++, BB_IMM));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_27(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, cbits;
+
+    /* DAA */
+		CYCLES(z80_cc_op[0x27]);
+		SYNC_FLAGS();
+		acu = hreg(AF);
+		temp = ldig(acu);
+		cbits = TSTFLAG(C);
+		if (TSTFLAG(N)) {	/* last operation was a subtract */
+			int hd = cbits || acu > 0x99;
+			if (TSTFLAG(H) || (temp > 9)) { /* adjust low digit */
+				if (temp > 5)
+					SETFLAG(H, 0);
+				acu -= 6;
+				acu &= 0xff;
+			}
+			if (hd)		/* adjust high digit */
+				acu -= 0x160;
+		}
+		else {			/* last operation was an add */
+			if (TSTFLAG(H) || (temp > 9)) { /* adjust low digit */
+				SETFLAG(H, (temp > 9));
+				acu += 6;
+			}
+			if (cbits || ((acu & 0x1f0) > 0x90)) /* adjust high digit */
+				acu += 0x60;
+		}
+		cbits |= (acu >> 8) & 1;
+		acu &= 0xff;
+		AF = (acu << 8) | (acu & 0xa8) | ((acu == 0) << 6) |
+			(AF & 0x12) | partab[acu] | cbits;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_28(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JR Z,dd */
+		CYCLES(z80_cc_op[0x28]);
+		BB_JRC(TSTFLAG(Z));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_29(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum, cbits;
+
+    /* ADD HL,HL */
+		CYCLES(z80_cc_op[0x29]);
+		HL &= 0xffff;
+		sum = HL + HL;
+		cbits = (HL ^ HL ^ sum) >> 8;
+		HL = sum;
+		SYNC_FLAGS();
+		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_2a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* LD HL,(nnnn) */
+		CYCLES(z80_cc_op[0x2a]);
+		temp = BB_IMM;
+		HL = GetWORD(temp);
+		PC += 2;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_2b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* DEC HL */
+		CYCLES(z80_cc_op[0x2b]);
+		--HL;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_2c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* INC L */
+		CYCLES(z80_cc_op[0x2c]);
+		temp = lreg(HL)+1;
+		Setlreg(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_2d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* DEC L */
+		CYCLES(z80_cc_op[0x2d]);
+		temp = lreg(HL)-1;
+		Setlreg(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_2e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD L,nn */
+		CYCLES(z80_cc_op[0x2e]);
+		Setlreg(HL, (PC++, BB_IMM));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_2f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* CPL */
+		CYCLES(z80_cc_op[0x2f]);
+		SYNC_FLAGS();
+		AF = (~AF & ~0xff) | (AF & 0xc5) | ((~AF >> 8) & 0x28) | 0x12;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_30(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JR NC,dd */
+		CYCLES(z80_cc_op[0x30]);
+		BB_JRC(!TSTFLAG(C));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_31(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD SP,nnnn */
+		CYCLES(z80_cc_op[0x31]);
+		SP = BB_IMM;
+		PC += 2;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_32(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* LD (nnnn),A */
+		CYCLES(z80_cc_op[0x32]);
+		temp = BB_IMM;
+		PutBYTE(temp, hreg(AF));
+		PC += 2;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_33(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* INC SP */
+		CYCLES(z80_cc_op[0x33]);
+		++SP;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_34(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* INC (HL) */
+		CYCLES(z80_cc_op[0x34]);
+		temp = GetBYTE(HL)+1;
+		PutBYTE(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_35(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* DEC (HL) */
+		CYCLES(z80_cc_op[0x35]);
+		temp = GetBYTE(HL)-1;
+		PutBYTE(HL, temp);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_36(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (HL),nn */
+		CYCLES(z80_cc_op[0x36]);
+		PutBYTE(HL, (PC++, BB_IMM));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_37(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* SCF */
+		CYCLES(z80_cc_op[0x37]);
+		SYNC_FLAGS();
+		AF = (AF&~0x3b)|((AF>>8)&0x28)|1;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_38(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JR C,dd */
+		CYCLES(z80_cc_op[0x38]);
+		BB_JRC(TSTFLAG(C));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_39(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum, cbits;
+
+    /* ADD HL,SP */
+		CYCLES(z80_cc_op[0x39]);
+		HL &= 0xffff;
+		SP &= 0xffff;
+		sum = HL + SP;
+		cbits = (HL ^ SP ^ sum) >> 8;
+		HL = sum;
+		SYNC_FLAGS();
+		AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_3a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* LD A,(nnnn) */
+		CYCLES(z80_cc_op[0x3a]);
+		temp = BB_IMM;
+		Sethreg(AF, GetBYTE(temp));
+		PC += 2;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_3b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* DEC SP */
+		CYCLES(z80_cc_op[0x3b]);
+		--SP;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_3c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* INC A */
+		CYCLES(z80_cc_op[0x3c]);
+		AF += 0x100;
+		temp = hreg(AF);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0) << 4) |
+			((temp == 0x80) << 2);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_3d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* DEC A */
+		CYCLES(z80_cc_op[0x3d]);
+		AF -= 0x100;
+		temp = hreg(AF);
+#ifdef OPT_LAZY_FLAGS
+		LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+		AF = (AF & ~0xfe) | (temp & 0xa8) |
+			(((temp & 0xff) == 0) << 6) |
+			(((temp & 0xf) == 0xf) << 4) |
+			((temp == 0x7f) << 2) | 2;
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_3e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,nn */
+		CYCLES(z80_cc_op[0x3e]);
+		Sethreg(AF, (PC++, BB_IMM));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_3f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* CCF */
+		CYCLES(z80_cc_op[0x3f]);
+		SYNC_FLAGS();
+		AF = (AF&~0x3b)|((AF>>8)&0x28)|((AF&1)<<4)|(~AF&1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_40(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD B,B */
+		CYCLES(z80_cc_op[0x40]);
+		/* nop */
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_41(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD B,C */
+		CYCLES(z80_cc_op[0x41]);
+		BC = (BC & 255) | ((BC & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_42(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD B,D */
+		CYCLES(z80_cc_op[0x42]);
+		BC = (BC & 255) | (DE & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_43(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD B,E */
+		CYCLES(z80_cc_op[0x43]);
+		BC = (BC & 255) | ((DE & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_44(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD B,H */
+		CYCLES(z80_cc_op[0x44]);
+		BC = (BC & 255) | (HL & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_45(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD B,L */
+		CYCLES(z80_cc_op[0x45]);
+		BC = (BC & 255) | ((HL & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_46(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD B,(HL) */
+		CYCLES(z80_cc_op[0x46]);
+		Sethreg(BC, GetBYTE(HL));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_47(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD B,A */
+		CYCLES(z80_cc_op[0x47]);
+		BC = (BC & 255) | (AF & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_48(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD C,B */
+		CYCLES(z80_cc_op[0x48]);
+		BC = (BC & ~255) | ((BC >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_49(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD C,C */
+		CYCLES(z80_cc_op[0x49]);
+		/* nop */
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_4a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD C,D */
+		CYCLES(z80_cc_op[0x4a]);
+		BC = (BC & ~255) | ((DE >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_4b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD C,E */
+		CYCLES(z80_cc_op[0x4b]);
+		BC = (BC & ~255) | (DE & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_4c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD C,H */
+		CYCLES(z80_cc_op[0x4c]);
+		BC = (BC & ~255) | ((HL >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_4d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD C,L */
+		CYCLES(z80_cc_op[0x4d]);
+		BC = (BC & ~255) | (HL & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_4e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD C,(HL) */
+		CYCLES(z80_cc_op[0x4e]);
+		Setlreg(BC, GetBYTE(HL));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_4f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD C,A */
+		CYCLES(z80_cc_op[0x4f]);
+		BC = (BC & ~255) | ((AF >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_50(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD D,B */
+		CYCLES(z80_cc_op[0x50]);
+		DE = (DE & 255) | (BC & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_51(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD D,C */
+		CYCLES(z80_cc_op[0x51]);
+		DE = (DE & 255) | ((BC & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_52(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD D,D */
+		CYCLES(z80_cc_op[0x52]);
+		/* nop */
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_53(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD D,E */
+		CYCLES(z80_cc_op[0x53]);
+		DE = (DE & 255) | ((DE & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_54(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD D,H */
+		CYCLES(z80_cc_op[0x54]);
+		DE = (DE & 255) | (HL & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_55(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD D,L */
+		CYCLES(z80_cc_op[0x55]);
+		DE = (DE & 255) | ((HL & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_56(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD D,(HL) */
+		CYCLES(z80_cc_op[0x56]);
+		Sethreg(DE, GetBYTE(HL));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_57(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD D,A */
+		CYCLES(z80_cc_op[0x57]);
+		DE = (DE & 255) | (AF & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_58(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD E,B */
+		CYCLES(z80_cc_op[0x58]);
+		DE = (DE & ~255) | ((BC >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_59(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD E,C */
+		CYCLES(z80_cc_op[0x59]);
+		DE = (DE & ~255) | (BC & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_5a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD E,D */
+		CYCLES(z80_cc_op[0x5a]);
+		DE = (DE & ~255) | ((DE >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_5b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD E,E */
+		CYCLES(z80_cc_op[0x5b]);
+		/* nop */
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_5c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD E,H */
+		CYCLES(z80_cc_op[0x5c]);
+		DE = (DE & ~255) | ((HL >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_5d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD E,L */
+		CYCLES(z80_cc_op[0x5d]);
+		DE = (DE & ~255) | (HL & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_5e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD E,(HL) */
+		CYCLES(z80_cc_op[0x5e]);
+		Setlreg(DE, GetBYTE(HL));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_5f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD E,A */
+		CYCLES(z80_cc_op[0x5f]);
+		DE = (DE & ~255) | ((AF >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_60(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD H,B */
+		CYCLES(z80_cc_op[0x60]);
+		HL = (HL & 255) | (BC & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_61(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD H,C */
+		CYCLES(z80_cc_op[0x61]);
+		HL = (HL & 255) | ((BC & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_62(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD H,D */
+		CYCLES(z80_cc_op[0x62]);
+		HL = (HL & 255) | (DE & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_63(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD H,E */
+		CYCLES(z80_cc_op[0x63]);
+		HL = (HL & 255) | ((DE & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_64(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD H,H */
+		CYCLES(z80_cc_op[0x64]);
+		/* nop */
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_65(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD H,L */
+		CYCLES(z80_cc_op[0x65]);
+		HL = (HL & 255) | ((HL & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_66(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD H,(HL) */
+		CYCLES(z80_cc_op[0x66]);
+		Sethreg(HL, GetBYTE(HL));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_67(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD H,A */
+		CYCLES(z80_cc_op[0x67]);
+		HL = (HL & 255) | (AF & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_68(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD L,B */
+		CYCLES(z80_cc_op[0x68]);
+		HL = (HL & ~255) | ((BC >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_69(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD L,C */
+		CYCLES(z80_cc_op[0x69]);
+		HL = (HL & ~255) | (BC & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_6a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD L,D */
+		CYCLES(z80_cc_op[0x6a]);
+		HL = (HL & ~255) | ((DE >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_6b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD L,E */
+		CYCLES(z80_cc_op[0x6b]);
+		HL = (HL & ~255) | (DE & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_6c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD L,H */
+		CYCLES(z80_cc_op[0x6c]);
+		HL = (HL & ~255) | ((HL >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_6d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD L,L */
+		CYCLES(z80_cc_op[0x6d]);
+		/* nop */
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_6e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD L,(HL) */
+		CYCLES(z80_cc_op[0x6e]);
+		Setlreg(HL, GetBYTE(HL));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_6f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD L,A */
+		CYCLES(z80_cc_op[0x6f]);
+		HL = (HL & ~255) | ((AF >> 8) & 255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_70(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (HL),B */
+		CYCLES(z80_cc_op[0x70]);
+		PutBYTE(HL, hreg(BC));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_71(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (HL),C */
+		CYCLES(z80_cc_op[0x71]);
+		PutBYTE(HL, lreg(BC));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_72(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (HL),D */
+		CYCLES(z80_cc_op[0x72]);
+		PutBYTE(HL, hreg(DE));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_73(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (HL),E */
+		CYCLES(z80_cc_op[0x73]);
+		PutBYTE(HL, lreg(DE));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_74(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (HL),H */
+		CYCLES(z80_cc_op[0x74]);
+		PutBYTE(HL, hreg(HL));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_75(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (HL),L */
+		CYCLES(z80_cc_op[0x75]);
+		PutBYTE(HL, lreg(HL));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_77(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD (HL),A */
+		CYCLES(z80_cc_op[0x77]);
+		PutBYTE(HL, hreg(AF));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_78(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,B */
+		CYCLES(z80_cc_op[0x78]);
+		AF = (AF & 255) | (BC & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_79(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,C */
+		CYCLES(z80_cc_op[0x79]);
+		AF = (AF & 255) | ((BC & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_7a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,D */
+		CYCLES(z80_cc_op[0x7a]);
+		AF = (AF & 255) | (DE & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_7b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,E */
+		CYCLES(z80_cc_op[0x7b]);
+		AF = (AF & 255) | ((DE & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_7c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,H */
+		CYCLES(z80_cc_op[0x7c]);
+		AF = (AF & 255) | (HL & ~255);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_7d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,L */
+		CYCLES(z80_cc_op[0x7d]);
+		AF = (AF & 255) | ((HL & 255) << 8);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_7e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,(HL) */
+		CYCLES(z80_cc_op[0x7e]);
+		Sethreg(AF, GetBYTE(HL));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_7f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD A,A */
+		CYCLES(z80_cc_op[0x7f]);
+		/* nop */
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_80(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADD A,B */
+		CYCLES(z80_cc_op[0x80]);
+		temp = hreg(BC);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_81(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADD A,C */
+		CYCLES(z80_cc_op[0x81]);
+		temp = lreg(BC);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_82(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADD A,D */
+		CYCLES(z80_cc_op[0x82]);
+		temp = hreg(DE);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_83(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADD A,E */
+		CYCLES(z80_cc_op[0x83]);
+		temp = lreg(DE);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_84(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADD A,H */
+		CYCLES(z80_cc_op[0x84]);
+		temp = hreg(HL);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_85(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADD A,L */
+		CYCLES(z80_cc_op[0x85]);
+		temp = lreg(HL);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_86(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADD A,(HL) */
+		CYCLES(z80_cc_op[0x86]);
+		temp = GetBYTE(HL);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_87(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADD A,A */
+		CYCLES(z80_cc_op[0x87]);
+		temp = hreg(AF);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_88(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADC A,B */
+		CYCLES(z80_cc_op[0x88]);
+		temp = hreg(BC);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_89(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADC A,C */
+		CYCLES(z80_cc_op[0x89]);
+		temp = lreg(BC);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_8a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADC A,D */
+		CYCLES(z80_cc_op[0x8a]);
+		temp = hreg(DE);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_8b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADC A,E */
+		CYCLES(z80_cc_op[0x8b]);
+		temp = lreg(DE);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_8c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADC A,H */
+		CYCLES(z80_cc_op[0x8c]);
+		temp = hreg(HL);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_8d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADC A,L */
+		CYCLES(z80_cc_op[0x8d]);
+		temp = lreg(HL);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_8e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADC A,(HL) */
+		CYCLES(z80_cc_op[0x8e]);
+		temp = GetBYTE(HL);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_8f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADC A,A */
+		CYCLES(z80_cc_op[0x8f]);
+		temp = hreg(AF);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_90(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SUB B */
+		CYCLES(z80_cc_op[0x90]);
+		temp = hreg(BC);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_91(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SUB C */
+		CYCLES(z80_cc_op[0x91]);
+		temp = lreg(BC);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_92(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SUB D */
+		CYCLES(z80_cc_op[0x92]);
+		temp = hreg(DE);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_93(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SUB E */
+		CYCLES(z80_cc_op[0x93]);
+		temp = lreg(DE);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_94(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SUB H */
+		CYCLES(z80_cc_op[0x94]);
+		temp = hreg(HL);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_95(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SUB L */
+		CYCLES(z80_cc_op[0x95]);
+		temp = lreg(HL);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_96(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SUB (HL) */
+		CYCLES(z80_cc_op[0x96]);
+		temp = GetBYTE(HL);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_97(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SUB A */
+		CYCLES(z80_cc_op[0x97]);
+		temp = hreg(AF);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_98(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SBC A,B */
+		CYCLES(z80_cc_op[0x98]);
+		temp = hreg(BC);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_99(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SBC A,C */
+		CYCLES(z80_cc_op[0x99]);
+		temp = lreg(BC);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_9a(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SBC A,D */
+		CYCLES(z80_cc_op[0x9a]);
+		temp = hreg(DE);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_9b(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SBC A,E */
+		CYCLES(z80_cc_op[0x9b]);
+		temp = lreg(DE);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_9c(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SBC A,H */
+		CYCLES(z80_cc_op[0x9c]);
+		temp = hreg(HL);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_9d(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SBC A,L */
+		CYCLES(z80_cc_op[0x9d]);
+		temp = lreg(HL);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_9e(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SBC A,(HL) */
+		CYCLES(z80_cc_op[0x9e]);
+		temp = GetBYTE(HL);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_9f(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SBC A,A */
+		CYCLES(z80_cc_op[0x9f]);
+		temp = hreg(AF);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a0(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* AND B */
+		CYCLES(z80_cc_op[0xa0]);
+		sum = ((AF & (BC)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) |
+			((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a1(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* AND C */
+		CYCLES(z80_cc_op[0xa1]);
+		sum = ((AF >> 8) & BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a2(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* AND D */
+		CYCLES(z80_cc_op[0xa2]);
+		sum = ((AF & (DE)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) |
+			((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a3(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* AND E */
+		CYCLES(z80_cc_op[0xa3]);
+		sum = ((AF >> 8) & DE) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a4(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* AND H */
+		CYCLES(z80_cc_op[0xa4]);
+		sum = ((AF & (HL)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) |
+			((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a5(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* AND L */
+		CYCLES(z80_cc_op[0xa5]);
+		sum = ((AF >> 8) & HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a6(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* AND (HL) */
+		CYCLES(z80_cc_op[0xa6]);
+		sum = ((AF >> 8) & GetBYTE(HL)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a7(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* AND A */
+		CYCLES(z80_cc_op[0xa7]);
+		sum = ((AF & (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) |
+			((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a8(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* XOR B */
+		CYCLES(z80_cc_op[0xa8]);
+		sum = ((AF ^ (BC)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_a9(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* XOR C */
+		CYCLES(z80_cc_op[0xa9]);
+		sum = ((AF >> 8) ^ BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_aa(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* XOR D */
+		CYCLES(z80_cc_op[0xaa]);
+		sum = ((AF ^ (DE)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ab(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* XOR E */
+		CYCLES(z80_cc_op[0xab]);
+		sum = ((AF >> 8) ^ DE) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ac(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* XOR H */
+		CYCLES(z80_cc_op[0xac]);
+		sum = ((AF ^ (HL)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ad(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* XOR L */
+		CYCLES(z80_cc_op[0xad]);
+		sum = ((AF >> 8) ^ HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ae(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* XOR (HL) */
+		CYCLES(z80_cc_op[0xae]);
+		sum = ((AF >> 8) ^ GetBYTE(HL)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_af(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* XOR A */
+		CYCLES(z80_cc_op[0xaf]);
+		sum = ((AF ^ (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b0(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* OR B */
+		CYCLES(z80_cc_op[0xb0]);
+		sum = ((AF | (BC)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b1(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* OR C */
+		CYCLES(z80_cc_op[0xb1]);
+		sum = ((AF >> 8) | BC) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b2(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* OR D */
+		CYCLES(z80_cc_op[0xb2]);
+		sum = ((AF | (DE)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b3(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* OR E */
+		CYCLES(z80_cc_op[0xb3]);
+		sum = ((AF >> 8) | DE) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b4(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* OR H */
+		CYCLES(z80_cc_op[0xb4]);
+		sum = ((AF | (HL)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b5(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* OR L */
+		CYCLES(z80_cc_op[0xb5]);
+		sum = ((AF >> 8) | HL) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b6(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* OR (HL) */
+		CYCLES(z80_cc_op[0xb6]);
+		sum = ((AF >> 8) | GetBYTE(HL)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b7(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* OR A */
+		CYCLES(z80_cc_op[0xb7]);
+		sum = ((AF | (AF)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b8(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* CP B */
+		CYCLES(z80_cc_op[0xb8]);
+		temp = hreg(BC);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_b9(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* CP C */
+		CYCLES(z80_cc_op[0xb9]);
+		temp = lreg(BC);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ba(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* CP D */
+		CYCLES(z80_cc_op[0xba]);
+		temp = hreg(DE);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_bb(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* CP E */
+		CYCLES(z80_cc_op[0xbb]);
+		temp = lreg(DE);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_bc(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* CP H */
+		CYCLES(z80_cc_op[0xbc]);
+		temp = hreg(HL);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_bd(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* CP L */
+		CYCLES(z80_cc_op[0xbd]);
+		temp = lreg(HL);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_be(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* CP (HL) */
+		CYCLES(z80_cc_op[0xbe]);
+		temp = GetBYTE(HL);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_bf(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* CP A */
+		CYCLES(z80_cc_op[0xbf]);
+		temp = hreg(AF);
+		AF = (AF & ~0x28) | (temp & 0x28);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+		AF = (AF & ~0xff) | (sum & 0x80) |
+			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c0(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RET NZ */
+		CYCLES(z80_cc_op[0xc0]);
+		RETC(!TSTFLAG(Z));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c1(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* POP BC */
+		CYCLES(z80_cc_op[0xc1]);
+		POP(BC);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c2(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP NZ,nnnn */
+		CYCLES(z80_cc_op[0xc2]);
+		BB_JPC(!TSTFLAG(Z));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c3(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP nnnn */
+		CYCLES(z80_cc_op[0xc3]);
+		BB_JPC(1);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c4(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+
+    /* CALL NZ,nnnn */
+		CYCLES(z80_cc_op[0xc4]);
+		BB_CALLC(!TSTFLAG(Z));
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c5(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* PUSH BC */
+		CYCLES(z80_cc_op[0xc5]);
+		PUSH(BC);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c6(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADD A,nn */
+		CYCLES(z80_cc_op[0xc6]);
+		temp = (PC++, BB_IMM);
+		acu = hreg(AF);
+		sum = acu + temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c7(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RST 0 */
+		CYCLES(z80_cc_op[0xc7]);
+		PUSH(PC); PC = 0;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c8(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RET Z */
+		CYCLES(z80_cc_op[0xc8]);
+		RETC(TSTFLAG(Z));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_c9(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RET */
+		CYCLES(z80_cc_op[0xc9]);
+		POP(PC);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ca(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP Z,nnnn */
+		CYCLES(z80_cc_op[0xca]);
+		BB_JPC(TSTFLAG(Z));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_cb(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, cbits, op, adr;
+
+    /* CB prefix */
+		adr = HL;
+		SYNC_FLAGS();
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_cb[op]);
+		switch (op & 7) {
+		case 0: acu = hreg(BC); break;
+		case 1: acu = lreg(BC); break;
+		case 2: acu = hreg(DE); break;
+		case 3: acu = lreg(DE); break;
+		case 4: acu = hreg(HL); break;
+		case 5: acu = lreg(HL); break;
+		case 6: acu = GetBYTE(adr);  break;
+		case 7: acu = hreg(AF); break;
+		}
+		switch (op & 0xc0) {
+		case 0x00:		/* shift/rotate */
+			switch (op & 0x38) {
+			case 0x00:	/* RLC */
+				temp = (acu << 1) | (acu >> 7);
+				cbits = temp & 1;
+				goto bb_cbshflg1;
+			case 0x08:	/* RRC */
+				temp = (acu >> 1) | (acu << 7);
+				cbits = temp & 0x80;
+				goto bb_cbshflg1;
+			case 0x10:	/* RL */
+				temp = (acu << 1) | TSTFLAG(C);
+				cbits = acu & 0x80;
+				goto bb_cbshflg1;
+			case 0x18:	/* RR */
+				temp = (acu >> 1) | (TSTFLAG(C) << 7);
+				cbits = acu & 1;
+				goto bb_cbshflg1;
+			case 0x20:	/* SLA */
+				temp = acu << 1;
+				cbits = acu & 0x80;
+				goto bb_cbshflg1;
+			case 0x28:	/* SRA */
+				temp = (acu >> 1) | (acu & 0x80);
+				cbits = acu & 1;
+				goto bb_cbshflg1;
+			case 0x30:	/* SLIA */
+				temp = (acu << 1) | 1;
+				cbits = acu & 0x80;
+				goto bb_cbshflg1;
+			default:	/* SRL (0x38) */
+				temp = acu >> 1;
+				cbits = acu & 1;
+			bb_cbshflg1:
+				AF = (AF & ~0xff) | (temp & 0xa8) |
+					(((temp & 0xff) == 0) << 6) |
+					parity(temp) | !!cbits;
+			}
+			break;
+		case 0x40:		/* BIT */
+			if (acu & (1 << ((op >> 3) & 7)))
+				AF = (AF & ~0xfe) | 0x10 |
+				(((op & 0x38) == 0x38) << 7);
+			else
+				AF = (AF & ~0xfe) | 0x54;
+			if ((op&7) != 6)
+				AF |= (acu & 0x28);
+			temp = acu;
+			break;
+		case 0x80:		/* RES */
+			temp = acu & ~(1 << ((op >> 3) & 7));
+			break;
+		default:		/* SET (0xc0) */
+			temp = acu | (1 << ((op >> 3) & 7));
+			break;
+		}
+		switch (op & 7) {
+		case 0: Sethreg(BC, temp); break;
+		case 1: Setlreg(BC, temp); break;
+		case 2: Sethreg(DE, temp); break;
+		case 3: Setlreg(DE, temp); break;
+		case 4: Sethreg(HL, temp); break;
+		case 5: Setlreg(HL, temp); break;
+		case 6: PutBYTE(adr, temp);  break;
+		case 7: Sethreg(AF, temp); break;
+		}
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_cc(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+
+    /* CALL Z,nnnn */
+		CYCLES(z80_cc_op[0xcc]);
+		BB_CALLC(TSTFLAG(Z));
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_cd(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+
+    /* CALL nnnn */
+		CYCLES(z80_cc_op[0xcd]);
+		BB_CALL();
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ce(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* ADC A,nn */
+		CYCLES(z80_cc_op[0xce]);
+		temp = (PC++, BB_IMM);
+		acu = hreg(AF);
+		sum = acu + temp + TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_cf(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RST 8 */
+		CYCLES(z80_cc_op[0xcf]);
+		PUSH(PC); PC = 8;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d0(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RET NC */
+		CYCLES(z80_cc_op[0xd0]);
+		RETC(!TSTFLAG(C));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d1(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* POP DE */
+		CYCLES(z80_cc_op[0xd1]);
+		POP(DE);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d2(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP NC,nnnn */
+		CYCLES(z80_cc_op[0xd2]);
+		BB_JPC(!TSTFLAG(C));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d3(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* OUT (nn),A */
+		CYCLES(z80_cc_op[0xd3]);
+		Output((PC++, BB_IMM), hreg(AF));
+		if (cpu->sched.next < cpu->jit.deadline)
+			cpu->jit.deadline = cpu->sched.next;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d4(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+
+    /* CALL NC,nnnn */
+		CYCLES(z80_cc_op[0xd4]);
+		BB_CALLC(!TSTFLAG(C));
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d5(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* PUSH DE */
+		CYCLES(z80_cc_op[0xd5]);
+		PUSH(DE);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d6(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SUB nn */
+		CYCLES(z80_cc_op[0xd6]);
+		temp = (PC++, BB_IMM);
+		acu = hreg(AF);
+		sum = acu - temp;
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d7(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RST 10H */
+		CYCLES(z80_cc_op[0xd7]);
+		PUSH(PC); PC = 0x10;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d8(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RET C */
+		CYCLES(z80_cc_op[0xd8]);
+		RETC(TSTFLAG(C));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_d9(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* EXX */
+		CYCLES(z80_cc_op[0xd9]);
+		cpu->regs[cpu->regs_sel].bc = BC;
+		cpu->regs[cpu->regs_sel].de = DE;
+		cpu->regs[cpu->regs_sel].hl = HL;
+		cpu->regs_sel = 1 - cpu->regs_sel;
+		BC = cpu->regs[cpu->regs_sel].bc;
+		DE = cpu->regs[cpu->regs_sel].de;
+		HL = cpu->regs[cpu->regs_sel].hl;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_da(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP C,nnnn */
+		CYCLES(z80_cc_op[0xda]);
+		BB_JPC(TSTFLAG(C));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_db(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* IN A,(nn) */
+		CYCLES(z80_cc_op[0xdb]);
+		Sethreg(AF, Input((PC++, BB_IMM)));
+		if (cpu->sched.next < cpu->jit.deadline)
+			cpu->jit.deadline = cpu->sched.next;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_dc(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+
+    /* CALL C,nnnn */
+		CYCLES(z80_cc_op[0xdc]);
+		BB_CALLC(TSTFLAG(C));
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_dd(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+    FASTWORK temp, acu, sum, cbits, op, adr;
+
+    /* DD prefix */
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_xy[op]);
+		switch (op) {
+		case 0x09:			/* ADD IX,BC */
+			IX &= 0xffff;
+			BC &= 0xffff;
+			sum = IX + BC;
+			cbits = (IX ^ BC ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x19:			/* ADD IX,DE */
+			IX &= 0xffff;
+			DE &= 0xffff;
+			sum = IX + DE;
+			cbits = (IX ^ DE ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x21:			/* LD IX,nnnn */
+			IX = GetWORD(PC);
+			PC += 2;
+			break;
+		case 0x22:			/* LD (nnnn),IX */
+			temp = GetWORD(PC);
+			PutWORD(temp, IX);
+			PC += 2;
+			break;
+		case 0x23:			/* INC IX */
+			++IX;
+			break;
+		case 0x24:			/* INC IXH */
+			IX += 0x100;
+			temp = hreg(IX);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x25:			/* DEC IXH */
+			IX -= 0x100;
+			temp = hreg(IX);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x26:			/* LD IXH,nn */
+			Sethreg(IX, GetBYTE(PC++));
+			break;
+		case 0x29:			/* ADD IX,IX */
+			IX &= 0xffff;
+			sum = IX + IX;
+			cbits = (IX ^ IX ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x2A:			/* LD IX,(nnnn) */
+			temp = GetWORD(PC);
+			IX = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x2B:			/* DEC IX */
+			--IX;
+			break;
+		case 0x2C:			/* INC IXL */
+			temp = lreg(IX)+1;
+			Setlreg(IX, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x2D:			/* DEC IXL */
+			temp = lreg(IX)-1;
+			Setlreg(IX, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x2E:			/* LD IXL,nn */
+			Setlreg(IX, GetBYTE(PC++));
+			break;
+		case 0x34:			/* INC (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)+1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x35:			/* DEC (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)-1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x36:			/* LD (IX+dd),nn */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, GetBYTE(PC++));
+			break;
+		case 0x39:			/* ADD IX,SP */
+			IX &= 0xffff;
+			SP &= 0xffff;
+			sum = IX + SP;
+			cbits = (IX ^ SP ^ sum) >> 8;
+			IX = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x44:			/* LD B,IXH */
+			Sethreg(BC, hreg(IX));
+			break;
+		case 0x45:			/* LD B,IXL */
+			Sethreg(BC, lreg(IX));
+			break;
+		case 0x46:			/* LD B,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(BC, GetBYTE(adr));
+			break;
+		case 0x4C:			/* LD C,IXH */
+			Setlreg(BC, hreg(IX));
+			break;
+		case 0x4D:			/* LD C,IXL */
+			Setlreg(BC, lreg(IX));
+			break;
+		case 0x4E:			/* LD C,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Setlreg(BC, GetBYTE(adr));
+			break;
+		case 0x54:			/* LD D,IXH */
+			Sethreg(DE, hreg(IX));
+			break;
+		case 0x55:			/* LD D,IXL */
+			Sethreg(DE, lreg(IX));
+			break;
+		case 0x56:			/* LD D,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(DE, GetBYTE(adr));
+			break;
+		case 0x5C:			/* LD E,IXH */
+			Setlreg(DE, hreg(IX));
+			break;
+		case 0x5D:			/* LD E,IXL */
+			Setlreg(DE, lreg(IX));
+			break;
+		case 0x5E:			/* LD E,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Setlreg(DE, GetBYTE(adr));
+			break;
+		case 0x60:			/* LD IXH,B */
+			Sethreg(IX, hreg(BC));
+			break;
+		case 0x61:			/* LD IXH,C */
+			Sethreg(IX, lreg(BC));
+			break;
+		case 0x62:			/* LD IXH,D */
+			Sethreg(IX, hreg(DE));
+			break;
+		case 0x63:			/* LD IXH,E */
+			Sethreg(IX, lreg(DE));
+			break;
+		case 0x64:			/* LD IXH,IXH */
+			/* nop */
+			break;
+		case 0x65:			/* LD IXH,IXL */
+			Sethreg(IX, lreg(IX));
+			break;
+		case 0x66:			/* LD H,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(HL, GetBYTE(adr));
+			break;
+		case 0x67:			/* LD IXH,A */
+			Sethreg(IX, hreg(AF));
+			break;
+		case 0x68:			/* LD IXL,B */
+			Setlreg(IX, hreg(BC));
+			break;
+		case 0x69:			/* LD IXL,C */
+			Setlreg(IX, lreg(BC));
+			break;
+		case 0x6A:			/* LD IXL,D */
+			Setlreg(IX, hreg(DE));
+			break;
+		case 0x6B:			/* LD IXL,E */
+			Setlreg(IX, lreg(DE));
+			break;
+		case 0x6C:			/* LD IXL,IXH */
+			Setlreg(IX, hreg(IX));
+			break;
+		case 0x6D:			/* LD IXL,IXL */
+			/* nop */
+			break;
+		case 0x6E:			/* LD L,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Setlreg(HL, GetBYTE(adr));
+			break;
+		case 0x6F:			/* LD IXL,A */
+			Setlreg(IX, hreg(AF));
+			break;
+		case 0x70:			/* LD (IX+dd),B */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(BC));
+			break;
+		case 0x71:			/* LD (IX+dd),C */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(BC));
+			break;
+		case 0x72:			/* LD (IX+dd),D */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(DE));
+			break;
+		case 0x73:			/* LD (IX+dd),E */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(DE));
+			break;
+		case 0x74:			/* LD (IX+dd),H */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(HL));
+			break;
+		case 0x75:			/* LD (IX+dd),L */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(HL));
+			break;
+		case 0x77:			/* LD (IX+dd),A */
+			adr = IX + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(AF));
+			break;
+		case 0x7C:			/* LD A,IXH */
+			Sethreg(AF, hreg(IX));
+			break;
+		case 0x7D:			/* LD A,IXL */
+			Sethreg(AF, lreg(IX));
+			break;
+		case 0x7E:			/* LD A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			Sethreg(AF, GetBYTE(adr));
+			break;
+		case 0x84:			/* ADD A,IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x85:			/* ADD A,IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x86:			/* ADD A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8C:			/* ADC A,IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8D:			/* ADC A,IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8E:			/* ADC A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x94:			/* SUB IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x95:			/* SUB IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x96:			/* SUB (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9C:			/* SBC A,IXH */
+			temp = hreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9D:			/* SBC A,IXL */
+			temp = lreg(IX);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x9E:			/* SBC A,(IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xA4:			/* AND IXH */
+			sum = ((AF & (IX)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) |
+				((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
+			break;
+		case 0xA5:			/* AND IXL */
+			sum = ((AF >> 8) & IX) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xA6:			/* AND (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) & GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAC:			/* XOR IXH */
+			sum = ((AF ^ (IX)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAD:			/* XOR IXL */
+			sum = ((AF >> 8) ^ IX) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAE:			/* XOR (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) ^ GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB4:			/* OR IXH */
+			sum = ((AF | (IX)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB5:			/* OR IXL */
+			sum = ((AF >> 8) | IX) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB6:			/* OR (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) | GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xBC:			/* CP IXH */
+			temp = hreg(IX);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBD:			/* CP IXL */
+			temp = lreg(IX);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBE:			/* CP (IX+dd) */
+			adr = IX + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xCB:			/* CB prefix */
+			adr = IX + (signed char) GetBYTE(PC++);
+			adr = adr;
+			SYNC_FLAGS();
+			op = GetBYTE(PC++);
+			CYCLES(z80_cc_xycb[op]);
+			switch (op & 7) {
+			case 0: acu = hreg(BC); break;
+			case 1: acu = lreg(BC); break;
+			case 2: acu = hreg(DE); break;
+			case 3: acu = lreg(DE); break;
+			case 4: acu = hreg(HL); break;
+			case 5: acu = lreg(HL); break;
+			case 6: acu = GetBYTE(adr);  break;
+			case 7: acu = hreg(AF); break;
+			}
+			switch (op & 0xc0) {
+			case 0x00:		/* shift/rotate */
+				switch (op & 0x38) {
+				case 0x00:	/* RLC */
+					temp = (acu << 1) | (acu >> 7);
+					cbits = temp & 1;
+					goto bb_cbshflg2;
+				case 0x08:	/* RRC */
+					temp = (acu >> 1) | (acu << 7);
+					cbits = temp & 0x80;
+					goto bb_cbshflg2;
+				case 0x10:	/* RL */
+					temp = (acu << 1) | TSTFLAG(C);
+					cbits = acu & 0x80;
+					goto bb_cbshflg2;
+				case 0x18:	/* RR */
+					temp = (acu >> 1) | (TSTFLAG(C) << 7);
+					cbits = acu & 1;
+					goto bb_cbshflg2;
+				case 0x20:	/* SLA */
+					temp = acu << 1;
+					cbits = acu & 0x80;
+					goto bb_cbshflg2;
+				case 0x28:	/* SRA */
+					temp = (acu >> 1) | (acu & 0x80);
+					cbits = acu & 1;
+					goto bb_cbshflg2;
+				case 0x30:	/* SLIA */
+					temp = (acu << 1) | 1;
+					cbits = acu & 0x80;
+					goto bb_cbshflg2;
+				default:	/* SRL (0x38) */
+					temp = acu >> 1;
+					cbits = acu & 1;
+				bb_cbshflg2:
+					AF = (AF & ~0xff) | (temp & 0xa8) |
+						(((temp & 0xff) == 0) << 6) |
+						parity(temp) | !!cbits;
+				}
+				break;
+			case 0x40:		/* BIT */
+				if (acu & (1 << ((op >> 3) & 7)))
+					AF = (AF & ~0xfe) | 0x10 |
+					(((op & 0x38) == 0x38) << 7);
+				else
+					AF = (AF & ~0xfe) | 0x54;
+				if ((op&7) != 6)
+					AF |= (acu & 0x28);
+				temp = acu;
+				break;
+			case 0x80:		/* RES */
+				temp = acu & ~(1 << ((op >> 3) & 7));
+				break;
+			default:		/* SET (0xc0) */
+				temp = acu | (1 << ((op >> 3) & 7));
+				break;
+			}
+			switch (op & 7) {
+			case 0: Sethreg(BC, temp); break;
+			case 1: Setlreg(BC, temp); break;
+			case 2: Sethreg(DE, temp); break;
+			case 3: Setlreg(DE, temp); break;
+			case 4: Sethreg(HL, temp); break;
+			case 5: Setlreg(HL, temp); break;
+			case 6: PutBYTE(adr, temp);  break;
+			case 7: Sethreg(AF, temp); break;
+			}
+			break;
+		case 0xE1:			/* POP IX */
+			POP(IX);
+			break;
+		case 0xE3:			/* EX (SP),IX */
+			temp = IX; POP(IX); PUSH(temp);
+			break;
+		case 0xE5:			/* PUSH IX */
+			PUSH(IX);
+			break;
+		case 0xE9:			/* JP (IX) */
+			PC = IX;
+			break;
+		case 0xF9:			/* LD SP,IX */
+			SP = IX;
+			break;
+		default: PC--;		/* ignore DD */
+		}
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_de(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* SBC A,nn */
+		CYCLES(z80_cc_op[0xde]);
+		temp = (PC++, BB_IMM);
+		acu = hreg(AF);
+		sum = acu - temp - TSTFLAG(C);
+		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+		AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+			(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+			((cbits >> 8) & 1);
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_df(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RST 18H */
+		CYCLES(z80_cc_op[0xdf]);
+		PUSH(PC); PC = 0x18;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e0(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RET PO */
+		CYCLES(z80_cc_op[0xe0]);
+		RETC(!TSTFLAG(P));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e1(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* POP HL */
+		CYCLES(z80_cc_op[0xe1]);
+		POP(HL);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e2(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP PO,nnnn */
+		CYCLES(z80_cc_op[0xe2]);
+		BB_JPC(!TSTFLAG(P));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e3(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* EX (SP),HL */
+		CYCLES(z80_cc_op[0xe3]);
+		temp = HL; POP(HL); PUSH(temp);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e4(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+
+    /* CALL PO,nnnn */
+		CYCLES(z80_cc_op[0xe4]);
+		BB_CALLC(!TSTFLAG(P));
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e5(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* PUSH HL */
+		CYCLES(z80_cc_op[0xe5]);
+		PUSH(HL);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e6(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* AND nn */
+		CYCLES(z80_cc_op[0xe6]);
+		sum = ((AF >> 8) & (PC++, BB_IMM)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+			((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e7(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RST 20H */
+		CYCLES(z80_cc_op[0xe7]);
+		PUSH(PC); PC = 0x20;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e8(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RET PE */
+		CYCLES(z80_cc_op[0xe8]);
+		RETC(TSTFLAG(P));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_e9(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP (HL) */
+		CYCLES(z80_cc_op[0xe9]);
+		PC = HL;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ea(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP PE,nnnn */
+		CYCLES(z80_cc_op[0xea]);
+		BB_JPC(TSTFLAG(P));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_eb(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp;
+
+    /* EX DE,HL */
+		CYCLES(z80_cc_op[0xeb]);
+		temp = HL; HL = DE; DE = temp;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ec(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+
+    /* CALL PE,nnnn */
+		CYCLES(z80_cc_op[0xec]);
+		BB_CALLC(TSTFLAG(P));
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ed(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits, op, adr;
+
+    /* ED prefix */
+		SYNC_FLAGS();
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_ed[op]);
+		switch (op) {
+		case 0x40:			/* IN B,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(BC, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x41:			/* OUT (C),B */
+			Output(lreg(BC), BC);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x42:			/* SBC HL,BC */
+			HL &= 0xffff;
+			BC &= 0xffff;
+			sum = HL - BC - TSTFLAG(C);
+			cbits = (HL ^ BC ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x43:			/* LD (nnnn),BC */
+			temp = GetWORD(PC);
+			PutWORD(temp, BC);
+			PC += 2;
+			break;
+		case 0x44:			/* NEG */
+			temp = hreg(AF);
+			AF = (-(AF & 0xff00) & 0xff00);
+			AF |= ((AF >> 8) & 0xa8) | (((AF & 0xff00) == 0) << 6) |
+				(((temp & 0x0f) != 0) << 4) | ((temp == 0x80) << 2) |
+				2 | (temp != 0);
+			break;
+		case 0x45:			/* RETN */
+			cpu->IFF |= cpu->IFF >> 1;
+			if (cpu->sched.irq)
+				cpu->jit.deadline = CYC;
+			POP(PC);
+			break;
+		case 0x46:			/* IM 0 */
+			cpu->im = 0;
+			break;
+		case 0x47:			/* LD I,A */
+			cpu->ir = (cpu->ir & 255) | (AF & ~255);
+			break;
+		case 0x48:			/* IN C,(C) */
+			temp = Input(lreg(BC));
+			Setlreg(BC, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x49:			/* OUT (C),C */
+			Output(lreg(BC), BC);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x4A:			/* ADC HL,BC */
+			HL &= 0xffff;
+			BC &= 0xffff;
+			sum = HL + BC + TSTFLAG(C);
+			cbits = (HL ^ BC ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x4B:			/* LD BC,(nnnn) */
+			temp = GetWORD(PC);
+			BC = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x4D:			/* RETI */
+			cpu->IFF |= cpu->IFF >> 1;
+			if (cpu->sched.irq)
+				cpu->jit.deadline = CYC;
+			POP(PC);
+			break;
+		case 0x4F:			/* LD R,A */
+			cpu->ir = (cpu->ir & ~255) | ((AF >> 8) & 255);
+			cpu->rbase = CYC;
+			break;
+		case 0x50:			/* IN D,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(DE, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x51:			/* OUT (C),D */
+			Output(lreg(BC), DE);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x52:			/* SBC HL,DE */
+			HL &= 0xffff;
+			DE &= 0xffff;
+			sum = HL - DE - TSTFLAG(C);
+			cbits = (HL ^ DE ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x53:			/* LD (nnnn),DE */
+			temp = GetWORD(PC);
+			PutWORD(temp, DE);
+			PC += 2;
+			break;
+		case 0x56:			/* IM 1 */
+			cpu->im = 1;
+			break;
+		case 0x57:			/* LD A,I */
+			AF = (AF & 255) | (cpu->ir & ~255);
+			break;
+		case 0x58:			/* IN E,(C) */
+			temp = Input(lreg(BC));
+			Setlreg(DE, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x59:			/* OUT (C),E */
+			Output(lreg(BC), DE);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x5A:			/* ADC HL,DE */
+			HL &= 0xffff;
+			DE &= 0xffff;
+			sum = HL + DE + TSTFLAG(C);
+			cbits = (HL ^ DE ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x5B:			/* LD DE,(nnnn) */
+			temp = GetWORD(PC);
+			DE = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x5E:			/* IM 2 */
+			cpu->im = 2;
+			break;
+		case 0x5F:			/* LD A,R */
+			AF = (AF & 255) | (Z80_R(cpu, CYC) << 8);
+			break;
+		case 0x60:			/* IN H,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(HL, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x61:			/* OUT (C),H */
+			Output(lreg(BC), HL);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x62:			/* SBC HL,HL */
+			HL &= 0xffff;
+			sum = HL - HL - TSTFLAG(C);
+			cbits = (HL ^ HL ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x63:			/* LD (nnnn),HL */
+			temp = GetWORD(PC);
+			PutWORD(temp, HL);
+			PC += 2;
+			break;
+		case 0x67:			/* RRD */
+			temp = GetBYTE(HL);
+			acu = hreg(AF);
+			PutBYTE(HL, hdig(temp) | (ldig(acu) << 4));
+			acu = (acu & 0xf0) | ldig(temp);
+			AF = (acu << 8) | (acu & 0xa8) | (((acu & 0xff) == 0) << 6) |
+				partab[acu] | (AF & 1);
+			break;
+		case 0x68:			/* IN L,(C) */
+			temp = Input(lreg(BC));
+			Setlreg(HL, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x69:			/* OUT (C),L */
+			Output(lreg(BC), HL);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x6A:			/* ADC HL,HL */
+			HL &= 0xffff;
+			sum = HL + HL + TSTFLAG(C);
+			cbits = (HL ^ HL ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x6B:			/* LD HL,(nnnn) */
+			temp = GetWORD(PC);
+			HL = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x6F:			/* RLD */
+			temp = GetBYTE(HL);
+			acu = hreg(AF);
+			PutBYTE(HL, (ldig(temp) << 4) | ldig(acu));
+			acu = (acu & 0xf0) | hdig(temp);
+			AF = (acu << 8) | (acu & 0xa8) | (((acu & 0xff) == 0) << 6) |
+				partab[acu] | (AF & 1);
+			break;
+		case 0x70:			/* IN (C) */
+			temp = Input(lreg(BC));
+			Setlreg(temp, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x71:			/* OUT (C),0 */
+			Output(lreg(BC), 0);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x72:			/* SBC HL,SP */
+			HL &= 0xffff;
+			SP &= 0xffff;
+			sum = HL - SP - TSTFLAG(C);
+			cbits = (HL ^ SP ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | 2 | ((cbits >> 8) & 1);
+			break;
+		case 0x73:			/* LD (nnnn),SP */
+			temp = GetWORD(PC);
+			PutWORD(temp, SP);
+			PC += 2;
+			break;
+		case 0x78:			/* IN A,(C) */
+			temp = Input(lreg(BC));
+			Sethreg(AF, temp);
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				parity(temp);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x79:			/* OUT (C),A */
+			Output(lreg(BC), AF);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0x7A:			/* ADC HL,SP */
+			HL &= 0xffff;
+			SP &= 0xffff;
+			sum = HL + SP + TSTFLAG(C);
+			cbits = (HL ^ SP ^ sum) >> 8;
+			HL = sum;
+			AF = (AF & ~0xff) | ((sum >> 8) & 0xa8) |
+				(((sum & 0xffff) == 0) << 6) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x7B:			/* LD SP,(nnnn) */
+			temp = GetWORD(PC);
+			SP = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0xA0:			/* LDI */
+			acu = GetBYTE(HL++);
+			PutBYTE(DE++, acu);
+			acu += hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4) |
+				(((--BC & 0xffff) != 0) << 2);
+			break;
+		case 0xA1:			/* CPI */
+			acu = hreg(AF);
+			temp = GetBYTE(HL++);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) | (cbits & 16) |
+				(sum & 8) | ((--BC & 0xffff) != 0) << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xA2:			/* INI */
+			PutBYTE(HL++, Input(lreg(BC)));
+			SETFLAG(N, 1);
+			SETFLAG(P, (--BC & 0xffff) != 0);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0xA3:			/* OUTI */
+			Output(lreg(BC), GetBYTE(HL++));
+			SETFLAG(N, 1);
+			Sethreg(BC, lreg(BC) - 1);
+			SETFLAG(Z, lreg(BC) == 0);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0xA8:			/* LDD */
+			acu = GetBYTE(HL--);
+			PutBYTE(DE--, acu);
+			acu += hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4) |
+				(((--BC & 0xffff) != 0) << 2);
+			break;
+		case 0xA9:			/* CPD */
+			acu = hreg(AF);
+			temp = GetBYTE(HL--);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) | (cbits & 16) |
+				(sum & 8) | ((--BC & 0xffff) != 0) << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xAA:			/* IND */
 			PutBYTE(HL--, Input(lreg(BC)));
 			SETFLAG(N, 1);
 			Sethreg(BC, lreg(BC) - 1);
 			SETFLAG(Z, lreg(BC) == 0);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0xAB:			/* OUTD */
+			Output(lreg(BC), GetBYTE(HL--));
+			SETFLAG(N, 1);
+			Sethreg(BC, lreg(BC) - 1);
+			SETFLAG(Z, lreg(BC) == 0);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0xB0:			/* LDIR */
+			adr = BC & 0xffff ? BC & 0xffff : 0x10000;
+			CYCLES(21 * (adr - 1));
+			trap_move_block(cpu, DE, HL, adr, 0);
+			HL += adr;
+			DE += adr;
+			BC = 0;
+			acu = RAM(DE - 1) + hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
+			break;
+		case 0xB1:			/* CPIR */
+			acu = hreg(AF);
+			adr = trap_find_byte(cpu, HL, BC & 0xffff ? BC & 0xffff : 0x10000,
+					     acu, 0);
+			CYCLES(21 * (adr - 1));
+			HL += adr;
+			BC = (BC - adr) & 0xffff;
+			temp = RAM(HL - 1);
+			op = BC != 0;
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) |
+				(cbits & 16) | (sum & 8) | op << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xB2:			/* INIR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				PutBYTE(HL++, Input(lreg(BC)));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0xB3:			/* OTIR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				Output(lreg(BC), GetBYTE(HL++));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0xB8:			/* LDDR */
+			adr = BC & 0xffff ? BC & 0xffff : 0x10000;
+			CYCLES(21 * (adr - 1));
+			trap_move_block(cpu, DE, HL, adr, 1);
+			HL -= adr;
+			DE -= adr;
+			BC = 0;
+			acu = RAM(DE + 1) + hreg(AF);
+			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
+			break;
+		case 0xB9:			/* CPDR */
+			acu = hreg(AF);
+			adr = trap_find_byte(cpu, HL, BC & 0xffff ? BC & 0xffff : 0x10000,
+					     acu, 1);
+			CYCLES(21 * (adr - 1));
+			HL -= adr;
+			BC = (BC - adr) & 0xffff;
+			temp = RAM(HL + 1);
+			op = BC != 0;
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
+				(((sum - ((cbits&16)>>4))&2) << 4) |
+				(cbits & 16) | (sum & 8) | op << 2 | 2;
+			if ((sum & 15) == 8 && (cbits & 16) != 0)
+				AF &= ~8;
+			break;
+		case 0xBA:			/* INDR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				PutBYTE(HL--, Input(lreg(BC)));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		case 0xBB:			/* OTDR */
+			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
+			do {
+				Output(lreg(BC), GetBYTE(HL--));
+			} while (--temp);
+			Sethreg(BC, 0);
+			SETFLAG(N, 1);
+			SETFLAG(Z, 1);
+			if (cpu->sched.next < cpu->jit.deadline)
+				cpu->jit.deadline = cpu->sched.next;
+			break;
+		default: if (0x40 <= op && op <= 0x7f) PC--;		/* ignore ED */
+		}
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ee(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* XOR nn */
+		CYCLES(z80_cc_op[0xee]);
+		sum = ((AF >> 8) ^ (PC++, BB_IMM)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ef(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RST 28H */
+		CYCLES(z80_cc_op[0xef]);
+		PUSH(PC); PC = 0x28;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f0(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RET P */
+		CYCLES(z80_cc_op[0xf0]);
+		RETC(!TSTFLAG(S));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f1(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* POP AF */
+		CYCLES(z80_cc_op[0xf1]);
+		SYNC_FLAGS(); POP(AF);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f2(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP P,nnnn */
+		CYCLES(z80_cc_op[0xf2]);
+		BB_JPC(!TSTFLAG(S));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f3(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* DI */
+		CYCLES(z80_cc_op[0xf3]);
+		cpu->IFF = 0;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f4(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+
+    /* CALL P,nnnn */
+		CYCLES(z80_cc_op[0xf4]);
+		BB_CALLC(!TSTFLAG(S));
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f5(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* PUSH AF */
+		CYCLES(z80_cc_op[0xf5]);
+		SYNC_FLAGS(); PUSH(AF);
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f6(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK sum;
+
+    /* OR nn */
+		CYCLES(z80_cc_op[0xf6]);
+		sum = ((AF >> 8) | (PC++, BB_IMM)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+		AF = sum << 8;
+		LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f7(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RST 30H */
+		CYCLES(z80_cc_op[0xf7]);
+		PUSH(PC); PC = 0x30;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f8(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RET M */
+		CYCLES(z80_cc_op[0xf8]);
+		RETC(TSTFLAG(S));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_f9(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* LD SP,HL */
+		CYCLES(z80_cc_op[0xf9]);
+		SP = HL;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_fa(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* JP M,nnnn */
+		CYCLES(z80_cc_op[0xfa]);
+		BB_JPC(TSTFLAG(S));
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_fb(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* EI */
+		CYCLES(z80_cc_op[0xfb]);
+		cpu->IFF = 3;
+		cpu->sched.ei = CYC;
+		if (cpu->sched.irq)
+			cpu->jit.deadline = CYC;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_fc(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+
+    /* CALL M,nnnn */
+		CYCLES(z80_cc_op[0xfc]);
+		BB_CALLC(TSTFLAG(S));
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_fd(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTREG IX = cpu->ix, IY = cpu->iy;
+    FASTWORK temp, acu, sum, cbits, op, adr;
+
+    /* FD prefix */
+		op = GetBYTE(PC++);
+		CYCLES(z80_cc_xy[op]);
+		switch (op) {
+		case 0x09:			/* ADD IY,BC */
+			IY &= 0xffff;
+			BC &= 0xffff;
+			sum = IY + BC;
+			cbits = (IY ^ BC ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x19:			/* ADD IY,DE */
+			IY &= 0xffff;
+			DE &= 0xffff;
+			sum = IY + DE;
+			cbits = (IY ^ DE ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x21:			/* LD IY,nnnn */
+			IY = GetWORD(PC);
+			PC += 2;
+			break;
+		case 0x22:			/* LD (nnnn),IY */
+			temp = GetWORD(PC);
+			PutWORD(temp, IY);
+			PC += 2;
+			break;
+		case 0x23:			/* INC IY */
+			++IY;
+			break;
+		case 0x24:			/* INC IYH */
+			IY += 0x100;
+			temp = hreg(IY);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x25:			/* DEC IYH */
+			IY -= 0x100;
+			temp = hreg(IY);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x26:			/* LD IYH,nn */
+			Sethreg(IY, GetBYTE(PC++));
+			break;
+		case 0x29:			/* ADD IY,IY */
+			IY &= 0xffff;
+			sum = IY + IY;
+			cbits = (IY ^ IY ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x2A:			/* LD IY,(nnnn) */
+			temp = GetWORD(PC);
+			IY = GetWORD(temp);
+			PC += 2;
+			break;
+		case 0x2B:			/* DEC IY */
+			--IY;
+			break;
+		case 0x2C:			/* INC IYL */
+			temp = lreg(IY)+1;
+			Setlreg(IY, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x2D:			/* DEC IYL */
+			temp = lreg(IY)-1;
+			Setlreg(IY, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x2E:			/* LD IYL,nn */
+			Setlreg(IY, GetBYTE(PC++));
+			break;
+		case 0x34:			/* INC (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)+1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_INC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0) << 4) |
+				((temp == 0x80) << 2);
+#endif
+			break;
+		case 0x35:			/* DEC (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr)-1;
+			PutBYTE(adr, temp);
+#ifdef OPT_LAZY_FLAGS
+			LAZY_FLAGS(LF_DEC, temp, 0, 0);
+#else
+			AF = (AF & ~0xfe) | (temp & 0xa8) |
+				(((temp & 0xff) == 0) << 6) |
+				(((temp & 0xf) == 0xf) << 4) |
+				((temp == 0x7f) << 2) | 2;
+#endif
+			break;
+		case 0x36:			/* LD (IY+dd),nn */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, GetBYTE(PC++));
+			break;
+		case 0x39:			/* ADD IY,SP */
+			IY &= 0xffff;
+			SP &= 0xffff;
+			sum = IY + SP;
+			cbits = (IY ^ SP ^ sum) >> 8;
+			IY = sum;
+			SYNC_FLAGS();
+			AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+			break;
+		case 0x44:			/* LD B,IYH */
+			Sethreg(BC, hreg(IY));
+			break;
+		case 0x45:			/* LD B,IYL */
+			Sethreg(BC, lreg(IY));
+			break;
+		case 0x46:			/* LD B,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(BC, GetBYTE(adr));
+			break;
+		case 0x4C:			/* LD C,IYH */
+			Setlreg(BC, hreg(IY));
+			break;
+		case 0x4D:			/* LD C,IYL */
+			Setlreg(BC, lreg(IY));
+			break;
+		case 0x4E:			/* LD C,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Setlreg(BC, GetBYTE(adr));
+			break;
+		case 0x54:			/* LD D,IYH */
+			Sethreg(DE, hreg(IY));
+			break;
+		case 0x55:			/* LD D,IYL */
+			Sethreg(DE, lreg(IY));
+			break;
+		case 0x56:			/* LD D,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(DE, GetBYTE(adr));
+			break;
+		case 0x5C:			/* LD E,IYH */
+			Setlreg(DE, hreg(IY));
+			break;
+		case 0x5D:			/* LD E,IYL */
+			Setlreg(DE, lreg(IY));
+			break;
+		case 0x5E:			/* LD E,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Setlreg(DE, GetBYTE(adr));
+			break;
+		case 0x60:			/* LD IYH,B */
+			Sethreg(IY, hreg(BC));
+			break;
+		case 0x61:			/* LD IYH,C */
+			Sethreg(IY, lreg(BC));
+			break;
+		case 0x62:			/* LD IYH,D */
+			Sethreg(IY, hreg(DE));
+			break;
+		case 0x63:			/* LD IYH,E */
+			Sethreg(IY, lreg(DE));
+			break;
+		case 0x64:			/* LD IYH,IYH */
+			/* nop */
+			break;
+		case 0x65:			/* LD IYH,IYL */
+			Sethreg(IY, lreg(IY));
+			break;
+		case 0x66:			/* LD H,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(HL, GetBYTE(adr));
+			break;
+		case 0x67:			/* LD IYH,A */
+			Sethreg(IY, hreg(AF));
+			break;
+		case 0x68:			/* LD IYL,B */
+			Setlreg(IY, hreg(BC));
+			break;
+		case 0x69:			/* LD IYL,C */
+			Setlreg(IY, lreg(BC));
+			break;
+		case 0x6A:			/* LD IYL,D */
+			Setlreg(IY, hreg(DE));
+			break;
+		case 0x6B:			/* LD IYL,E */
+			Setlreg(IY, lreg(DE));
+			break;
+		case 0x6C:			/* LD IYL,IYH */
+			Setlreg(IY, hreg(IY));
+			break;
+		case 0x6D:			/* LD IYL,IYL */
+			/* nop */
+			break;
+		case 0x6E:			/* LD L,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Setlreg(HL, GetBYTE(adr));
+			break;
+		case 0x6F:			/* LD IYL,A */
+			Setlreg(IY, hreg(AF));
+			break;
+		case 0x70:			/* LD (IY+dd),B */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(BC));
+			break;
+		case 0x71:			/* LD (IY+dd),C */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(BC));
+			break;
+		case 0x72:			/* LD (IY+dd),D */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(DE));
+			break;
+		case 0x73:			/* LD (IY+dd),E */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(DE));
+			break;
+		case 0x74:			/* LD (IY+dd),H */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(HL));
+			break;
+		case 0x75:			/* LD (IY+dd),L */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, lreg(HL));
+			break;
+		case 0x77:			/* LD (IY+dd),A */
+			adr = IY + (signed char) GetBYTE(PC++);
+			PutBYTE(adr, hreg(AF));
+			break;
+		case 0x7C:			/* LD A,IYH */
+			Sethreg(AF, hreg(IY));
+			break;
+		case 0x7D:			/* LD A,IYL */
+			Sethreg(AF, lreg(IY));
+			break;
+		case 0x7E:			/* LD A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			Sethreg(AF, GetBYTE(adr));
+			break;
+		case 0x84:			/* ADD A,IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x85:			/* ADD A,IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x86:			/* ADD A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8C:			/* ADC A,IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
+			break;
+		case 0x8D:			/* ADC A,IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
 			break;
-		case 0xAB:			/* OUTD */
-			Output(lreg(BC), GetBYTE(HL--));
-			SETFLAG(N, 1);
-			Sethreg(BC, lreg(BC) - 1);
-			SETFLAG(Z, lreg(BC) == 0);
+		case 0x8E:			/* ADC A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu + temp + TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_ADD, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) |
+				((cbits >> 8) & 1);
+#endif
 			break;
-		case 0xB0:			/* LDIR */
+		case 0x94:			/* SUB IYH */
+			temp = hreg(IY);
 			acu = hreg(AF);
-			BC &= 0xffff;
-			do {
-				acu = GetBYTE(HL++);
-				PutBYTE(DE++, acu);
-			} while (--BC);
-			acu += hreg(AF);
-			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
 			break;
-		case 0xB1:			/* CPIR */
+		case 0x95:			/* SUB IYL */
+			temp = lreg(IY);
 			acu = hreg(AF);
-			BC &= 0xffff;
-			do {
-				temp = GetBYTE(HL++);
-				op = --BC != 0;
-				sum = acu - temp;
-			} while (op && sum != 0);
+			sum = acu - temp;
 			cbits = acu ^ temp ^ sum;
-			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
-				(((sum - ((cbits&16)>>4))&2) << 4) |
-				(cbits & 16) | (sum & 8) | op << 2 | 2;
-			if ((sum & 15) == 8 && (cbits & 16) != 0)
-				AF &= ~8;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
 			break;
-		case 0xB2:			/* INIR */
-			temp = hreg(BC);
-			do {
-				PutBYTE(HL++, Input(lreg(BC)));
-			} while (--temp);
-			Sethreg(BC, 0);
-			SETFLAG(N, 1);
-			SETFLAG(Z, 1);
+		case 0x96:			/* SUB (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
 			break;
-		case 0xB3:			/* OTIR */
-			temp = hreg(BC);
-			do {
-				Output(lreg(BC), GetBYTE(HL++));
-			} while (--temp);
-			Sethreg(BC, 0);
-			SETFLAG(N, 1);
-			SETFLAG(Z, 1);
+		case 0x9C:			/* SBC A,IYH */
+			temp = hreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
 			break;
-		case 0xB8:			/* LDDR */
-			BC &= 0xffff;
-			do {
-				acu = GetBYTE(HL--);
-				PutBYTE(DE--, acu);
-			} while (--BC);
-			acu += hreg(AF);
-			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
+		case 0x9D:			/* SBC A,IYL */
+			temp = lreg(IY);
+			acu = hreg(AF);
+			sum = acu - temp - TSTFLAG(C);
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
 			break;
-		case 0xB9:			/* CPDR */
+		case 0x9E:			/* SBC A,(IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
 			acu = hreg(AF);
-			BC &= 0xffff;
-			do {
-				temp = GetBYTE(HL--);
-				op = --BC != 0;
-				sum = acu - temp;
-			} while (op && sum != 0);
+			sum = acu - temp - TSTFLAG(C);
 			cbits = acu ^ temp ^ sum;
-			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
-				(((sum - ((cbits&16)>>4))&2) << 4) |
-				(cbits & 16) | (sum & 8) | op << 2 | 2;
-			if ((sum & 15) == 8 && (cbits & 16) != 0)
-				AF &= ~8;
+#ifdef OPT_LAZY_FLAGS
+			AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_SUB, sum, cbits, 0);
+#else
+			AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
+				(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				((cbits >> 8) & 1);
+#endif
 			break;
-		case 0xBA:			/* INDR */
-			temp = hreg(BC);
-			do {
-				PutBYTE(HL--, Input(lreg(BC)));
-			} while (--temp);
-			Sethreg(BC, 0);
-			SETFLAG(N, 1);
-			SETFLAG(Z, 1);
+		case 0xA4:			/* AND IYH */
+			sum = ((AF & (IY)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) |
+				((sum == 0) << 6) | 0x10 | partab[sum];
+#endif
 			break;
-		case 0xBB:			/* OTDR */
-			temp = hreg(BC);
-			do {
-				Output(lreg(BC), GetBYTE(HL--));
-			} while (--temp);
-			Sethreg(BC, 0);
-			SETFLAG(N, 1);
-			SETFLAG(Z, 1);
+		case 0xA5:			/* AND IYL */
+			sum = ((AF >> 8) & IY) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
 			break;
-		default: if (0x40 <= op && op <= 0x7f) PC--;		/* ignore ED */
+		case 0xA6:			/* AND (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) & GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_AND, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | 0x10 |
+				((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAC:			/* XOR IYH */
+			sum = ((AF ^ (IY)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAD:			/* XOR IYL */
+			sum = ((AF >> 8) ^ IY) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xAE:			/* XOR (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) ^ GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB4:			/* OR IYH */
+			sum = ((AF | (IY)) >> 8) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB5:			/* OR IYL */
+			sum = ((AF >> 8) | IY) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xB6:			/* OR (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			sum = ((AF >> 8) | GetBYTE(adr)) & 0xff;
+#ifdef OPT_LAZY_FLAGS
+			AF = sum << 8;
+			LAZY_FLAGS(LF_LOG, sum, 0, 0);
+#else
+			AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
+#endif
+			break;
+		case 0xBC:			/* CP IYH */
+			temp = hreg(IY);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBD:			/* CP IYL */
+			temp = lreg(IY);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xBE:			/* CP (IY+dd) */
+			adr = IY + (signed char) GetBYTE(PC++);
+			temp = GetBYTE(adr);
+			AF = (AF & ~0x28) | (temp & 0x28);
+			acu = hreg(AF);
+			sum = acu - temp;
+			cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+			AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+			LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
+			AF = (AF & ~0xff) | (sum & 0x80) |
+				(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
+				(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
+				(cbits & 0x10) | ((cbits >> 8) & 1);
+#endif
+			break;
+		case 0xCB:			/* CB prefix */
+			adr = IY + (signed char) GetBYTE(PC++);
+			adr = adr;
+			SYNC_FLAGS();
+			op = GetBYTE(PC++);
+			CYCLES(z80_cc_xycb[op]);
+			switch (op & 7) {
+			case 0: acu = hreg(BC); break;
+			case 1: acu = lreg(BC); break;
+			case 2: acu = hreg(DE); break;
+			case 3: acu = lreg(DE); break;
+			case 4: acu = hreg(HL); break;
+			case 5: acu = lreg(HL); break;
+			case 6: acu = GetBYTE(adr);  break;
+			case 7: acu = hreg(AF); break;
+			}
+			switch (op & 0xc0) {
+			case 0x00:		/* shift/rotate */
+				switch (op & 0x38) {
+				case 0x00:	/* RLC */
+					temp = (acu << 1) | (acu >> 7);
+					cbits = temp & 1;
+					goto bb_cbshflg3;
+				case 0x08:	/* RRC */
+					temp = (acu >> 1) | (acu << 7);
+					cbits = temp & 0x80;
+					goto bb_cbshflg3;
+				case 0x10:	/* RL */
+					temp = (acu << 1) | TSTFLAG(C);
+					cbits = acu & 0x80;
+					goto bb_cbshflg3;
+				case 0x18:	/* RR */
+					temp = (acu >> 1) | (TSTFLAG(C) << 7);
+					cbits = acu & 1;
+					goto bb_cbshflg3;
+				case 0x20:	/* SLA */
+					temp = acu << 1;
+					cbits = acu & 0x80;
+					goto bb_cbshflg3;
+				case 0x28:	/* SRA */
+					temp = (acu >> 1) | (acu & 0x80);
+					cbits = acu & 1;
+					goto bb_cbshflg3;
+				case 0x30:	/* SLIA */
+					temp = (acu << 1) | 1;
+					cbits = acu & 0x80;
+					goto bb_cbshflg3;
+				default:	/* SRL (0x38) */
+					temp = acu >> 1;
+					cbits = acu & 1;
+				bb_cbshflg3:
+					AF = (AF & ~0xff) | (temp & 0xa8) |
+						(((temp & 0xff) == 0) << 6) |
+						parity(temp) | !!cbits;
+				}
+				break;
+			case 0x40:		/* BIT */
+				if (acu & (1 << ((op >> 3) & 7)))
+					AF = (AF & ~0xfe) | 0x10 |
+					(((op & 0x38) == 0x38) << 7);
+				else
+					AF = (AF & ~0xfe) | 0x54;
+				if ((op&7) != 6)
+					AF |= (acu & 0x28);
+				temp = acu;
+				break;
+			case 0x80:		/* RES */
+				temp = acu & ~(1 << ((op >> 3) & 7));
+				break;
+			default:		/* SET (0xc0) */
+				temp = acu | (1 << ((op >> 3) & 7));
+				break;
+			}
+			switch (op & 7) {
+			case 0: Sethreg(BC, temp); break;
+			case 1: Setlreg(BC, temp); break;
+			case 2: Sethreg(DE, temp); break;
+			case 3: Setlreg(DE, temp); break;
+			case 4: Sethreg(HL, temp); break;
+			case 5: Setlreg(HL, temp); break;
+			case 6: PutBYTE(adr, temp);  break;
+			case 7: Sethreg(AF, temp); break;
+			}
+			break;
+		case 0xE1:			/* POP IY */
+			POP(IY);
+			break;
+		case 0xE3:			/* EX (SP),IY */
+			temp = IY; POP(IY); PUSH(temp);
+			break;
+		case 0xE5:			/* PUSH IY */
+			PUSH(IY);
+			break;
+		case 0xE9:			/* JP (IY) */
+			PC = IY;
+			break;
+		case 0xF9:			/* LD SP,IY */
+			SP = IY;
+			break;
+		default: PC--;		/* ignore DD */
 		}
-		break;
-	case 0xEE:			/* XOR nn */
-		sum = ((AF >> 8) ^ GetBYTE(PC++)) & 0xff;
-		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xEF:			/* RST 28H */
-		PUSH(PC); PC = 0x28;
-		break;
-	case 0xF0:			/* RET P */
-		if (!TSTFLAG(S)) POP(PC);
-		break;
-	case 0xF1:			/* POP AF */
-		POP(AF);
-		break;
-	case 0xF2:			/* JP P,nnnn */
-		JPC(!TSTFLAG(S));
-		break;
-	case 0xF3:			/* DI */
-		IFF = 0;
-		break;
-	case 0xF4:			/* CALL P,nnnn */
-		CALLC(!TSTFLAG(S));
-		break;
-	case 0xF5:			/* PUSH AF */
-		PUSH(AF);
-		break;
-	case 0xF6:			/* OR nn */
-		sum = ((AF >> 8) | GetBYTE(PC++)) & 0xff;
-		AF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];
-		break;
-	case 0xF7:			/* RST 30H */
-		PUSH(PC); PC = 0x30;
-		break;
-	case 0xF8:			/* RET M */
-		if (TSTFLAG(S)) POP(PC);
-		break;
-	case 0xF9:			/* LD SP,HL */
-		SP = HL;
-		break;
-	case 0xFA:			/* JP M,nnnn */
-		JPC(TSTFLAG(S));
-		break;
-	case 0xFB:			/* EI */
-		IFF = 3;
-		break;
-	case 0xFC:			/* CALL M,nnnn */
-		CALLC(TSTFLAG(S));
-		break;
-	case 0xFD:			/* FD prefix */
-		SAVE_STATE();
-		iy = dfd_prefix(iy);
-		LOAD_STATE();
-		break;
-	case 0xFE:			/* CP nn */
-		temp = GetBYTE(PC++);
+    cpu->ix = IX;
+    cpu->iy = IY;
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_fe(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+    FASTWORK temp, acu, sum, cbits;
+
+    /* CP nn */
+		CYCLES(z80_cc_op[0xfe]);
+		temp = (PC++, BB_IMM);
 		AF = (AF & ~0x28) | (temp & 0x28);
 		acu = hreg(AF);
 		sum = acu - temp;
 		cbits = acu ^ temp ^ sum;
+#ifdef OPT_LAZY_FLAGS
+		AF = (AF & ~0xff) | ((cbits >> 8) & 1);
+		LAZY_FLAGS(LF_CP, sum, cbits, temp);
+#else
 		AF = (AF & ~0xff) | (sum & 0x80) |
 			(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 			(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 			(cbits & 0x10) | ((cbits >> 8) & 1);
-		break;
-	case 0xFF:			/* RST 38H */
+#endif
+
+    JIT_STORE_STATE();
+    return PC;
+}
+
+static FASTREG
+jit_op_ff(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+#ifdef OPT_LAZY_FLAGS
+    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;
+#endif
+
+    /* RST 38H */
+		CYCLES(z80_cc_op[0xff]);
 		PUSH(PC); PC = 0x38;
-    }
-    }
-/* make registers visible for debugging if interrupted */
-    SAVE_STATE();
-    return (PC&0xffff)|0x10000;	/* flag non-bios stop */
+
+    JIT_STORE_STATE();
+    return PC;
 }
+
+jit_helper jit_optab[256] = {
+	jit_op_00,jit_op_01,jit_op_02,jit_op_03,
+	jit_op_04,jit_op_05,jit_op_06,jit_op_07,
+	jit_op_08,jit_op_09,jit_op_0a,jit_op_0b,
+	jit_op_0c,jit_op_0d,jit_op_0e,jit_op_0f,
+	jit_op_10,jit_op_11,jit_op_12,jit_op_13,
+	jit_op_14,jit_op_15,jit_op_16,jit_op_17,
+	jit_op_18,jit_op_19,jit_op_1a,jit_op_1b,
+	jit_op_1c,jit_op_1d,jit_op_1e,jit_op_1f,
+	jit_op_20,jit_op_21,jit_op_22,jit_op_23,
+	jit_op_24,jit_op_25,jit_op_26,jit_op_27,
+	jit_op_28,jit_op_29,jit_op_2a,jit_op_2b,
+	jit_op_2c,jit_op_2d,jit_op_2e,jit_op_2f,
+	jit_op_30,jit_op_31,jit_op_32,jit_op_33,
+	jit_op_34,jit_op_35,jit_op_36,jit_op_37,
+	jit_op_38,jit_op_39,jit_op_3a,jit_op_3b,
+	jit_op_3c,jit_op_3d,jit_op_3e,jit_op_3f,
+	jit_op_40,jit_op_41,jit_op_42,jit_op_43,
+	jit_op_44,jit_op_45,jit_op_46,jit_op_47,
+	jit_op_48,jit_op_49,jit_op_4a,jit_op_4b,
+	jit_op_4c,jit_op_4d,jit_op_4e,jit_op_4f,
+	jit_op_50,jit_op_51,jit_op_52,jit_op_53,
+	jit_op_54,jit_op_55,jit_op_56,jit_op_57,
+	jit_op_58,jit_op_59,jit_op_5a,jit_op_5b,
+	jit_op_5c,jit_op_5d,jit_op_5e,jit_op_5f,
+	jit_op_60,jit_op_61,jit_op_62,jit_op_63,
+	jit_op_64,jit_op_65,jit_op_66,jit_op_67,
+	jit_op_68,jit_op_69,jit_op_6a,jit_op_6b,
+	jit_op_6c,jit_op_6d,jit_op_6e,jit_op_6f,
+	jit_op_70,jit_op_71,jit_op_72,jit_op_73,
+	jit_op_74,jit_op_75,NULL,jit_op_77,
+	jit_op_78,jit_op_79,jit_op_7a,jit_op_7b,
+	jit_op_7c,jit_op_7d,jit_op_7e,jit_op_7f,
+	jit_op_80,jit_op_81,jit_op_82,jit_op_83,
+	jit_op_84,jit_op_85,jit_op_86,jit_op_87,
+	jit_op_88,jit_op_89,jit_op_8a,jit_op_8b,
+	jit_op_8c,jit_op_8d,jit_op_8e,jit_op_8f,
+	jit_op_90,jit_op_91,jit_op_92,jit_op_93,
+	jit_op_94,jit_op_95,jit_op_96,jit_op_97,
+	jit_op_98,jit_op_99,jit_op_9a,jit_op_9b,
+	jit_op_9c,jit_op_9d,jit_op_9e,jit_op_9f,
+	jit_op_a0,jit_op_a1,jit_op_a2,jit_op_a3,
+	jit_op_a4,jit_op_a5,jit_op_a6,jit_op_a7,
+	jit_op_a8,jit_op_a9,jit_op_aa,jit_op_ab,
+	jit_op_ac,jit_op_ad,jit_op_ae,jit_op_af,
+	jit_op_b0,jit_op_b1,jit_op_b2,jit_op_b3,
+	jit_op_b4,jit_op_b5,jit_op_b6,jit_op_b7,
+	jit_op_b8,jit_op_b9,jit_op_ba,jit_op_bb,
+	jit_op_bc,jit_op_bd,jit_op_be,jit_op_bf,
+	jit_op_c0,jit_op_c1,jit_op_c2,jit_op_c3,
+	jit_op_c4,jit_op_c5,jit_op_c6,jit_op_c7,
+	jit_op_c8,jit_op_c9,jit_op_ca,jit_op_cb,
+	jit_op_cc,jit_op_cd,jit_op_ce,jit_op_cf,
+	jit_op_d0,jit_op_d1,jit_op_d2,jit_op_d3,
+	jit_op_d4,jit_op_d5,jit_op_d6,jit_op_d7,
+	jit_op_d8,jit_op_d9,jit_op_da,jit_op_db,
+	jit_op_dc,jit_op_dd,jit_op_de,jit_op_df,
+	jit_op_e0,jit_op_e1,jit_op_e2,jit_op_e3,
+	jit_op_e4,jit_op_e5,jit_op_e6,jit_op_e7,
+	jit_op_e8,jit_op_e9,jit_op_ea,jit_op_eb,
+	jit_op_ec,jit_op_ed,jit_op_ee,jit_op_ef,
+	jit_op_f0,jit_op_f1,jit_op_f2,jit_op_f3,
+	jit_op_f4,jit_op_f5,jit_op_f6,jit_op_f7,
+	jit_op_f8,jit_op_f9,jit_op_fa,jit_op_fb,
+	jit_op_fc,jit_op_fd,jit_op_fe,jit_op_ff,
+};
+#endif
+
+/* mnemonics of the op-codes for disasm.c: nn is a byte, nnnn a word,
+   dd a displacement, XY stands for IX or IY; NULL if not defined */
+const char *const z80_mn_op[256] = {
+	"NOP",	/* 00 */
+	"LD BC,nnnn",	/* 01 */
+	"LD (BC),A",	/* 02 */
+	"INC BC",	/* 03 */
+	"INC B",	/* 04 */
+	"DEC B",	/* 05 */
+	"LD B,nn",	/* 06 */
+	"RLCA",	/* 07 */
+	"EX AF,AF'",	/* 08 */
+	"ADD HL,BC",	/* 09 */
+	"LD A,(BC)",	/* 0a */
+	"DEC BC",	/* 0b */
+	"INC C",	/* 0c */
+	"DEC C",	/* 0d */
+	"LD C,nn",	/* 0e */
+	"RRCA",	/* 0f */
+	"DJNZ dd",	/* 10 */
+	"LD DE,nnnn",	/* 11 */
+	"LD (DE),A",	/* 12 */
+	"INC DE",	/* 13 */
+	"INC D",	/* 14 */
+	"DEC D",	/* 15 */
+	"LD D,nn",	/* 16 */
+	"RLA",	/* 17 */
+	"JR dd",	/* 18 */
+	"ADD HL,DE",	/* 19 */
+	"LD A,(DE)",	/* 1a */
+	"DEC DE",	/* 1b */
+	"INC E",	/* 1c */
+	"DEC E",	/* 1d */
+	"LD E,nn",	/* 1e */
+	"RRA",	/* 1f */
+	"JR NZ,dd",	/* 20 */
+	"LD HL,nnnn",	/* 21 */
+	"LD (nnnn),HL",	/* 22 */
+	"INC HL",	/* 23 */
+	"INC H",	/* 24 */
+	"DEC H",	/* 25 */
+	"LD H,nn",	/* 26 */
+	"DAA",	/* 27 */
+	"JR Z,dd",	/* 28 */
+	"ADD HL,HL",	/* 29 */
+	"LD HL,(nnnn)",	/* 2a */
+	"DEC HL",	/* 2b */
+	"INC L",	/* 2c */
+	"DEC L",	/* 2d */
+	"LD L,nn",	/* 2e */
+	"CPL",	/* 2f */
+	"JR NC,dd",	/* 30 */
+	"LD SP,nnnn",	/* 31 */
+	"LD (nnnn),A",	/* 32 */
+	"INC SP",	/* 33 */
+	"INC (HL)",	/* 34 */
+	"DEC (HL)",	/* 35 */
+	"LD (HL),nn",	/* 36 */
+	"SCF",	/* 37 */
+	"JR C,dd",	/* 38 */
+	"ADD HL,SP",	/* 39 */
+	"LD A,(nnnn)",	/* 3a */
+	"DEC SP",	/* 3b */
+	"INC A",	/* 3c */
+	"DEC A",	/* 3d */
+	"LD A,nn",	/* 3e */
+	"CCF",	/* 3f */
+	"LD B,B",	/* 40 */
+	"LD B,C",	/* 41 */
+	"LD B,D",	/* 42 */
+	"LD B,E",	/* 43 */
+	"LD B,H",	/* 44 */
+	"LD B,L",	/* 45 */
+	"LD B,(HL)",	/* 46 */
+	"LD B,A",	/* 47 */
+	"LD C,B",	/* 48 */
+	"LD C,C",	/* 49 */
+	"LD C,D",	/* 4a */
+	"LD C,E",	/* 4b */
+	"LD C,H",	/* 4c */
+	"LD C,L",	/* 4d */
+	"LD C,(HL)",	/* 4e */
+	"LD C,A",	/* 4f */
+	"LD D,B",	/* 50 */
+	"LD D,C",	/* 51 */
+	"LD D,D",	/* 52 */
+	"LD D,E",	/* 53 */
+	"LD D,H",	/* 54 */
+	"LD D,L",	/* 55 */
+	"LD D,(HL)",	/* 56 */
+	"LD D,A",	/* 57 */
+	"LD E,B",	/* 58 */
+	"LD E,C",	/* 59 */
+	"LD E,D",	/* 5a */
+	"LD E,E",	/* 5b */
+	"LD E,H",	/* 5c */
+	"LD E,L",	/* 5d */
+	"LD E,(HL)",	/* 5e */
+	"LD E,A",	/* 5f */
+	"LD H,B",	/* 60 */
+	"LD H,C",	/* 61 */
+	"LD H,D",	/* 62 */
+	"LD H,E",	/* 63 */
+	"LD H,H",	/* 64 */
+	"LD H,L",	/* 65 */
+	"LD H,(HL)",	/* 66 */
+	"LD H,A",	/* 67 */
+	"LD L,B",	/* 68 */
+	"LD L,C",	/* 69 */
+	"LD L,D",	/* 6a */
+	"LD L,E",	/* 6b */
+	"LD L,H",	/* 6c */
+	"LD L,L",	/* 6d */
+	"LD L,(HL)",	/* 6e */
+	"LD L,A",	/* 6f */
+	"LD (HL),B",	/* 70 */
+	"LD (HL),C",	/* 71 */
+	"LD (HL),D",	/* 72 */
+	"LD (HL),E",	/* 73 */
+	"LD (HL),H",	/* 74 */
+	"LD (HL),L",	/* 75 */
+	"HALT",	/* 76 */
+	"LD (HL),A",	/* 77 */
+	"LD A,B",	/* 78 */
+	"LD A,C",	/* 79 */
+	"LD A,D",	/* 7a */
+	"LD A,E",	/* 7b */
+	"LD A,H",	/* 7c */
+	"LD A,L",	/* 7d */
+	"LD A,(HL)",	/* 7e */
+	"LD A,A",	/* 7f */
+	"ADD A,B",	/* 80 */
+	"ADD A,C",	/* 81 */
+	"ADD A,D",	/* 82 */
+	"ADD A,E",	/* 83 */
+	"ADD A,H",	/* 84 */
+	"ADD A,L",	/* 85 */
+	"ADD A,(HL)",	/* 86 */
+	"ADD A,A",	/* 87 */
+	"ADC A,B",	/* 88 */
+	"ADC A,C",	/* 89 */
+	"ADC A,D",	/* 8a */
+	"ADC A,E",	/* 8b */
+	"ADC A,H",	/* 8c */
+	"ADC A,L",	/* 8d */
+	"ADC A,(HL)",	/* 8e */
+	"ADC A,A",	/* 8f */
+	"SUB B",	/* 90 */
+	"SUB C",	/* 91 */
+	"SUB D",	/* 92 */
+	"SUB E",	/* 93 */
+	"SUB H",	/* 94 */
+	"SUB L",	/* 95 */
+	"SUB (HL)",	/* 96 */
+	"SUB A",	/* 97 */
+	"SBC A,B",	/* 98 */
+	"SBC A,C",	/* 99 */
+	"SBC A,D",	/* 9a */
+	"SBC A,E",	/* 9b */
+	"SBC A,H",	/* 9c */
+	"SBC A,L",	/* 9d */
+	"SBC A,(HL)",	/* 9e */
+	"SBC A,A",	/* 9f */
+	"AND B",	/* a0 */
+	"AND C",	/* a1 */
+	"AND D",	/* a2 */
+	"AND E",	/* a3 */
+	"AND H",	/* a4 */
+	"AND L",	/* a5 */
+	"AND (HL)",	/* a6 */
+	"AND A",	/* a7 */
+	"XOR B",	/* a8 */
+	"XOR C",	/* a9 */
+	"XOR D",	/* aa */
+	"XOR E",	/* ab */
+	"XOR H",	/* ac */
+	"XOR L",	/* ad */
+	"XOR (HL)",	/* ae */
+	"XOR A",	/* af */
+	"OR B",	/* b0 */
+	"OR C",	/* b1 */
+	"OR D",	/* b2 */
+	"OR E",	/* b3 */
+	"OR H",	/* b4 */
+	"OR L",	/* b5 */
+	"OR (HL)",	/* b6 */
+	"OR A",	/* b7 */
+	"CP B",	/* b8 */
+	"CP C",	/* b9 */
+	"CP D",	/* ba */
+	"CP E",	/* bb */
+	"CP H",	/* bc */
+	"CP L",	/* bd */
+	"CP (HL)",	/* be */
+	"CP A",	/* bf */
+	"RET NZ",	/* c0 */
+	"POP BC",	/* c1 */
+	"JP NZ,nnnn",	/* c2 */
+	"JP nnnn",	/* c3 */
+	"CALL NZ,nnnn",	/* c4 */
+	"PUSH BC",	/* c5 */
+	"ADD A,nn",	/* c6 */
+	"RST 0",	/* c7 */
+	"RET Z",	/* c8 */
+	"RET",	/* c9 */
+	"JP Z,nnnn",	/* ca */
+	NULL,	/* cb */
+	"CALL Z,nnnn",	/* cc */
+	"CALL nnnn",	/* cd */
+	"ADC A,nn",	/* ce */
+	"RST 8",	/* cf */
+	"RET NC",	/* d0 */
+	"POP DE",	/* d1 */
+	"JP NC,nnnn",	/* d2 */
+	"OUT (nn),A",	/* d3 */
+	"CALL NC,nnnn",	/* d4 */
+	"PUSH DE",	/* d5 */
+	"SUB nn",	/* d6 */
+	"RST 10H",	/* d7 */
+	"RET C",	/* d8 */
+	"EXX",	/* d9 */
+	"JP C,nnnn",	/* da */
+	"IN A,(nn)",	/* db */
+	"CALL C,nnnn",	/* dc */
+	NULL,	/* dd */
+	"SBC A,nn",	/* de */
+	"RST 18H",	/* df */
+	"RET PO",	/* e0 */
+	"POP HL",	/* e1 */
+	"JP PO,nnnn",	/* e2 */
+	"EX (SP),HL",	/* e3 */
+	"CALL PO,nnnn",	/* e4 */
+	"PUSH HL",	/* e5 */
+	"AND nn",	/* e6 */
+	"RST 20H",	/* e7 */
+	"RET PE",	/* e8 */
+	"JP (HL)",	/* e9 */
+	"JP PE,nnnn",	/* ea */
+	"EX DE,HL",	/* eb */
+	"CALL PE,nnnn",	/* ec */
+	NULL,	/* ed */
+	"XOR nn",	/* ee */
+	"RST 28H",	/* ef */
+	"RET P",	/* f0 */
+	"POP AF",	/* f1 */
+	"JP P,nnnn",	/* f2 */
+	"DI",	/* f3 */
+	"CALL P,nnnn",	/* f4 */
+	"PUSH AF",	/* f5 */
+	"OR nn",	/* f6 */
+	"RST 30H",	/* f7 */
+	"RET M",	/* f8 */
+	"LD SP,HL",	/* f9 */
+	"JP M,nnnn",	/* fa */
+	"EI",	/* fb */
+	"CALL M,nnnn",	/* fc */
+	NULL,	/* fd */
+	"CP nn",	/* fe */
+	"RST 38H",	/* ff */
+};
+const char *const z80_mn_cb[256] = {
+	"RLC B",	/* 00 */
+	"RLC C",	/* 01 */
+	"RLC D",	/* 02 */
+	"RLC E",	/* 03 */
+	"RLC H",	/* 04 */
+	"RLC L",	/* 05 */
+	"RLC (HL)",	/* 06 */
+	"RLC A",	/* 07 */
+	"RRC B",	/* 08 */
+	"RRC C",	/* 09 */
+	"RRC D",	/* 0a */
+	"RRC E",	/* 0b */
+	"RRC H",	/* 0c */
+	"RRC L",	/* 0d */
+	"RRC (HL)",	/* 0e */
+	"RRC A",	/* 0f */
+	"RL B",	/* 10 */
+	"RL C",	/* 11 */
+	"RL D",	/* 12 */
+	"RL E",	/* 13 */
+	"RL H",	/* 14 */
+	"RL L",	/* 15 */
+	"RL (HL)",	/* 16 */
+	"RL A",	/* 17 */
+	"RR B",	/* 18 */
+	"RR C",	/* 19 */
+	"RR D",	/* 1a */
+	"RR E",	/* 1b */
+	"RR H",	/* 1c */
+	"RR L",	/* 1d */
+	"RR (HL)",	/* 1e */
+	"RR A",	/* 1f */
+	"SLA B",	/* 20 */
+	"SLA C",	/* 21 */
+	"SLA D",	/* 22 */
+	"SLA E",	/* 23 */
+	"SLA H",	/* 24 */
+	"SLA L",	/* 25 */
+	"SLA (HL)",	/* 26 */
+	"SLA A",	/* 27 */
+	"SRA B",	/* 28 */
+	"SRA C",	/* 29 */
+	"SRA D",	/* 2a */
+	"SRA E",	/* 2b */
+	"SRA H",	/* 2c */
+	"SRA L",	/* 2d */
+	"SRA (HL)",	/* 2e */
+	"SRA A",	/* 2f */
+	"SLIA B",	/* 30 */
+	"SLIA C",	/* 31 */
+	"SLIA D",	/* 32 */
+	"SLIA E",	/* 33 */
+	"SLIA H",	/* 34 */
+	"SLIA L",	/* 35 */
+	"SLIA (HL)",	/* 36 */
+	"SLIA A",	/* 37 */
+	"SRL B",	/* 38 */
+	"SRL C",	/* 39 */
+	"SRL D",	/* 3a */
+	"SRL E",	/* 3b */
+	"SRL H",	/* 3c */
+	"SRL L",	/* 3d */
+	"SRL (HL)",	/* 3e */
+	"SRL A",	/* 3f */
+	"BIT 0,B",	/* 40 */
+	"BIT 0,C",	/* 41 */
+	"BIT 0,D",	/* 42 */
+	"BIT 0,E",	/* 43 */
+	"BIT 0,H",	/* 44 */
+	"BIT 0,L",	/* 45 */
+	"BIT 0,(HL)",	/* 46 */
+	"BIT 0,A",	/* 47 */
+	"BIT 1,B",	/* 48 */
+	"BIT 1,C",	/* 49 */
+	"BIT 1,D",	/* 4a */
+	"BIT 1,E",	/* 4b */
+	"BIT 1,H",	/* 4c */
+	"BIT 1,L",	/* 4d */
+	"BIT 1,(HL)",	/* 4e */
+	"BIT 1,A",	/* 4f */
+	"BIT 2,B",	/* 50 */
+	"BIT 2,C",	/* 51 */
+	"BIT 2,D",	/* 52 */
+	"BIT 2,E",	/* 53 */
+	"BIT 2,H",	/* 54 */
+	"BIT 2,L",	/* 55 */
+	"BIT 2,(HL)",	/* 56 */
+	"BIT 2,A",	/* 57 */
+	"BIT 3,B",	/* 58 */
+	"BIT 3,C",	/* 59 */
+	"BIT 3,D",	/* 5a */
+	"BIT 3,E",	/* 5b */
+	"BIT 3,H",	/* 5c */
+	"BIT 3,L",	/* 5d */
+	"BIT 3,(HL)",	/* 5e */
+	"BIT 3,A",	/* 5f */
+	"BIT 4,B",	/* 60 */
+	"BIT 4,C",	/* 61 */
+	"BIT 4,D",	/* 62 */
+	"BIT 4,E",	/* 63 */
+	"BIT 4,H",	/* 64 */
+	"BIT 4,L",	/* 65 */
+	"BIT 4,(HL)",	/* 66 */
+	"BIT 4,A",	/* 67 */
+	"BIT 5,B",	/* 68 */
+	"BIT 5,C",	/* 69 */
+	"BIT 5,D",	/* 6a */
+	"BIT 5,E",	/* 6b */
+	"BIT 5,H",	/* 6c */
+	"BIT 5,L",	/* 6d */
+	"BIT 5,(HL)",	/* 6e */
+	"BIT 5,A",	/* 6f */
+	"BIT 6,B",	/* 70 */
+	"BIT 6,C",	/* 71 */
+	"BIT 6,D",	/* 72 */
+	"BIT 6,E",	/* 73 */
+	"BIT 6,H",	/* 74 */
+	"BIT 6,L",	/* 75 */
+	"BIT 6,(HL)",	/* 76 */
+	"BIT 6,A",	/* 77 */
+	"BIT 7,B",	/* 78 */
+	"BIT 7,C",	/* 79 */
+	"BIT 7,D",	/* 7a */
+	"BIT 7,E",	/* 7b */
+	"BIT 7,H",	/* 7c */
+	"BIT 7,L",	/* 7d */
+	"BIT 7,(HL)",	/* 7e */
+	"BIT 7,A",	/* 7f */
+	"RES 0,B",	/* 80 */
+	"RES 0,C",	/* 81 */
+	"RES 0,D",	/* 82 */
+	"RES 0,E",	/* 83 */
+	"RES 0,H",	/* 84 */
+	"RES 0,L",	/* 85 */
+	"RES 0,(HL)",	/* 86 */
+	"RES 0,A",	/* 87 */
+	"RES 1,B",	/* 88 */
+	"RES 1,C",	/* 89 */
+	"RES 1,D",	/* 8a */
+	"RES 1,E",	/* 8b */
+	"RES 1,H",	/* 8c */
+	"RES 1,L",	/* 8d */
+	"RES 1,(HL)",	/* 8e */
+	"RES 1,A",	/* 8f */
+	"RES 2,B",	/* 90 */
+	"RES 2,C",	/* 91 */
+	"RES 2,D",	/* 92 */
+	"RES 2,E",	/* 93 */
+	"RES 2,H",	/* 94 */
+	"RES 2,L",	/* 95 */
+	"RES 2,(HL)",	/* 96 */
+	"RES 2,A",	/* 97 */
+	"RES 3,B",	/* 98 */
+	"RES 3,C",	/* 99 */
+	"RES 3,D",	/* 9a */
+	"RES 3,E",	/* 9b */
+	"RES 3,H",	/* 9c */
+	"RES 3,L",	/* 9d */
+	"RES 3,(HL)",	/* 9e */
+	"RES 3,A",	/* 9f */
+	"RES 4,B",	/* a0 */
+	"RES 4,C",	/* a1 */
+	"RES 4,D",	/* a2 */
+	"RES 4,E",	/* a3 */
+	"RES 4,H",	/* a4 */
+	"RES 4,L",	/* a5 */
+	"RES 4,(HL)",	/* a6 */
+	"RES 4,A",	/* a7 */
+	"RES 5,B",	/* a8 */
+	"RES 5,C",	/* a9 */
+	"RES 5,D",	/* aa */
+	"RES 5,E",	/* ab */
+	"RES 5,H",	/* ac */
+	"RES 5,L",	/* ad */
+	"RES 5,(HL)",	/* ae */
+	"RES 5,A",	/* af */
+	"RES 6,B",	/* b0 */
+	"RES 6,C",	/* b1 */
+	"RES 6,D",	/* b2 */
+	"RES 6,E",	/* b3 */
+	"RES 6,H",	/* b4 */
+	"RES 6,L",	/* b5 */
+	"RES 6,(HL)",	/* b6 */
+	"RES 6,A",	/* b7 */
+	"RES 7,B",	/* b8 */
+	"RES 7,C",	/* b9 */
+	"RES 7,D",	/* ba */
+	"RES 7,E",	/* bb */
+	"RES 7,H",	/* bc */
+	"RES 7,L",	/* bd */
+	"RES 7,(HL)",	/* be */
+	"RES 7,A",	/* bf */
+	"SET 0,B",	/* c0 */
+	"SET 0,C",	/* c1 */
+	"SET 0,D",	/* c2 */
+	"SET 0,E",	/* c3 */
+	"SET 0,H",	/* c4 */
+	"SET 0,L",	/* c5 */
+	"SET 0,(HL)",	/* c6 */
+	"SET 0,A",	/* c7 */
+	"SET 1,B",	/* c8 */
+	"SET 1,C",	/* c9 */
+	"SET 1,D",	/* ca */
+	"SET 1,E",	/* cb */
+	"SET 1,H",	/* cc */
+	"SET 1,L",	/* cd */
+	"SET 1,(HL)",	/* ce */
+	"SET 1,A",	/* cf */
+	"SET 2,B",	/* d0 */
+	"SET 2,C",	/* d1 */
+	"SET 2,D",	/* d2 */
+	"SET 2,E",	/* d3 */
+	"SET 2,H",	/* d4 */
+	"SET 2,L",	/* d5 */
+	"SET 2,(HL)",	/* d6 */
+	"SET 2,A",	/* d7 */
+	"SET 3,B",	/* d8 */
+	"SET 3,C",	/* d9 */
+	"SET 3,D",	/* da */
+	"SET 3,E",	/* db */
+	"SET 3,H",	/* dc */
+	"SET 3,L",	/* dd */
+	"SET 3,(HL)",	/* de */
+	"SET 3,A",	/* df */
+	"SET 4,B",	/* e0 */
+	"SET 4,C",	/* e1 */
+	"SET 4,D",	/* e2 */
+	"SET 4,E",	/* e3 */
+	"SET 4,H",	/* e4 */
+	"SET 4,L",	/* e5 */
+	"SET 4,(HL)",	/* e6 */
+	"SET 4,A",	/* e7 */
+	"SET 5,B",	/* e8 */
+	"SET 5,C",	/* e9 */
+	"SET 5,D",	/* ea */
+	"SET 5,E",	/* eb */
+	"SET 5,H",	/* ec */
+	"SET 5,L",	/* ed */
+	"SET 5,(HL)",	/* ee */
+	"SET 5,A",	/* ef */
+	"SET 6,B",	/* f0 */
+	"SET 6,C",	/* f1 */
+	"SET 6,D",	/* f2 */
+	"SET 6,E",	/* f3 */
+	"SET 6,H",	/* f4 */
+	"SET 6,L",	/* f5 */
+	"SET 6,(HL)",	/* f6 */
+	"SET 6,A",	/* f7 */
+	"SET 7,B",	/* f8 */
+	"SET 7,C",	/* f9 */
+	"SET 7,D",	/* fa */
+	"SET 7,E",	/* fb */
+	"SET 7,H",	/* fc */
+	"SET 7,L",	/* fd */
+	"SET 7,(HL)",	/* fe */
+	"SET 7,A",	/* ff */
+};
+const char *const z80_mn_ed[256] = {
+	NULL,	/* 00 */
+	NULL,	/* 01 */
+	NULL,	/* 02 */
+	NULL,	/* 03 */
+	NULL,	/* 04 */
+	NULL,	/* 05 */
+	NULL,	/* 06 */
+	NULL,	/* 07 */
+	NULL,	/* 08 */
+	NULL,	/* 09 */
+	NULL,	/* 0a */
+	NULL,	/* 0b */
+	NULL,	/* 0c */
+	NULL,	/* 0d */
+	NULL,	/* 0e */
+	NULL,	/* 0f */
+	NULL,	/* 10 */
+	NULL,	/* 11 */
+	NULL,	/* 12 */
+	NULL,	/* 13 */
+	NULL,	/* 14 */
+	NULL,	/* 15 */
+	NULL,	/* 16 */
+	NULL,	/* 17 */
+	NULL,	/* 18 */
+	NULL,	/* 19 */
+	NULL,	/* 1a */
+	NULL,	/* 1b */
+	NULL,	/* 1c */
+	NULL,	/* 1d */
+	NULL,	/* 1e */
+	NULL,	/* 1f */
+	NULL,	/* 20 */
+	NULL,	/* 21 */
+	NULL,	/* 22 */
+	NULL,	/* 23 */
+	NULL,	/* 24 */
+	NULL,	/* 25 */
+	NULL,	/* 26 */
+	NULL,	/* 27 */
+	NULL,	/* 28 */
+	NULL,	/* 29 */
+	NULL,	/* 2a */
+	NULL,	/* 2b */
+	NULL,	/* 2c */
+	NULL,	/* 2d */
+	NULL,	/* 2e */
+	NULL,	/* 2f */
+	NULL,	/* 30 */
+	NULL,	/* 31 */
+	NULL,	/* 32 */
+	NULL,	/* 33 */
+	NULL,	/* 34 */
+	NULL,	/* 35 */
+	NULL,	/* 36 */
+	NULL,	/* 37 */
+	NULL,	/* 38 */
+	NULL,	/* 39 */
+	NULL,	/* 3a */
+	NULL,	/* 3b */
+	NULL,	/* 3c */
+	NULL,	/* 3d */
+	NULL,	/* 3e */
+	NULL,	/* 3f */
+	"IN B,(C)",	/* 40 */
+	"OUT (C),B",	/* 41 */
+	"SBC HL,BC",	/* 42 */
+	"LD (nnnn),BC",	/* 43 */
+	"NEG",	/* 44 */
+	"RETN",	/* 45 */
+	"IM 0",	/* 46 */
+	"LD I,A",	/* 47 */
+	"IN C,(C)",	/* 48 */
+	"OUT (C),C",	/* 49 */
+	"ADC HL,BC",	/* 4a */
+	"LD BC,(nnnn)",	/* 4b */
+	NULL,	/* 4c */
+	"RETI",	/* 4d */
+	NULL,	/* 4e */
+	"LD R,A",	/* 4f */
+	"IN D,(C)",	/* 50 */
+	"OUT (C),D",	/* 51 */
+	"SBC HL,DE",	/* 52 */
+	"LD (nnnn),DE",	/* 53 */
+	NULL,	/* 54 */
+	NULL,	/* 55 */
+	"IM 1",	/* 56 */
+	"LD A,I",	/* 57 */
+	"IN E,(C)",	/* 58 */
+	"OUT (C),E",	/* 59 */
+	"ADC HL,DE",	/* 5a */
+	"LD DE,(nnnn)",	/* 5b */
+	NULL,	/* 5c */
+	NULL,	/* 5d */
+	"IM 2",	/* 5e */
+	"LD A,R",	/* 5f */
+	"IN H,(C)",	/* 60 */
+	"OUT (C),H",	/* 61 */
+	"SBC HL,HL",	/* 62 */
+	"LD (nnnn),HL",	/* 63 */
+	NULL,	/* 64 */
+	NULL,	/* 65 */
+	NULL,	/* 66 */
+	"RRD",	/* 67 */
+	"IN L,(C)",	/* 68 */
+	"OUT (C),L",	/* 69 */
+	"ADC HL,HL",	/* 6a */
+	"LD HL,(nnnn)",	/* 6b */
+	NULL,	/* 6c */
+	NULL,	/* 6d */
+	NULL,	/* 6e */
+	"RLD",	/* 6f */
+	"IN (C)",	/* 70 */
+	"OUT (C),0",	/* 71 */
+	"SBC HL,SP",	/* 72 */
+	"LD (nnnn),SP",	/* 73 */
+	NULL,	/* 74 */
+	NULL,	/* 75 */
+	NULL,	/* 76 */
+	NULL,	/* 77 */
+	"IN A,(C)",	/* 78 */
+	"OUT (C),A",	/* 79 */
+	"ADC HL,SP",	/* 7a */
+	"LD SP,(nnnn)",	/* 7b */
+	NULL,	/* 7c */
+	NULL,	/* 7d */
+	NULL,	/* 7e */
+	NULL,	/* 7f */
+	NULL,	/* 80 */
+	NULL,	/* 81 */
+	NULL,	/* 82 */
+	NULL,	/* 83 */
+	NULL,	/* 84 */
+	NULL,	/* 85 */
+	NULL,	/* 86 */
+	NULL,	/* 87 */
+	NULL,	/* 88 */
+	NULL,	/* 89 */
+	NULL,	/* 8a */
+	NULL,	/* 8b */
+	NULL,	/* 8c */
+	NULL,	/* 8d */
+	NULL,	/* 8e */
+	NULL,	/* 8f */
+	NULL,	/* 90 */
+	NULL,	/* 91 */
+	NULL,	/* 92 */
+	NULL,	/* 93 */
+	NULL,	/* 94 */
+	NULL,	/* 95 */
+	NULL,	/* 96 */
+	NULL,	/* 97 */
+	NULL,	/* 98 */
+	NULL,	/* 99 */
+	NULL,	/* 9a */
+	NULL,	/* 9b */
+	NULL,	/* 9c */
+	NULL,	/* 9d */
+	NULL,	/* 9e */
+	NULL,	/* 9f */
+	"LDI",	/* a0 */
+	"CPI",	/* a1 */
+	"INI",	/* a2 */
+	"OUTI",	/* a3 */
+	NULL,	/* a4 */
+	NULL,	/* a5 */
+	NULL,	/* a6 */
+	NULL,	/* a7 */
+	"LDD",	/* a8 */
+	"CPD",	/* a9 */
+	"IND",	/* aa */
+	"OUTD",	/* ab */
+	NULL,	/* ac */
+	NULL,	/* ad */
+	NULL,	/* ae */
+	NULL,	/* af */
+	"LDIR",	/* b0 */
+	"CPIR",	/* b1 */
+	"INIR",	/* b2 */
+	"OTIR",	/* b3 */
+	NULL,	/* b4 */
+	NULL,	/* b5 */
+	NULL,	/* b6 */
+	NULL,	/* b7 */
+	"LDDR",	/* b8 */
+	"CPDR",	/* b9 */
+	"INDR",	/* ba */
+	"OTDR",	/* bb */
+	NULL,	/* bc */
+	NULL,	/* bd */
+	NULL,	/* be */
+	NULL,	/* bf */
+	NULL,	/* c0 */
+	NULL,	/* c1 */
+	NULL,	/* c2 */
+	NULL,	/* c3 */
+	NULL,	/* c4 */
+	NULL,	/* c5 */
+	NULL,	/* c6 */
+	NULL,	/* c7 */
+	NULL,	/* c8 */
+	NULL,	/* c9 */
+	NULL,	/* ca */
+	NULL,	/* cb */
+	NULL,	/* cc */
+	NULL,	/* cd */
+	NULL,	/* ce */
+	NULL,	/* cf */
+	NULL,	/* d0 */
+	NULL,	/* d1 */
+	NULL,	/* d2 */
+	NULL,	/* d3 */
+	NULL,	/* d4 */
+	NULL,	/* d5 */
+	NULL,	/* d6 */
+	NULL,	/* d7 */
+	NULL,	/* d8 */
+	NULL,	/* d9 */
+	NULL,	/* da */
+	NULL,	/* db */
+	NULL,	/* dc */
+	NULL,	/* dd */
+	NULL,	/* de */
+	NULL,	/* df */
+	NULL,	/* e0 */
+	NULL,	/* e1 */
+	NULL,	/* e2 */
+	NULL,	/* e3 */
+	NULL,	/* e4 */
+	NULL,	/* e5 */
+	NULL,	/* e6 */
+	NULL,	/* e7 */
+	NULL,	/* e8 */
+	NULL,	/* e9 */
+	NULL,	/* ea */
+	NULL,	/* eb */
+	NULL,	/* ec */
+	NULL,	/* ed */
+	NULL,	/* ee */
+	NULL,	/* ef */
+	NULL,	/* f0 */
+	NULL,	/* f1 */
+	NULL,	/* f2 */
+	NULL,	/* f3 */
+	NULL,	/* f4 */
+	NULL,	/* f5 */
+	NULL,	/* f6 */
+	NULL,	/* f7 */
+	NULL,	/* f8 */
+	NULL,	/* f9 */
+	NULL,	/* fa */
+	NULL,	/* fb */
+	NULL,	/* fc */
+	NULL,	/* fd */
+	NULL,	/* fe */
+	NULL,	/* ff */
+};
+const char *const z80_mn_xy[256] = {
+	NULL,	/* 00 */
+	NULL,	/* 01 */
+	NULL,	/* 02 */
+	NULL,	/* 03 */
+	NULL,	/* 04 */
+	NULL,	/* 05 */
+	NULL,	/* 06 */
+	NULL,	/* 07 */
+	NULL,	/* 08 */
+	"ADD XY,BC",	/* 09 */
+	NULL,	/* 0a */
+	NULL,	/* 0b */
+	NULL,	/* 0c */
+	NULL,	/* 0d */
+	NULL,	/* 0e */
+	NULL,	/* 0f */
+	NULL,	/* 10 */
+	NULL,	/* 11 */
+	NULL,	/* 12 */
+	NULL,	/* 13 */
+	NULL,	/* 14 */
+	NULL,	/* 15 */
+	NULL,	/* 16 */
+	NULL,	/* 17 */
+	NULL,	/* 18 */
+	"ADD XY,DE",	/* 19 */
+	NULL,	/* 1a */
+	NULL,	/* 1b */
+	NULL,	/* 1c */
+	NULL,	/* 1d */
+	NULL,	/* 1e */
+	NULL,	/* 1f */
+	NULL,	/* 20 */
+	"LD XY,nnnn",	/* 21 */
+	"LD (nnnn),XY",	/* 22 */
+	"INC XY",	/* 23 */
+	"INC XYH",	/* 24 */
+	"DEC XYH",	/* 25 */
+	"LD XYH,nn",	/* 26 */
+	NULL,	/* 27 */
+	NULL,	/* 28 */
+	"ADD XY,XY",	/* 29 */
+	"LD XY,(nnnn)",	/* 2a */
+	"DEC XY",	/* 2b */
+	"INC XYL",	/* 2c */
+	"DEC XYL",	/* 2d */
+	"LD XYL,nn",	/* 2e */
+	NULL,	/* 2f */
+	NULL,	/* 30 */
+	NULL,	/* 31 */
+	NULL,	/* 32 */
+	NULL,	/* 33 */
+	"INC (XY+dd)",	/* 34 */
+	"DEC (XY+dd)",	/* 35 */
+	"LD (XY+dd),nn",	/* 36 */
+	NULL,	/* 37 */
+	NULL,	/* 38 */
+	"ADD XY,SP",	/* 39 */
+	NULL,	/* 3a */
+	NULL,	/* 3b */
+	NULL,	/* 3c */
+	NULL,	/* 3d */
+	NULL,	/* 3e */
+	NULL,	/* 3f */
+	NULL,	/* 40 */
+	NULL,	/* 41 */
+	NULL,	/* 42 */
+	NULL,	/* 43 */
+	"LD B,XYH",	/* 44 */
+	"LD B,XYL",	/* 45 */
+	"LD B,(XY+dd)",	/* 46 */
+	NULL,	/* 47 */
+	NULL,	/* 48 */
+	NULL,	/* 49 */
+	NULL,	/* 4a */
+	NULL,	/* 4b */
+	"LD C,XYH",	/* 4c */
+	"LD C,XYL",	/* 4d */
+	"LD C,(XY+dd)",	/* 4e */
+	NULL,	/* 4f */
+	NULL,	/* 50 */
+	NULL,	/* 51 */
+	NULL,	/* 52 */
+	NULL,	/* 53 */
+	"LD D,XYH",	/* 54 */
+	"LD D,XYL",	/* 55 */
+	"LD D,(XY+dd)",	/* 56 */
+	NULL,	/* 57 */
+	NULL,	/* 58 */
+	NULL,	/* 59 */
+	NULL,	/* 5a */
+	NULL,	/* 5b */
+	"LD E,XYH",	/* 5c */
+	"LD E,XYL",	/* 5d */
+	"LD E,(XY+dd)",	/* 5e */
+	NULL,	/* 5f */
+	"LD XYH,B",	/* 60 */
+	"LD XYH,C",	/* 61 */
+	"LD XYH,D",	/* 62 */
+	"LD XYH,E",	/* 63 */
+	"LD XYH,XYH",	/* 64 */
+	"LD XYH,XYL",	/* 65 */
+	"LD H,(XY+dd)",	/* 66 */
+	"LD XYH,A",	/* 67 */
+	"LD XYL,B",	/* 68 */
+	"LD XYL,C",	/* 69 */
+	"LD XYL,D",	/* 6a */
+	"LD XYL,E",	/* 6b */
+	"LD XYL,XYH",	/* 6c */
+	"LD XYL,XYL",	/* 6d */
+	"LD L,(XY+dd)",	/* 6e */
+	"LD XYL,A",	/* 6f */
+	"LD (XY+dd),B",	/* 70 */
+	"LD (XY+dd),C",	/* 71 */
+	"LD (XY+dd),D",	/* 72 */
+	"LD (XY+dd),E",	/* 73 */
+	"LD (XY+dd),H",	/* 74 */
+	"LD (XY+dd),L",	/* 75 */
+	NULL,	/* 76 */
+	"LD (XY+dd),A",	/* 77 */
+	NULL,	/* 78 */
+	NULL,	/* 79 */
+	NULL,	/* 7a */
+	NULL,	/* 7b */
+	"LD A,XYH",	/* 7c */
+	"LD A,XYL",	/* 7d */
+	"LD A,(XY+dd)",	/* 7e */
+	NULL,	/* 7f */
+	NULL,	/* 80 */
+	NULL,	/* 81 */
+	NULL,	/* 82 */
+	NULL,	/* 83 */
+	"ADD A,XYH",	/* 84 */
+	"ADD A,XYL",	/* 85 */
+	"ADD A,(XY+dd)",	/* 86 */
+	NULL,	/* 87 */
+	NULL,	/* 88 */
+	NULL,	/* 89 */
+	NULL,	/* 8a */
+	NULL,	/* 8b */
+	"ADC A,XYH",	/* 8c */
+	"ADC A,XYL",	/* 8d */
+	"ADC A,(XY+dd)",	/* 8e */
+	NULL,	/* 8f */
+	NULL,	/* 90 */
+	NULL,	/* 91 */
+	NULL,	/* 92 */
+	NULL,	/* 93 */
+	"SUB XYH",	/* 94 */
+	"SUB XYL",	/* 95 */
+	"SUB (XY+dd)",	/* 96 */
+	NULL,	/* 97 */
+	NULL,	/* 98 */
+	NULL,	/* 99 */
+	NULL,	/* 9a */
+	NULL,	/* 9b */
+	"SBC A,XYH",	/* 9c */
+	"SBC A,XYL",	/* 9d */
+	"SBC A,(XY+dd)",	/* 9e */
+	NULL,	/* 9f */
+	NULL,	/* a0 */
+	NULL,	/* a1 */
+	NULL,	/* a2 */
+	NULL,	/* a3 */
+	"AND XYH",	/* a4 */
+	"AND XYL",	/* a5 */
+	"AND (XY+dd)",	/* a6 */
+	NULL,	/* a7 */
+	NULL,	/* a8 */
+	NULL,	/* a9 */
+	NULL,	/* aa */
+	NULL,	/* ab */
+	"XOR XYH",	/* ac */
+	"XOR XYL",	/* ad */
+	"XOR (XY+dd)",	/* ae */
+	NULL,	/* af */
+	NULL,	/* b0 */
+	NULL,	/* b1 */
+	NULL,	/* b2 */
+	NULL,	/* b3 */
+	"OR XYH",	/* b4 */
+	"OR XYL",	/* b5 */
+	"OR (XY+dd)",	/* b6 */
+	NULL,	/* b7 */
+	NULL,	/* b8 */
+	NULL,	/* b9 */
+	NULL,	/* ba */
+	NULL,	/* bb */
+	"CP XYH",	/* bc */
+	"CP XYL",	/* bd */
+	"CP (XY+dd)",	/* be */
+	NULL,	/* bf */
+	NULL,	/* c0 */
+	NULL,	/* c1 */
+	NULL,	/* c2 */
+	NULL,	/* c3 */
+	NULL,	/* c4 */
+	NULL,	/* c5 */
+	NULL,	/* c6 */
+	NULL,	/* c7 */
+	NULL,	/* c8 */
+	NULL,	/* c9 */
+	NULL,	/* ca */
+	NULL,	/* cb */
+	NULL,	/* cc */
+	NULL,	/* cd */
+	NULL,	/* ce */
+	NULL,	/* cf */
+	NULL,	/* d0 */
+	NULL,	/* d1 */
+	NULL,	/* d2 */
+	NULL,	/* d3 */
+	NULL,	/* d4 */
+	NULL,	/* d5 */
+	NULL,	/* d6 */
+	NULL,	/* d7 */
+	NULL,	/* d8 */
+	NULL,	/* d9 */
+	NULL,	/* da */
+	NULL,	/* db */
+	NULL,	/* dc */
+	NULL,	/* dd */
+	NULL,	/* de */
+	NULL,	/* df */
+	NULL,	/* e0 */
+	"POP XY",	/* e1 */
+	NULL,	/* e2 */
+	"EX (SP),XY",	/* e3 */
+	NULL,	/* e4 */
+	"PUSH XY",	/* e5 */
+	NULL,	/* e6 */
+	NULL,	/* e7 */
+	NULL,	/* e8 */
+	"JP (XY)",	/* e9 */
+	NULL,	/* ea */
+	NULL,	/* eb */
+	NULL,	/* ec */
+	NULL,	/* ed */
+	NULL,	/* ee */
+	NULL,	/* ef */
+	NULL,	/* f0 */
+	NULL,	/* f1 */
+	NULL,	/* f2 */
+	NULL,	/* f3 */
+	NULL,	/* f4 */
+	NULL,	/* f5 */
+	NULL,	/* f6 */
+	NULL,	/* f7 */
+	NULL,	/* f8 */
+	"LD SP,XY",	/* f9 */
+	NULL,	/* fa */
+	NULL,	/* fb */
+	NULL,	/* fc */
+	NULL,	/* fd */
+	NULL,	/* fe */
+	NULL,	/* ff */
+};
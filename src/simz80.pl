@@ -1,4 +1,5 @@
-print <<"EOT";
+# the copyright notice heads C code, the list of the variants is not
+print <<"EOT" if (!grep { $_ eq "variants" } @ARGV);
 /* Z80 instruction set simulator.
    Copyright (C) 1995  Frank D. Cringle.
 
@@ -48,36 +49,208 @@ $combine = 0;
 # Set $optab = 1 to use an array of labels instead of a switch for the
 # main op-code dispatch function.  This only works with gcc, and
 # actually produces worse code with gcc-2.6.1 on a sparc.
+# Every handler then ends with its own indirect branch to the next
+# handler, so that the branch predictor sees one branch per opcode.
+# Set $optab = 2 to generate both forms; the label array is used when
+# OPT_DISPATCH_THREADED is defined (configure --with-dispatch=threaded).
 
-$optab = 0;
+$optab = 2;
 
 # Set $xx_inline = 1 to generate inline code for the instruction prefix xx.
 # If $xx_inline is undefined or 0, prefix xx will be handled by a separate
 # function which does not have access to the local variables of the main
-# simz80() function.
+# simz80() function; the registers are then stored into the machine and
+# loaded back around every instruction with the prefix.
 
-$cb_inline = 0;
-$dfd_inline = 0;
+$cb_inline = 1;
+$dfd_inline = 1;
 $ed_inline = 1;
+
+# Pairs of op-codes which run in one handler of the block executor
+# (configure --with-fusion) are read from $fuse_list, one pair of hex
+# op-codes per line.  The counts written by "sos -B jobfile -F file"
+# make such a list; the first $fuse_max pairs which can be fused are
+# used.  Set $fuse_max = 0 to generate no fused handlers.
+
+$fuse_list = "fuse.lst";
+$fuse_max = 16;
+
+# The options above may be overridden on the command line, e.g.
+#
+#	perl simz80.pl combine=1 cb_inline=1
+#
+# "dispatch=switch" or "dispatch=threaded" fixes the dispatch instead
+# of leaving it to OPT_DISPATCH_THREADED.  "variant=name" generates the
+# variant of that name listed in $variant_list, one line of its name
+# and options each: only the interpreter, called simz80_run_name(),
+# with the tables and the helpers left to simz80.c.  "variants"
+# generates the list of them for variant.c (configure --with-variants).
+
+$variant_list = "variants.lst";
 # ****************
 
 ##### end of configuration options ####
 
+# A pair can be fused if its first op-code falls through to the second
+# one, and neither of them is prefixed or HALT.
+sub fusable {
+    local($op) = @_;
+    return 0 if ($op == 0x76 || $op == 0xcb || $op == 0xdd ||
+		 $op == 0xed || $op == 0xfd);
+    return 1;
+}
+
+sub falls_through {
+    local($op) = @_;
+    return 0 if (($op & 0xe7) == 0x20 || $op == 0x10 || $op == 0x18);
+    return 0 if (($op & 0xc0) == 0xc0 && ($op & 7) =~ /^[0247]$/);
+    return 0 if ($op == 0xc3 || $op == 0xc9 || $op == 0xcd || $op == 0xe9);
+    return 1;
+}
+
+($fuse_dir = __FILE__) =~ s|[^/]*$||;
+
+sub setopt {
+    local($o) = @_;
+    die "bad option: $o\n"
+	if ($o !~ /^(combine|optab|cb_inline|dfd_inline|ed_inline|dispatch|fuse_max)=(\w+)$/);
+    ${$1} = $2;
+    die "bad dispatch: $dispatch\n" if ($dispatch !~ /^(|switch|threaded)$/);
+    $optab = 2 if ($dispatch);
+}
+
+# the variants of $variant_list, as [name, options]
+sub variants {
+    local(@v);
+    open(VARIANTS, '<', "$fuse_dir$variant_list") ||
+	die "cannot open $variant_list: $!\n";
+    while (<VARIANTS>) {
+	next if (/^\s*(#|$)/);
+	die "$variant_list: bad line: $_" if (!/^\s*([a-z_][a-z0-9_]*)((\s+\w+=\w+)*)\s*$/i);
+	push(@v, [$1, join(' ', split(' ', $2))]);
+    }
+    close(VARIANTS);
+    return @v;
+}
+
+$variant = "";
+$dispatch = "";
+foreach $arg (@ARGV) {
+    if ($arg eq "variants") {
+	print "/* generated by simz80.pl from $variant_list */\n";
+	foreach (&variants) {
+	    print "SIMZ80_VARIANT($_->[0], \"$_->[1]\")\n";
+	}
+	exit 0;
+    }
+    elsif ($arg =~ /^variant=(\w+)$/) {
+	$variant = $1;
+	($v) = grep { $_->[0] eq $variant } &variants;
+	die "no variant $variant in $variant_list\n" if (!$v);
+	foreach (split(' ', $v->[1])) {
+	    &setopt($_);
+	}
+    }
+    else {
+	&setopt($arg);
+    }
+}
+$run = $variant ? "simz80_run_$variant" : "simz80_run";
+
+@fuse = ();
+if ($fuse_max > 0 && open(FUSE, '<', "$fuse_dir$fuse_list")) {
+    while (<FUSE>) {
+	next if (/^\s*(#|$)/);
+	die "$fuse_list: bad line: $_" if (!/^\s*([0-9a-f]{2})\s+([0-9a-f]{2})\b/i);
+	($x, $y) = (hex($1), hex($2));
+	next if (!&fusable($x) || !&falls_through($x) || !&fusable($y));
+	next if (grep { $_->[0] == $x && $_->[1] == $y } @fuse);
+	push(@fuse, [$x, $y]);
+	last if (@fuse >= $fuse_max);
+    }
+    close(FUSE);
+}
+
+# T-states of the op-codes.  Conditional branches are listed as not taken;
+# their handlers add the difference when the branch is taken, and the
+# repeating block instructions add 21 for every repetition.  The prefix
+# bytes cost nothing in @cc_op, the prefixed tables hold the time of the
+# whole instruction.  An unused DD/FD prefix costs 4 and the op-code
+# which follows it is counted by itself.
+
+@cc_op = (
+     4,10, 7, 6, 4, 4, 7, 4, 4,11, 7, 6, 4, 4, 7, 4,	# 00
+     8,10, 7, 6, 4, 4, 7, 4,12,11, 7, 6, 4, 4, 7, 4,	# 10
+     7,10,16, 6, 4, 4, 7, 4, 7,11,16, 6, 4, 4, 7, 4,	# 20
+     7,10,13, 6,11,11,10, 4, 7,11,13, 6, 4, 4, 7, 4,	# 30
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,	# 40
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,	# 50
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,	# 60
+     7, 7, 7, 7, 7, 7, 4, 7, 4, 4, 4, 4, 4, 4, 7, 4,	# 70
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,	# 80
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,	# 90
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,	# A0
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,	# B0
+     5,10,10,10,10,11, 7,11, 5,10,10, 0,10,17, 7,11,	# C0
+     5,10,10,11,10,11, 7,11, 5, 4,10,11,10, 0, 7,11,	# D0
+     5,10,10,19,10,11, 7,11, 5, 4,10, 4,10, 0, 7,11,	# E0
+     5,10,10, 4,10,11, 7,11, 5, 6,10, 4,10, 0, 7,11);	# F0
+
+# CB xx: 8 on a register, 12 for BIT b,(HL) and 15 for the others on (HL)
+@cc_cb = map { ($_ & 7) != 6 ? 8 : ($_ & 0xc0) == 0x40 ? 12 : 15 } (0..255);
+
+# DD/FD CB dd xx: 20 for BIT, 23 for the others
+@cc_xycb = map { ($_ & 0xc0) == 0x40 ? 20 : 23 } (0..255);
+
+# DD/FD xx, for the op-codes which use IX or IY
+@cc_xy = (4) x 256;
+@cc_xy[0x09, 0x19, 0x29, 0x39] = (15) x 4;	# ADD IX,rr
+@cc_xy[0x21, 0x22, 0x23, 0x2a, 0x2b] = (14, 20, 10, 20, 10);
+@cc_xy[0x24, 0x25, 0x2c, 0x2d, 0x26, 0x2e] = (8, 8, 8, 8, 11, 11);
+@cc_xy[0x34, 0x35, 0x36] = (23, 23, 19);
+foreach (0x40..0xbf) {
+    $x = (($_ & 0xc0) == 0x40) ? ($_ >> 3) & 7 : 7;
+    $y = $_ & 7;
+    next if ($_ == 0x76);
+    if ($y == 6 || ($_ & 0xf8) == 0x70) {	# (IX+dd)
+	$cc_xy[$_] = 19 if ($x != 6 || $y != 6);
+    }
+    elsif ($x == 4 || $x == 5 || $y == 4 || $y == 5) {	# IXH, IXL
+	$cc_xy[$_] = 8;
+    }
+}
+@cc_xy[0xcb, 0xe1, 0xe3, 0xe5, 0xe9, 0xf9] = (0, 14, 23, 15, 8, 10);
+
+# ED xx; the undefined ones work as two NOPs
+@cc_ed = (8) x 256;
+foreach (0x40..0x7f) {
+    $cc_ed[$_] = (12, 12, 15, 20, 8, 14, 8, 9)[$_ & 7];
+}
+@cc_ed[0x67, 0x6f, 0x77, 0x7f] = (18, 18, 8, 8);
+@cc_ed[0xa0..0xa3, 0xa8..0xab, 0xb0..0xb3, 0xb8..0xbb] = (16) x 16;
+
 $f = __FILE__;
 print <<"EOT";
 /* This file was generated from $f
    with the following choice of options */
-char *perl_params =
+EOT
+print $variant ? "const char perl_params_$variant\[] =\n" :
+    "char *perl_params =\n";
+print <<"EOT";
     "combine=$combine,"
     "optab=$optab,"
     "cb_inline=$cb_inline,"
     "dfd_inline=$dfd_inline,"
-    "ed_inline=$ed_inline";
+    "ed_inline=$ed_inline,"
+    "fuse_max=$fuse_max";
 
 EOT
 
 $tab = "\t";
 $cblabno = 0;
+$mntab = "op";			# table of the mnemonics being generated
+$cctab = "z80_cc_op";		# T-states of the op-codes being generated
+$cbtab = "z80_cc_cb";
 
 &preamble;			# generate the function header and switch
 
@@ -89,13 +262,15 @@ $cblabno = 0;
 &case(0x05, "DEC B");		&DECr(BC, "h");
 &case(0x06, "LD B,nn");		print "\t\tSethreg(BC, GetBYTE(PC++));\n";
 &case(0x07, "RLCA");		print <<"EOT";
+		SYNC_FLAGS();
 		AF = ((AF >> 7) & 0x0128) | ((AF << 1) & ~0x1ff) |
 			(AF & 0xc4) | ((AF >> 15) & 1);
 EOT
 &case(0x08, "EX AF,AF'");	print <<"EOT";
-		af[af_sel] = AF;
-		af_sel = 1 - af_sel;
-		AF = af[af_sel];
+		SYNC_FLAGS();
+		cpu->af[cpu->af_sel] = AF;
+		cpu->af_sel = 1 - cpu->af_sel;
+		AF = cpu->af[cpu->af_sel];
 EOT
 &case(0x09, "ADD HL,BC");	&ADDdd(HL, BC);
 &case(0x0A, "LD A,(BC)");	print "\t\tSethreg(AF, GetBYTE(BC));\n";
@@ -104,6 +279,7 @@ EOT
 &case(0x0D, "DEC C");		&DECr(BC, "l");
 &case(0x0E, "LD C,nn");		print "\t\tSetlreg(BC, GetBYTE(PC++));\n";
 &case(0x0F, "RRCA");		print <<"EOT";
+		SYNC_FLAGS();
 		temp = hreg(AF);
 		sum = temp >> 1;
 		AF = ((temp & 1) << 15) | (sum << 8) |
@@ -117,6 +293,7 @@ EOT
 &case(0x15, "DEC D");           &DECr(DE, "h");
 &case(0x16, "LD D,nn");		print "\t\tSethreg(DE, GetBYTE(PC++));\n";
 &case(0x17, "RLA");		print <<"EOT";
+		SYNC_FLAGS();
 		AF = ((AF << 8) & 0x0100) | ((AF >> 7) & 0x28) | ((AF << 1) & ~0x01ff) |
 			(AF & 0xc4) | ((AF >> 15) & 1);
 EOT
@@ -128,6 +305,7 @@ EOT
 &case(0x1D, "DEC E");           &DECr(DE, "l");
 &case(0x1E, "LD E,nn");		print "\t\tSetlreg(DE, GetBYTE(PC++));\n";
 &case(0x1F, "RRA");		print <<"EOT";
+		SYNC_FLAGS();
 		temp = hreg(AF);
 		sum = temp >> 1;
 		AF = ((AF & 1) << 15) | (sum << 8) |
@@ -141,6 +319,7 @@ EOT
 &case(0x25, "DEC H");           &DECr(HL, "h");
 &case(0x26, "LD H,nn");         print "\t\tSethreg(HL, GetBYTE(PC++));\n";
 &case(0x27, "DAA");		print <<"EOT";
+		SYNC_FLAGS();
 		acu = hreg(AF);
 		temp = ldig(acu);
 		cbits = TSTFLAG(C);
@@ -176,6 +355,7 @@ EOT
 &case(0x2D, "DEC L");           &DECr(HL, "l");
 &case(0x2E, "LD L,nn");		print "\t\tSetlreg(HL, GetBYTE(PC++));\n";
 &case(0x2F, "CPL");		print <<"EOT";
+		SYNC_FLAGS();
 		AF = (~AF & ~0xff) | (AF & 0xc5) | ((~AF >> 8) & 0x28) | 0x12;
 EOT
 &case(0x30, "JR NC,dd");	&JRcond("!TSTFLAG(C)");
@@ -185,7 +365,8 @@ EOT
 &case(0x34, "INC (HL)");	&INCm(HL);
 &case(0x35, "DEC (HL)");	&DECm(HL);
 &case(0x36, "LD (HL),nn");	print "\t\tPutBYTE(HL, GetBYTE(PC++));\n";
-&case(0x37, "SCF");		print "\t\tAF = (AF&~0x3b)|((AF>>8)&0x28)|1;\n";
+&case(0x37, "SCF");		print "\t\tSYNC_FLAGS();\n";
+	print "\t\tAF = (AF&~0x3b)|((AF>>8)&0x28)|1;\n";
 &case(0x38, "JR C,dd");		&JRcond("TSTFLAG(C)");
 &case(0x39, "ADD HL,SP");	&ADDdd(HL, SP);
 &case(0x3A, "LD A,(nnnn)");	&LDrmem(AF, "h");
@@ -193,7 +374,7 @@ EOT
 &case(0x3C, "INC A");		&INCr(AF, "h");
 &case(0x3D, "DEC A");		&DECr(AF, "h");
 &case(0x3E, "LD A,nn");		print "\t\tSethreg(AF, GetBYTE(PC++));\n";
-&case(0x3F, "CCF");
+&case(0x3F, "CCF");		print "\t\tSYNC_FLAGS();\n";
 	print "\t\tAF = (AF&~0x3b)|((AF>>8)&0x28)|((AF&1)<<4)|(~AF&1);\n";
 &case(0x40, "LD B,B");		print "\t\t/* nop */\n";
 &case(0x41, "LD B,C");		print "\t\tBC = (BC & 255) | ((BC & 255) << 8);\n";
@@ -323,7 +504,7 @@ EOT
 &case(0xBD, "CP L");		&CPAr("lreg(HL)");
 &case(0xBE, "CP (HL)");		&CPAr("GetBYTE(HL)");
 &case(0xBF, "CP A");		&CPAr("hreg(AF)");
-&case(0xC0, "RET NZ");		print "\t\tif (!TSTFLAG(Z)) POP(PC);\n";
+&case(0xC0, "RET NZ");		print "\t\tRETC(!TSTFLAG(Z));\n";
 &case(0xC1, "POP BC");		print "\t\tPOP(BC);\n";
 &case(0xC2, "JP NZ,nnnn");	print "\t\tJPC(!TSTFLAG(Z));\n";
 &case(0xC3, "JP nnnn");		print "\t\tJPC(1);\n";
@@ -331,39 +512,39 @@ EOT
 &case(0xC5, "PUSH BC");		print "\t\tPUSH(BC);\n";
 &case(0xC6, "ADD A,nn");	&ADDAr("GetBYTE(PC++)");
 &case(0xC7, "RST 0");		print "\t\tPUSH(PC); PC = 0;\n";
-&case(0xC8, "RET Z");		print "\t\tif (TSTFLAG(Z)) POP(PC);\n";
+&case(0xC8, "RET Z");		print "\t\tRETC(TSTFLAG(Z));\n";
 &case(0xC9, "RET");		print "\t\tPOP(PC);\n";
 &case(0xCA, "JP Z,nnnn");	print "\t\tJPC(TSTFLAG(Z));\n";
 &case(0xCB, "CB prefix");	&CB("HL");
 &case(0xCC, "CALL Z,nnnn");	print "\t\tCALLC(TSTFLAG(Z));\n";
-&case(0xCD, "CALL nnnn");	print "\t\tCALLC(1);\n";
+&case(0xCD, "CALL nnnn");	print "\t\tCALL();\n";
 &case(0xCE, "ADC A,nn");	&ADCAr("GetBYTE(PC++)");
 &case(0xCF, "RST 8");		print "\t\tPUSH(PC); PC = 8;\n";
-&case(0xD0, "RET NC");		print "\t\tif (!TSTFLAG(C)) POP(PC);\n";
+&case(0xD0, "RET NC");		print "\t\tRETC(!TSTFLAG(C));\n";
 &case(0xD1, "POP DE");		print "\t\tPOP(DE);\n";
 &case(0xD2, "JP NC,nnnn");	print "\t\tJPC(!TSTFLAG(C));\n";
-&case(0xD3, "OUT (nn),A");	print "\t\tOutput(GetBYTE(PC++), hreg(AF));\n";
+&case(0xD3, "OUT (nn),A");	print "\t\tOutput(GetBYTE(PC++), hreg(AF));\n"; &schedsync("\t");
 &case(0xD4, "CALL NC,nnnn");	print "\t\tCALLC(!TSTFLAG(C));\n";
 &case(0xD5, "PUSH DE");		print "\t\tPUSH(DE);\n";
 &case(0xD6, "SUB nn");		&SUBAr("GetBYTE(PC++)");
 &case(0xD7, "RST 10H");		print "\t\tPUSH(PC); PC = 0x10;\n";
-&case(0xD8, "RET C");		print "\t\tif (TSTFLAG(C)) POP(PC);\n";
+&case(0xD8, "RET C");		print "\t\tRETC(TSTFLAG(C));\n";
 &case(0xD9, "EXX");		print <<"EOT";
-		regs[regs_sel].bc = BC;
-		regs[regs_sel].de = DE;
-		regs[regs_sel].hl = HL;
-		regs_sel = 1 - regs_sel;
-		BC = regs[regs_sel].bc;
-		DE = regs[regs_sel].de;
-		HL = regs[regs_sel].hl;
+		cpu->regs[cpu->regs_sel].bc = BC;
+		cpu->regs[cpu->regs_sel].de = DE;
+		cpu->regs[cpu->regs_sel].hl = HL;
+		cpu->regs_sel = 1 - cpu->regs_sel;
+		BC = cpu->regs[cpu->regs_sel].bc;
+		DE = cpu->regs[cpu->regs_sel].de;
+		HL = cpu->regs[cpu->regs_sel].hl;
 EOT
 &case(0xDA, "JP C,nnnn");	print "\t\tJPC(TSTFLAG(C));\n";
-&case(0xDB, "IN A,(nn)");	print "\t\tSethreg(AF, Input(GetBYTE(PC++)));\n";
+&case(0xDB, "IN A,(nn)");	print "\t\tSethreg(AF, Input(GetBYTE(PC++)));\n"; &schedsync("\t");
 &case(0xDC, "CALL C,nnnn");	print "\t\tCALLC(TSTFLAG(C));\n";
-&case(0xDD, "DD prefix");	$dfd_inline ? &DFD("IX") : &DFD("ix");
+&case(0xDD, "DD prefix");	$dfd_inline ? &DFD("IX") : &DFD("cpu->ix");
 &case(0xDE, "SBC A,nn");	&SBCAr("GetBYTE(PC++)");
 &case(0xDF, "RST 18H");		print "\t\tPUSH(PC); PC = 0x18;\n";
-&case(0xE0, "RET PO");		print "\t\tif (!TSTFLAG(P)) POP(PC);\n";
+&case(0xE0, "RET PO");		print "\t\tRETC(!TSTFLAG(P));\n";
 &case(0xE1, "POP HL");		print "\t\tPOP(HL);\n";
 &case(0xE2, "JP PO,nnnn");	print "\t\tJPC(!TSTFLAG(P));\n";
 &case(0xE3, "EX (SP),HL");	print "\t\ttemp = HL; POP(HL); PUSH(temp);\n";
@@ -371,7 +552,7 @@ EOT
 &case(0xE5, "PUSH HL");		print "\t\tPUSH(HL);\n";
 &case(0xE6, "AND nn");		&ANDAl("&", "GetBYTE(PC++)");
 &case(0xE7, "RST 20H");		print "\t\tPUSH(PC); PC = 0x20;\n";
-&case(0xE8, "RET PE");		print "\t\tif (TSTFLAG(P)) POP(PC);\n";
+&case(0xE8, "RET PE");		print "\t\tRETC(TSTFLAG(P));\n";
 &case(0xE9, "JP (HL)");		print "\t\tPC = HL;\n";
 &case(0xEA, "JP PE,nnnn");	print "\t\tJPC(TSTFLAG(P));\n";
 &case(0xEB, "EX DE,HL");	print "\t\ttemp = HL; HL = DE; DE = temp;\n";
@@ -379,38 +560,66 @@ EOT
 &case(0xED, "ED prefix");	&ED("HL");
 &case(0xEE, "XOR nn");		&LOGAl("^", "GetBYTE(PC++)");
 &case(0xEF, "RST 28H");		print "\t\tPUSH(PC); PC = 0x28;\n";
-&case(0xF0, "RET P");		print "\t\tif (!TSTFLAG(S)) POP(PC);\n";
-&case(0xF1, "POP AF");		print "\t\tPOP(AF);\n";
+&case(0xF0, "RET P");		print "\t\tRETC(!TSTFLAG(S));\n";
+&case(0xF1, "POP AF");		print "\t\tSYNC_FLAGS(); POP(AF);\n";
 &case(0xF2, "JP P,nnnn");	print "\t\tJPC(!TSTFLAG(S));\n";
-&case(0xF3, "DI");		print "\t\tIFF = 0;\n";
+&case(0xF3, "DI");		print "\t\tcpu->IFF = 0;\n";
 &case(0xF4, "CALL P,nnnn");	print "\t\tCALLC(!TSTFLAG(S));\n";
-&case(0xF5, "PUSH AF");		print "\t\tPUSH(AF);\n";
+&case(0xF5, "PUSH AF");		print "\t\tSYNC_FLAGS(); PUSH(AF);\n";
 &case(0xF6, "OR nn");		&LOGAl("|", "GetBYTE(PC++)");
 &case(0xF7, "RST 30H");		print "\t\tPUSH(PC); PC = 0x30;\n";
-&case(0xF8, "RET M");		print "\t\tif (TSTFLAG(S)) POP(PC);\n";
+&case(0xF8, "RET M");		print "\t\tRETC(TSTFLAG(S));\n";
 &case(0xF9, "LD SP,HL");	print "\t\tSP = HL;\n";
 &case(0xFA, "JP M,nnnn");	print "\t\tJPC(TSTFLAG(S));\n";
-&case(0xFB, "EI");		print "\t\tIFF = 3;\n";
+&case(0xFB, "EI");		print "\t\tcpu->IFF = 3;\n";
+				print "\t\tcpu->sched.ei = CYC;\n"; &intrcheck("\t");
 &case(0xFC, "CALL M,nnnn");	print "\t\tCALLC(TSTFLAG(S));\n";
-&case(0xFD, "FD prefix");	$dfd_inline ? &DFD("IY") : &DFD("iy");
+&case(0xFD, "FD prefix");	$dfd_inline ? &DFD("IY") : &DFD("cpu->iy");
 &case(0xFE, "CP nn");		&CPAr("GetBYTE(PC++)");
 &case(0xFF, "RST 38H");		print "\t\tPUSH(PC); PC = 0x38;\n";
 
 &postamble;
+&mnemtab if (!$variant);
 
 sub case {
     local($op,$cmnt) = @_;
     if ($needbreak) {
-	print $optab ? "${tab}\tcontinue;\n" : "${tab}\tbreak;\n";
+	print $optab ? ($branchop ? "${tab}\tBRANCH_NEXT;\n" :
+			$prefixop ? "${tab}\tCHECK_NEXT;\n" : "${tab}\tNEXT;\n")
+		     : "${tab}\tbreak;\n";
     }
     $needbreak = 1;
+    $mn = $cmnt;
+    $mn =~ s/\b$mnreg/XY/g if ($mnreg);
+    $mnem{$mntab}[$op] = $mn if ($mn !~ / prefix$/);
+    $branchop = ($cmnt =~ /^(JP|JR|DJNZ|CALL|RET|RST)/) if $optab;
+    $prefixop = ($cmnt =~ /^(DD|ED|FD) prefix/) if $optab;
     printf("${tab}case 0x%02X:\t\t\t/* $cmnt */\n", $op) if !$optab;
-    printf("${tab}op_%02x:\t\t\t/* $cmnt */\n", $op) if $optab;
+    printf("${tab}OPCODE(%02x):\t\t\t/* $cmnt */\n", $op) if $optab;
+    printf("${tab}\tCYCLES($cctab\[0x%02x]);\n", $op)
+	if ($cctab && $cc_op[$op]);
 }
 
 sub JRcond {
     local($cond) = @_;
-    print "${tab}\tPC += ($cond) ? (signed char) GetBYTE(PC) + 1 : 1;\n";
+    if ($cond eq "1") {
+	print "${tab}\tPC += (signed char) GetBYTE(PC) + 1;\n";
+    }
+    else {
+	print "${tab}\tJRC($cond);\n";
+    }
+}
+
+# The flags of the common arithmetic and logical instructions are only
+# worked out when something looks at them (configure --with-lazyflags).
+# The carry is always kept in AF; the other flags are derived from the
+# recorded operation by lazy_flags() on demand.
+sub lazyflags {
+    local($kind, $res, $x, $y, $af) = @_;
+    print "#ifdef OPT_LAZY_FLAGS\n";
+    print "${tab}\t$af\n" if ($af);
+    print "${tab}\tLAZY_FLAGS($kind, $res, $x, $y);\n";
+    print "#else\n";
 }
 
 sub LDmemr {
@@ -502,12 +711,14 @@ sub INCr {
     else {
 	$labincr = 1;
 	print "${tab}labincr:\n" if $combine;
+	&lazyflags("LF_INC", "temp", "0", "0");
 	print <<"EOT";
 $tab	AF = (AF & ~0xfe) | (temp & 0xa8) |
 $tab		(((temp & 0xff) == 0) << 6) |
 $tab		(((temp & 0xf) == 0) << 4) |
 $tab		((temp == 0x80) << 2);
 EOT
+	print "#endif\n";
     }
 }
 
@@ -521,12 +732,14 @@ sub INCm {
     else {
 	$labincr = 1;
 	print "${tab}labincr:\n" if $combine;
+	&lazyflags("LF_INC", "temp", "0", "0");
 	print <<"EOT";
 $tab	AF = (AF & ~0xfe) | (temp & 0xa8) |
 $tab		(((temp & 0xff) == 0) << 6) |
 $tab		(((temp & 0xf) == 0) << 4) |
 $tab		((temp == 0x80) << 2);
 EOT
+	print "#endif\n";
     }
 }
 
@@ -545,12 +758,14 @@ sub DECr {
     else {
 	$labdecr = 1;
 	print "${tab}labdecr:\n" if $combine;
+	&lazyflags("LF_DEC", "temp", "0", "0");
 	print <<"EOT";
 $tab	AF = (AF & ~0xfe) | (temp & 0xa8) |
 $tab		(((temp & 0xff) == 0) << 6) |
 $tab		(((temp & 0xf) == 0xf) << 4) |
 $tab		((temp == 0x7f) << 2) | 2;
 EOT
+	print "#endif\n";
     }
 }
 
@@ -564,12 +779,14 @@ sub DECm {
     else {
 	$labdecr = 1;
 	print "${tab}labdecr:\n" if $combine;
+	&lazyflags("LF_DEC", "temp", "0", "0");
 	print <<"EOT";
 $tab	AF = (AF & ~0xfe) | (temp & 0xa8) |
 $tab		(((temp & 0xff) == 0) << 6) |
 $tab		(((temp & 0xf) == 0xf) << 4) |
 $tab		((temp == 0x7f) << 2) | 2;
 EOT
+	print "#endif\n";
     }
 }
 
@@ -587,11 +804,15 @@ sub ADDAr {
 $tab	acu = hreg(AF);
 $tab	sum = acu + temp;
 $tab	cbits = acu ^ temp ^ sum;
+EOT
+		&lazyflags("LF_ADD", "sum", "cbits", "0", "AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);");
+		print <<"EOT";
 $tab	AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 $tab		(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 $tab		(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 $tab		((cbits >> 8) & 1);
 EOT
+		print "#endif\n";
     }
 }
 
@@ -609,11 +830,15 @@ sub ADCAr {
 $tab	acu = hreg(AF);
 $tab	sum = acu + temp + TSTFLAG(C);
 $tab	cbits = acu ^ temp ^ sum;
+EOT
+		&lazyflags("LF_ADD", "sum", "cbits", "0", "AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);");
+		print <<"EOT";
 $tab	AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 $tab		(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 $tab		(((cbits >> 6) ^ (cbits >> 5)) & 4) |
 $tab		((cbits >> 8) & 1);
 EOT
+		print "#endif\n";
     }
 }
 
@@ -631,11 +856,15 @@ sub SUBAr {
 $tab	acu = hreg(AF);
 $tab	sum = acu - temp;
 $tab	cbits = acu ^ temp ^ sum;
+EOT
+		&lazyflags("LF_SUB", "sum", "cbits", "0", "AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);");
+		print <<"EOT";
 $tab	AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 $tab		(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 $tab		(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 $tab		((cbits >> 8) & 1);
 EOT
+		print "#endif\n";
     }
 }
 
@@ -653,11 +882,15 @@ sub SBCAr {
 $tab	acu = hreg(AF);
 $tab	sum = acu - temp - TSTFLAG(C);
 $tab	cbits = acu ^ temp ^ sum;
+EOT
+	&lazyflags("LF_SUB", "sum", "cbits", "0", "AF = ((sum & 0xff) << 8) | ((cbits >> 8) & 1);");
+	print <<"EOT";
 $tab	AF = ((sum & 0xff) << 8) | (sum & 0xa8) |
 $tab		(((sum & 0xff) == 0) << 6) | (cbits & 0x10) |
 $tab		(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 $tab		((cbits >> 8) & 1);
 EOT
+	print "#endif\n";
     }
 }
 
@@ -671,8 +904,10 @@ sub ANDAh {
     else {
 	$labandar = 1;
 	print "${tab}labandar:\n" if $combine;
+	&lazyflags("LF_AND", "sum", "0", "0", "AF = sum << 8;");
 	print "${tab}\tAF = (sum << 8) | (sum & 0xa8) |\n";
 	print "${tab}\t\t((sum == 0) << 6) | 0x10 | partab[sum];\n";
+	print "#endif\n";
     }
 }
 
@@ -686,8 +921,10 @@ sub ANDAl {
     else {
 	$labandar = 1;
 	print "${tab}labandar:\n" if $combine;
+	&lazyflags("LF_AND", "sum", "0", "0", "AF = sum << 8;");
 	print "${tab}\tAF = (sum << 8) | (sum & 0xa8) | 0x10 |\n";
 	print "${tab}\t\t((sum == 0) << 6) | partab[sum];\n";
+	print "#endif\n";
     }
 }
 
@@ -701,8 +938,10 @@ sub LOGAh {
     else {
 	$lablogar = 1;
 	print "${tab}lablogar:\n" if $combine;
+	&lazyflags("LF_LOG", "sum", "0", "0", "AF = sum << 8;");
 	print
 "${tab}\tAF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];\n";
+	print "#endif\n";
     }
 }
 
@@ -716,8 +955,10 @@ sub LOGAl {
     else {
 	$lablogar = 1;
 	print "${tab}lablogar:\n" if $combine;
+	&lazyflags("LF_LOG", "sum", "0", "0", "AF = sum << 8;");
 	print
 "${tab}\tAF = (sum << 8) | (sum & 0xa8) | ((sum == 0) << 6) | partab[sum];\n";
+	print "#endif\n";
     }
 }
 
@@ -736,11 +977,15 @@ sub CPAr {
 $tab	acu = hreg(AF);
 $tab	sum = acu - temp;
 $tab	cbits = acu ^ temp ^ sum;
+EOT
+	&lazyflags("LF_CP", "sum", "cbits", "temp", "AF = (AF & ~0xff) | ((cbits >> 8) & 1);");
+	print <<"EOT";
 $tab	AF = (AF & ~0xff) | (sum & 0x80) |
 $tab		(((sum & 0xff) == 0) << 6) | (temp & 0x28) |
 $tab		(((cbits >> 6) ^ (cbits >> 5)) & 4) | 2 |
 $tab		(cbits & 0x10) | ((cbits >> 8) & 1);
 EOT
+	print "#endif\n";
     }
 }
 
@@ -761,6 +1006,7 @@ EOT
 	$labadddd = 1;
 	print "${tab}labadddd:\n" if $combine;
 	print <<"EOT";
+$tab	SYNC_FLAGS();
 $tab	AF = (AF & ~0x3b) | ((sum >> 8) & 0x28) |
 $tab		(cbits & 0x10) | ((cbits >> 8) & 1);
 EOT
@@ -826,6 +1072,7 @@ $tab	AF = (AF & ~0xfe) | (temp & 0xa8) |
 $tab		(((temp & 0xff) == 0) << 6) |
 $tab		parity(temp);
 EOT
+    &schedsync($tab);
 }
 
 sub OUTP {
@@ -833,19 +1080,39 @@ sub OUTP {
     print <<"EOT";
 $tab	Output(lreg(BC), $reg);
 EOT
+    &schedsync($tab);
+}
+
+# A port handler may have added an event or raised an interrupt
+# request: make simz80_run() stop in time for sched_run().
+sub schedsync {
+    local($t) = @_;
+    print "${t}\tif (cpu->sched.next < deadline)\n";
+    print "${t}\t\tdeadline = cpu->sched.next;\n";
+}
+
+# An interrupt may have been enabled: if one is requested, make
+# simz80_run() stop at its next check, after at least one more
+# instruction, so that sched_run() accepts it.
+sub intrcheck {
+    local($t) = @_;
+    print "${t}\tif (cpu->sched.irq)\n";
+    print "${t}\t\tdeadline = CYC;\n";
 }
 
 sub CB {
     local($reg) = @_;
     if ($cb_inline) {
 	print "${tab}\tadr = $reg;\n";
+	print "${tab}\tSYNC_FLAGS();\n";
 	&cb_switch;
     }
     else {
 	print <<"EOT";
 $tab	SAVE_STATE();
-$tab	cb_prefix($reg);
+$tab	cb_prefix(cpu, $reg);
 $tab	LOAD_STATE();
+$tab	CYCLES($cbtab\[RAM(PC - 1)]);
 EOT
     }
 }
@@ -855,7 +1122,11 @@ sub cb_switch {
     $optab = 0;
     $cblabno += 1;
     print <<"EOT";
-$tab	switch ((op = GetBYTE(PC++)) & 7) {
+$tab	op = GetBYTE(PC++);
+EOT
+    print "${tab}\tCYCLES($cbtab\[op]);\n" if ($cbtab);
+    print <<"EOT";
+$tab	switch (op & 7) {
 $tab	case 0: acu = hreg(BC); break;
 $tab	case 1: acu = lreg(BC); break;
 $tab	case 2: acu = hreg(DE); break;
@@ -896,7 +1167,7 @@ $tab		case 0x30:	/* SLIA */
 $tab			temp = (acu << 1) | 1;
 $tab			cbits = acu & 0x80;
 $tab			goto cbshflg$cblabno;
-$tab		case 0x38:	/* SRL */
+$tab		default:	/* SRL (0x38) */
 $tab			temp = acu >> 1;
 $tab			cbits = acu & 1;
 $tab		cbshflg$cblabno:
@@ -918,7 +1189,7 @@ $tab		break;
 $tab	case 0x80:		/* RES */
 $tab		temp = acu & ~(1 << ((op >> 3) & 7));
 $tab		break;
-$tab	case 0xc0:		/* SET */
+$tab	default:		/* SET (0xc0) */
 $tab		temp = acu | (1 << ((op >> 3) & 7));
 $tab		break;
 $tab	}
@@ -945,7 +1216,7 @@ sub DFD {
     else {
 	print <<"EOT";
 $tab	SAVE_STATE();
-$tab	$reg = dfd_prefix($reg);
+$tab	$reg = dfd_prefix(cpu, $reg);
 $tab	LOAD_STATE();
 EOT
     }
@@ -959,8 +1230,13 @@ sub Offsadr {
 sub dfd_switch {
     local($reg) = @_;
     local($optabsav) = $optab;
+    local($cctab) = "";
+    local($cbtab) = "z80_cc_xycb";
+    local($mntab, $mnreg) = ("xy", $reg);
     $optab = 0;
-    print "${tab}\tswitch (op = GetBYTE(PC++)) {\n";
+    print "${tab}\top = GetBYTE(PC++);\n";
+    print "${tab}\tCYCLES(z80_cc_xy[op]);\n";
+    print "${tab}\tswitch (op) {\n";
     $tab = "\t\t";
     $needbreak = 0;
     &case(0x09, "ADD $reg,BC");		&ADDdd($reg, BC);
@@ -990,8 +1266,8 @@ sub dfd_switch {
     &case(0x54, "LD D,${reg}H");	print "${tab}\tSethreg(DE, hreg($reg));\n";
     &case(0x55, "LD D,${reg}L");	print "${tab}\tSethreg(DE, lreg($reg));\n";
     &case(0x56, "LD D,($reg+dd)");	&Offsadr($reg); print "${tab}\tSethreg(DE, GetBYTE(adr));\n";
-    &case(0x5C, "LD E,H");		print "${tab}\tSetlreg(DE, hreg($reg));\n";
-    &case(0x5D, "LD E,L");		print "${tab}\tSetlreg(DE, lreg($reg));\n";
+    &case(0x5C, "LD E,${reg}H");	print "${tab}\tSetlreg(DE, hreg($reg));\n";
+    &case(0x5D, "LD E,${reg}L");	print "${tab}\tSetlreg(DE, lreg($reg));\n";
     &case(0x5E, "LD E,($reg+dd)");	&Offsadr($reg); print "${tab}\tSetlreg(DE, GetBYTE(adr));\n";
     &case(0x60, "LD ${reg}H,B");	print "${tab}\tSethreg($reg, hreg(BC));\n";
     &case(0x61, "LD ${reg}H,C");	print "${tab}\tSethreg($reg, lreg(BC));\n";
@@ -1058,21 +1334,31 @@ sub dfd_switch {
 sub ED {
     local($reg) = @_;
     if ($ed_inline) {
+	print "${tab}\tSYNC_FLAGS();\n";
 	&ed_switch;
     }
     else {
 	print <<"EOT";
 $tab	SAVE_STATE();
-$tab	ed_prefix();
-$tab	LOAD_STATE();
+$tab	{
+$tab	    unsigned long long cut = ed_prefix(cpu);
+
+$tab	    LOAD_STATE();
+$tab	    if (cut < deadline)
+$tab		deadline = cut;
+$tab	}
 EOT
     }
 }
 
 sub ed_switch {
     local($optabsav) = $optab;
+    local($cctab) = "";
+    local($mntab) = "ed";
     $optab = 0;
-    print "${tab}\tswitch (op = GetBYTE(PC++)) {\n";
+    print "${tab}\top = GetBYTE(PC++);\n";
+    print "${tab}\tCYCLES(z80_cc_ed[op]);\n";
+    print "${tab}\tswitch (op) {\n";
     $tab = "\t\t";
     $needbreak = 0;
     &case(0x40, "IN B,(C)");		&INP(BC, "h");
@@ -1086,28 +1372,32 @@ sub ed_switch {
 				(((temp & 0x0f) != 0) << 4) | ((temp == 0x80) << 2) |
 				2 | (temp != 0);
 EOT
-    &case(0x45, "RETN");		print "\t\t\tIFF |= IFF >> 1;\n\t\t\tPOP(PC);\n";
-    &case(0x46, "IM 0");		print "\t\t\t/* interrupt mode 0 */\n";
-    &case(0x47, "LD I,A");		print "\t\t\tir = (ir & 255) | (AF & ~255);\n";
+    &case(0x45, "RETN");		print "\t\t\tcpu->IFF |= cpu->IFF >> 1;\n"; &intrcheck("\t\t");
+					print "\t\t\tPOP(PC);\n";
+    &case(0x46, "IM 0");		print "\t\t\tcpu->im = 0;\n";
+    &case(0x47, "LD I,A");		print "\t\t\tcpu->ir = (cpu->ir & 255) | (AF & ~255);\n";
     &case(0x48, "IN C,(C)");		&INP(BC, "l");
     &case(0x49, "OUT (C),C");		&OUTP(BC, "l");
     &case(0x4A, "ADC HL,BC");		&ADCdd(HL, BC);
     &case(0x4B, "LD BC,(nnnn)");	&LDddmem(BC);
-    &case(0x4D, "RETI");		print "\t\t\tIFF |= IFF >> 1;\n\t\t\tPOP(PC);\n";
-    &case(0x4F, "LD R,A");		print "\t\t\tir = (ir & ~255) | ((AF >> 8) & 255);\n";
+    &case(0x4D, "RETI");		print "\t\t\tcpu->IFF |= cpu->IFF >> 1;\n"; &intrcheck("\t\t");
+					print "\t\t\tPOP(PC);\n";
+    &case(0x4F, "LD R,A");		print <<"EOT";
+			cpu->ir = (cpu->ir & ~255) | ((AF >> 8) & 255);
+			cpu->rbase = CYC;
+EOT
     &case(0x50, "IN D,(C)");		&INP(DE, "h");
     &case(0x51, "OUT (C),D");		&OUTP(DE, "h");
     &case(0x52, "SBC HL,DE");		&SBCdd(HL, DE);
     &case(0x53, "LD (nnnn),DE");	&LDmemdd(DE);
-    &case(0x56, "IM 1");		print "\t\t\t/* interrupt mode 1 */\n";
-    &case(0x57, "LD A,I");		print "\t\t\tAF = (AF & 255) | (ir & ~255);\n";
+    &case(0x56, "IM 1");		print "\t\t\tcpu->im = 1;\n";
+    &case(0x57, "LD A,I");		print "\t\t\tAF = (AF & 255) | (cpu->ir & ~255);\n";
     &case(0x58, "IN E,(C)");		&INP(DE, "l");
     &case(0x59, "OUT (C),E");		&OUTP(DE, "l");
     &case(0x5A, "ADC HL,DE");		&ADCdd(HL, DE);
     &case(0x5B, "LD DE,(nnnn)");	&LDddmem(DE);
-    &case(0x5E, "IM 2");		print "\t\t\t/* interrupt mode 2 */\n";
-#    &case(0x5F, "LD A,R");		print "\t\t\tAF = (AF & 255) | ((ir & 255) << 8);\n";
-    &case(0x5F, "LD A,R");		print "\t\t\tAF = (AF & 255) | (rand() & 0xff00);\n";
+    &case(0x5E, "IM 2");		print "\t\t\tcpu->im = 2;\n";
+    &case(0x5F, "LD A,R");		print "\t\t\tAF = (AF & 255) | (Z80_R(cpu, CYC) << 8);\n";
     &case(0x60, "IN H,(C)");		&INP(HL, "h");
     &case(0x61, "OUT (C),H");		&OUTP(HL, "h");
     &case(0x62, "SBC HL,HL");		&SBCdd(HL, HL);
@@ -1163,12 +1453,14 @@ EOT
 			SETFLAG(N, 1);
 			SETFLAG(P, (--BC & 0xffff) != 0);
 EOT
+    &schedsync($tab);
     &case(0xA3, "OUTI");		print <<"EOT";
 			Output(lreg(BC), GetBYTE(HL++));
 			SETFLAG(N, 1);
 			Sethreg(BC, lreg(BC) - 1);
 			SETFLAG(Z, lreg(BC) == 0);
 EOT
+    &schedsync($tab);
     &case(0xA8, "LDD");			print <<"EOT";
 			acu = GetBYTE(HL--);
 			PutBYTE(DE--, acu);
@@ -1193,30 +1485,34 @@ EOT
 			Sethreg(BC, lreg(BC) - 1);
 			SETFLAG(Z, lreg(BC) == 0);
 EOT
+    &schedsync($tab);
     &case(0xAB, "OUTD");		print <<"EOT";
 			Output(lreg(BC), GetBYTE(HL--));
 			SETFLAG(N, 1);
 			Sethreg(BC, lreg(BC) - 1);
 			SETFLAG(Z, lreg(BC) == 0);
 EOT
+    &schedsync($tab);
     &case(0xB0, "LDIR");		print <<"EOT";
-			acu = hreg(AF);
-			BC &= 0xffff;
-			do {
-				acu = GetBYTE(HL++);
-				PutBYTE(DE++, acu);
-			} while (--BC);
-			acu += hreg(AF);
+			adr = BC & 0xffff ? BC & 0xffff : 0x10000;
+			CYCLES(21 * (adr - 1));
+			trap_move_block(cpu, DE, HL, adr, 0);
+			HL += adr;
+			DE += adr;
+			BC = 0;
+			acu = RAM(DE - 1) + hreg(AF);
 			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
 EOT
     &case(0xB1, "CPIR");		print <<"EOT";
 			acu = hreg(AF);
-			BC &= 0xffff;
-			do {
-				temp = GetBYTE(HL++);
-				op = --BC != 0;
-				sum = acu - temp;
-			} while (op && sum != 0);
+			adr = trap_find_byte(cpu, HL, BC & 0xffff ? BC & 0xffff : 0x10000,
+					     acu, 0);
+			CYCLES(21 * (adr - 1));
+			HL += adr;
+			BC = (BC - adr) & 0xffff;
+			temp = RAM(HL - 1);
+			op = BC != 0;
+			sum = acu - temp;
 			cbits = acu ^ temp ^ sum;
 			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
 				(((sum - ((cbits&16)>>4))&2) << 4) |
@@ -1226,6 +1522,7 @@ EOT
 EOT
     &case(0xB2, "INIR");		print <<"EOT";
 			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
 			do {
 				PutBYTE(HL++, Input(lreg(BC)));
 			} while (--temp);
@@ -1233,8 +1530,10 @@ EOT
 			SETFLAG(N, 1);
 			SETFLAG(Z, 1);
 EOT
+    &schedsync($tab);
     &case(0xB3, "OTIR");		print <<"EOT";
 			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
 			do {
 				Output(lreg(BC), GetBYTE(HL++));
 			} while (--temp);
@@ -1242,23 +1541,27 @@ EOT
 			SETFLAG(N, 1);
 			SETFLAG(Z, 1);
 EOT
+    &schedsync($tab);
     &case(0xB8, "LDDR");		print <<"EOT";
-			BC &= 0xffff;
-			do {
-				acu = GetBYTE(HL--);
-				PutBYTE(DE--, acu);
-			} while (--BC);
-			acu += hreg(AF);
+			adr = BC & 0xffff ? BC & 0xffff : 0x10000;
+			CYCLES(21 * (adr - 1));
+			trap_move_block(cpu, DE, HL, adr, 1);
+			HL -= adr;
+			DE -= adr;
+			BC = 0;
+			acu = RAM(DE + 1) + hreg(AF);
 			AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
 EOT
     &case(0xB9, "CPDR");		print <<"EOT";
 			acu = hreg(AF);
-			BC &= 0xffff;
-			do {
-				temp = GetBYTE(HL--);
-				op = --BC != 0;
-				sum = acu - temp;
-			} while (op && sum != 0);
+			adr = trap_find_byte(cpu, HL, BC & 0xffff ? BC & 0xffff : 0x10000,
+					     acu, 1);
+			CYCLES(21 * (adr - 1));
+			HL -= adr;
+			BC = (BC - adr) & 0xffff;
+			temp = RAM(HL + 1);
+			op = BC != 0;
+			sum = acu - temp;
 			cbits = acu ^ temp ^ sum;
 			AF = (AF & ~0xfe) | (sum & 0x80) | (!(sum & 0xff) << 6) |
 				(((sum - ((cbits&16)>>4))&2) << 4) |
@@ -1268,6 +1571,7 @@ EOT
 EOT
     &case(0xBA, "INDR");		print <<"EOT";
 			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
 			do {
 				PutBYTE(HL--, Input(lreg(BC)));
 			} while (--temp);
@@ -1275,8 +1579,10 @@ EOT
 			SETFLAG(N, 1);
 			SETFLAG(Z, 1);
 EOT
+    &schedsync($tab);
     &case(0xBB, "OTDR");		print <<"EOT";
 			temp = hreg(BC);
+			CYCLES(21 * ((temp - 1) & 0xff));
 			do {
 				Output(lreg(BC), GetBYTE(HL--));
 			} while (--temp);
@@ -1284,6 +1590,7 @@ EOT
 			SETFLAG(N, 1);
 			SETFLAG(Z, 1);
 EOT
+    &schedsync($tab);
     print "${tab}\tbreak;\n${tab}default: if (0x40 <= op && op <= 0x7f) PC--;\t\t/* ignore ED */\n";
     print "${tab}}\n";
     $tab = "\t";
@@ -1306,8 +1613,14 @@ sub reslabs {
 
 
 sub preamble {
+    print "#include \"config.h\"\n\n";
+    print "#ifndef OPT_DISPATCH_THREADED\n#define OPT_DISPATCH_THREADED\n#endif\n\n"
+	if ($dispatch eq "threaded");
+    print "#undef OPT_DISPATCH_THREADED\n\n" if ($dispatch eq "switch");
     print "#include <stdlib.h>\n\n";
-    print "#include \"simz80.h\"\n\n";
+    print "#include \"simz80.h\"\n";
+    print "#include \"bbcache.h\"\n";
+    print "#include \"jit.h\"\n\n";
 
     print "static const unsigned char partab[256] = {\n";
     for (0..255) {
@@ -1323,10 +1636,108 @@ sub preamble {
 
 #define parity(x)	partab[(x)&0xff]
 
+EOT
+    if (!$variant) {
+	&cctab("z80_cc_op", @cc_op);
+	&cctab("z80_cc_cb", @cc_cb);
+	&cctab("z80_cc_ed", @cc_ed);
+	&cctab("z80_cc_xy", @cc_xy);
+	&cctab("z80_cc_xycb", @cc_xycb);
+	&fusetab;
+    }
+    print <<'EOT';
+/* the count of the machine is kept in the local CYC while simz80_run()
+   runs */
+#define CYCLES(n)	(CYC += (n))
+
+EOT
+    my ($ix, $iy) = $dfd_inline ? ("IX", "IY") : ("cpu->ix", "cpu->iy");
+    print <<EOT;
+/* every instruction is counted while the machine is profiled, and
+   recorded while it is traced */
+#define INSN_HOOK()	do {						\\
+	PROF_INSN(PC & 0xffff, SP, CYC);				\\
+	TRACE_INSN(PC & 0xffff, (SYNC_FLAGS(), AF), BC, DE, HL,	\\
+	    $ix, $iy, SP);					\\
+    } while (0)
+
+EOT
+    print <<'EOT';
+#ifdef OPT_LAZY_FLAGS
+/* operations whose flags other than the carry are not worked out yet */
+#define LF_ADD	1
+#define LF_SUB	2
+#define LF_CP	3
+#define LF_AND	4
+#define LF_LOG	5
+#define LF_INC	6
+#define LF_DEC	7
+
+#define LAZY_FLAGS(op, res, x, y) do {					\
+    lf_op = (op);							\
+    lf_res = (res);							\
+    lf_x = (x);								\
+    lf_y = (y);								\
+} while (0)
+
+/* flags S, Z, H, P/V and N (and the undocumented bits 3 and 5) of an
+   operation recorded by LAZY_FLAGS(), exactly as the eager code sets them */
+static inline FASTWORK
+lazy_flags(FASTWORK op, FASTWORK res, FASTWORK x, FASTWORK y)
+{
+    switch (op) {
+    case LF_ADD:
+	return (res & 0xa8) | (((res & 0xff) == 0) << 6) | (x & 0x10) |
+		(((x >> 6) ^ (x >> 5)) & 4);
+    case LF_SUB:
+	return (res & 0xa8) | (((res & 0xff) == 0) << 6) | (x & 0x10) |
+		(((x >> 6) ^ (x >> 5)) & 4) | 2;
+    case LF_CP:
+	return (res & 0x80) | (((res & 0xff) == 0) << 6) | (y & 0x28) |
+		(((x >> 6) ^ (x >> 5)) & 4) | 2 | (x & 0x10);
+    case LF_AND:
+	return (res & 0xa8) | ((res == 0) << 6) | 0x10 | partab[res];
+    case LF_LOG:
+	return (res & 0xa8) | ((res == 0) << 6) | partab[res];
+    case LF_INC:
+	return (res & 0xa8) | (((res & 0xff) == 0) << 6) |
+		(((res & 0xf) == 0) << 4) | ((res == 0x80) << 2);
+    default:		/* LF_DEC */
+	return (res & 0xa8) | (((res & 0xff) == 0) << 6) |
+		(((res & 0xf) == 0xf) << 4) | ((res == 0x7f) << 2) | 2;
+    }
+}
+
+/* bring the flags in AF up to date */
+#define FLAGS_SYNCED()							\
+    (lf_op ? (AF = (AF & ~0xfe) | lazy_flags(lf_op, lf_res, lf_x, lf_y),\
+	      lf_op = 0) : 0)
+#define SYNC_FLAGS()	((void)FLAGS_SYNCED())
+
+/* S and Z follow from the result alone, and C is always in AF */
+#undef TSTFLAG
+#undef SETFLAG
+#define TSTFLAG(f)	LF_TST_ ## f
+#define LF_TST_C	((AF & FLAG_C) != 0)
+#define LF_TST_Z	(lf_op ? (lf_res & 0xff) == 0 : (AF & FLAG_Z) != 0)
+#define LF_TST_S	(lf_op ? (lf_res & 0x80) != 0 : (AF & FLAG_S) != 0)
+#define LF_TST_P	(FLAGS_SYNCED(), (AF & FLAG_P) != 0)
+#define LF_TST_H	(FLAGS_SYNCED(), (AF & FLAG_H) != 0)
+#define LF_TST_N	(FLAGS_SYNCED(), (AF & FLAG_N) != 0)
+#define SETFLAG(f,c)							\
+    (FLAGS_SYNCED(), AF = (c) ? AF | FLAG_ ## f : AF & ~FLAG_ ## f)
+#else
+#define SYNC_FLAGS()	((void)0)
+#endif
+
+EOT
+    print <<'EOT' if (!$variant);
 #ifdef DEBUG
 volatile int stopsim;
 #endif
 
+EOT
+    print <<'EOT';
 #define POP(x)	do {							\
 	FASTREG y = RAM(SP++);						\
 	x = y + (RAM(SP++) << 8);					\
@@ -1335,79 +1746,281 @@ volatile int stopsim;
 #define PUSH(x) do {							\
 	RAM(--SP) = (x) >> 8;						\
 	RAM(--SP) = x;							\
+	BB_CHECK(SP);							\
+	BB_CHECK(SP + 1);						\
 } while (0)
 
 #define JPC(cond) PC = cond ? GetWORD(PC) : PC+2
 
-#define CALLC(cond) {							\
+#define JRC(cond) {							\
     if (cond) {								\
-	FASTREG adrr = GetWORD(PC);					\
+	PC += (signed char) GetBYTE(PC) + 1;				\
+	CYCLES(5);							\
+    }									\
+    else								\
+	PC++;								\
+}
+
+#ifdef OPT_HLE
+/* a known library routine runs as host code instead, see hle.c */
+#define HLE_DEADLINE	deadline
+
+#define CALL() {							\
+    FASTREG adrr = GetWORD(PC);						\
+    int hle_ran = 0;							\
+    if (HLE_MAYBE(adrr)) {						\
+	SAVE_STATE();							\
+	hle_ran = hle_call(cpu, adrr, PC+2, HLE_DEADLINE);		\
+	LOAD_STATE();							\
+    }									\
+    if (!hle_ran) {							\
 	PUSH(PC+2);							\
 	PC = adrr;							\
     }									\
+}
+#else
+#define CALL() {							\
+    FASTREG adrr = GetWORD(PC);						\
+    PUSH(PC+2);								\
+    PC = adrr;								\
+}
+#endif
+
+#define CALLC(cond) {							\
+    if (cond) {								\
+	CALL();								\
+	CYCLES(7);							\
+    }									\
     else								\
 	PC += 2;							\
 }
 
+#define RETC(cond) {							\
+    if (cond) {								\
+	POP(PC);							\
+	CYCLES(6);							\
+    }									\
+}
+
+#ifdef OPT_BBCACHE
+/* the same with the operand taken from the pre-decoded record */
+#define BB_IMM		(ins->imm)
+
+#define BB_JPC(cond) PC = cond ? BB_IMM : PC+2
+
+#define BB_JRC(cond) {							\
+    if (cond) {								\
+	PC = ins->target;						\
+	CYCLES(5);							\
+    }									\
+    else								\
+	PC = ins->next;							\
+}
+
+#ifdef OPT_HLE
+#define BB_CALL() {							\
+    int hle_ran = 0;							\
+    if (HLE_MAYBE(BB_IMM)) {						\
+	SAVE_STATE();							\
+	hle_ran = hle_call(cpu, BB_IMM, PC+2, HLE_DEADLINE);		\
+	LOAD_STATE();							\
+    }									\
+    if (!hle_ran) {							\
+	PUSH(PC+2);							\
+	PC = BB_IMM;							\
+    }									\
+}
+#else
+#define BB_CALL() {							\
+    PUSH(PC+2);								\
+    PC = BB_IMM;							\
+}
+#endif
+
+#define BB_CALLC(cond) {						\
+    if (cond) {								\
+	BB_CALL();							\
+	CYCLES(7);							\
+    }									\
+    else								\
+	PC += 2;							\
+}
+#endif
+
 /* load Z80 registers into (we hope) host registers */
 #define LOAD_STATE()							\
-    PC = pc;								\
-    AF = af[af_sel];							\
-    BC = regs[regs_sel].bc;						\
-    DE = regs[regs_sel].de;						\
-    HL = regs[regs_sel].hl;						\
+    PC = cpu->pc;							\
+    CYC = cpu->cycles;							\
+    AF = cpu->af[cpu->af_sel];						\
+    BC = cpu->regs[cpu->regs_sel].bc;					\
+    DE = cpu->regs[cpu->regs_sel].de;					\
+    HL = cpu->regs[cpu->regs_sel].hl;					\
 EOT
     if ($dfd_inline) {
 	print <<'EOT';
-    IX = ix;								\
-    IY = iy;								\
+    IX = cpu->ix;							\
+    IY = cpu->iy;							\
 EOT
     }
     print <<'EOT';
-    SP = sp
+    SP = cpu->sp
 
 /* load Z80 registers into (we hope) host registers */
 #define DECLARE_STATE()							\
-    FASTREG PC = pc;							\
-    FASTREG AF = af[af_sel];						\
-    FASTREG BC = regs[regs_sel].bc;					\
-    FASTREG DE = regs[regs_sel].de;					\
-    FASTREG HL = regs[regs_sel].hl;					\
+    FASTREG PC = cpu->pc;						\
+    unsigned long long CYC = cpu->cycles;				\
+    FASTREG AF = cpu->af[cpu->af_sel];					\
+    FASTREG BC = cpu->regs[cpu->regs_sel].bc;				\
+    FASTREG DE = cpu->regs[cpu->regs_sel].de;				\
+    FASTREG HL = cpu->regs[cpu->regs_sel].hl;				\
+EOT
+    if ($dfd_inline) {
+	print <<'EOT';
+    FASTREG IX = cpu->ix;						\
+    FASTREG IY = cpu->iy;						\
+EOT
+    }
+    print <<'EOT';
+    FASTREG SP = cpu->sp
+
+#ifdef OPT_JIT
+/* hand the registers over to translated code and back */
+#define JIT_SAVE()							\
+    SYNC_FLAGS();							\
+    cpu->cycles = CYC;							\
+    cpu->jit.af = AF;							\
+    cpu->jit.bc = BC;							\
+    cpu->jit.de = DE;							\
+    cpu->jit.hl = HL;							\
+EOT
+    if ($dfd_inline) {
+	print <<'EOT';
+    cpu->ix = IX;							\
+    cpu->iy = IY;							\
+EOT
+    }
+    print <<'EOT';
+    cpu->jit.sp = SP
+
+#define JIT_LOAD()							\
+    CYC = cpu->cycles;							\
+    AF = cpu->jit.af;							\
+    BC = cpu->jit.bc;							\
+    DE = cpu->jit.de;							\
+    HL = cpu->jit.hl;							\
 EOT
     if ($dfd_inline) {
 	print <<'EOT';
-    FASTREG IX = ix;							\
-    FASTREG IY = iy;							\
+    IX = cpu->ix;							\
+    IY = cpu->iy;							\
 EOT
     }
     print <<'EOT';
-    FASTREG SP = sp
+    SP = cpu->jit.sp
+
+/* the same for a helper called from translated code; the registers
+   are accessed one by one, as the translated code stores them so */
+#define JIT_DECLARE_STATE()						\
+    struct z80_cpu *cpu = JIT_CPU(r);					\
+    volatile struct jit_regs *vr = r;					\
+    unsigned long long CYC = cpu->cycles;				\
+    FASTREG AF = vr->af;						\
+    FASTREG BC = vr->bc;						\
+    FASTREG DE = vr->de;						\
+    FASTREG HL = vr->hl;						\
+    FASTREG SP = vr->sp
+
+#define JIT_STORE_STATE()						\
+    SYNC_FLAGS();							\
+    cpu->cycles = CYC;							\
+    vr->af = AF;							\
+    vr->bc = BC;							\
+    vr->de = DE;							\
+    vr->hl = HL;							\
+    vr->sp = SP
+#endif
 
 /* save Z80 registers back into memory */
 #define SAVE_STATE()							\
-    pc = PC;								\
-    af[af_sel] = AF;							\
-    regs[regs_sel].bc = BC;						\
-    regs[regs_sel].de = DE;						\
-    regs[regs_sel].hl = HL;						\
+    SYNC_FLAGS();							\
+    cpu->cycles = CYC;							\
+    cpu->pc = PC;							\
+    cpu->af[cpu->af_sel] = AF;						\
+    cpu->regs[cpu->regs_sel].bc = BC;					\
+    cpu->regs[cpu->regs_sel].de = DE;					\
+    cpu->regs[cpu->regs_sel].hl = HL;					\
 EOT
     if ($dfd_inline) {
 	print <<'EOT';
-    ix = IX;								\
-    iy = IY;								\
+    cpu->ix = IX;							\
+    cpu->iy = IY;							\
 EOT
     }
     print <<'EOT';
-    sp = SP
+    cpu->sp = SP
+
+EOT
+
+    if ($optab == 2) {
+	print "#ifdef OPT_DISPATCH_THREADED\n";
+	&dispatch_macros(1);
+	print "#else\n";
+	&dispatch_macros(0);
+	print "#endif\n\n";
+    }
+    elsif ($optab) {
+	&dispatch_macros(1);
+	print "\n";
+    }
+    print <<'EOT' if ($optab);
+/* prefixed op-codes may move PC anywhere */
+#define BB_NEXT_CHECK							\
+    if ((PC & 0xffff) != ins[1].addr)					\
+	goto bb_enter;							\
+    else								\
+	BB_NEXT
+
+/* go on with the second op-code of a fused pair, unless the first one
+   has thrown the block away */
+#define BB_FUSE_NEXT(op)						\
+    if (ins[1].xop != 0x ## op)						\
+	BB_NEXT;							\
+    ins++;								\
+    PC++
+
+/* every loop goes through a branch, a prefixed op-code or the wrap of
+   PC past 0FFFFH, where simz80_run() checks the cycle budget; code
+   without branches runs round the memory */
+#define WRAP_CHECK() do {						\
+    if (PC > 0xffff)							\
+	goto wrapped;							\
+} while (0)
+
+#define CHECK_NEXT							\
+    if (CYC >= deadline)						\
+	goto expired;							\
+    else								\
+	NEXT
+
+/* a taken branch may enter a cached block, which checks the budget */
+#ifdef OPT_BBCACHE
+#define BRANCH_NEXT	goto bb_enter
+#else
+#define BRANCH_NEXT	CHECK_NEXT
+#endif
 
 EOT
 
     if (!$cb_inline) {
 	print <<'EOT';
 static void
-cb_prefix(FASTREG adr)
+cb_prefix(struct z80_cpu *cpu, FASTREG adr)
 {
     DECLARE_STATE();
+EOT
+	local($cbtab) = "";
+	&lazydecl;
+	print <<'EOT';
     FASTWORK temp, acu, op, cbits;
 
 EOT
@@ -1422,9 +2035,12 @@ EOT
     if (!$dfd_inline) {
 	print <<'EOT';
 static FASTREG
-dfd_prefix(FASTREG IXY)
+dfd_prefix(struct z80_cpu *cpu, FASTREG IXY)
 {
     DECLARE_STATE();
+EOT
+	&lazydecl;
+	print <<'EOT';
     FASTWORK temp, adr, acu, op, sum, cbits;
 
 EOT
@@ -1447,11 +2063,16 @@ EOT
 
     if (!$ed_inline) {
 	print <<'EOT';
-static void
-ed_prefix(void)
+/* returns where simz80_run() must stop for an event or an interrupt */
+static unsigned long long
+ed_prefix(struct z80_cpu *cpu)
 {
     DECLARE_STATE();
-    FASTWORK temp, acu, op, sum, cbits;
+    unsigned long long deadline = SIMZ80_FOREVER;
+EOT
+	&lazydecl;
+	print <<'EOT';
+    FASTWORK temp, acu, op, adr, sum, cbits;
 
 EOT
 	local(@labs) = ($labpcp2, $labcpar, $lablogar,
@@ -1465,50 +2086,90 @@ EOT
 	 $labdecr, $labincr) = @labs;
 	print <<'EOT';
     SAVE_STATE();
+    return(deadline);
 }
 
 EOT
 }
 
     print <<'EOT';
+/** Run Z80 code until HALT or until a number of T-states have passed.
+    The budget is checked at branches and where PC wraps round, so that
+    it may be exceeded by the length of a basic block.
+    @param[in] cpu        the machine
+    @param[in] PC         Z80 address to start at
+    @param[in] max_cycles T-states to run for
+    @return the address of the HALT instruction, or the PC to continue
+            at with SIMZ80_STOP set
+ */
 FASTWORK
-simz80(FASTREG PC)
+EOT
+    print "$run(struct z80_cpu *cpu, FASTREG PC, unsigned long long max_cycles)\n";
+    print <<'EOT';
 {
-    FASTREG AF = af[af_sel];
-    FASTREG BC = regs[regs_sel].bc;
-    FASTREG DE = regs[regs_sel].de;
-    FASTREG HL = regs[regs_sel].hl;
-    FASTREG SP = sp;
+    unsigned long long CYC = cpu->cycles;
+    unsigned long long deadline = (max_cycles > SIMZ80_FOREVER - CYC) ?
+	SIMZ80_FOREVER : CYC + max_cycles;
+    FASTREG AF = cpu->af[cpu->af_sel];
+    FASTREG BC = cpu->regs[cpu->regs_sel].bc;
+    FASTREG DE = cpu->regs[cpu->regs_sel].de;
+    FASTREG HL = cpu->regs[cpu->regs_sel].hl;
+    FASTREG SP = cpu->sp;
 EOT
     if ($dfd_inline) {
 	print <<'EOT';
-    FASTREG IX = ix;
-    FASTREG IY = iy;
+    FASTREG IX = cpu->ix;
+    FASTREG IY = cpu->iy;
 EOT
     }
     print "    FASTWORK temp, acu, sum, cbits;\n";
+    &lazydecl;
     print "    FASTWORK op, adr;\n" if ($cb_inline + $dfd_inline +
 				  $ed_inline != 0);
 
     if ($optab) {
-	print "static void *optab[256] = {\n";
-	for (0..255) {
-	    print "\t" if (($_ & 7) == 0);
-	    printf("&&op_%02x,", $_);
-	    print "\n" if (($_ & 7) == 7);
+	print "#ifdef OPT_BBCACHE\n";
+	print "    const struct bb_insn *ins = NULL;\n";
+	print "#endif\n";
+	print "#ifdef OPT_DISPATCH_THREADED\n" if ($optab == 2);
+	&labeltab("optab", "op_");
+	print "#ifdef OPT_BBCACHE\n";
+	if (@fuse) {
+	    print "#ifdef OPT_FUSION\n";
+	    &labeltab("bbtab", "bb_op_", 257 + @fuse);
+	    print "#else\n";
 	}
-	print "};\n";
+	&labeltab("bbtab", "bb_op_", 257);
+	print "#endif\n" if (@fuse);
+	print "#endif\n";
+	print "#endif\n" if ($optab == 2);
     }
+    print <<'EOT' if ($optab);
+
+#ifdef OPT_BBCACHE
+    goto bb_enter;
+#endif
+EOT
 print <<'EOT';
 
 #ifdef DEBUG
     while (!stopsim) {
 #else
-    while (1) {
+EOT
+    print $optab ? "    while (1) {\n" : "    while (CYC < deadline) {\n";
+    print <<'EOT';
 #endif
 EOT
     if ($optab) {
-	print "    goto *optab[RAM(PC++)]; {\n";
+	print "#ifdef OPT_BBCACHE\n";
+	print "bb_interp:\n";
+	print "#endif\n";
+	print "dispatch:\n";
+	print "    DISPATCH() {\n";
+	# keep the handlers for the block executor
+	$mainsw = '';
+	open(MAINSW, '>', \$mainsw) || die "cannot capture output: $!";
+	select(MAINSW);
     }
     else {
 	print "    switch(RAM(PC++)) {\n";
@@ -1516,13 +2177,341 @@ EOT
     $needbreak = 0;
 }
 
+sub cctab {
+    local($name, @t) = @_;
+    print "const BYTE ${name}[256] = {\n";
+    for (0..255) {
+	print "\t" if (($_ & 15) == 0);
+	print "$t[$_],";
+	print "\n" if (($_ & 15) == 15);
+    }
+    print "};\n\n";
+}
+
+# the mnemonics given to &case, for the disassembler
+sub mnemtab {
+    local(@rot) = ("RLC", "RRC", "RL", "RR", "SLA", "SRA", "SLIA", "SRL");
+    local(@bit) = ("BIT", "RES", "SET");
+    local(@r) = ("B", "C", "D", "E", "H", "L", "(HL)", "A");
+    for (0..255) {
+	$mnem{"cb"}[$_] = ($_ < 0x40) ? "$rot[$_ >> 3] $r[$_ & 7]" :
+	    $bit[($_ >> 6) - 1] . " " . (($_ >> 3) & 7) . ",$r[$_ & 7]";
+    }
+    print <<'EOT';
+
+/* mnemonics of the op-codes for disasm.c: nn is a byte, nnnn a word,
+   dd a displacement, XY stands for IX or IY; NULL if not defined */
+EOT
+    foreach $t ("op", "cb", "ed", "xy") {
+	print "const char *const z80_mn_${t}[256] = {\n";
+	for (0..255) {
+	    printf("\t%s,\t/* %02x */\n", defined($mnem{$t}[$_]) ?
+		   "\"$mnem{$t}[$_]\"" : "NULL", $_);
+	}
+	print "};\n";
+    }
+}
+
+sub fusetab {
+    local($n) = scalar(@fuse);
+    print "#ifdef OPT_FUSION\n";
+    print "const BYTE z80_fuse_pairs[][2] = {\n";
+    foreach (@fuse) {
+	printf("\t{ 0x%02x, 0x%02x },\n", $_->[0], $_->[1]);
+    }
+    print "\t{ 0, 0 },\n" if (!$n);
+    print "};\n";
+    print "const int z80_nfuse = $n;\n";
+    print "#endif\n\n";
+}
+
+sub lazydecl {
+    print "#ifdef OPT_LAZY_FLAGS\n";
+    print "    FASTWORK lf_op = 0, lf_res = 0, lf_x = 0, lf_y = 0;\n";
+    print "#endif\n";
+}
+
+sub labeltab {
+    local($name, $prefix, $n) = @_;
+    $n = 256 if (!$n);
+    print "static void *${name}[$n] = {\n";
+    for (0..$n-1) {
+	print "\t" if (($_ & 7) == 0);
+	printf("&&${prefix}%02x,", $_);
+	print "\n" if ((($_ & 7) == 7) || ($_ == $n - 1));
+    }
+    print "};\n";
+}
+
+sub dispatch_macros {
+    local($threaded) = @_;
+    if ($threaded) {
+	print <<'EOT';
+/* threaded code: each handler jumps straight to the next one */
+#define DISPATCH()	WRAP_CHECK(); INSN_HOOK(); goto *optab[RAM(PC++)];
+#define OPCODE(op)	op_ ## op
+#ifdef DEBUG
+#define NEXT		continue	/* go round the loop to check stopsim */
+#else
+#define NEXT		do {						\
+    WRAP_CHECK();							\
+    INSN_HOOK();							\
+    goto *optab[RAM(PC++)];						\
+} while (0)
+#endif
+#define BB_DISPATCH()	goto *bbtab[ins->xop];
+#define BB_OPCODE(op)	bb_op_ ## op
+#define BB_NEXT do {							\
+    ins++;								\
+    PC++;								\
+    goto *bbtab[ins->xop];						\
+} while (0)
+EOT
+    }
+    else {
+	print <<'EOT';
+#define DISPATCH()	WRAP_CHECK(); INSN_HOOK(); switch(RAM(PC++))
+#define OPCODE(op)	case 0x ## op
+#define NEXT		break
+#define BB_DISPATCH()	switch(ins->xop)
+#define BB_OPCODE(op)	case 0x ## op
+#define BB_NEXT		break
+EOT
+    }
+}
+
+# Turn the captured handlers of the main switch into handlers for the
+# block executor: immediate operands and relative branch targets come
+# from the pre-decoded record.  PC is still kept up to date, so the
+# prefixed op-codes run unchanged; they may move PC anywhere, so the
+# executor checks it against the next record after them.  A branch
+# always ends a block.
+sub bb_handlers {
+    local($sw) = @_;
+    local($out, $op, $body, $lab, %tail, @chunks);
+    @chunks = split(/^(?=\tOPCODE\()/m, $sw);
+    # a handler has to stand alone in a helper of jit.c: copy the code
+    # shared by the op-codes ($combine) in place of the jumps to it
+    foreach (@chunks) {
+	$tail{$1} = $2 if (/^\t(lab\w+):\n(.*)\z/ms);
+    }
+    foreach (@chunks) {
+	foreach $lab (keys %tail) {
+	    s/^\t$lab:\n//m;
+	    s/^\t+goto $lab;\n/$tail{$lab}/mg;
+	}
+    }
+    foreach (@chunks) {
+	($op) = /^\tOPCODE\(([0-9a-f]{2})\)/;
+	$body = $_;
+	if (defined($op) && $op !~ /^(cb|dd|ed|fd)$/) {
+	    $body =~ s/GetWORD\(PC\)/BB_IMM/g;
+	    $body =~ s/GetBYTE\(PC\+\+\)/(PC++, BB_IMM)/g;
+	    $body =~ s/PC \+= \(signed char\) GetBYTE\(PC\) \+ 1;/PC = ins->target;/g;
+	    $body =~ s/\b(JRC|JPC|CALLC|CALL)\(/BB_$1(/g;
+	    die "operand fetch left in op-code $op\n" if ($body =~ /(GetBYTE|GetWORD|RAM)\(PC/);
+	    $body =~ s/\bBRANCH_NEXT;/goto bb_enter;/g;
+	}
+	elsif (defined($op)) {
+	    $body =~ s/\b(CHECK_)?NEXT;/BB_NEXT_CHECK;/g;
+	}
+	$body =~ s/\bOPCODE\(/BB_OPCODE(/;
+	$body =~ s/\bNEXT;/BB_NEXT;/g;
+	$out .= $body;
+    }
+    # the labels of the handlers are there in the interpreter already
+    foreach $lab ($out =~ /^\s*([a-z]\w*):/mg) {
+	$out =~ s/\b$lab\b/bb_$lab/g if ($lab ne 'default');
+    }
+    return $out;
+}
+
+# Handlers of the block executor for the fused op-code pairs: the
+# handler of the first op-code followed by that of the second one.
+sub fused_handlers {
+    local($sw) = @_;
+    local(%h, %cmnt, $op, $a, $b, $body1, $body2, $n);
+    foreach (split(/^(?=\tBB_OPCODE\()/m, $sw)) {
+	next if (!/^\tBB_OPCODE\(([0-9a-f]{2})\):\s*\/\* (.*) \*\/\n/);
+	($op, $cmnt{$1}) = ($1, $2);
+	($h{$op} = $_) =~ s/^.*\n//;
+    }
+    print "#ifdef OPT_FUSION\n";
+    $n = 0x101;
+    foreach (@fuse) {
+	($a, $b) = (sprintf("%02x", $_->[0]), sprintf("%02x", $_->[1]));
+	$body1 = $h{$a};
+	$body2 = $h{$b};
+	printf("\tBB_OPCODE(%x):\t\t\t/* %s; %s */\n", $n++, $cmnt{$a}, $cmnt{$b});
+	if ($body1 !~ s/^\t\tBB_NEXT;\n\z//m || $body1 =~ /BB_NEXT|goto|return/) {
+	    # it ends in code shared with other op-codes ($combine): run
+	    # it alone, the second op-code has a record of its own
+	    print $h{$a};
+	    next;
+	}
+	print $body1;
+	print "\t\tBB_FUSE_NEXT($b);\n";
+	print $body2;
+    }
+    print "#endif\n";
+}
+
 sub postamble {
+    if ($optab) {
+	print $branchop ? "\tBRANCH_NEXT;\n" :
+	    $prefixop ? "\tCHECK_NEXT;\n" : "\tNEXT;\n" if ($needbreak);
+	select(STDOUT);
+	close(MAINSW);
+	print $mainsw;
+    }
     print <<'EOT';
     }
     }
-/* make registers visible for debugging if interrupted */
+EOT
+    print <<'EOT' if ($optab);
+    /* PC has run past 0FFFFH; kept apart from the dispatch, so that
+       it costs the dispatch no registers */
+wrapped:
+    PC &= 0xffff;
+    if (CYC < deadline)
+	goto dispatch;
+EOT
+    print "/* make registers visible for debugging if interrupted */\n";
+    print "expired:\n" if ($optab);
+    print <<'EOT';
     SAVE_STATE();
-    return (PC&0xffff)|0x10000;	/* flag non-bios stop */
+    return (PC&0xffff)|SIMZ80_STOP;	/* flag non-bios stop */
+EOT
+    if ($optab) {
+	print <<'EOT';
+
+#ifdef OPT_BBCACHE
+    /* run pre-decoded basic blocks while the code stays in the cache */
+bb_enter:
+#ifdef DEBUG
+    if (stopsim) {
+	SAVE_STATE();
+	return (PC&0xffff)|SIMZ80_STOP;
+    }
+#endif
+    if (CYC >= deadline)
+	goto expired;
+#if defined(OPT_PROFILE) || defined(OPT_TRACE)
+    if (cpu->prof != NULL || cpu->trace != NULL)
+	goto bb_interp;		/* see every instruction */
+#endif
+#ifdef OPT_JIT
+    if (cpu->jit.arena != NULL && cpu->bb->map[PC & 0xffff] != NULL) {
+	JIT_SAVE();
+	PC = jit_run(cpu, PC, deadline);
+	JIT_LOAD();
+	if (cpu->jit.deadline < deadline)
+	    deadline = cpu->jit.deadline;	/* cut by a helper */
+	if (PC & JIT_HALT) {
+	    PC &= 0xffff;
+	    SAVE_STATE();
+	    return PC;
+	}
+	if (CYC >= deadline)
+	    goto expired;
+    }
+#endif
+    if ((ins = bb_lookup(cpu, PC & 0xffff)) == NULL)
+	goto bb_interp;
+#ifdef OPT_FUSION
+    if (cpu->bb->pairs != NULL)
+	bb_count_pairs(cpu, ins);
+#endif
+    PC++;
+    for (;;) {
+	BB_DISPATCH() {
+EOT
+	$bbsw = &bb_handlers($mainsw);
+	print $bbsw;
+	print <<'EOT';
+	BB_OPCODE(100):			/* end of block or stale record */
+		PC--;
+		goto bb_enter;
+EOT
+	&fused_handlers($bbsw) if (@fuse);
+	print <<'EOT';
+	}
+	ins++;
+	PC++;
+    }
+#endif
+EOT
+    }
+    print "}\n";
+    return if ($variant);
+    print <<'EOT';
+
+/** Run Z80 code until HALT.
+    @param[in] cpu the machine
+    @param[in] PC  Z80 address to start at
+    @return the address of the HALT instruction
+ */
+FASTWORK
+simz80(struct z80_cpu *cpu, FASTREG PC)
+{
+    return simz80_run(cpu, PC, SIMZ80_FOREVER);
 }
 EOT
+    &jit_helpers(&bb_handlers($mainsw)) if ($optab);
+}
+
+# Emit a function for every handler of the block executor, which the
+# translated code of jit.c calls for the op-codes it does not expand.
+sub jit_helpers {
+    local($sw) = @_;
+    local($op, $body, $decl, $ixy, @vars, @tab);
+    print <<'EOT';
+
+#ifdef OPT_JIT
+#ifdef OPT_HLE
+/* the end of the run is kept for the translated code */
+#undef HLE_DEADLINE
+#define HLE_DEADLINE	cpu->jit.deadline
+#endif
+
+EOT
+    foreach (split(/^(?=\tBB_OPCODE\()/m, $sw)) {
+	($op) = /^\tBB_OPCODE\(([0-9a-f]{2})\)/;
+	next if (!defined($op) || $op eq "76");		# HALT
+	$body = $_;
+	$body =~ s/^\tBB_OPCODE\(..\):\s*(\/\*.*\*\/)\n/    $1\n/;
+	$body =~ s/^\s*(BB_NEXT|BB_NEXT_CHECK|goto bb_enter);\n//mg;
+	$body =~ s/\bdeadline\b/cpu->jit.deadline/g;
+	@vars = grep { $body =~ /\b$_\b/ } ('temp', 'acu', 'sum', 'cbits', 'op', 'adr');
+	$decl = @vars ? "    FASTWORK " . join(', ', @vars) . ";\n" : "";
+	# translated code keeps IX and IY in the machine ($dfd_inline);
+	# BB_CALL() saves the state for hle.c
+	$ixy = $dfd_inline && $body =~ /\bI[XY]\b|_STATE\(\)|\bBB_CALL/;
+	$decl = "    FASTREG IX = cpu->ix, IY = cpu->iy;\n" . $decl if ($ixy);
+	$body .= "    cpu->ix = IX;\n    cpu->iy = IY;\n" if ($ixy);
+	print <<"EOT";
+static FASTREG
+jit_op_$op(struct jit_regs *r, FASTREG PC, const struct bb_insn *ins)
+{
+    JIT_DECLARE_STATE();
+EOT
+	&lazydecl;
+	print <<"EOT";
+$decl
+$body
+    JIT_STORE_STATE();
+    return PC;
+}
+
+EOT
+	$tab[hex($op)] = "jit_op_$op";
+    }
+    print "jit_helper jit_optab[256] = {\n";
+    for (0..255) {
+	print "\t" if (($_ & 3) == 0);
+	print defined($tab[$_]) ? "$tab[$_]," : "NULL,";
+	print "\n" if (($_ & 3) == 3);
+    }
+    print "};\n";
+    print "#endif\n";
 }
@@ -0,0 +1,214 @@
+/*
+   SWORD Emurator  machine snapshot
+
+   A snapshot holds the registers, the memory, the S-OS special work,
+   the tape devices, the files of the session (the mounted disk images
+   and the open file) and the virtual screen.  It is laid out as it is
+   in memory: the header, then the memory and the special work, each
+   starting on a page.  snap_load() maps the file and copies the pages
+   into the machine, there is nothing to parse.
+
+   The cycle count of the machine goes on from where it is, so that
+   pending events and the pacing are not disturbed; the count at the
+   save is only recorded.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
+#include "simz80.h"
+#include "bbcache.h"
+#include "trap.h"
+#include "snap.h"
+
+/* offset rounded up to the next section */
+#define	SNAP_ROUND(_n)	( ( (_n) + SNAP_ALIGN - 1 ) & ~(size_t)( SNAP_ALIGN - 1 ) )
+
+/** Save a machine in a file.
+    @param[in] cpu  the machine
+    @param[in] file the file
+    @retval 0 success
+    @retval -1 out of memory, a file name of the session is too long,
+               or the file can not be written
+ */
+int
+snap_save(struct z80_cpu *cpu, const char *file){
+	struct snap_header *h;
+	size_t	size;
+	BYTE	*buf;
+	FILE	*fp;
+	int	i, rc;
+
+	size = SNAP_ROUND(sizeof(*h)) + SNAP_ROUND(sizeof(cpu->ram))
+	    + SNAP_ROUND(SNAP_WKSIZ);
+	buf = calloc(1, size);
+	if ( buf == NULL )
+		return -1;
+
+	h = (struct snap_header *)buf;
+	memcpy(h->magic, SNAP_MAGIC, sizeof(h->magic));
+	h->version = SNAP_VERSION;
+	h->order = SNAP_ORDER;
+	h->hsize = sizeof(*h);
+	h->ram = SNAP_ROUND(sizeof(*h));
+	h->wkram = h->ram + SNAP_ROUND(sizeof(cpu->ram));
+	h->size = size;
+	h->cycles = cpu->cycles;
+
+	for(i = 0; i < 2; ++i) {
+
+		h->af[i] = cpu->af[i];
+		h->bc[i] = cpu->regs[i].bc;
+		h->de[i] = cpu->regs[i].de;
+		h->hl[i] = cpu->regs[i].hl;
+	}
+	h->sp = cpu->sp;
+	h->pc = cpu->pc;
+	h->ix = cpu->ix;
+	h->iy = cpu->iy;
+	h->ir = ( cpu->ir & ~255 ) | Z80_R(cpu, cpu->cycles);
+	h->iff = cpu->IFF;
+	h->im = cpu->im;
+	h->af_sel = cpu->af_sel;
+	h->regs_sel = cpu->regs_sel;
+	h->irq = cpu->sched.irq;
+	memcpy(h->vector, cpu->sched.vector, sizeof(h->vector));
+
+	memcpy(buf + h->ram, cpu->ram, sizeof(cpu->ram));
+	trap_save(buf + h->wkram, h->tapes);
+	scr_save(&h->scr);
+	if ( dio_save(&h->dio) ) {
+
+		free(buf);
+		return -1;
+	}
+
+	rc = -1;
+	fp = fopen(file, "wb");
+	if ( fp != NULL ) {
+
+		if ( fwrite(buf, 1, size, fp) == size )
+			rc = 0;
+		if ( fclose(fp) != 0 )
+			rc = -1;
+	}
+
+	free(buf);
+	return rc;
+}
+
+/** Check the header of a snapshot.
+    @param[in] h    the header
+    @param[in] size size of the file
+    @retval 0 it is a snapshot of this build
+    @retval -1 it is not
+ */
+static int
+snap_check(const struct snap_header *h, size_t size){
+
+	if ( size < sizeof(*h) )
+		return -1;
+	if ( memcmp(h->magic, SNAP_MAGIC, sizeof(h->magic)) != 0
+	    || h->version != SNAP_VERSION || h->order != SNAP_ORDER
+	    || h->hsize != sizeof(*h) || h->size != size )
+		return -1;
+	/* in 64 bits: a file shorter than the memory must not wrap */
+	if ( h->ram < sizeof(*h)
+	    || (uint64_t)h->ram + 64*1024 > (uint64_t)size
+	    || h->wkram < sizeof(*h)
+	    || (uint64_t)h->wkram + SNAP_WKSIZ > (uint64_t)size )
+		return -1;
+	return 0;
+}
+
+/** Put a machine saved by snap_save() back.  The block cache is
+    flushed; a profile and a trace go on.
+    @param[in] cpu  the machine
+    @param[in] file the file
+    @retval 0 success
+    @retval -1 the file can not be read or is not a snapshot of this
+               build, and the machine is left alone; or the files of
+               the session can not be opened again, and the rest of the
+               machine is restored
+ */
+int
+snap_load(struct z80_cpu *cpu, const char *file){
+	const struct snap_header *h;
+	const BYTE *buf;
+	struct stat st;
+	size_t	size;
+	int	fd, i, rc;
+
+	fd = open(file, O_RDONLY);
+	if ( fd < 0 )
+		return -1;
+	if ( fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(*h) ) {
+
+		close(fd);
+		return -1;
+	}
+	size = st.st_size;
+#ifdef HAVE_MMAP
+	buf = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if ( buf == MAP_FAILED )
+		return -1;
+#else
+	buf = malloc(size);
+	rc = ( buf != NULL && read(fd, (void *)buf, size) == (ssize_t)size );
+	close(fd);
+	if ( !rc ) {
+
+		free((void *)buf);
+		return -1;
+	}
+#endif
+
+	h = (const struct snap_header *)buf;
+	rc = snap_check(h, size);
+	if ( rc == 0 ) {
+
+		for(i = 0; i < 2; ++i) {
+
+			cpu->af[i] = h->af[i];
+			cpu->regs[i].bc = h->bc[i];
+			cpu->regs[i].de = h->de[i];
+			cpu->regs[i].hl = h->hl[i];
+		}
+		cpu->sp = h->sp;
+		cpu->pc = h->pc;
+		cpu->ix = h->ix;
+		cpu->iy = h->iy;
+		cpu->ir = h->ir;
+		cpu->rbase = cpu->cycles;	/* R goes on from the save */
+		cpu->IFF = h->iff;
+		cpu->im = h->im;
+		cpu->af_sel = h->af_sel;
+		cpu->regs_sel = h->regs_sel;
+		cpu->sched.irq = h->irq;
+		memcpy(cpu->sched.vector, h->vector, sizeof(h->vector));
+		cpu->sched.next = 0;	/* have a look at the requests */
+
+		memcpy(cpu->ram, buf + h->ram, sizeof(cpu->ram));
+		bb_init(cpu);
+		trap_load(buf + h->wkram, h->tapes);
+		scr_load(&h->scr);
+		rc = dio_load(&h->dio);
+	}
+
+#ifdef HAVE_MMAP
+	munmap((void *)buf, size);
+#else
+	free((void *)buf);
+#endif
+	return rc;
+}
@@ -22,6 +22,17 @@
 #include "screen.h"
 #include "trap.h"
 #include "misc.h"
+#include "bbcache.h"
+#include "jit.h"
+#include "throttle.h"
+#include "sched.h"
+#include "prof.h"
+#include "disasm.h"
+#include "snap.h"
+#include "replay.h"
+#include "hle.h"
+#include "batch.h"
+#include "variant.h"
 
 #ifndef VERSION
 #define VERSION	"0.5 (beta)"		/* version */
@@ -38,25 +49,18 @@
 /* command processor state */
 #define	CCP_MODE_NONE	(0)
 #define	CCP_MODE_INIT	(1)	/* in initialize state, don't call other module */
-
-/* Z80 registers */
-WORD af[2];			/* accumulator and flags (2 banks) */
-int af_sel;			/* bank select for af */
-
-struct ddregs regs[2];		/* bc,de,hl */
-int regs_sel;			/* bank select for ddregs */
-
-WORD ir;			/* other Z80 registers */
-WORD ix;
-WORD iy;
-WORD sp;
-WORD pc;
-WORD IFF;
-
-BYTE ram[EM_MEMAX + 1];		/* Z80 memory space */
+#define	CCP_DISLINES	(16)	/* instructions listed by "dis" */
 
 static char *progname;
 char	*dosfile = NULL;	/* common DOS image file */
+static struct throttle pace;	/* real-speed pacing of the machine */
+static char *proffile = NULL;	/* file to write the profile to */
+static char *statsfile = NULL;	/* file to write the trap statistics to */
+static char *tracefile = NULL;	/* file to dump the instruction trace to */
+static char *snapfile = NULL;	/* snapshot to start from */
+static char *replayfile = NULL;	/* log to record to or replay */
+static int replaymode;		/* REPLAY_RECORD or REPLAY_PLAY */
+static __thread WORD disaddr;	/* where "dis" goes on */
 
 /* getopt declarations */
 extern int getopt();
@@ -67,8 +71,14 @@ extern int optind, opterr, optopt;
    quit emulator
 */
 void
-emu_quit(void){
+emu_quit(struct z80_cpu *cpu){
     (void) scr_finish();
+    if (proffile != NULL && prof_write(cpu, proffile))
+	fprintf(stderr,"profile: can not write <%s>\n", proffile);
+    if (statsfile != NULL && trap_stats_write(statsfile))
+	fprintf(stderr,"stats: can not write <%s>\n", statsfile);
+    if (replay_stop(cpu))
+	fprintf(stderr,"record: can not write <%s>\n", replayfile);
     exit(0);
 }
 
@@ -78,12 +88,14 @@ emu_quit(void){
    return true if quit command requested
 */
 int
-ccpline(char *p, int mode){
+ccpline(struct z80_cpu *cpu, char *p, int mode){
     char lbuf[CCP_LINLIM];
     char *np,c;
     char *cp;
     char *ref;
-    int n;
+    char *save;
+    char insn[DISASM_BUFSIZ];
+    int n, i, len;
     int rc;
 
     /* prompt & space skip */
@@ -91,7 +103,7 @@ ccpline(char *p, int mode){
 	p++;
     if (isupper(c))
 	c = tolower(c);
-    np = strtok(p, " ");	/* np := command name */
+    np = strtok_r(p, " ", &save);	/* np := command name */
     if (c == 'r' || c == 'q'){	/* return to emulator */
 	return(1);
     } else if (c == '#' || c == '\0'){
@@ -99,7 +111,11 @@ ccpline(char *p, int mode){
 	return(0);
     } else if (strcasecmp(np, "chdir") == 0 ||
 	       strcasecmp(np, "cd") == 0){
-	if ((np = strtok(NULL, " ")) != NULL){
+	if (scr_isbatch()){	/* the directory is shared by all sessions */
+	    scr_puts("cd: not available in batch mode\r");
+	    return(0);
+	}
+	if ((np = strtok_r(NULL, " ", &save)) != NULL){
 	    if (chdir(np)){
 		    snprintf(lbuf, CCP_LINLIM, "%s: %s\r", np, strerror(errno));
 		scr_puts(lbuf);
@@ -115,7 +131,7 @@ ccpline(char *p, int mode){
 	}
     } else if (strcasecmp(np, "dosfile") == 0){
 	if (mode == CCP_MODE_INIT){
-	    if ((np = strtok(NULL, " ")) != NULL)
+	    if ((np = strtok_r(NULL, " ", &save)) != NULL)
 		dosfile = strdup(np);
 	}
 	if (dosfile != NULL){
@@ -123,7 +139,7 @@ ccpline(char *p, int mode){
 	    scr_puts(lbuf);
 	}
     } else if (strcasecmp(np, "mount") == 0){
-	if ((np = strtok(NULL, " ")) == NULL){
+	if ((np = strtok_r(NULL, " ", &save)) == NULL){
 	    for (n=0; n<SOS_MAXIMAGEDRIVES; n++){
 		if (dio_disk[n] != NULL){
 			snprintf(lbuf, CCP_LINLIM,"disk#%d : %s\r", n, dio_disk[n]);
@@ -140,7 +156,7 @@ ccpline(char *p, int mode){
 	    scr_puts("bad drive number\r");
 	    return(0);
 	}
-	if ((np = strtok(NULL, " ")) == NULL){
+	if ((np = strtok_r(NULL, " ", &save)) == NULL){
 	    if (dio_disk[n] != NULL){
 		    snprintf(lbuf, CCP_LINLIM,
 			"unmount <%s> as disk#%d\r",dio_disk[n],n);
@@ -177,7 +193,7 @@ ccpline(char *p, int mode){
 		scr_puts(lbuf);
 	}
     } else if (strcasecmp(np, "keymap") == 0){
-	if ((np = strtok(NULL, " ")) == NULL){
+	if ((np = strtok_r(NULL, " ", &save)) == NULL){
 	    scr_puts("Current bindings:\r");
 	    for (n=0; n<(int)' '; n++){
 		if ((cp = scr_maplook(n)) != NULL){
@@ -188,7 +204,7 @@ ccpline(char *p, int mode){
 	    return(0);
 	}
 	cp = np;
-	if ((np = strtok(NULL, " ")) == NULL){
+	if ((np = strtok_r(NULL, " ", &save)) == NULL){
 	    scr_puts("must specify corresponding char\r");
 	    return(0);
 	}
@@ -210,7 +226,7 @@ ccpline(char *p, int mode){
 	}
 	return(0);
     } else if (strcmp(np, "keyclear") == 0){
-	if ((np = strtok(NULL, " ")) == NULL){
+	if ((np = strtok_r(NULL, " ", &save)) == NULL){
 	    scr_mapclear();
 	    scr_puts("Keymap cleared.\r");
 	} else {
@@ -231,12 +247,59 @@ ccpline(char *p, int mode){
 		scr_puts("unknown result\r");
 	    }
 	}
+    } else if (strcasecmp(np, "dis") == 0){
+	if ((np = strtok_r(NULL, " ", &save)) != NULL)
+	    disaddr = (WORD) strtol(np, NULL, 16);
+	np = strtok_r(NULL, " ", &save);
+	n = (np != NULL) ? atoi(np) : CCP_DISLINES;
+	while (n-- > 0){
+	    len = disasm_ram(cpu, disaddr, insn, sizeof(insn));
+	    snprintf(lbuf, CCP_LINLIM, "%04X ", disaddr);
+	    for (i = 0; i < DISASM_MAX; i++)
+		snprintf(lbuf + strlen(lbuf), CCP_LINLIM - strlen(lbuf),
+		    (i < len) ? " %02X" : "   ", RAM(disaddr + i));
+	    snprintf(lbuf + strlen(lbuf), CCP_LINLIM - strlen(lbuf),
+		"  %s\r", insn);
+	    scr_puts(lbuf);
+	    disaddr += len;
+	}
+    } else if (strcasecmp(np, "save") == 0 ||
+	       strcasecmp(np, "load") == 0){
+	cp = np;
+	if ((np = strtok_r(NULL, " ", &save)) == NULL){
+	    snprintf(lbuf, CCP_LINLIM, "%s: no snapshot file\r", cp);
+	    scr_puts(lbuf);
+	    return(0);
+	}
+	if (mode == CCP_MODE_INIT){
+	    snprintf(lbuf, CCP_LINLIM, "%s: not available at startup\r", cp);
+	    scr_puts(lbuf);
+	    return(0);
+	}
+	if (tolower(*cp) == 's')
+	    rc = snap_save(cpu, np);
+	else
+	    rc = snap_load(cpu, np);
+	if (rc){
+	    snprintf(lbuf, CCP_LINLIM, "%s: can not %s <%s>\r", cp, cp, np);
+	    scr_puts(lbuf);
+	}
+    } else if (strcasecmp(np, "trace") == 0){
+	np = strtok_r(NULL, " ", &save);
+	trace_print(cpu, (np != NULL) ? atoi(np) : TRACE_SHOW);
+    } else if (strcasecmp(np, "stats") == 0){
+	trap_stats_print(strtok_r(NULL, " ", &save));
     } else if (c == '?'){
 	scr_puts("ret                      .. return to SWORD\r"
 		 "cd [directory]           .. chdir\r"
 		 "mount [drive [filename]] .. mount/umount disk image file\r"
 		 "keymap [function char]   .. map function to control code\r"
 		 "keyclear [char]          .. clear current keymap\r"
+		 "dis [addr [count]]       .. disassemble Z80 code\r"
+		 "save filename            .. save the machine in a snapshot\r"
+		 "load filename            .. restore the machine from a snapshot\r"
+		 "stats [trap]             .. display trap call statistics\r"
+		 "trace [count]            .. display the last instructions run\r"
 		 "?                        .. display this help\r"
 		 /* "! .. shell command\r" */
 		 );
@@ -263,19 +326,19 @@ ccpline(char *p, int mode){
    SWORD shell
 */
 void
-ccp(void){
+ccp(struct z80_cpu *cpu){
     char	buf[CCP_LINLIM];
 
     for(;;){
 	scr_puts("\r$ ");		/* prompt */
 	(void) scr_getl(buf);
-	if (ccpline(buf, CCP_MODE_NONE))
+	if (ccpline(cpu, buf, CCP_MODE_NONE) || scr_keys_exhausted())
 	    return;
     }
 }
 
 void
-readrc(void){
+readrc(struct z80_cpu *cpu){
 	FILE	*fp;
 	char	*rcfilename=NULL;
 	char	*homedir=NULL;
@@ -319,7 +382,7 @@ readrc(void){
 			--len;
 		}
 
-		ccpline(buf, CCP_MODE_INIT);
+		ccpline(cpu, buf, CCP_MODE_INIT);
 	}
 
 	fclose(fp);
@@ -343,7 +406,7 @@ readrc(void){
    no file conversion
 */
 int
-fileload(char *name, int addr){
+fileload(struct z80_cpu *cpu, char *name, int addr){
     int		fattr, fdtadr, fexadr, fsize;
     BYTE	*p;
     int		r;
@@ -355,41 +418,65 @@ fileload(char *name, int addr){
 	addr = fdtadr;
     addr &= 0xffff;
 
-    return(dio_rdd(ram + addr, fsize));
+    r = dio_rdd(cpu->ram + addr, fsize);
+    BB_INVALIDATE(addr, fsize);
+    return(r);
 }
 
 
 
+/*
+   load a program given by the command line, and tell if it fails
+
+   return 0 if success
+*/
+static int
+loadprog(struct z80_cpu *cpu, char *name, int addr){
+    if (fileload(cpu, name, addr)){
+	scr_puts("load: failed to load <");
+	scr_puts(name);
+	scr_puts(">\r");
+	return(1);
+    }
+    return(0);
+}
+
 void
-coldboot(void){
-    (void) trap_init();
+coldboot(struct z80_cpu *cpu){
+    (void) trap_init(cpu);
+    bb_init(cpu);
 
-    sp = EM_STKAD;
+    cpu->sp = EM_STKAD;
 }
 
 int
-z80loop(void){
+z80loop(struct z80_cpu *cpu){
     int	r;
     WORD	xpc;
 
     for(;;){
-	switch((r = trap((int) ram[simz80(pc)]))){
+	sched_run(cpu);
+	r = SIMZ80_RUN(cpu, cpu->pc,
+	    sched_budget(cpu, throttle_budget(&pace, cpu->cycles)));
+	if (r & SIMZ80_STOP)
+	    continue;		/* end of a time slice, or an event */
+	switch((r = trap(cpu, (int) cpu->ram[r]))){
 	  case TRAP_NEXT:
-	    pc++;
+	    cpu->pc++;
 	    break;
 	  case TRAP_HOLD:
 	    break;
 	  case TRAP_COLD:
-	    xpc = pc;		/* backup PC */
-	    coldboot();
-	    pc = xpc;
+	    xpc = cpu->pc;	/* backup PC */
+	    coldboot(cpu);
+	    cpu->pc = xpc;
 	    break;
 	  case TRAP_MON:
-	    ccp();
-	    pc++;
+	    cpu->pc++;		/* a snapshot goes on after the trap */
+	    ccp(cpu);
 	    break;
 	  case TRAP_QUIT:
-	    emu_quit();
+	    emu_quit(cpu);
 	    /* not reach */
 	  default:
 	    fprintf(stderr,"SOS: unkown trap result %d\n", r);
@@ -401,22 +488,23 @@ z80loop(void){
 }
 
 /** Try to load the sword dos file from a user directory or the system data directory.
+    @param[in] cpu the machine
     @retval 0 success
     @retval -1 Can not load the sword dos module.
  */
-static int
-setup_dos_file(void){
+int
+setup_dos_file(struct z80_cpu *cpu){
 	int                           rc;
 	char pathname[SOS_UNIX_PATH_MAX];
 
-	rc = fileload(dosfile, -1); /* load from current directory. */
+	rc = fileload(cpu, dosfile, -1); /* load from current directory. */
 
 	if ( rc != 0 ) { /* File not found on current directory. */
 
 		/* load from data directory. */
 		snprintf(pathname, SOS_UNIX_PATH_MAX,
 		    "%s/%s", DATADIR, dosfile);
-		rc = fileload(pathname, -1);
+		rc = fileload(cpu, pathname, -1);
 		if ( rc != 0 )
 			goto err_out;
 
@@ -427,9 +515,8 @@ setup_dos_file(void){
 	scr_puts("load: failed to load dos module <");
 	scr_puts(dosfile);
 	scr_puts(">\r");
-	(void) scr_finish();
 
-	exit(1);
+	return -1;
 }
 
 int
@@ -440,11 +527,19 @@ main(int argc, char **argv)
     int	    loadaddr = -1;
     int     jumpaddr = -1;
     char *loadfile = NULL;
+    int       usejit = 0;
+    int       usehle = 0;
+    unsigned long vsyncrate = 0;
+    unsigned long long vsync = 0;
+    char *jobfile = NULL;
+    struct batch_opts batch;
+    struct z80_cpu *cpu;
 
     /* default */
     dosfile = DOSFILE;
+    memset(&batch, 0, sizeof(batch));
 
-    while ((c = getopt(argc, argv, "l:a:j:d:c")) != EOF){
+    while ((c = getopt(argc, argv, "l:a:j:d:C:B:T:L:F:P:S:t:s:f:R:r:X:V:cJH")) != EOF){
 	switch (c) {
 	  case 'l':
 	    loadfile = optarg;
@@ -460,16 +555,117 @@ main(int argc, char **argv)
 	    break;
 	  case 'c':
 	    scr_caps(1);	/* enable caps lock */
+	    batch.caps = 1;
+	    break;
+	  case 'J':
+	    usejit = 1;		/* run hot code as host code */
+	    batch.jit = 1;
+	    break;
+	  case 'H':
+	    usehle = 1;		/* run known routines as host code */
+	    batch.hle = 1;
+	    break;
+	  case 'B':
+	    jobfile = optarg;	/* run the sessions of a job file */
+	    break;
+	  case 'T':
+	    batch.threads = atoi(optarg);	/* workers of a batch run */
+	    break;
+	  case 'L':
+	    batch.limit = strtoull(optarg, NULL, 10);	/* T-states per session */
+	    break;
+	  case 'F':
+	    batch.pairs = optarg;	/* count the op-code pairs run */
+	    break;
+	  case 'P':
+	    proffile = optarg;	/* profile the Z80 code */
+	    batch.profile = optarg;
+	    break;
+	  case 'S':
+	    statsfile = optarg;	/* write the trap statistics at exit */
+	    batch.stats = optarg;
+	    break;
+	  case 't':
+	    tracefile = optarg;	/* record the last instructions run */
+	    batch.trace = optarg;
+	    break;
+	  case 's':
+	    snapfile = optarg;	/* start from a snapshot */
+	    batch.snapshot = optarg;
+	    break;
+	  case 'R':
+	    replayfile = optarg;	/* record the inputs */
+	    replaymode = REPLAY_RECORD;
+	    batch.replay = optarg;
+	    batch.replaymode = REPLAY_RECORD;
+	    break;
+	  case 'r':
+	    replayfile = optarg;	/* replay recorded inputs */
+	    replaymode = REPLAY_PLAY;
+	    batch.replay = optarg;
+	    batch.replaymode = REPLAY_PLAY;
+	    break;
+	  case 'f':
+	    batch.fork = 1;	/* fork the sessions at an address */
+	    batch.forkpc = (WORD) strtol(optarg, NULL, 16);
+	    break;
+	  case 'X':
+	    if (strcmp(optarg, "list") == 0){	/* the interpreters built in */
+		simz80_list();
+		return(0);
+	    }
+	    if (strcmp(optarg, "bench") == 0){	/* time them, for configure */
+		if (simz80_bench()){
+		    fprintf(stderr,"%s: variants: not available (configure --with-variants)\n", argv[0]);
+		    return(1);
+		}
+		return(0);
+	    }
+	    if (simz80_select(optarg)){	/* run the machines with one */
+		fprintf(stderr,"%s: no interpreter variant <%s>\n", argv[0], optarg);
+		simz80_list();
+		return(1);
+	    }
+	    break;
+	  case 'V':
+	    vsyncrate = strtoul(optarg, NULL, 10);	/* vsync interrupts a second */
+	    if (vsyncrate == 0){
+		fprintf(stderr,"%s: bad vsync rate <%s>\n", argv[0], optarg);
+		return(1);
+	    }
+	    break;
+	  case 'C':
+	    if (throttle_set(&pace, optarg)){	/* pace the CPU, e.g. 4MHz */
+		fprintf(stderr,"%s: bad clock frequency <%s>\n", argv[0], optarg);
+		return(1);
+	    }
 	    break;
 	  case '?':
-	    fprintf(stderr,"%s: [-d dosfile] [-a addr] [-l file] [-j addr] [-c]\n", argv[0]);
+	    fprintf(stderr,"%s: [-d dosfile] [-a addr] [-l file] [-j addr] [-c] [-J] [-H] [-C clock] [-V rate] [-P file] [-S file] [-t file] [-s snapshot] [-R log | -r log] [-X variant]\n", argv[0]);
+	    fprintf(stderr,"%s: -B jobfile [-d dosfile] [-c] [-J] [-H] [-V rate] [-T threads] [-L cycles] [-F pairfile] [-P file] [-S file] [-t file] [-s snapshot] [-R log | -r log] [-f addr] [-X variant]\n", argv[0]);
 	    return(1);
 	}
     }
 
+    /* frames in T-states of the paced clock, or of an X1 */
+    if (vsyncrate != 0)
+	vsync = ((pace.hz != 0) ? pace.hz : SCHED_CLOCK) / vsyncrate;
+    batch.vsync = vsync;
+    if (pace.hz != 0)
+	scr_clock(pace.hz);	/* an idle #GETKY loop waits at that pace */
+
+    if (jobfile != NULL)
+	return(batch_run(jobfile, &batch));	/* no terminal */
+
+    if ((cpu = z80_new()) == NULL){
+	fprintf(stderr,"%s: out of memory\n", argv[0]);
+	return(1);
+    }
+
     /* initialize screen */
     if (scr_initx())
 	return(1);
+    scr_attach(cpu);
     /* define default keymap */
     setdefaultkeymap();
 
@@ -479,31 +675,66 @@ main(int argc, char **argv)
 	 "This program comes with ABSOLUTELY NO WARRANTY; for details\r"
 	 "see the file \"COPYING\" in the distribution directory.\r\r");
 
-    readrc();
+    readrc(cpu);
 
-    setup_dos_file();
-
-    if (loadfile != NULL){
-	if (fileload(loadfile, loadaddr)){
-	    scr_puts("load: failed to load <");
-	    scr_puts(loadfile);
+    if (snapfile == NULL){
+	if (setup_dos_file(cpu)){
+	    (void) scr_finish();
+	    return(1);
+	}
+	if (loadfile != NULL && loadprog(cpu, loadfile, loadaddr)){
+	    (void)scr_finish();
+	    return(1);
+	}
+	coldboot(cpu);
+    } else {
+	/* the snapshot replaces the dos file, a program goes onto it */
+	coldboot(cpu);
+	if (snap_load(cpu, snapfile)){
+	    scr_puts("load: can not load <");
+	    scr_puts(snapfile);
 	    scr_puts(">\r");
 	    (void)scr_finish();
 	    return(1);
 	}
+	if (loadfile != NULL && loadprog(cpu, loadfile, loadaddr)){
+	    (void)scr_finish();
+	    return(1);
+	}
     }
 
-    coldboot();
+    if (usejit && jit_init(cpu))
+	scr_puts("jit: dynamic recompiler is not available\r");
+
+    if (usehle && hle_start(cpu))
+	scr_puts("hle: not available (configure --with-hle)\r");
+
+    if (vsync != 0 && sched_vsync(cpu, vsync))
+	scr_puts("vsync: can not start the timer\r");
+
+    if (proffile != NULL && prof_start(cpu))
+	scr_puts("profile: not available (configure --with-profile)\r");
+
+    if (tracefile != NULL && trace_start(cpu, tracefile))
+	scr_puts("trace: not available (configure --with-trace)\r");
+
+    if (replayfile != NULL && replay_start(cpu, replayfile, replaymode)){
+	scr_puts("replay: can not open <");
+	scr_puts(replayfile);
+	scr_puts(">\r");
+	(void)scr_finish();
+	return(1);
+    }
 
     if (jumpaddr > 0){
-	z80_push(SOS_BOOT);		/* quit address */
-	pc = jumpaddr;
-    } else {
-	pc = SOS_COLD;
+	z80_push(cpu, SOS_BOOT);	/* quit address */
+	cpu->pc = jumpaddr;
+    } else if (snapfile == NULL){
+	cpu->pc = SOS_COLD;
     }
-    z80loop();
+    z80loop(cpu);
 
-    emu_quit();
+    emu_quit(cpu);
     /* not reach */
 
     return(0);	/* against compiler's warning */
@@ -0,0 +1,123 @@
+/*
+   SWORD Emurator  real-speed throttling
+
+   The emulated CPU runs in slices of THROTTLE_SLICE_NS worth of
+   T-states.  At the end of each slice the emulator sleeps until the
+   host monotonic clock reaches the time the slice should have ended
+   at, so that a throttled session sleeps a few hundred times per
+   second instead of once per instruction.  The schedule is absolute:
+   a slice which ends late is made up by the following ones.  If the
+   emulator falls more than THROTTLE_LAG_NS behind (e.g. while a trap
+   waits for a key), the schedule restarts from the current time.
+*/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include "compat.h"
+#include "simz80.h"
+#include "throttle.h"
+
+#define	NSEC	(1000000000L)
+
+/** Parse and set the emulated clock frequency.
+    @param[in] t     the pace
+    @param[in] spec  frequency, e.g. "4MHz", "3.58mhz", "4000kHz", "4000000"
+    @retval  0  success
+    @retval -1  malformed frequency
+ */
+int
+throttle_set(struct throttle *t, const char *spec){
+	char	*end;
+	double	hz;
+
+	hz = strtod(spec, &end);
+	if (end == spec || hz <= 0)
+		return -1;
+	if (*end == 'M' || *end == 'm'){
+		hz *= 1000000;
+		end++;
+	} else if (*end == 'K' || *end == 'k'){
+		hz *= 1000;
+		end++;
+	}
+	if ((end[0] == 'H' || end[0] == 'h') && (end[1] == 'Z' || end[1] == 'z'))
+		end += 2;
+	if (*end != '\0' || hz < 1000 || hz > 1e10)
+		return -1;
+
+	t->hz = (unsigned long) hz;
+	t->slice = (unsigned long long) t->hz * THROTTLE_SLICE_NS / NSEC;
+	t->slice_end = 0;	/* restart the schedule */
+	return 0;
+}
+
+/** Sleep until the host clock catches up with the machine.
+    @param[in] t      the pace
+    @param[in] cycles cycle count of the machine
+ */
+static void
+throttle_wait(struct throttle *t, unsigned long long cycles){
+	struct timespec	now, target;
+	unsigned long long ns;
+
+	ns = (cycles - t->base_cycles) * NSEC / t->hz;
+	target.tv_sec = t->base_time.tv_sec + ns / NSEC;
+	target.tv_nsec = t->base_time.tv_nsec + ns % NSEC;
+	if (target.tv_nsec >= NSEC){
+		target.tv_sec++;
+		target.tv_nsec -= NSEC;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (now.tv_sec < target.tv_sec
+	    || (now.tv_sec == target.tv_sec && now.tv_nsec < target.tv_nsec)){
+#ifdef	HAVE_CLOCK_NANOSLEEP
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+			   &target, NULL) == EINTR)
+			;
+#else
+		struct timespec	rest;
+
+		rest.tv_sec = target.tv_sec - now.tv_sec;
+		rest.tv_nsec = target.tv_nsec - now.tv_nsec;
+		if (rest.tv_nsec < 0){
+			rest.tv_sec--;
+			rest.tv_nsec += NSEC;
+		}
+		while (nanosleep(&rest, &rest) < 0 && errno == EINTR)
+			;
+#endif
+	} else if ((now.tv_sec - target.tv_sec) * NSEC
+	    + (now.tv_nsec - target.tv_nsec) > THROTTLE_LAG_NS)
+		target = now;	/* too far behind, do not race to catch up */
+
+	/* rebase on every slice, so that the products above never overflow */
+	t->base_time = target;
+	t->base_cycles = cycles;
+}
+
+/** Cycle budget for the next simz80_run().
+    Sleeps first if the current slice is used up.
+    @param[in] t      the pace
+    @param[in] cycles cycle count of the machine
+    @retval  T-states left in the current slice, SIMZ80_FOREVER if
+	     the machine is not throttled
+ */
+unsigned long long
+throttle_budget(struct throttle *t, unsigned long long cycles){
+	if (t->hz == 0)
+		return SIMZ80_FOREVER;
+
+	if (t->slice_end == 0){		/* first slice */
+		clock_gettime(CLOCK_MONOTONIC, &t->base_time);
+		t->base_cycles = cycles;
+		t->slice_end = cycles + t->slice;
+	} else if (cycles >= t->slice_end){
+		throttle_wait(t, cycles);
+		t->slice_end = cycles + t->slice;
+	}
+	return t->slice_end - cycles;
+}
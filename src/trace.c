@@ -0,0 +1,196 @@
+/*
+   SWORD Emurator  instruction trace
+
+   While a machine is traced, simz80_run() interprets every instruction
+   and calls trace_insn() before it runs, which records the address,
+   the bytes there and the registers in a ring of the last TRACE_SIZE
+   instructions; the cached blocks and the translated code are left
+   alone.  Nothing is written until the ring is dumped:
+
+	- by trap() on an invalid trap, the usual end of a program which
+	  ran away,
+	- when SIGINT is caught (trace_intr() is called by the handler;
+	  the next instruction of every traced machine dumps its ring),
+	- by the "trace" command of the command processor, on the screen.
+
+   A dump is appended to the file given to trace_start().
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simz80.h"
+#include "screen.h"
+#include "disasm.h"
+#include "trace.h"
+
+/* interrupts caught, see trace_intr() */
+volatile sig_atomic_t trace_intrs = 0;
+
+/** Start tracing a machine.
+    @param[in] cpu  the machine
+    @param[in] file file to append the dumps to
+    @retval 0 success
+    @retval -1 out of memory, or the trace is not compiled in
+ */
+int
+trace_start(struct z80_cpu *cpu, const char *file){
+#ifdef OPT_TRACE
+	struct trace *t;
+
+	if ( cpu->trace != NULL )
+		return 0;
+
+	t = calloc(1, sizeof(struct trace));
+	if ( t == NULL )
+		return -1;
+	t->file = strdup(file);
+	if ( t->file == NULL ) {
+
+		free(t);
+		return -1;
+	}
+	t->intr = trace_intrs;
+	cpu->trace = t;
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/** Stop tracing a machine and throw the trace away.
+    @param[in] cpu the machine
+ */
+void
+trace_stop(struct z80_cpu *cpu){
+
+	if ( cpu->trace == NULL )
+		return;
+	free(cpu->trace->file);
+	free(cpu->trace);
+	cpu->trace = NULL;
+}
+
+/** Record an instruction which is about to run.
+    @param[in] cpu the machine
+    @param[in] pc  address of the instruction
+    @param[in] af  AF register
+    @param[in] bc  BC register
+    @param[in] de  DE register
+    @param[in] hl  HL register
+    @param[in] ix  IX register
+    @param[in] iy  IY register
+    @param[in] sp  the stack pointer
+ */
+void
+trace_insn(struct z80_cpu *cpu, WORD pc, WORD af, WORD bc, WORD de, WORD hl,
+    WORD ix, WORD iy, WORD sp){
+	struct trace *t = cpu->trace;
+	struct trace_ent *e;
+
+	e = &t->ent[t->n++ & ( TRACE_SIZE - 1 )];
+	e->pc = pc;
+	e->sp = sp;
+	e->af = af;
+	e->bc = bc;
+	e->de = de;
+	e->hl = hl;
+	e->ix = ix;
+	e->iy = iy;
+	e->op[0] = RAM(pc);
+	e->op[1] = RAM(pc + 1);
+	e->op[2] = RAM(pc + 2);
+	e->op[3] = RAM(pc + 3);
+
+	if ( t->intr != trace_intrs ) {
+
+		t->intr = trace_intrs;
+		(void)trace_dump(cpu, "interrupted");
+	}
+}
+
+/** Format an entry.
+    @param[out] buf the line
+    @param[in]  len size of buf
+    @param[in]  e   the entry
+ */
+static void
+trace_format(char *buf, size_t len, const struct trace_ent *e){
+	char insn[DISASM_BUFSIZ];
+
+	(void)disasm(e->op, e->pc, insn, sizeof(insn));
+	snprintf(buf, len, "%04X  %-16s AF=%04X BC=%04X DE=%04X HL=%04X "
+	    "IX=%04X IY=%04X SP=%04X", e->pc, insn, e->af, e->bc, e->de, e->hl,
+	    e->ix, e->iy, e->sp);
+}
+
+/** Append the ring of a machine to its file, the oldest entry first.
+    @param[in] cpu the machine
+    @param[in] why what caused the dump
+    @retval 0 success
+    @retval -1 the machine is not traced, or the file can not be written
+ */
+int
+trace_dump(struct z80_cpu *cpu, const char *why){
+	const struct trace *t = cpu->trace;
+	unsigned long long i;
+	char buf[128];
+	FILE *fp;
+
+	if ( t == NULL )
+		return -1;
+
+	fp = fopen(t->file, "a");
+	if ( fp == NULL )
+		return -1;
+
+	fprintf(fp, "# %s after %llu instructions\n", why, t->n);
+	i = ( t->n > TRACE_SIZE ) ? t->n - TRACE_SIZE : 0;
+	for(; i < t->n; ++i) {
+
+		trace_format(buf, sizeof(buf), &t->ent[i & ( TRACE_SIZE - 1 )]);
+		fprintf(fp, "%s\n", buf);
+	}
+
+	return ( fclose(fp) != 0 ) ? -1 : 0;
+}
+
+/** Print the last entries of the ring of a machine on the screen.
+    @param[in] cpu the machine
+    @param[in] n   entries to print
+ */
+void
+trace_print(struct z80_cpu *cpu, int n){
+	const struct trace *t = cpu->trace;
+	unsigned long long i;
+	char buf[128];
+
+	if ( t == NULL ) {
+
+		scr_puts("trace: not traced (sos -t file)\r");
+		return;
+	}
+
+	if ( n <= 0 || n > TRACE_SIZE )
+		n = TRACE_SIZE;
+	i = ( t->n > (unsigned long long)n ) ? t->n - n : 0;
+	for(; i < t->n; ++i) {
+
+		trace_format(buf, sizeof(buf), &t->ent[i & ( TRACE_SIZE - 1 )]);
+		scr_puts(buf);
+		scr_puts("\r");
+	}
+}
+
+/** Have every traced machine dump its ring.  This may be called from a
+    signal handler.
+    @param[in] sig the signal caught
+ */
+void
+trace_intr(int sig){
+
+	(void)sig;
+	trace_intrs++;
+}
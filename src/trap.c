@@ -14,70 +14,73 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
+#include "compat.h"
 #include "simz80.h"
 #include "trap.h"
 #include "sos.h"
 #include "screen.h"
 #include "util.h"
 #include "dio.h"
+#include "bbcache.h"
 
 /*
    trap functions
 */
-int sos_cold(void);
-int sos_ver(void);
-int sos_print(void);
-int sos_prints(void);
-int sos_ltnl(void);
-int sos_nl(void);
-int sos_msg(void);
-int sos_msx(void);
-int sos_mprint(void);
-int sos_tab(void);
-int sos_lprint(void);
-int sos_lpton(void);
-int sos_lptof(void);
-int sos_getl(void);
-int sos_getky(void);
-int sos_brkey(void);
-int sos_inkey(void);
-int sos_pause(void);
-int sos_bell(void);
-int sos_prthx(void);
-int sos_prthl(void);
-int sos_asc(void);
-int sos_hex(void);
-int sos_2hex(void);
-int sos_hlhex(void);
-int sos_fcb(void);
-int sos_file(void);
-int sos_fsame(void);
-int sos_fprnt(void);
-int sos_poke(void);
-int sos_pokea(void);
-int sos_peek(void);
-int sos_peeka(void);
-int sos_mon(void);
-int sos_hl(void);
-int sos_getpc(void);
-int sos_csr(void);
-int sos_scrn(void);
-int sos_loc(void);
-int sos_flget(void);
-int sos_inp(void);
-int sos_out(void);
-int sos_widch(void);
-int sos_dread(void);
-int sos_dwrite(void);
-int sos_rdi(void);
-int sos_tropn(void);
-int sos_wri(void);
-int sos_twrd(void);
-int sos_trdd(void);
-int sos_tdir(void);
-int sos_parsc(void);
-int sos_parcs(void);
-int sos_boot(void);
+int sos_cold(struct z80_cpu *cpu);
+int sos_ver(struct z80_cpu *cpu);
+int sos_print(struct z80_cpu *cpu);
+int sos_prints(struct z80_cpu *cpu);
+int sos_ltnl(struct z80_cpu *cpu);
+int sos_nl(struct z80_cpu *cpu);
+int sos_msg(struct z80_cpu *cpu);
+int sos_msx(struct z80_cpu *cpu);
+int sos_mprint(struct z80_cpu *cpu);
+int sos_tab(struct z80_cpu *cpu);
+int sos_lprint(struct z80_cpu *cpu);
+int sos_lpton(struct z80_cpu *cpu);
+int sos_lptof(struct z80_cpu *cpu);
+int sos_getl(struct z80_cpu *cpu);
+int sos_getky(struct z80_cpu *cpu);
+int sos_brkey(struct z80_cpu *cpu);
+int sos_inkey(struct z80_cpu *cpu);
+int sos_pause(struct z80_cpu *cpu);
+int sos_bell(struct z80_cpu *cpu);
+int sos_prthx(struct z80_cpu *cpu);
+int sos_prthl(struct z80_cpu *cpu);
+int sos_asc(struct z80_cpu *cpu);
+int sos_hex(struct z80_cpu *cpu);
+int sos_2hex(struct z80_cpu *cpu);
+int sos_hlhex(struct z80_cpu *cpu);
+int sos_fcb(struct z80_cpu *cpu);
+int sos_file(struct z80_cpu *cpu);
+int sos_fsame(struct z80_cpu *cpu);
+int sos_fprnt(struct z80_cpu *cpu);
+int sos_poke(struct z80_cpu *cpu);
+int sos_pokea(struct z80_cpu *cpu);
+int sos_peek(struct z80_cpu *cpu);
+int sos_peeka(struct z80_cpu *cpu);
+int sos_mon(struct z80_cpu *cpu);
+int sos_hl(struct z80_cpu *cpu);
+int sos_getpc(struct z80_cpu *cpu);
+int sos_csr(struct z80_cpu *cpu);
+int sos_scrn(struct z80_cpu *cpu);
+int sos_loc(struct z80_cpu *cpu);
+int sos_flget(struct z80_cpu *cpu);
+int sos_inp(struct z80_cpu *cpu);
+int sos_out(struct z80_cpu *cpu);
+int sos_widch(struct z80_cpu *cpu);
+int sos_dread(struct z80_cpu *cpu);
+int sos_dwrite(struct z80_cpu *cpu);
+int sos_rdi(struct z80_cpu *cpu);
+int sos_tropn(struct z80_cpu *cpu);
+int sos_wri(struct z80_cpu *cpu);
+int sos_twrd(struct z80_cpu *cpu);
+int sos_trdd(struct z80_cpu *cpu);
+int sos_tdir(struct z80_cpu *cpu);
+int sos_parsc(struct z80_cpu *cpu);
+int sos_parcs(struct z80_cpu *cpu);
+int sos_boot(struct z80_cpu *cpu);
 
 /*
    trap function table
@@ -85,91 +88,107 @@ int sos_boot(void);
 struct functbl {
     /* pointer of function of the trap
        if func == NULL, "JP zaddr" is used instead */
-    int	(*func)(void);
+    int	(*func)(struct z80_cpu *cpu);
     /* Z80 address of the trap entry */
     WORD	calladdr;
     /* Z80 address of proxy entry */
     WORD	zaddr;
+    /* name in the trap statistics */
+    const char	*name;
 } sos_funcs[] = {
-  { sos_cold, 0x1ffd , 0},
-  { NULL, 0x1ffa , 0x2100},		/* #hot */
-  { sos_ver, 0x1ff7 , 0},
-  { sos_print, 0x1ff4 , 0},
-  { sos_prints, 0x1ff1 , 0},
-  { sos_ltnl, 0x1fee , 0},
-  { sos_nl, 0x1feb , 0},
-  { sos_msg, 0x1fe8, 0},
-  { sos_msx, 0x1fe5, 0},
-  { sos_mprint, 0x1fe2, 0},
-  { sos_tab, 0x1fdf, 0},
-  { sos_lprint, 0x1fdc, 0},
-  { sos_lpton, 0x1fd9, 0},
-  { sos_lptof, 0x1fd6, 0},
-  { sos_getl, 0x1fd3, 0},
-  { sos_getky, 0x1fd0, 0},
-  { sos_brkey, 0x1fcd, 0},
-  { sos_inkey, 0x1fca, 0},
-  { sos_pause, 0x1fc7, 0},
-  { sos_bell, 0x1fc4, 0},
-  { sos_prthx, 0x1fc1, 0},
-  { sos_prthl, 0x1fbe, 0},
-  { sos_asc, 0x1fbb, 0},
-  { sos_hex, 0x1fb8, 0},
-  { sos_2hex, 0x1fb5, 0},
-  { sos_hlhex, 0x1fb2, 0},
-  { NULL, 0x1faf, 0x22b3},		/* #wopen */
-  { NULL, 0x1fac, 0x232d},		/* #wrd */
-  { sos_fcb, 0x1fa9, 0},		/* #fcb */
-  { NULL, 0x1fa6, 0x234f},		/* #rdd */
-  { sos_file, 0x1fa3, 0},
-  { sos_fsame, 0x1fa0, 0},
-  { sos_fprnt, 0x1f9d, 0},
-  { sos_poke, 0x1f9a, 0},
-  { sos_pokea, 0x1f97, 0},
-  { sos_peek, 0x1f94, 0},
-  { sos_peeka, 0x1f91, 0},
-  { sos_mon, 0x1f8e, 0},
-  { sos_hl, 0x1f81, 0},
-  { sos_getpc, 0x1f80, 0},
-  { NULL, 0x2000, 0x2544},		/* #drdsb */
-  { NULL, 0x2003, 0x255a},		/* #dwtsb */
-  { NULL, 0x2006, 0x2419},		/* #dir */
-  { NULL, 0x2009, 0x22fa},		/* #ropen */
-  { NULL, 0x200c, 0x2508},		/* #set */
-  { NULL, 0x200f, 0x2526},		/* #reset */
-  { NULL, 0x2012, 0x24ac},		/* #name */
-  { NULL, 0x2015, 0x2477},		/* #kill */
-  { sos_csr, 0x2018, 0},
-  { sos_scrn, 0x201b, 0},
-  { sos_loc, 0x201e, 0},
-  { sos_flget, 0x2021, 0},
-  { NULL, 0x2024, 0x25ad},		/* #rdvsw */
-  { NULL, 0x2027, 0x25c9},		/* #sdvsw */
-  { sos_inp, 0x202a, 0},
-  { sos_out, 0x202d, 0},
-  { sos_widch, 0x2030, 0},
-  { NULL, 0x2033, 0x286c},		/* #error */
-  { sos_boot, 0x2036, 0},
+  { sos_cold, 0x1ffd , 0, "#cold"},
+  { NULL, 0x1ffa , 0x2100, "#hot"},
+  { sos_ver, 0x1ff7 , 0, "#ver"},
+  { sos_print, 0x1ff4 , 0, "#print"},
+  { sos_prints, 0x1ff1 , 0, "#prints"},
+  { sos_ltnl, 0x1fee , 0, "#ltnl"},
+  { sos_nl, 0x1feb , 0, "#nl"},
+  { sos_msg, 0x1fe8, 0, "#msg"},
+  { sos_msx, 0x1fe5, 0, "#msx"},
+  { sos_mprint, 0x1fe2, 0, "#mprint"},
+  { sos_tab, 0x1fdf, 0, "#tab"},
+  { sos_lprint, 0x1fdc, 0, "#lprint"},
+  { sos_lpton, 0x1fd9, 0, "#lpton"},
+  { sos_lptof, 0x1fd6, 0, "#lptof"},
+  { sos_getl, 0x1fd3, 0, "#getl"},
+  { sos_getky, 0x1fd0, 0, "#getky"},
+  { sos_brkey, 0x1fcd, 0, "#brkey"},
+  { sos_inkey, 0x1fca, 0, "#inkey"},
+  { sos_pause, 0x1fc7, 0, "#pause"},
+  { sos_bell, 0x1fc4, 0, "#bell"},
+  { sos_prthx, 0x1fc1, 0, "#prthx"},
+  { sos_prthl, 0x1fbe, 0, "#prthl"},
+  { sos_asc, 0x1fbb, 0, "#asc"},
+  { sos_hex, 0x1fb8, 0, "#hex"},
+  { sos_2hex, 0x1fb5, 0, "#2hex"},
+  { sos_hlhex, 0x1fb2, 0, "#hlhex"},
+  { NULL, 0x1faf, 0x22b3, "#wopen"},
+  { NULL, 0x1fac, 0x232d, "#wrd"},
+  { sos_fcb, 0x1fa9, 0, "#fcb"},
+  { NULL, 0x1fa6, 0x234f, "#rdd"},
+  { sos_file, 0x1fa3, 0, "#file"},
+  { sos_fsame, 0x1fa0, 0, "#fsame"},
+  { sos_fprnt, 0x1f9d, 0, "#fprnt"},
+  { sos_poke, 0x1f9a, 0, "#poke"},
+  { sos_pokea, 0x1f97, 0, "#pokea"},
+  { sos_peek, 0x1f94, 0, "#peek"},
+  { sos_peeka, 0x1f91, 0, "#peeka"},
+  { sos_mon, 0x1f8e, 0, "#mon"},
+  { sos_hl, 0x1f81, 0, "#hl"},
+  { sos_getpc, 0x1f80, 0, "#getpc"},
+  { NULL, 0x2000, 0x2544, "#drdsb"},
+  { NULL, 0x2003, 0x255a, "#dwtsb"},
+  { NULL, 0x2006, 0x2419, "#dir"},
+  { NULL, 0x2009, 0x22fa, "#ropen"},
+  { NULL, 0x200c, 0x2508, "#set"},
+  { NULL, 0x200f, 0x2526, "#reset"},
+  { NULL, 0x2012, 0x24ac, "#name"},
+  { NULL, 0x2015, 0x2477, "#kill"},
+  { sos_csr, 0x2018, 0, "#csr"},
+  { sos_scrn, 0x201b, 0, "#scrn"},
+  { sos_loc, 0x201e, 0, "#loc"},
+  { sos_flget, 0x2021, 0, "#flget"},
+  { NULL, 0x2024, 0x25ad, "#rdvsw"},
+  { NULL, 0x2027, 0x25c9, "#sdvsw"},
+  { sos_inp, 0x202a, 0, "#inp"},
+  { sos_out, 0x202d, 0, "#out"},
+  { sos_widch, 0x2030, 0, "#widch"},
+  { NULL, 0x2033, 0x286c, "#error"},
+  { sos_boot, 0x2036, 0, "#boot"},
   /* disk I/O */
-  { sos_dread, 0x2b00, 0},
-  { sos_dwrite, 0x2b03, 0},
+  { sos_dread, 0x2b00, 0, "dread"},
+  { sos_dwrite, 0x2b03, 0, "dwrite"},
   /* sword dos module internal hook */
-  { sos_rdi, 0x2900, 0},
-  { sos_tropn, 0x2903, 0},
-  { sos_wri, 0x2906, 0},
-  { sos_twrd, 0x2909, 0},
-  { sos_trdd, 0x290c, 0},
-  { sos_tdir, 0x290f, 0},
-  { NULL, 0x2912, 0x27e3},		/* p#fnam */
-  { NULL, 0x2915, 0x2851},		/* devchk */
-  { NULL, 0x2918, 0x2863},		/* tpchk */
-  { sos_parsc, 0x292a, 0},
-  { sos_parcs, 0x293f, 0},
+  { sos_rdi, 0x2900, 0, "rdi"},
+  { sos_tropn, 0x2903, 0, "tropn"},
+  { sos_wri, 0x2906, 0, "wri"},
+  { sos_twrd, 0x2909, 0, "twrd"},
+  { sos_trdd, 0x290c, 0, "trdd"},
+  { sos_tdir, 0x290f, 0, "tdir"},
+  { NULL, 0x2912, 0x27e3, "p#fnam"},
+  { NULL, 0x2915, 0x2851, "devchk"},
+  { NULL, 0x2918, 0x2863, "tpchk"},
+  { sos_parsc, 0x292a, 0, "parsc"},
+  { sos_parcs, 0x293f, 0, "parcs"},
 };
 
 /* total number of traps */
 #define	trap_nfunc	(sizeof sos_funcs / sizeof(struct functbl))
 
+/* buckets of the latency histograms */
+#define	TRAP_HIST	(32)
+
+/*
+   statistics of a trap
+*/
+struct trapstat {
+    unsigned long long	calls;		/* times called */
+    unsigned long long	total;		/* host time taken in ns */
+    unsigned long long	max;		/* longest call in ns */
+    /* calls which took 2^i .. 2^(i+1)-1 ns, longer ones in the last */
+    unsigned long long	hist[TRAP_HIST];
+};
+
 /* file attributes */
 char *trap_attr[] = {
 	"Nul",	/* 0 */
@@ -191,19 +210,20 @@ char *trap_attr[] = {
 #define	Z80_RET		(0xc9)
 #define	Z80_JP		(0xc3)
 
-#define	Z80_A		(hreg(af[af_sel]))
-#define	Z80_B		(hreg(regs[regs_sel].bc))
-#define	Z80_C		(lreg(regs[regs_sel].bc))
-#define	Z80_D		(hreg(regs[regs_sel].de))
-#define	Z80_E		(lreg(regs[regs_sel].de))
-#define	Z80_H		(hreg(regs[regs_sel].hl))
-#define	Z80_L		(lreg(regs[regs_sel].hl))
-#define	Z80_AF		(af[af_sel])
-#define	Z80_BC		(regs[regs_sel].bc)
-#define	Z80_DE		(regs[regs_sel].de)
-#define	Z80_HL		(regs[regs_sel].hl)
-#define	Z80_SP		(sp)
-#define	Z80_PC		(pc)
+/* registers of the machine "cpu" */
+#define	Z80_A		(hreg(cpu->af[cpu->af_sel]))
+#define	Z80_B		(hreg(cpu->regs[cpu->regs_sel].bc))
+#define	Z80_C		(lreg(cpu->regs[cpu->regs_sel].bc))
+#define	Z80_D		(hreg(cpu->regs[cpu->regs_sel].de))
+#define	Z80_E		(lreg(cpu->regs[cpu->regs_sel].de))
+#define	Z80_H		(hreg(cpu->regs[cpu->regs_sel].hl))
+#define	Z80_L		(lreg(cpu->regs[cpu->regs_sel].hl))
+#define	Z80_AF		(cpu->af[cpu->af_sel])
+#define	Z80_BC		(cpu->regs[cpu->regs_sel].bc)
+#define	Z80_DE		(cpu->regs[cpu->regs_sel].de)
+#define	Z80_HL		(cpu->regs[cpu->regs_sel].hl)
+#define	Z80_SP		(cpu->sp)
+#define	Z80_PC		(cpu->pc)
 
 /*
    trick
@@ -214,10 +234,11 @@ char *trap_attr[] = {
 #define TSTFLAG(f)	((Z80_AF & FLAG_ ## f) != 0)
 
 /*
-   variables
+   variables (of the session run by this thread)
 */
-static BYTE	wkram[EM_WKSIZ+1];	/* S-OS special work */
-static sos_tape_device_info tapes[SOS_TAPE_NR];  /* tape devices */
+static __thread BYTE	wkram[EM_WKSIZ+1];	/* S-OS special work */
+static __thread sos_tape_device_info tapes[SOS_TAPE_NR];  /* tape devices */
+static __thread struct trapstat stats[trap_nfunc];	/* trap statistics */
 
 /** Initialize tape device emulation
  */
@@ -234,36 +255,29 @@ init_tape_devices(void){
 		inf->retpoi = 0; /* initialize RETPOI of this device */
 	}
 }
-/** Detect writing to a workspace and sync behaviors according to a value in a workspace.
-    @param[in] addr an address to be written
+/** Sync behaviors according to a value written to a workspace.
+    This is the watcher of XYADR, see trap_init().
+    @param[in] cpu  the machine
+    @param[in] addr an address written
+    @param[in] arg  not used
 */
 static void
-sync_workarea(WORD addr){
+sync_workarea(struct z80_cpu *cpu, WORD addr, void *arg){
 	int   x, y;
 	BYTE nx,ny;
 	BYTE     v;
 
 	v = GetBYTE_INTERNAL(addr);  /* read specified address */
 	scr_csr(&y, &x);  /* Get current cursor for modifications of XYADR */
-	switch( addr ) {
 
-	case EM_XYADR:  /* Cursor X position */
-	case (EM_XYADR + 1):  /* Cursor Y position */
-
-		nx = ( addr == EM_XYADR ) ? (v) : ( x & 0xff );
-		ny = ( addr == ( EM_XYADR + 1 ) ) ? (v) : ( y & 0xff );
-
-		/*
-		 *  locate cursor without writing to the S-OS workarea.
-		 *  Note: scr_locate_cursor() will modify arguments properly.
-		 */
-		scr_locate_cursor(ny, nx);  /* update cursor */
-		break;
-	default:
-		break;
-	}
+	nx = ( addr == EM_XYADR ) ? (v) : ( x & 0xff );	/* Cursor X position */
+	ny = ( addr == ( EM_XYADR + 1 ) ) ? (v) : ( y & 0xff ); /* Cursor Y */
 
-	return ;
+	/*
+	 *  locate cursor without writing to the S-OS workarea.
+	 *  Note: scr_locate_cursor() will modify arguments properly.
+	 */
+	scr_locate_cursor(ny, nx);  /* update cursor */
 }
 
 /** Convert a drive letter to an unit number.
@@ -321,7 +335,7 @@ alchk_internal(BYTE dsk){
   TRDVSW routine
  */
 static int
-trdvsw_internal(void){
+trdvsw_internal(struct z80_cpu *cpu){
 
 	switch( GetBYTE(SOS_DVSW) ) {
 
@@ -343,7 +357,7 @@ trdvsw_internal(void){
 }
 
 static void
-dskred_internal(void){
+dskred_internal(struct z80_cpu *cpu){
 	int    rc;
 	BYTE  dsk;
 	BYTE unit;
@@ -355,7 +369,7 @@ dskred_internal(void){
 	unit = dev2unitno(dsk);  /* disk unit number */
 
 	PutBYTE(SOS_UNITNO, unit); /* write unit number */
-	sos_dread();               /* read records */
+	sos_dread(cpu);               /* read records */
 
 	return;
 error:
@@ -366,10 +380,13 @@ dskred_internal(void){
    initialize trap handler & SWORD memory
 */
 int
-trap_init(void){
+trap_init(struct z80_cpu *cpu){
     WORD	addr;
     int		funcnum;
 
+    /* the screen follows the cursor position in XYADR */
+    (void) watch_add(cpu, EM_XYADR, EM_XYADR + 1, sync_workarea, NULL);
+
     /* create SWORD system call table */
     funcnum = 0;
     for(funcnum=0; funcnum < trap_nfunc; funcnum++){
@@ -421,6 +438,167 @@ trap_init(void){
     return(0);
 }
 
+/** Forget the S-OS special work and the tape positions of the previous
+    session run by this thread.
+ */
+void
+trap_reset(void){
+
+	memset(wkram, 0, sizeof(wkram));
+	memset(stats, 0, sizeof(stats));
+	init_tape_devices();
+}
+
+/** Copy the S-OS special work and the tape positions out for a snapshot.
+    @param[out] wk the special work, EM_WKSIZ+1 bytes
+    @param[out] tp the tape devices, SOS_TAPE_NR of them
+ */
+void
+trap_save(BYTE *wk, sos_tape_device_info *tp){
+
+	memcpy(wk, wkram, sizeof(wkram));
+	memcpy(tp, tapes, sizeof(tapes));
+}
+
+/** Put the S-OS special work and the tape positions saved by
+    trap_save() back.
+    @param[in] wk the special work
+    @param[in] tp the tape devices
+ */
+void
+trap_load(const BYTE *wk, const sos_tape_device_info *tp){
+
+	memcpy(wkram, wk, sizeof(wkram));
+	memcpy(tapes, tp, sizeof(tapes));
+}
+
+/** Account a trap call.
+    @param[in] func trap number
+    @param[in] t0   host time when it was called
+    @param[in] t1   host time when it returned
+ */
+static void
+trap_account(int func, const struct timespec *t0, const struct timespec *t1){
+	struct trapstat *st = &stats[func];
+	unsigned long long ns, v;
+	int i;
+
+	ns = (unsigned long long)( t1->tv_sec - t0->tv_sec ) * 1000000000ULL
+	    + t1->tv_nsec - t0->tv_nsec;
+	for(i = 0, v = ns; v > 1 && i < TRAP_HIST - 1; v >>= 1)
+		++i;
+
+	st->calls++;
+	st->total += ns;
+	if ( ns > st->max )
+		st->max = ns;
+	st->hist[i]++;
+}
+
+/** Find a trap by its name, with or without the leading '#'.
+    @param[in] name the name
+    @return trap number, -1 if not found
+ */
+static int
+trap_lookup(const char *name){
+	const char *n;
+	int func;
+
+	for(func = 0; func < trap_nfunc; ++func) {
+
+		n = sos_funcs[func].name;
+		if ( strcasecmp(n, name) == 0
+		    || ( n[0] == '#' && strcasecmp(n + 1, name) == 0 ) )
+			return func;
+	}
+	return -1;
+}
+
+/** Print the trap statistics of this session on the screen.
+    @param[in] name a trap to print the latency histogram of,
+                    NULL to print the calls of all traps
+ */
+void
+trap_stats_print(const char *name){
+	struct trapstat *st;
+	char buf[TRAP_BUFSIZ];
+	int func, i;
+
+	if ( name != NULL ) {
+
+		func = trap_lookup(name);
+		if ( func < 0 || sos_funcs[func].func == NULL ) {
+
+			scr_puts("stats: unknown trap\r");
+			return;
+		}
+		st = &stats[func];
+		snprintf(buf, TRAP_BUFSIZ, "%s: %llu calls\r",
+		    sos_funcs[func].name, st->calls);
+		scr_puts(buf);
+		for(i = 0; i < TRAP_HIST; ++i) {
+
+			if ( st->hist[i] == 0 )
+				continue;
+			snprintf(buf, TRAP_BUFSIZ, "%12llu ns- %llu\r",
+			    ( i == 0 ) ? 0ULL : 1ULL << i, st->hist[i]);
+			scr_puts(buf);
+		}
+		return;
+	}
+
+	scr_puts("trap         calls  total[us]  avg[ns]  max[us]\r");
+	for(func = 0; func < trap_nfunc; ++func) {
+
+		st = &stats[func];
+		if ( st->calls == 0 )
+			continue;
+		snprintf(buf, TRAP_BUFSIZ, "%-8s %9llu %10llu %8llu %8llu\r",
+		    sos_funcs[func].name, st->calls, st->total / 1000,
+		    st->total / st->calls, st->max / 1000);
+		scr_puts(buf);
+	}
+}
+
+/** Write the trap statistics of this session as JSON.
+    @param[in] name file name
+    @retval 0 success
+    @retval -1 the file can not be written
+ */
+int
+trap_stats_write(const char *name){
+	struct trapstat *st;
+	FILE *fp;
+	int func, i, n, first;
+
+	fp = fopen(name, "w");
+	if ( fp == NULL )
+		return -1;
+
+	fprintf(fp, "{\n  \"unit\": \"ns\",\n  \"traps\": [");
+	first = 1;
+	for(func = 0; func < trap_nfunc; ++func) {
+
+		st = &stats[func];
+		if ( st->calls == 0 )
+			continue;
+		for(n = TRAP_HIST; n > 0 && st->hist[n - 1] == 0; --n)
+			;
+		fprintf(fp, "%s\n    { \"name\": \"%s\", \"addr\": %u, "
+		    "\"calls\": %llu, \"total\": %llu, \"max\": %llu, "
+		    "\"hist\": [", first ? "" : ",", sos_funcs[func].name,
+		    (unsigned int)sos_funcs[func].calladdr, st->calls, st->total,
+		    st->max);
+		for(i = 0; i < n; ++i)
+			fprintf(fp, "%s%llu", ( i > 0 ) ? ", " : "", st->hist[i]);
+		fprintf(fp, "] }");
+		first = 0;
+	}
+	fprintf(fp, "\n  ]\n}\n");
+
+	return ( fclose(fp) != 0 ) ? -1 : 0;
+}
+
 
 /*
    SWORD trap handler
@@ -428,73 +606,223 @@ trap_init(void){
    call when HALT on emulation
 */
 int
-trap(int func){
+trap(struct z80_cpu *cpu, int func){
     int	r;
     char buf[TRAP_BUFSIZ];
+    struct timespec t0, t1;
 
     if (func < 0 || trap_nfunc <= func || sos_funcs[func].func == NULL){
 
 	    snprintf(buf, TRAP_BUFSIZ, "\nSOS Emulator: Invalid trap: %d\r",func);
 	    scr_puts(buf);
+	    snprintf(buf, TRAP_BUFSIZ, "invalid trap %d at %04X", func, Z80_PC);
+	    (void) trace_dump(cpu, buf);
 	    return TRAP_COLD;
-    } else
-	r = (*sos_funcs[func].func)();
+    }
+
+    if (sos_funcs[func].func != sos_getky && sos_funcs[func].func != sos_brkey)
+	scr_busy();		/* not a loop polling for a key */
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    r = (*sos_funcs[func].func)(cpu);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    trap_account(func, &t0, &t1);
 
     return r;
 }
 
 /** Get a byte data from an address in RAM
+    @param[in] cpu  the machine
     @param[in] addr an address to be written
     @value     byte data
  */
 BYTE
-trap_get_byte(WORD addr){
+trap_get_byte(struct z80_cpu *cpu, WORD addr){
 
 	return GetBYTE_INTERNAL(addr);
 }
 /** Get a byte data from an address in RAM
+    @param[in] cpu  the machine
     @param[in] addr an address to be written
     @value     byte data
  */
 WORD
-trap_get_word(WORD addr){
+trap_get_word(struct z80_cpu *cpu, WORD addr){
 
 	return GetWORD_INTERNAL(addr);
 }
 
+/** Copy bytes upwards within a linear part of RAM, as LDIR does.
+    @param[in] ram RAM of the machine
+    @param[in] d   the first address to write to
+    @param[in] s   the first address to read from
+    @param[in] n   the number of bytes, neither range may pass 0xffff
+ */
+static void
+move_up(BYTE *ram, unsigned int d, unsigned int s, unsigned int n){
+	unsigned int p, done, c;
 
-/** Put a byte data to RAM
-    @param[in] addr an address to write to
-    @param[in] val  a byte data to be written
-    @value     byte data
+	if ( ( d <= s ) || ( d - s >= n ) ) {
+
+		memmove(ram + d, ram + s, n);
+		return;
+	}
+
+	/* the copy reads bytes it has written: the first p bytes repeat */
+	p = d - s;
+	if ( p == 1 ) {
+
+		memset(ram + d, ram[s], n);
+		return;
+	}
+	for(done = p; done < p + n; done += c) {
+
+		c = ( done < p + n - done ) ? done : p + n - done;
+		memcpy(ram + s + done, ram + s, c);
+	}
+}
+
+/** Copy bytes downwards within a linear part of RAM, as LDDR does.
+    @param[in] ram RAM of the machine
+    @param[in] d   the last address to write to
+    @param[in] s   the last address to read from
+    @param[in] n   the number of bytes, neither range may pass 0x0000
  */
-void
-trap_put_byte(WORD addr, BYTE val){
+static void
+move_down(BYTE *ram, unsigned int d, unsigned int s, unsigned int n){
+	unsigned int p, done, c, top;
+
+	if ( ( d >= s ) || ( s - d >= n ) ) {
+
+		memmove(ram + d + 1 - n, ram + s + 1 - n, n);
+		return;
+	}
 
-	PutBYTE_INTERNAL(addr, val);
-	sync_workarea(addr);
+	/* the copy reads bytes it has written: the last p bytes repeat */
+	p = s - d;
+	if ( p == 1 ) {
+
+		memset(ram + d + 1 - n, ram[s], n);
+		return;
+	}
+	top = s + 1;
+	for(done = p; done < p + n; done += c) {
+
+		c = ( done < p + n - done ) ? done : p + n - done;
+		memcpy(ram + top - done - c, ram + top - c, c);
+	}
 }
 
-/** Put a word data to RAM
-    @param[in] addr an address to write to
-    @param[in] v    a word data to be written
+/** Tell the block cache, the known routines and the watchers about a
+    block written by Z80 code.
+    @param[in] cpu  the machine
+    @param[in] lo   the lowest address written
+    @param[in] len  the number of bytes written, may wrap at 0xffff
+    @param[in] down the bytes were written from the highest address
+ */
+static void
+sync_block(struct z80_cpu *cpu, WORD lo, unsigned int len, int down){
+	unsigned int n;
+
+	n = 0x10000 - lo;
+	if ( len <= n ) {
+
+		BB_CHECK_RANGE(lo, len);
+	} else {
+
+		BB_CHECK_RANGE(lo, n);
+		BB_CHECK_RANGE(0, len - n);
+	}
+	HLE_INVALIDATE(lo, len);
+	watch_hit(cpu, lo, len, down);
+}
+
+/** Copy a block of RAM as LDIR or LDDR does.
+    The result is the same as copying byte by byte, even if the blocks
+    overlap or wrap around at 0xffff.
+    @param[in] cpu  the machine
+    @param[in] dst  the first address to write to (DE)
+    @param[in] src  the first address to read from (HL)
+    @param[in] len  the number of bytes, 1 to 0x10000
+    @param[in] down copy downwards (LDDR) if non-zero
  */
 void
-trap_put_word(WORD addr, WORD val){
+trap_move_block(struct z80_cpu *cpu, WORD dst, WORD src, unsigned int len,
+    int down){
+	unsigned int d, s, n, seg;
+
+	d = dst;
+	s = src;
+	for(n = len; n > 0; n -= seg) {
+
+		if ( down ) {
+
+			seg = ( d < s ) ? d + 1 : s + 1;
+			if ( seg > n )
+				seg = n;
+			move_down(cpu->ram, d, s, seg);
+			d = ( d - seg ) & 0xffff;
+			s = ( s - seg ) & 0xffff;
+		} else {
+
+			seg = 0x10000 - ( ( d > s ) ? d : s );
+			if ( seg > n )
+				seg = n;
+			move_up(cpu->ram, d, s, seg);
+			d = ( d + seg ) & 0xffff;
+			s = ( s + seg ) & 0xffff;
+		}
+	}
+
+	sync_block(cpu, down ? (WORD)(dst + 1 - len) : dst, len, down);
+}
 
-	PutWORD_INTERNAL(addr, val);
-	sync_workarea(addr);
-	sync_workarea(addr + 1);
+/** Search a block of RAM for a byte as CPIR or CPDR does.
+    @param[in] cpu  the machine
+    @param[in] addr the first address to compare (HL)
+    @param[in] len  the number of bytes, 1 to 0x10000
+    @param[in] val  the byte to search for (A)
+    @param[in] down search downwards (CPDR) if non-zero
+    @return the number of bytes compared, including the matching one
+ */
+unsigned int
+trap_find_byte(struct z80_cpu *cpu, WORD addr, unsigned int len, BYTE val,
+    int down){
+	unsigned int a, i, n, seg;
+	const BYTE  *p;
+
+	a = addr;
+	for(n = 0; n < len; n += seg) {
+
+		if ( down ) {
+
+			seg = ( a + 1 < len - n ) ? a + 1 : len - n;
+			for(i = 0; i < seg; ++i) {
+
+				if ( cpu->ram[a - i] == val )
+					return n + i + 1;
+			}
+			a = ( a - seg ) & 0xffff;
+		} else {
+
+			seg = ( 0x10000 - a < len - n ) ? 0x10000 - a : len - n;
+			p = memchr(cpu->ram + a, val, seg);
+			if ( p != NULL )
+				return n + ( p - ( cpu->ram + a ) ) + 1;
+			a = ( a + seg ) & 0xffff;
+		}
+	}
+	return len;
 }
 
 /** Write to an address in workarea for screen.c and trap.c.
+    @param[in] cpu  the machine
     @param[in] addr an address to be written
     @param[in] val  a value to write
     @retval  0  success
     @retval -1  the addr is not corresponding to any workarea.
 */
 int
-trap_write_workarea_without_sync(WORD addr, BYTE val){
+trap_write_workarea_without_sync(struct z80_cpu *cpu, WORD addr, BYTE val){
 	int x, y;
 
 	switch( addr ) {
@@ -525,37 +853,37 @@ trap_change_tape(char dev){
     inf->retpoi = 0;  /* reset RETPOI */
 }
 
-int sos_cold(void){
+int sos_cold(struct z80_cpu *cpu){
     Z80_PC = GetWORD(SOS_USR);
     return(TRAP_COLD);
 }
 
-int sos_ver(void){
+int sos_ver(struct z80_cpu *cpu){
     Z80_HL = EM_VER;
     return(TRAP_NEXT);
 }
 
-int sos_print(void){
+int sos_print(struct z80_cpu *cpu){
     scr_putchar(Z80_A);
     return(TRAP_NEXT);
 }
 
-int sos_prints(void){
+int sos_prints(struct z80_cpu *cpu){
     scr_putchar(' ');
     return(TRAP_NEXT);
 }
 
-int sos_ltnl(void){
+int sos_ltnl(struct z80_cpu *cpu){
     scr_ltnl();
     return(TRAP_NEXT);
 }
 
-int sos_nl(void){
+int sos_nl(struct z80_cpu *cpu){
     scr_nl();
     return(TRAP_NEXT);
 }
 
-int sos_msg(void){
+int sos_msg(struct z80_cpu *cpu){
     WORD	addr;
     char	c;
 
@@ -567,8 +895,8 @@ int sos_msg(void){
     return(TRAP_NEXT);
 }
 
-int sos_msx(void){
-    scr_puts((char *)&(ram[Z80_DE]));
+int sos_msx(struct z80_cpu *cpu){
+    scr_puts((char *)&(cpu->ram[Z80_DE]));
     return(TRAP_NEXT);
 }
 
@@ -578,60 +906,61 @@ int sos_msx(void){
    but at least MZ-80K & MZ-2000 implementation saves DE reg. and
    some programs include REDA expect it.
 */
-int sos_mprint(void){
+int sos_mprint(struct z80_cpu *cpu){
     WORD	addr;
     char	c;
 
-    addr = z80_pop();
+    addr = z80_pop(cpu);
     while((c = GetBYTE(addr++)) != 0){		/* search return addr */
 	scr_asyncputchar(c);
     }
     scr_sync();
-    z80_push(addr);
+    z80_push(cpu, addr);
     return(TRAP_NEXT);
 }
 
-int sos_tab(void){
+int sos_tab(struct z80_cpu *cpu){
     scr_tab(Z80_B);
     return(TRAP_NEXT);
 }
 
-int sos_lprint(void){
+int sos_lprint(struct z80_cpu *cpu){
     /* XX: not support */
     return(TRAP_NEXT);
 }
 
-int sos_lpton(void){
+int sos_lpton(struct z80_cpu *cpu){
     /* XX: not support */
     return(TRAP_NEXT);
 }
 
-int sos_lptof(void){
+int sos_lptof(struct z80_cpu *cpu){
     /* XX: not support */
     return(TRAP_NEXT);
 }
 
-int sos_getl(void){
+int sos_getl(struct z80_cpu *cpu){
     char	buf[2000];
     int		len;
 
     len =  scr_getl(buf);
-    memcpy(ram + Z80_DE, buf, len+1);	/* copy with last '\0' */
+    memcpy(cpu->ram + Z80_DE, buf, len+1);	/* copy with last '\0' */
     /* NOTE: some caller (includes DOS module) require filling zero
              onto rest of buffer, to rid a overrun. */
     if (len < EM_WIDTH-1)
-	memset(ram + Z80_DE + len + 1, '\0', EM_WIDTH - 1 - len);
+	memset(cpu->ram + Z80_DE + len + 1, '\0', EM_WIDTH - 1 - len);
+    BB_INVALIDATE(Z80_DE, (len < EM_WIDTH) ? EM_WIDTH : len + 1);
     SETFLAG(C, 0);
     return(TRAP_NEXT);
 }
 
-int sos_getky(void){
+int sos_getky(struct z80_cpu *cpu){
     Sethreg(Z80_AF, scr_getky());
     SETFLAG(C, 0);
     return(TRAP_NEXT);
 }
 
-int sos_brkey(void){
+int sos_brkey(struct z80_cpu *cpu){
     if (scr_brkey()){
 	SETFLAG(Z, 1);
     } else {
@@ -640,35 +969,35 @@ int sos_brkey(void){
     return(TRAP_NEXT);
 }
 
-int sos_inkey(void){
+int sos_inkey(struct z80_cpu *cpu){
     Sethreg(Z80_AF, scr_inkey());
     return(TRAP_NEXT);
 }
 
-int sos_pause(void){
+int sos_pause(struct z80_cpu *cpu){
     WORD	addr;
 
     if (scr_pause()){
 	/* break */
-	addr = z80_pop();
+	addr = z80_pop(cpu);
 	addr = GetWORD(addr);
-	z80_push(addr);
+	z80_push(cpu, addr);
 	return(TRAP_HOLD);
     }
     /* space pressed, so skip 2 byte */
-    addr = z80_pop();
+    addr = z80_pop(cpu);
     addr += 2;
-    z80_push(addr);
+    z80_push(cpu, addr);
 
     return(TRAP_NEXT);
 }
 
-int sos_bell(void){
+int sos_bell(struct z80_cpu *cpu){
     scr_bell();
     return(TRAP_NEXT);
 }
 
-int sos_prthx(void){
+int sos_prthx(struct z80_cpu *cpu){
     char	buf[3];
 
     snprintf(buf, 3, "%02X", (int) Z80_A);
@@ -676,7 +1005,7 @@ int sos_prthx(void){
     return(TRAP_NEXT);
 }
 
-int sos_prthl(void){
+int sos_prthl(struct z80_cpu *cpu){
     char	buf[5];
 
     snprintf(buf, 5, "%04X", (int) Z80_HL);
@@ -684,7 +1013,7 @@ int sos_prthl(void){
     return(TRAP_NEXT);
 }
 
-int sos_asc(void){
+int sos_asc(struct z80_cpu *cpu){
     int	c;
 
     c = (int)Z80_A & 0x0f;
@@ -707,7 +1036,7 @@ int hexone(int c){
     return(-1);
 }
 
-int sos_hex(void){
+int sos_hex(struct z80_cpu *cpu){
     int	r;
 
     if ((r = hexone((int)Z80_A & 0xff)) < 0){
@@ -719,7 +1048,7 @@ int sos_hex(void){
     return(TRAP_NEXT);
 }
 
-int sos_2hex(void){
+int sos_2hex(struct z80_cpu *cpu){
     int	result;
     int	r;
     int	i;
@@ -738,7 +1067,7 @@ int sos_2hex(void){
     return(TRAP_NEXT);
 }
 
-int sos_hlhex(void){
+int sos_hlhex(struct z80_cpu *cpu){
     int	result;
     int	r;
     int	i;
@@ -771,7 +1100,7 @@ int sos_hlhex(void){
      return  .. 0 if success, or sword error code
 */
 int
-trap_fname(unsigned char *buf, unsigned char *dsk, unsigned char defdsk){
+trap_fname(struct z80_cpu *cpu, unsigned char *buf, unsigned char *dsk, unsigned char defdsk){
     WORD	ri;
     BYTE	c;
     int		len;
@@ -780,10 +1109,10 @@ trap_fname(unsigned char *buf, unsigned char *dsk, unsigned char defdsk){
     ri = Z80_DE;
 
     /* get drive name if exist */
-    while(ram[ri] == ' ')		/* space skip */
+    while(cpu->ram[ri] == ' ')		/* space skip */
 	ri++;
-    if (ram[ri + 1] == ':'){
-	if (islower(d = ram[ri]))
+    if (cpu->ram[ri + 1] == ':'){
+	if (islower(d = cpu->ram[ri]))
 	    d = toupper(d);
 	if ( !sos_device_is_disk(d) && !sos_device_is_tape(d) )
 	    return SOS_ERROR_INVAL;	/* bad data */
@@ -794,10 +1123,10 @@ trap_fname(unsigned char *buf, unsigned char *dsk, unsigned char defdsk){
     *dsk = d;
 
     /* get file name */
-    while(ram[ri] == ' ')		/* space skip */
+    while(cpu->ram[ri] == ' ')		/* space skip */
 	ri++;
     for (len=0; len<SOS_FNAMENAMELEN; len++){
-	if ((c = ram[ri]) < ' ' || c == ':' || c == '.')
+	if ((c = cpu->ram[ri]) < ' ' || c == ':' || c == '.')
 	    break;
 	*buf++ = c;
 	ri++;
@@ -806,12 +1135,12 @@ trap_fname(unsigned char *buf, unsigned char *dsk, unsigned char defdsk){
 	*buf++ = ' ';			/* space padding */
 
     /* skip "." of extension */
-    if (ram[ri] == '.')
+    if (cpu->ram[ri] == '.')
 	ri++;
 
     /* get extention */
     for (len=0; len<SOS_FNAMEEXTLEN; len++){
-	if ((c = ram[ri]) < ' ' || c == ':')
+	if ((c = cpu->ram[ri]) < ' ' || c == ':')
 	    break;
 	*buf++ = c;
 	ri++;
@@ -825,7 +1154,7 @@ trap_fname(unsigned char *buf, unsigned char *dsk, unsigned char defdsk){
     return(0);
 }
 
-int sos_file(void){
+int sos_file(struct z80_cpu *cpu){
     WORD	wi;
     BYTE	attr;
     unsigned char	buf[SOS_FNAMEBUF_SIZE];
@@ -841,20 +1170,22 @@ int sos_file(void){
     PutBYTE(SOS_FTYPE, attr);
     wi++;
 
-    if (r = trap_fname(buf, &dsk, GetBYTE(SOS_DFDV))){
+    if (r = trap_fname(cpu, buf, &dsk, GetBYTE(SOS_DFDV))){
 	Sethreg(Z80_AF, r);
 	SETFLAG(C, 1);
 	return(TRAP_NEXT);
     }
-    memcpy(ram + wi, buf, SOS_FNAMELEN);
-    memcpy(ram + EM_NAMEBF, buf, SOS_FNAMELEN);
+    memcpy(cpu->ram + wi, buf, SOS_FNAMELEN);
+    memcpy(cpu->ram + EM_NAMEBF, buf, SOS_FNAMELEN);
+    BB_INVALIDATE(wi, SOS_FNAMELEN);
+    BB_INVALIDATE(EM_NAMEBF, SOS_FNAMELEN);
     PutBYTE(SOS_DSK, dsk);
 
     SETFLAG(C, 0);
     return(TRAP_NEXT);
 }
 
-int sos_fsame(void){
+int sos_fsame(struct z80_cpu *cpu){
     unsigned char	buf[SOS_FNAMEBUF_SIZE];
     unsigned char	dsk;
     WORD           saved_de;
@@ -870,7 +1201,7 @@ int sos_fsame(void){
     /*
      * check the buffer pointed by DE register
      */
-    r = trap_fname(buf, &dsk, GetBYTE(SOS_DSK));
+    r = trap_fname(cpu, buf, &dsk, GetBYTE(SOS_DSK));
     if ( r != 0 ){
 
 	    Sethreg(Z80_AF, r);
@@ -879,7 +1210,7 @@ int sos_fsame(void){
     }
 
     /* compare them */
-    if (memcmp(buf, ram + EM_IBFAD + 1, SOS_FNAMELEN) == 0){
+    if (memcmp(buf, cpu->ram + EM_IBFAD + 1, SOS_FNAMELEN) == 0){
 	    SETFLAG(Z, 1);
     } else {
 	    SETFLAG(Z, 0);
@@ -890,7 +1221,7 @@ int sos_fsame(void){
     return(TRAP_NEXT);
 }
 
-int sos_fprnt(void){
+int sos_fprnt(struct z80_cpu *cpu){
     WORD	namep;
     char	buf[SOS_FNAMEBUF_SIZE+1], *p;
     int		i;
@@ -930,12 +1261,12 @@ int sos_fprnt(void){
     return(TRAP_NEXT);
 }
 
-int sos_poke(void){
+int sos_poke(struct z80_cpu *cpu){
     wkram[Z80_HL] = Z80_A;
     return(TRAP_NEXT);
 }
 
-int sos_pokea(void){
+int sos_pokea(struct z80_cpu *cpu){
     WORD	from;
     int		offset;
     int		len;
@@ -947,17 +1278,17 @@ int sos_pokea(void){
     if (offset + len > EM_WKSIZ){
 	len = EM_WKSIZ - offset;		/* overflow check */
     }
-    memcpy(wkram + offset, ram + from, len);
+    memcpy(wkram + offset, cpu->ram + from, len);
     SETFLAG(C, 0);	/* S-OS ref. man. p.120 */
     return(TRAP_NEXT);
 }
 
-int sos_peek(void){
+int sos_peek(struct z80_cpu *cpu){
     Sethreg(Z80_AF, wkram[Z80_HL]);
     return(TRAP_NEXT);
 }
 
-int sos_peeka(void){
+int sos_peeka(struct z80_cpu *cpu){
     int		offset;
     WORD	target;
     int		len;
@@ -969,27 +1300,28 @@ int sos_peeka(void){
     if (offset + len > EM_WKSIZ){
 	len = EM_WKSIZ - offset;		/* overflow check */
     }
-    memcpy(ram + target, wkram + offset, len);
+    memcpy(cpu->ram + target, wkram + offset, len);
+    BB_INVALIDATE(target, len);
 
     SETFLAG(C, 0);
     return(TRAP_NEXT);
 }
 
-int sos_mon(void){
+int sos_mon(struct z80_cpu *cpu){
     return(TRAP_MON);		/* quit to monitor */
 }
 
-int sos_hl(void){
+int sos_hl(struct z80_cpu *cpu){
     /* never call */
     return(TRAP_NEXT);
 }
 
-int sos_getpc(void){
+int sos_getpc(struct z80_cpu *cpu){
     /* never call */
     return(TRAP_NEXT);
 }
 
-int sos_csr(void){
+int sos_csr(struct z80_cpu *cpu){
     int	x,y;
 
     scr_csr(&y, &x);
@@ -998,7 +1330,7 @@ int sos_csr(void){
     return(TRAP_NEXT);
 }
 
-int sos_scrn(void){
+int sos_scrn(struct z80_cpu *cpu){
     int	c;
 
     c = scr_scrn(Z80_H, Z80_L);
@@ -1006,7 +1338,7 @@ int sos_scrn(void){
     return(TRAP_NEXT);
 }
 
-int sos_loc(void){
+int sos_loc(struct z80_cpu *cpu){
 	int x,y;
 
 	x = (int) Z80_L;
@@ -1034,7 +1366,7 @@ int sos_loc(void){
 	return(TRAP_NEXT);
 }
 
-int sos_flget(void){
+int sos_flget(struct z80_cpu *cpu){
     int	c;
 
     c = scr_flget();
@@ -1042,17 +1374,17 @@ int sos_flget(void){
     return(TRAP_NEXT);
 }
 
-int sos_inp(void){
+int sos_inp(struct z80_cpu *cpu){
     /* not support */
     return(TRAP_NEXT);
 }
 
-int sos_out(void){
+int sos_out(struct z80_cpu *cpu){
     /* not support */
     return(TRAP_NEXT);
 }
 
-int sos_widch(void){
+int sos_widch(struct z80_cpu *cpu){
     int	w;
 
     w = (Z80_A <= 40) ? 40 : 80;
@@ -1065,20 +1397,21 @@ int sos_widch(void){
 /*
    raw disk I/O
 */
-int sos_dread(void){
+int sos_dread(struct z80_cpu *cpu){
     int	r;
 
-    r = dio_dread(ram + Z80_HL, (int) GetBYTE(SOS_UNITNO),
+    r = dio_dread(cpu->ram + Z80_HL, (int) GetBYTE(SOS_UNITNO),
 		     (int) Z80_DE, (int) Z80_A);
+    BB_INVALIDATE(Z80_HL, (int) Z80_A * SOS_RECORD_SIZE);
     Sethreg(Z80_AF, r);
     SETFLAG(C, r);
     return(TRAP_NEXT);
 }
 
-int sos_dwrite(void){
+int sos_dwrite(struct z80_cpu *cpu){
     int	r;
 
-    r = dio_dwrite(ram + Z80_HL, (int) GetBYTE(SOS_UNITNO),
+    r = dio_dwrite(cpu->ram + Z80_HL, (int) GetBYTE(SOS_UNITNO),
 		      (int) Z80_DE, (int) Z80_A);
 
     Sethreg(Z80_AF, r);
@@ -1089,11 +1422,11 @@ int sos_dwrite(void){
 /*
    trap for dos module internal hooks
 */
-int sos_tropn(void){
+int sos_tropn(struct z80_cpu *cpu){
     int	len, attr, addr, exaddr;
     int	r;
 
-    if (r = dio_ropen((char *)ram +EM_IBFAD +1, &attr, &addr, &len, &exaddr, 1)){
+    if (r = dio_ropen((char *)cpu->ram +EM_IBFAD +1, &attr, &addr, &len, &exaddr, 1)){
 	Sethreg(Z80_AF, r);
 	SETFLAG(C, 1);
 	return(TRAP_NEXT);
@@ -1114,7 +1447,7 @@ int sos_tropn(void){
      @retval SCR_SOS_CR    CR  key pressed
  */
 static BYTE
-sos_fcb_common(void){
+sos_fcb_common(struct z80_cpu *cpu){
 	BYTE    key;
 
 	/*
@@ -1146,7 +1479,7 @@ sos_fcb_common(void){
 
 /** Read file control block on a tape or a disk.
  */
-int sos_fcb(void){
+int sos_fcb(struct z80_cpu *cpu){
 	int      rc;
 	BYTE    key;
 	BYTE  recno;
@@ -1172,14 +1505,14 @@ int sos_fcb(void){
 	 */
 	if ( sos_device_is_tape( GetBYTE(SOS_DSK) ) ) {
 
-		PutBYTE(SOS_DSK, trdvsw_internal());    /* Set device letter into #DSK */
-		return sos_rdi();          /* Call RDI */
+		PutBYTE(SOS_DSK, trdvsw_internal(cpu));    /* Set device letter into #DSK */
+		return sos_rdi(cpu);          /* Call RDI */
 	}
 
 	/*
 	 * key handling
 	 */
-	key = sos_fcb_common();
+	key = sos_fcb_common(cpu);
 
 	if ( key == SCR_SOS_BREAK )
 		goto file_not_found;  /* Cancel Read File Control Block */
@@ -1203,7 +1536,7 @@ int sos_fcb(void){
 		Z80_HL = EM_DTBUF;    /* Destination address */
 		Z80_DE = recno;       /* Record number */
 		Sethreg(Z80_AF, 0x1); /* read count (1 record ) */
-		dskred_internal();    /* Set unit number and read sector */
+		dskred_internal(cpu);    /* Set unit number and read sector */
 
 		/* Calculate offset address of dentry in the record
 		 * This should be done before update DIRNO.
@@ -1211,7 +1544,7 @@ int sos_fcb(void){
 		recoff = ( GetBYTE(SOS_DIRNO) % SOS_DENTRIES_PER_REC )
 			* SOS_DENTRY_SIZE;
 
-		attr = *( (char *)&ram[0] + EM_DTBUF + recoff);
+		attr = *( (char *)&cpu->ram[0] + EM_DTBUF + recoff);
 		if ( attr == SOS_FATTR_EODENT )
 			goto file_not_found;
 
@@ -1229,11 +1562,12 @@ int sos_fcb(void){
 	}
 
 	/* Load Information block */
-	memmove( ( (char *)&ram[0] ) + EM_IBFAD,
-	    ( (char *)&ram[0] ) + EM_DTBUF + recoff,
+	memmove( ( (char *)&cpu->ram[0] ) + EM_IBFAD,
+	    ( (char *)&cpu->ram[0] ) + EM_DTBUF + recoff,
 	    SOS_DENTRY_SIZE);
+	BB_INVALIDATE(EM_IBFAD, SOS_DENTRY_SIZE);
 
-	sos_parsc();            /* Set #SIZE, #DTADR, #EXADR up */
+	sos_parsc(cpu);            /* Set #SIZE, #DTADR, #EXADR up */
 	PutBYTE(SOS_OPNFG, 1);  /* open file */
 
 	SETFLAG(C, 0);          /* Clear carry */
@@ -1249,7 +1583,7 @@ int sos_fcb(void){
 	return TRAP_NEXT;
 }
 
-int sos_rdi(void){
+int sos_rdi(struct z80_cpu *cpu){
     int	len, attr, addr, exaddr;
     int	rc;
     BYTE key;
@@ -1266,7 +1600,7 @@ int sos_rdi(void){
 
     inf = &tapes[ sos_tape_devindex( GetBYTE(SOS_DSK) ) ];
 
-    key = sos_fcb_common();  /* read key */
+    key = sos_fcb_common(cpu);  /* read key */
 
     if ( key == SCR_SOS_BREAK )
 	    goto file_not_found;  /* Cancel Read File Control Block */
@@ -1275,13 +1609,13 @@ int sos_rdi(void){
 	    goto position_reset;  /* Read position changed */
 
     /* Get the next file name on the tape from UNIX direntries or the tape emulation. */
-    rc = dio_dopen((char *)ram + EM_FNAME, &attr, &addr, &len, &exaddr,
+    rc = dio_dopen((char *)cpu->ram + EM_FNAME, &attr, &addr, &len, &exaddr,
 	inf->dirno );
     if ( rc != 0 )
 	    goto file_not_found;  /* No file found on inf->dirno */
 
     /* Load the File Information Block (FIB) */
-    rc = dio_ropen((char *)ram +EM_FNAME, &attr, &addr, &len, &exaddr, 1);
+    rc = dio_ropen((char *)cpu->ram +EM_FNAME, &attr, &addr, &len, &exaddr, 1);
     if ( rc != 0 )
 	    goto inc_dirno; /* Some UNIX files can not be read by S-OS apps. */
 
@@ -1293,7 +1627,7 @@ int sos_rdi(void){
     PutWORD(EM_DTADR, addr);
     PutWORD(EM_EXADR, exaddr);
 
-    sos_parsc();  /* Fill SOS_DTADR, SOS_EXADR, SOS_SIZE */
+    sos_parsc(cpu);  /* Fill SOS_DTADR, SOS_EXADR, SOS_SIZE */
 
 inc_dirno:
     if ( UCHAR_MAX > inf->dirno )
@@ -1319,11 +1653,11 @@ int sos_rdi(void){
 	return TRAP_NEXT;
 }
 
-int sos_wri(void){
+int sos_wri(struct z80_cpu *cpu){
     int r;
     int	attr;
 
-    if (r = dio_wopen((char *)ram + EM_IBFAD + 1, GetBYTE(EM_IBFAD),
+    if (r = dio_wopen((char *)cpu->ram + EM_IBFAD + 1, GetBYTE(EM_IBFAD),
 		      GetWORD(SOS_DTADR), GetWORD(SOS_SIZE),
 		      GetWORD(SOS_EXADR))){
 	Sethreg(Z80_AF, r);
@@ -1335,10 +1669,10 @@ int sos_wri(void){
     return(TRAP_NEXT);
 }
 
-int sos_twrd(void){
+int sos_twrd(struct z80_cpu *cpu){
     int	r;
 
-    if (r = dio_wdd(ram + GetWORD(SOS_DTADR), GetWORD(SOS_SIZE))){
+    if (r = dio_wdd(cpu->ram + GetWORD(SOS_DTADR), GetWORD(SOS_SIZE))){
 	Sethreg(Z80_AF, r);
 	SETFLAG(C, 1);
 	return(TRAP_NEXT);
@@ -1348,10 +1682,12 @@ int sos_twrd(void){
     return(TRAP_NEXT);
 }
 
-int sos_trdd(void){
+int sos_trdd(struct z80_cpu *cpu){
     int	r;
 
-    if (r = dio_rdd(ram + GetWORD(SOS_DTADR), GetWORD(SOS_SIZE))){
+    r = dio_rdd(cpu->ram + GetWORD(SOS_DTADR), GetWORD(SOS_SIZE));
+    BB_INVALIDATE(GetWORD(SOS_DTADR), GetWORD(SOS_SIZE));
+    if (r){
 	Sethreg(Z80_AF, r);
 	SETFLAG(C, 1);
 	return(TRAP_NEXT);
@@ -1360,7 +1696,7 @@ int sos_trdd(void){
     return(TRAP_NEXT);
 }
 
-int sos_tdir(void){
+int sos_tdir(struct z80_cpu *cpu){
     int	dirno;
     char	name[SOS_FNAMEBUF_SIZE];
     char	ext[SOS_FNAMEEXTLEN + 1];
@@ -1387,20 +1723,20 @@ int sos_tdir(void){
     return(TRAP_NEXT);
 }
 
-int sos_parsc(void){
+int sos_parsc(struct z80_cpu *cpu){
     PutWORD(SOS_SIZE, GetWORD(EM_SIZE));
     PutWORD(SOS_DTADR, GetWORD(EM_DTADR));
     PutWORD(SOS_EXADR, GetWORD(EM_EXADR));
     return(TRAP_NEXT);
 }
 
-int sos_parcs(void){
+int sos_parcs(struct z80_cpu *cpu){
     PutWORD(EM_SIZE, GetWORD(SOS_SIZE));
     PutWORD(EM_DTADR, GetWORD(SOS_DTADR));
     PutWORD(EM_EXADR, GetWORD(SOS_EXADR));
     return(TRAP_NEXT);
 }
 
-int sos_boot(void){
+int sos_boot(struct z80_cpu *cpu){
     return(TRAP_QUIT);		/* quit emulator */
 }
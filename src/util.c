@@ -4,21 +4,61 @@
 
    tate@spa.is.uec.ac.jp
 */
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
 #include "simz80.h"
+#include "bbcache.h"
+#include "jit.h"
 
 void
-z80_push(WORD x){
-    PutBYTE(--sp, (x) >> 8);
-    PutBYTE(--sp, x);
+z80_push(struct z80_cpu *cpu, WORD x){
+    PutBYTE(--cpu->sp, (x) >> 8);
+    PutBYTE(--cpu->sp, x);
 }
 
 WORD
-z80_pop(void){
+z80_pop(struct z80_cpu *cpu){
     WORD	r;
 
     /* poor code, against some compiler error */
-    r = (WORD) GetBYTE(sp++);
-    r += ((WORD) GetBYTE(sp++) << 8);
+    r = (WORD) GetBYTE(cpu->sp++);
+    r += ((WORD) GetBYTE(cpu->sp++) << 8);
     return(r);
 }
 
+/** Create a machine with cleared registers and memory.
+    @retval NULL out of memory
+    @return the machine
+ */
+struct z80_cpu *
+z80_new(void){
+    void	*p;
+    struct z80_cpu *cpu;
+
+    if (posix_memalign(&p, Z80_CACHELINE, sizeof(struct z80_cpu)))
+	return(NULL);
+    cpu = p;
+    memset(cpu, 0, sizeof(struct z80_cpu));
+    sched_init(cpu);
+    if (bb_alloc(cpu)){
+	free(cpu);
+	return(NULL);
+    }
+    return(cpu);
+}
+
+/** Release a machine created by z80_new().
+    @param[in] cpu the machine
+ */
+void
+z80_free(struct z80_cpu *cpu){
+    prof_stop(cpu);
+    trace_stop(cpu);
+    (void) replay_stop(cpu);
+    hle_stop(cpu);
+    jit_free(cpu);
+    bb_free(cpu);
+    free(cpu);
+}
@@ -0,0 +1,279 @@
+/*
+   SWORD Emurator  interpreter variants
+
+   simz80.pl generates simz80-name.c for every line of variants.lst,
+   an interpreter called simz80_run_name() built with the options of
+   the line instead of those of simz80.c, and simz80v.h, the list of
+   them.  The machines of the process run the one selected here;
+   which is the fastest depends on the compiler and the host, so
+   "make bench-cpu" times them on the same Z80 code, and configure
+   selects the fastest by default next time.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "simz80.h"
+#include "util.h"
+#include "bbcache.h"
+#include "variant.h"
+
+#ifdef OPT_VARIANTS
+
+#define	VARIANT_BENCH_CYCLES	(200000000ULL)	/* T-states of a run */
+#define	VARIANT_BENCH_RUNS	(5)		/* the fastest run counts */
+
+#define	SIMZ80_VARIANT(_name, _options)					\
+	extern FASTWORK simz80_run_ ## _name(struct z80_cpu *, FASTREG,	\
+	    unsigned long long);
+#include "simz80v.h"
+#undef	SIMZ80_VARIANT
+
+const struct simz80_variant simz80_variants[] = {
+	{ VARIANT_DEFAULT, "as simz80.c", simz80_run },
+#define	SIMZ80_VARIANT(_name, _options)					\
+	{ #_name, _options, simz80_run_ ## _name },
+#include "simz80v.h"
+#undef	SIMZ80_VARIANT
+	{ NULL, NULL, NULL }
+};
+
+#ifndef SIMZ80_DEFAULT
+#define	SIMZ80_DEFAULT	simz80_run
+#endif
+
+FASTWORK (*simz80_runner)(struct z80_cpu *, FASTREG, unsigned long long)
+    = SIMZ80_DEFAULT;
+
+/* the workloads: each runs for ever in memory it does not write */
+struct variant_bench {
+	const char *name;
+	WORD	org;			/* where it runs */
+	const BYTE *code;
+	size_t	size;
+};
+
+/* an indexed load, arithmetic with CB and ED op-codes, a store and a
+   conditional jump for each of 256 bytes, and a call for each of them
+
+	3000	LD IX,4000H
+		LD HL,5000H
+		LD B,0
+	3009	LD A,(IX+0)
+		ADD A,L
+		RLC A
+		NEG
+		LD (HL),A
+		INC HL
+		INC IX
+		BIT 0,A
+		JR Z,301AH
+		INC C
+	301A	PUSH BC
+		CALL 3024H
+		POP BC
+		DJNZ 3009H
+		JP 3000H
+	3024	LD A,C
+		AND 0FH
+		LD C,A
+		RET
+*/
+static const BYTE variant_bench_mixed[] = {
+	0xdd, 0x21, 0x00, 0x40, 0x21, 0x00, 0x50, 0x06, 0x00,
+	0xdd, 0x7e, 0x00, 0x85, 0xcb, 0x07, 0xed, 0x44, 0x77, 0x23,
+	0xdd, 0x23, 0xcb, 0x47, 0x28, 0x01, 0x0c,
+	0xc5, 0xcd, 0x24, 0x30, 0xc1, 0x10, 0xe8, 0xc3, 0x00, 0x30,
+	0x79, 0xe6, 0x0f, 0x4f, 0xc9,
+};
+
+/* two tables walked by IX and IY, all but the loop CB, DD, FD, DDCB
+   and FDCB op-codes
+
+	3100	LD IX,4000H
+		LD IY,5000H
+		LD B,0
+	310A	LD A,(IX+0)
+		LD (IY+1),A
+		RLC (IX+0)
+		BIT 0,(IY+1)
+		SRL A
+		ADD A,(IX+1)
+		LD (IY+0),A
+		INC IX
+		INC IY
+		RL C
+		DJNZ 310AH
+		JP 3100H
+*/
+static const BYTE variant_bench_prefixed[] = {
+	0xdd, 0x21, 0x00, 0x40, 0xfd, 0x21, 0x00, 0x50, 0x06, 0x00,
+	0xdd, 0x7e, 0x00, 0xfd, 0x77, 0x01, 0xdd, 0xcb, 0x00, 0x06,
+	0xfd, 0xcb, 0x01, 0x46, 0xcb, 0x3f, 0xdd, 0x86, 0x01,
+	0xfd, 0x77, 0x00, 0xdd, 0x23, 0xfd, 0x23, 0xcb, 0x11,
+	0x10, 0xe2, 0xc3, 0x00, 0x31,
+};
+
+static const struct variant_bench variant_benches[] = {
+	{ "mixed", 0x3000, variant_bench_mixed, sizeof(variant_bench_mixed) },
+	{ "prefixed", 0x3100, variant_bench_prefixed,
+	  sizeof(variant_bench_prefixed) },
+	{ NULL, 0, NULL, 0 }
+};
+
+/** Time one run of a workload.
+    @param[in] cpu a machine, with the workloads in memory
+    @param[in] v   the interpreter
+    @param[in] b   the workload
+    @return the seconds taken
+ */
+static double
+variant_bench_run(struct z80_cpu *cpu, const struct simz80_variant *v,
+    const struct variant_bench *b){
+	struct timespec	t0, t1;
+	unsigned long long end;
+
+	bb_init(cpu);
+	cpu->sp = 0xf000;
+	cpu->pc = b->org;
+	end = cpu->cycles + VARIANT_BENCH_CYCLES;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	while ( cpu->cycles < end )
+		cpu->pc = v->run(cpu, cpu->pc, end - cpu->cycles) & 0xffff;
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	return ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+}
+#endif	/* OPT_VARIANTS */
+
+/** Select the interpreter of every machine.
+    @param[in] name its name, VARIANT_DEFAULT for simz80_run()
+    @retval 0 success
+    @retval -1 no such variant; without the variants built, there is
+               only VARIANT_DEFAULT
+ */
+int
+simz80_select(const char *name){
+#ifdef OPT_VARIANTS
+	const struct simz80_variant *v;
+
+	for(v = simz80_variants; v->name != NULL; ++v) {
+
+		if ( strcmp(v->name, name) == 0 ) {
+
+			simz80_runner = v->run;
+			return 0;
+		}
+	}
+	return -1;
+#else
+	return ( strcmp(name, VARIANT_DEFAULT) == 0 ) ? 0 : -1;
+#endif
+}
+
+/** List the interpreters on the standard error, the selected one
+    marked.
+ */
+void
+simz80_list(void){
+#ifdef OPT_VARIANTS
+	const struct simz80_variant *v;
+
+	for(v = simz80_variants; v->name != NULL; ++v)
+		fprintf(stderr, "%c %-20s %s\n",
+		    ( v->run == simz80_runner ) ? '*' : ' ',
+		    v->name, v->options);
+#else
+	fprintf(stderr, "* %-20s %s\n", VARIANT_DEFAULT, "as simz80.c");
+#endif
+}
+
+/** Time every interpreter on each workload, and write the name of
+    the fastest over all of them to the standard output; the speeds go
+    to the standard error.
+    Every interpreter runs each workload once untimed first, to warm
+    the caches and the branch predictors; then the rounds run all the
+    interpreters in turn, so that a slow spell of the host falls on
+    all of them, and the fastest run of each counts.
+    @retval 0 success
+    @retval -1 out of memory, or the variants are not built
+ */
+int
+simz80_bench(void){
+#ifdef OPT_VARIANTS
+	const struct simz80_variant *v, *best = NULL;
+	const struct variant_bench *b;
+	struct z80_cpu *cpu;
+	double	t, *bt, vt, total = 0.0;
+	int	nv, nb, i, j, r;
+
+	for(nv = 0; simz80_variants[nv].name != NULL; ++nv)
+		;
+	for(nb = 0; variant_benches[nb].name != NULL; ++nb)
+		;
+	bt = calloc(nv * nb, sizeof(double));
+	if ( bt == NULL )
+		return -1;
+	cpu = z80_new();
+	if ( cpu == NULL ) {
+
+		free(bt);
+		return -1;
+	}
+	for(b = variant_benches; b->name != NULL; ++b)
+		memcpy(&cpu->ram[b->org], b->code, b->size);
+
+	for(v = simz80_variants; v->name != NULL; ++v) {
+
+		for(b = variant_benches; b->name != NULL; ++b)
+			(void)variant_bench_run(cpu, v, b);
+	}
+	for(r = 0; r < VARIANT_BENCH_RUNS; ++r) {
+
+		for(i = 0; i < nv; ++i) {
+
+			for(j = 0; j < nb; ++j) {
+
+				t = variant_bench_run(cpu, &simz80_variants[i],
+				    &variant_benches[j]);
+				if ( r == 0 || t < bt[i * nb + j] )
+					bt[i * nb + j] = t;
+			}
+		}
+	}
+
+	fprintf(stderr, "%-20s", "");
+	for(b = variant_benches; b->name != NULL; ++b)
+		fprintf(stderr, " %12s", b->name);
+	fprintf(stderr, "\n");
+	for(i = 0; i < nv; ++i) {
+
+		v = &simz80_variants[i];
+		fprintf(stderr, "%-20s", v->name);
+		vt = 0.0;
+		for(j = 0; j < nb; ++j) {
+
+			fprintf(stderr, " %8.1f MHz",
+			    VARIANT_BENCH_CYCLES / bt[i * nb + j] / 1e6);
+			vt += bt[i * nb + j];
+		}
+		fprintf(stderr, "\n");
+		if ( best == NULL || vt < total ) {
+
+			best = v;
+			total = vt;
+		}
+	}
+
+	free(bt);
+	z80_free(cpu);
+	printf("%s\n", best->name);
+	return 0;
+#else
+	return -1;
+#endif
+}
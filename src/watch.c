@@ -0,0 +1,119 @@
+/*
+   SWORD Emurator  write watch
+
+   Each machine has a page table with a bit for every watcher whose
+   range touches the page.  A store to a page without watchers is a
+   plain store; a store to a watched page calls watch_hit(), which
+   calls the watchers of the addresses written.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include "simz80.h"
+#include "watch.h"
+
+/** Rebuild the page table from the watchers.
+    @param[in] cpu the machine
+ */
+static void
+watch_map_pages(struct z80_cpu *cpu){
+	const struct watch *w;
+	int i, page;
+
+	for(page = 0; page < 256; ++page)
+		cpu->watch_map[page] = 0;
+
+	for(i = 0; i < WATCH_NR; ++i) {
+
+		w = &cpu->watch[i];
+		if ( w->fn == NULL )
+			continue;
+		for(page = w->lo >> 8; page <= w->hi >> 8; ++page)
+			cpu->watch_map[page] |= ( 1 << i );
+	}
+}
+
+/** Watch writes to a range of Z80 memory.
+    Adding the same watcher again does nothing.
+    @param[in] cpu the machine
+    @param[in] lo  the first address to watch
+    @param[in] hi  the last address to watch
+    @param[in] fn  the function to call after a write
+    @param[in] arg argument of fn
+    @return watcher ID
+    @retval -1 no free watcher or lo > hi
+ */
+int
+watch_add(struct z80_cpu *cpu, WORD lo, WORD hi, watch_fn fn, void *arg){
+	struct watch *w;
+	int i, id;
+
+	if ( lo > hi )
+		return -1;
+
+	id = -1;
+	for(i = 0; i < WATCH_NR; ++i) {
+
+		w = &cpu->watch[i];
+		if ( w->fn == fn && w->arg == arg && w->lo == lo && w->hi == hi )
+			return i;
+		if ( w->fn == NULL && id < 0 )
+			id = i;
+	}
+	if ( id < 0 )
+		return -1;
+
+	w = &cpu->watch[id];
+	w->fn = fn;
+	w->arg = arg;
+	w->lo = lo;
+	w->hi = hi;
+	watch_map_pages(cpu);
+	return id;
+}
+
+/** Stop watching.
+    @param[in] cpu the machine
+    @param[in] id  watcher ID returned by watch_add()
+ */
+void
+watch_del(struct z80_cpu *cpu, int id){
+
+	if ( id < 0 || id >= WATCH_NR )
+		return;
+	cpu->watch[id].fn = NULL;
+	watch_map_pages(cpu);
+}
+
+/** Call the watchers of the addresses written by Z80 code.
+    @param[in] cpu  the machine
+    @param[in] addr the lowest address written
+    @param[in] len  the number of bytes written, may wrap at 0xffff
+    @param[in] down the bytes were written from the highest address
+ */
+void
+watch_hit(struct z80_cpu *cpu, WORD addr, unsigned int len, int down){
+	const struct watch *w;
+	unsigned int n, bits;
+	WORD a;
+	int i;
+
+	for(n = 0; n < len; ++n) {
+
+		a = down ? (WORD)( addr + len - 1 - n ) : (WORD)( addr + n );
+		bits = cpu->watch_map[a >> 8];
+		if ( bits == 0 ) {
+
+			/* skip the rest of the page */
+			n += down ? ( a & 0xff ) : ( 0xff - ( a & 0xff ) );
+			continue;
+		}
+		for(i = 0; bits != 0; ++i, bits >>= 1) {
+
+			w = &cpu->watch[i];
+			if ( ( bits & 1 ) && a >= w->lo && a <= w->hi )
+				w->fn(cpu, a, w->arg);
+		}
+	}
+}